@@ -360,7 +360,17 @@ class CacheDB : public BasicDB {
   enum Option {
     TSMALL = 1 << 0,                     ///< dummy for compatibility
     TLINEAR = 1 << 1,                    ///< dummy for compatibility
-    TCOMPRESS = 1 << 2                   ///< compress each record
+    TCOMPRESS = 1 << 2,                  ///< compress each record
+    TXXHASH = 1 << 3,                    ///< use XXH64 hashing instead of MurMur hashing
+    TCHECKSUM = 1 << 4                   ///< dummy for compatibility
+  };
+  /**
+   * Options of the memory-mapped region.
+   */
+  enum MapOption {
+    MGROW = 1 << 0,                      ///< dummy for compatibility
+    MPOPULATE = 1 << 1,                  ///< dummy for compatibility
+    MHUGE = 1 << 2                       ///< dummy for compatibility
   };
   /**
    * Status flags.
@@ -1088,7 +1098,8 @@ class CacheDB : public BasicDB {
   }
   /**
    * Set the optional features.
-   * @param opts the optional features by bitwise-or: DirDB::TCOMPRESS to compress each record.
+   * @param opts the optional features by bitwise-or: DirDB::TCOMPRESS to compress each record,
+   * CacheDB::TXXHASH to use XXH64 hashing.
    * @return true on success, or false on failure.
    */
   bool tune_options(int8_t opts) {
@@ -1431,6 +1442,13 @@ class CacheDB : public BasicDB {
   bool tune_map(int64_t msiz) {
     return true;
   }
+  /**
+   * Set the options of the internal memory-mapped region.
+   * @note This is a dummy implementation for compatibility.
+   */
+  bool tune_map_options(int8_t mopts) {
+    return true;
+  }
   /**
    * Set the unit step number of auto defragmentation.
    * @note This is a dummy implementation for compatibility.
@@ -1935,7 +1953,7 @@ class CacheDB : public BasicDB {
    */
   uint64_t hash_record(const char* kbuf, size_t ksiz) {
     _assert_(kbuf && ksiz <= MEMMAXSIZ);
-    return hashmurmur(kbuf, ksiz);
+    return (opts_ & TXXHASH) ? hashxx(kbuf, ksiz) : hashmurmur(kbuf, ksiz);
   }
   /**
    * Fold a hash value into a small number.
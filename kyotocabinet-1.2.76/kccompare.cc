@@ -47,6 +47,27 @@ DecimalDescendingComparator decimaldescfunc;
 DecimalDescendingComparator* const DECIMALDESCCOMP = &decimaldescfunc;
 
 
+/**
+ * Prepared pointer of the comparator in the order of signed integers.
+ */
+IntegerComparator integerfunc;
+IntegerComparator* const INTEGERCOMP = &integerfunc;
+
+
+/**
+ * Prepared pointer of the comparator in the order of unsigned integers.
+ */
+UnsignedComparator unsignedfunc;
+UnsignedComparator* const UNSIGNEDCOMP = &unsignedfunc;
+
+
+/**
+ * Prepared pointer of the comparator in the order of floating-point numbers.
+ */
+FloatComparator floatfunc;
+FloatComparator* const FLOATCOMP = &floatfunc;
+
+
 }                                        // common namespace
 
 // END OF FILE
@@ -53,10 +53,8 @@ class LexicalComparator : public Comparator {
   int32_t compare(const char* akbuf, size_t aksiz, const char* bkbuf, size_t bksiz) {
     _assert_(akbuf && bkbuf);
     size_t msiz = aksiz < bksiz ? aksiz : bksiz;
-    for (size_t i = 0; i < msiz; i++) {
-      if (((uint8_t*)akbuf)[i] != ((uint8_t*)bkbuf)[i])
-        return ((uint8_t*)akbuf)[i] - ((uint8_t*)bkbuf)[i];
-    }
+    int32_t rv = std::memcmp(akbuf, bkbuf, msiz);
+    if (rv != 0) return rv;
     return (int32_t)aksiz - (int32_t)bksiz;
   }
 };
@@ -184,6 +182,107 @@ class DecimalDescendingComparator : public Comparator {
 };
 
 
+/**
+ * Comparator in the order of signed integers in big-endian.
+ * @note Each key is read as a two's complement integer of its size in the network byte order.
+ * Keys longer than 8 bytes are read by the first 8 bytes.  Keys of the same value are compared
+ * in the lexical order.
+ */
+class IntegerComparator : public Comparator {
+ public:
+  explicit IntegerComparator() {}
+  int32_t compare(const char* akbuf, size_t aksiz, const char* bkbuf, size_t bksiz) {
+    _assert_(akbuf && bkbuf);
+    if (aksiz == sizeof(int64_t) && bksiz == sizeof(int64_t)) {
+      int64_t anum = (int64_t)readfixnum(akbuf, sizeof(int64_t));
+      int64_t bnum = (int64_t)readfixnum(bkbuf, sizeof(int64_t));
+      return anum < bnum ? -1 : anum > bnum ? 1 : 0;
+    }
+    int64_t anum = read(akbuf, aksiz);
+    int64_t bnum = read(bkbuf, bksiz);
+    if (anum < bnum) return -1;
+    if (anum > bnum) return 1;
+    LexicalComparator lexcomp;
+    return lexcomp.compare(akbuf, aksiz, bkbuf, bksiz);
+  }
+ private:
+  static int64_t read(const char* kbuf, size_t ksiz) {
+    if (ksiz > sizeof(int64_t)) ksiz = sizeof(int64_t);
+    if (ksiz < 1) return 0;
+    uint64_t num = readfixnum(kbuf, ksiz);
+    if (ksiz < sizeof(int64_t) && (*(uint8_t*)kbuf & 0x80)) num |= ~0ULL << (ksiz * 8);
+    return (int64_t)num;
+  }
+};
+
+
+/**
+ * Comparator in the order of unsigned integers in big-endian.
+ * @note Each key is read as an unsigned integer of its size in the network byte order.  Keys
+ * longer than 8 bytes are read by the first 8 bytes.  Keys of the same value are compared in
+ * the lexical order.
+ */
+class UnsignedComparator : public Comparator {
+ public:
+  explicit UnsignedComparator() {}
+  int32_t compare(const char* akbuf, size_t aksiz, const char* bkbuf, size_t bksiz) {
+    _assert_(akbuf && bkbuf);
+    uint64_t anum = read(akbuf, aksiz);
+    uint64_t bnum = read(bkbuf, bksiz);
+    if (anum < bnum) return -1;
+    if (anum > bnum) return 1;
+    if (aksiz == bksiz && aksiz <= sizeof(uint64_t)) return 0;
+    LexicalComparator lexcomp;
+    return lexcomp.compare(akbuf, aksiz, bkbuf, bksiz);
+  }
+ private:
+  static uint64_t read(const char* kbuf, size_t ksiz) {
+    if (ksiz == sizeof(uint64_t)) return readfixnum(kbuf, sizeof(uint64_t));
+    if (ksiz > sizeof(uint64_t)) ksiz = sizeof(uint64_t);
+    return ksiz > 0 ? readfixnum(kbuf, ksiz) : 0;
+  }
+};
+
+
+/**
+ * Comparator in the order of floating-point numbers in big-endian.
+ * @note Each key of 8 bytes is read as a double and each key of 4 bytes is read as a float of
+ * IEEE 754 in the network byte order.  Keys of the other sizes are regarded as zero.  Negative
+ * zero comes before positive zero and NaNs come at both ends by their sign.  Keys of the same
+ * value are compared in the lexical order.
+ */
+class FloatComparator : public Comparator {
+ public:
+  explicit FloatComparator() {}
+  int32_t compare(const char* akbuf, size_t aksiz, const char* bkbuf, size_t bksiz) {
+    _assert_(akbuf && bkbuf);
+    uint64_t anum = read(akbuf, aksiz);
+    uint64_t bnum = read(bkbuf, bksiz);
+    if (anum < bnum) return -1;
+    if (anum > bnum) return 1;
+    LexicalComparator lexcomp;
+    return lexcomp.compare(akbuf, aksiz, bkbuf, bksiz);
+  }
+ private:
+  static uint64_t read(const char* kbuf, size_t ksiz) {
+    uint64_t bits;
+    if (ksiz == sizeof(double)) {
+      bits = readfixnum(kbuf, sizeof(double));
+    } else if (ksiz == sizeof(float)) {
+      uint32_t fbits = readfixnum(kbuf, sizeof(float));
+      float fnum;
+      std::memcpy(&fnum, &fbits, sizeof(fnum));
+      double dnum = fnum;
+      std::memcpy(&bits, &dnum, sizeof(bits));
+    } else {
+      bits = 0;
+    }
+    const uint64_t SIGNBIT = 1ULL << 63;
+    return (bits & SIGNBIT) ? ~bits : bits | SIGNBIT;
+  }
+};
+
+
 /**
  * Prepared pointer of the comparator in the lexical order.
  */
@@ -208,6 +307,24 @@ extern DecimalComparator* const DECIMALCOMP;
 extern DecimalDescendingComparator* const DECIMALDESCCOMP;
 
 
+/**
+ * Prepared pointer of the comparator in the order of signed integers.
+ */
+extern IntegerComparator* const INTEGERCOMP;
+
+
+/**
+ * Prepared pointer of the comparator in the order of unsigned integers.
+ */
+extern UnsignedComparator* const UNSIGNEDCOMP;
+
+
+/**
+ * Prepared pointer of the comparator in the order of floating-point numbers.
+ */
+extern FloatComparator* const FLOATCOMP;
+
+
 }                                        // common namespace
 
 #endif                                   // duplication check
@@ -34,9 +34,36 @@ extern "C" {
 }
 #endif
 
+#if _KC_LZ4
+extern "C" {
+#include <lz4.h>
+}
+#endif
+
+#if _KC_ZSTD
+extern "C" {
+#include <zstd.h>
+#include <zdict.h>
+}
+#endif
+
 namespace kyotocabinet {                 // common namespace
 
 
+// read a copy tagged by a build without the compression library
+static char* readtagged(const void* buf, size_t size, size_t* sp, char tag, uint8_t mode) {
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  if (size < 2 || ((char*)buf)[0] != tag || ((uint8_t*)buf)[1] != mode) return NULL;
+  buf = (char*)buf + 2;
+  size -= 2;
+  char* zbuf = new char[size+1];
+  std::memcpy(zbuf, buf, size);
+  zbuf[size] = '\0';
+  *sp = size;
+  return zbuf;
+}
+
+
 /**
  * Compress a serial data.
  */
@@ -139,17 +166,10 @@ char* ZLIB::decompress(const void* buf, size_t size, size_t* sp, Mode mode) {
       break;
     }
   }
-  return NULL;
+  return readtagged(buf, size, sp, 'z', mode);
 #else
   _assert_(buf && size <= MEMMAXSIZ && sp);
-  if (size < 2 || ((char*)buf)[0] != 'z' || ((char*)buf)[1] != (uint8_t)mode) return NULL;
-  buf = (char*)buf + 2;
-  size -= 2;
-  char* zbuf = new char[size+1];
-  std::memcpy(zbuf, buf, size);
-  zbuf[size] = '\0';
-  *sp = size;
-  return zbuf;
+  return readtagged(buf, size, sp, 'z', mode);
 #endif
 }
 
@@ -362,17 +382,10 @@ char* LZMA::decompress(const void* buf, size_t size, size_t* sp, Mode mode) {
       break;
     }
   }
-  return NULL;
+  return readtagged(buf, size, sp, 'x', mode);
 #else
   _assert_(buf && size <= MEMMAXSIZ && sp);
-  if (size < 2 || ((char*)buf)[0] != 'x' || ((char*)buf)[1] != mode) return NULL;
-  buf = (char*)buf + 2;
-  size -= 2;
-  char* zbuf = new char[size+1];
-  std::memcpy(zbuf, buf, size);
-  zbuf[size] = '\0';
-  *sp = size;
-  return zbuf;
+  return readtagged(buf, size, sp, 'x', mode);
 #endif
 }
 
@@ -391,6 +404,313 @@ uint32_t LZMA::calculate_crc(const void* buf, size_t size, uint32_t seed) {
 }
 
 
+/**
+ * Compress a serial data.
+ */
+char* LZ4::compress(const void* buf, size_t size, size_t* sp, Mode mode) {
+#if _KC_LZ4
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  if (size > (size_t)LZ4_MAX_INPUT_SIZE) return NULL;
+  int32_t bound = LZ4_compressBound(size);
+  char* zbuf = new char[NUMBUFSIZ+bound+sizeof(uint32_t)+1];
+  char* wp = zbuf;
+  wp += writevarnum(wp, size);
+  int32_t zsiz = LZ4_compress_default((const char*)buf, wp, size, bound);
+  if (zsiz < 1) {
+    delete[] zbuf;
+    return NULL;
+  }
+  wp += zsiz;
+  if (mode == CRC) {
+    uint32_t hash = hashcrc32c(zbuf, wp - zbuf);
+    writefixnum(wp, hash, sizeof(hash));
+    wp += sizeof(hash);
+  }
+  *wp = '\0';
+  *sp = wp - zbuf;
+  return zbuf;
+#else
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  char* zbuf = new char[size+2];
+  char* wp = zbuf;
+  *(wp++) = '4';
+  *(wp++) = mode;
+  std::memcpy(wp, buf, size);
+  *sp = size + 2;
+  return zbuf;
+#endif
+}
+
+
+/**
+ * Decompress a serial data.
+ */
+char* LZ4::decompress(const void* buf, size_t size, size_t* sp, Mode mode) {
+#if _KC_LZ4
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  const char* rp = (const char*)buf;
+  size_t rsiz = size;
+  if (mode == CRC) {
+    if (rsiz < sizeof(uint32_t)) return readtagged(buf, size, sp, '4', mode);
+    uint32_t hash = readfixnum(rp + rsiz - sizeof(hash), sizeof(hash));
+    rsiz -= sizeof(hash);
+    if (hashcrc32c(rp, rsiz) != hash) return readtagged(buf, size, sp, '4', mode);
+  }
+  uint64_t usiz;
+  size_t step = readvarnum(rp, rsiz, &usiz);
+  if (step < 1 || usiz > (uint64_t)LZ4_MAX_INPUT_SIZE)
+    return readtagged(buf, size, sp, '4', mode);
+  rp += step;
+  rsiz -= step;
+  char* zbuf = new char[usiz+1];
+  if (LZ4_decompress_safe(rp, zbuf, rsiz, usiz) != (int64_t)usiz) {
+    delete[] zbuf;
+    return readtagged(buf, size, sp, '4', mode);
+  }
+  zbuf[usiz] = '\0';
+  *sp = usiz;
+  return zbuf;
+#else
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  return readtagged(buf, size, sp, '4', mode);
+#endif
+}
+
+
+/**
+ * Hidden resources for Zstandard.
+ */
+struct ZSTDCore {
+#if _KC_ZSTD
+  SpinLock lock;                         ///< lock of the context pools
+  std::vector<ZSTD_CCtx*> cctxs;         ///< pool of compression contexts
+  std::vector<ZSTD_DCtx*> dctxs;         ///< pool of decompression contexts
+  ZSTD_CDict* cdict;                     ///< digested dictionary for compression
+  ZSTD_DDict* ddict;                     ///< digested dictionary for decompression
+#endif
+  ZSTD::Mode mode;                       ///< compression mode
+  /** constructor */
+  explicit ZSTDCore(ZSTD::Mode mode = ZSTD::RAW) :
+#if _KC_ZSTD
+      lock(), cctxs(), dctxs(), cdict(NULL), ddict(NULL),
+#endif
+      mode(mode) {}
+  /** destructor */
+  ~ZSTDCore() {
+#if _KC_ZSTD
+    for (size_t i = 0; i < cctxs.size(); i++) {
+      ZSTD_freeCCtx(cctxs[i]);
+    }
+    for (size_t i = 0; i < dctxs.size(); i++) {
+      ZSTD_freeDCtx(dctxs[i]);
+    }
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+#endif
+  }
+};
+static ZSTDCore zstdcore;
+
+
+// compress a serial data with Zstandard
+static char* zstdcompress(ZSTDCore* core, const void* buf, size_t size, size_t* sp,
+                          ZSTD::Mode mode) {
+#if _KC_ZSTD
+  _assert_(core && buf && size <= MEMMAXSIZ && sp);
+  ZSTD_CCtx* cctx = NULL;
+  core->lock.lock();
+  if (!core->cctxs.empty()) {
+    cctx = core->cctxs.back();
+    core->cctxs.pop_back();
+  }
+  core->lock.unlock();
+  if (!cctx) {
+    cctx = ZSTD_createCCtx();
+    if (!cctx) return NULL;
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_dictIDFlag, 0);
+  }
+  ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, mode == ZSTD::CRC ? 1 : 0);
+  ZSTD_CCtx_refCDict(cctx, core->cdict);
+  size_t bound = ZSTD_compressBound(size);
+  char* zbuf = new char[bound+1];
+  size_t zsiz = ZSTD_compress2(cctx, zbuf, bound, buf, size);
+  core->lock.lock();
+  core->cctxs.push_back(cctx);
+  core->lock.unlock();
+  if (ZSTD_isError(zsiz)) {
+    delete[] zbuf;
+    return NULL;
+  }
+  zbuf[zsiz] = '\0';
+  *sp = zsiz;
+  return zbuf;
+#else
+  _assert_(core && buf && size <= MEMMAXSIZ && sp);
+  char* zbuf = new char[size+2];
+  char* wp = zbuf;
+  *(wp++) = 's';
+  *(wp++) = mode;
+  std::memcpy(wp, buf, size);
+  *sp = size + 2;
+  return zbuf;
+#endif
+}
+
+
+// decompress a serial data with Zstandard
+static char* zstddecompress(ZSTDCore* core, const void* buf, size_t size, size_t* sp,
+                            ZSTD::Mode mode) {
+#if _KC_ZSTD
+  _assert_(core && buf && size <= MEMMAXSIZ && sp);
+  unsigned long long usiz = ZSTD_getFrameContentSize(buf, size);
+  if (usiz == ZSTD_CONTENTSIZE_ERROR || usiz == ZSTD_CONTENTSIZE_UNKNOWN ||
+      usiz > (unsigned long long)MEMMAXSIZ) return readtagged(buf, size, sp, 's', mode);
+  ZSTD_DCtx* dctx = NULL;
+  core->lock.lock();
+  if (!core->dctxs.empty()) {
+    dctx = core->dctxs.back();
+    core->dctxs.pop_back();
+  }
+  core->lock.unlock();
+  if (!dctx) {
+    dctx = ZSTD_createDCtx();
+    if (!dctx) return NULL;
+  }
+  char* zbuf = new char[usiz+1];
+  size_t rv = core->ddict ?
+    ZSTD_decompress_usingDDict(dctx, zbuf, usiz, buf, size, core->ddict) :
+    ZSTD_decompressDCtx(dctx, zbuf, usiz, buf, size);
+  core->lock.lock();
+  core->dctxs.push_back(dctx);
+  core->lock.unlock();
+  if (ZSTD_isError(rv) || rv != usiz) {
+    delete[] zbuf;
+    return readtagged(buf, size, sp, 's', mode);
+  }
+  zbuf[usiz] = '\0';
+  *sp = usiz;
+  return zbuf;
+#else
+  _assert_(core && buf && size <= MEMMAXSIZ && sp);
+  return readtagged(buf, size, sp, 's', mode);
+#endif
+}
+
+
+/**
+ * Compress a serial data.
+ */
+char* ZSTD::compress(const void* buf, size_t size, size_t* sp, Mode mode) {
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  return zstdcompress(&zstdcore, buf, size, sp, mode);
+}
+
+
+/**
+ * Decompress a serial data.
+ */
+char* ZSTD::decompress(const void* buf, size_t size, size_t* sp, Mode mode) {
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  return zstddecompress(&zstdcore, buf, size, sp, mode);
+}
+
+
+/**
+ * Train a dictionary from sample data.
+ */
+char* ZSTD::train_dictionary(const std::vector<std::string>& samples, size_t capacity,
+                             size_t* sp) {
+  _assert_(capacity <= MEMMAXSIZ && sp);
+  if (capacity < 1 || samples.empty()) return NULL;
+  std::string sbuf;
+  std::vector<size_t> sizes;
+  std::vector<std::string>::const_iterator it = samples.begin();
+  std::vector<std::string>::const_iterator itend = samples.end();
+  while (it != itend) {
+    sbuf.append(*it);
+    sizes.push_back(it->size());
+    ++it;
+  }
+#if _KC_ZSTD
+  char* dbuf = new char[capacity];
+  size_t dsiz = ZDICT_trainFromBuffer(dbuf, capacity, sbuf.data(), &sizes[0], sizes.size());
+  if (!ZDICT_isError(dsiz)) {
+    *sp = dsiz;
+    return dbuf;
+  }
+  delete[] dbuf;
+#endif
+  size_t rsiz = sbuf.size() < capacity ? sbuf.size() : capacity;
+  if (rsiz < 1) return NULL;
+  char* rbuf = new char[rsiz];
+  std::memcpy(rbuf, sbuf.data() + sbuf.size() - rsiz, rsiz);
+  *sp = rsiz;
+  return rbuf;
+}
+
+
+/**
+ * Constructor.
+ */
+ZSTDDictCompressor::ZSTDDictCompressor(ZSTD::Mode mode) : opq_(NULL) {
+  _assert_(true);
+  opq_ = new ZSTDCore(mode);
+}
+
+
+/**
+ * Destructor.
+ */
+ZSTDDictCompressor::~ZSTDDictCompressor() {
+  _assert_(true);
+  delete (ZSTDCore*)opq_;
+}
+
+
+/**
+ * Set the dictionary.
+ */
+bool ZSTDDictCompressor::set_dictionary(const void* buf, size_t size) {
+  _assert_(buf && size <= MEMMAXSIZ);
+#if _KC_ZSTD
+  ZSTDCore* core = (ZSTDCore*)opq_;
+  ZSTD_CDict* cdict = ZSTD_createCDict(buf, size, ZSTD_CLEVEL_DEFAULT);
+  ZSTD_DDict* ddict = ZSTD_createDDict(buf, size);
+  if (!cdict || !ddict) {
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+    return false;
+  }
+  ZSTD_freeCDict(core->cdict);
+  ZSTD_freeDDict(core->ddict);
+  core->cdict = cdict;
+  core->ddict = ddict;
+#endif
+  return true;
+}
+
+
+/**
+ * Compress a serial data.
+ */
+char* ZSTDDictCompressor::compress(const void* buf, size_t size, size_t* sp) {
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  ZSTDCore* core = (ZSTDCore*)opq_;
+  return zstdcompress(core, buf, size, sp, core->mode);
+}
+
+
+/**
+ * Decompress a serial data.
+ */
+char* ZSTDDictCompressor::decompress(const void* buf, size_t size, size_t* sp) {
+  _assert_(buf && size <= MEMMAXSIZ && sp);
+  ZSTDCore* core = (ZSTDCore*)opq_;
+  return zstddecompress(core, buf, size, sp, core->mode);
+}
+
+
 /**
  * Prepared pointer of the ZLIB raw mode.
  */
@@ -61,6 +61,9 @@ class Compressor {
 
 /**
  * ZLIB compressor.
+ * @note Without the library, data is stored as a copy tagged with the codec and the mode.  Such
+ * copies are still decompressed after the library is enabled, and so are those of LZO, LZMA,
+ * LZ4, and Zstandard.
  */
 class ZLIB {
  public:
@@ -208,6 +211,103 @@ class LZMA {
 };
 
 
+/**
+ * LZ4 compressor.
+ */
+class LZ4 {
+ public:
+  /**
+   * Compression modes.
+   */
+  enum Mode {
+    RAW,                                 ///< without any checksum
+    CRC                                  ///< with CRC32C checksum
+  };
+  /**
+   * Compress a serial data.
+   * @param buf the input buffer.
+   * @param size the size of the input buffer.
+   * @param sp the pointer to the variable into which the size of the region of the return
+   * value is assigned.
+   * @param mode the compression mode.
+   * @return the pointer to the result data, or NULL on failure.
+   * @note Because the region of the return value is allocated with the the new[] operator, it
+   * should be released with the delete[] operator when it is no longer in use.  The result is
+   * a block without frame headers, preceded by the size of the input.
+   */
+  static char* compress(const void* buf, size_t size, size_t* sp, Mode mode = RAW);
+  /**
+   * Decompress a serial data.
+   * @param buf the input buffer.
+   * @param size the size of the input buffer.
+   * @param sp the pointer to the variable into which the size of the region of the return
+   * value is assigned.
+   * @param mode the compression mode.
+   * @return the pointer to the result data, or NULL on failure.
+   * @note Because an additional zero code is appended at the end of the region of the return
+   * value, the return value can be treated as a C-style string.  Because the region of the
+   * return value is allocated with the the new[] operator, it should be released with the
+   * delete[] operator when it is no longer in use.
+   */
+  static char* decompress(const void* buf, size_t size, size_t* sp, Mode mode = RAW);
+};
+
+
+/**
+ * Zstandard compressor.
+ */
+class ZSTD {
+ public:
+  /**
+   * Compression modes.
+   */
+  enum Mode {
+    RAW,                                 ///< without any checksum
+    CRC                                  ///< with XXH64 checksum of the content
+  };
+  /**
+   * Compress a serial data.
+   * @param buf the input buffer.
+   * @param size the size of the input buffer.
+   * @param sp the pointer to the variable into which the size of the region of the return
+   * value is assigned.
+   * @param mode the compression mode.
+   * @return the pointer to the result data, or NULL on failure.
+   * @note Because the region of the return value is allocated with the the new[] operator, it
+   * should be released with the delete[] operator when it is no longer in use.
+   */
+  static char* compress(const void* buf, size_t size, size_t* sp, Mode mode = RAW);
+  /**
+   * Decompress a serial data.
+   * @param buf the input buffer.
+   * @param size the size of the input buffer.
+   * @param sp the pointer to the variable into which the size of the region of the return
+   * value is assigned.
+   * @param mode the compression mode.
+   * @return the pointer to the result data, or NULL on failure.
+   * @note Because an additional zero code is appended at the end of the region of the return
+   * value, the return value can be treated as a C-style string.  Because the region of the
+   * return value is allocated with the the new[] operator, it should be released with the
+   * delete[] operator when it is no longer in use.
+   */
+  static char* decompress(const void* buf, size_t size, size_t* sp, Mode mode = RAW);
+  /**
+   * Train a dictionary from sample data.
+   * @param samples the sample data, typically values of existing records.
+   * @param capacity the maximum size of the dictionary.
+   * @param sp the pointer to the variable into which the size of the region of the return
+   * value is assigned.
+   * @return the pointer to the dictionary, or NULL on failure.
+   * @note Because the region of the return value is allocated with the the new[] operator, it
+   * should be released with the delete[] operator when it is no longer in use.  If the
+   * samples are too few to be trained, the trailing samples are used as a raw content
+   * dictionary.
+   */
+  static char* train_dictionary(const std::vector<std::string>& samples, size_t capacity,
+                                size_t* sp);
+};
+
+
 /**
  * Compressor with ZLIB.
  */
@@ -277,6 +377,95 @@ class LZMACompressor : public Compressor {
 };
 
 
+/**
+ * Compressor with LZ4.
+ */
+template <LZ4::Mode MODE>
+class LZ4Compressor : public Compressor {
+ private:
+  /**
+   * Compress a serial data.
+   */
+  char* compress(const void* buf, size_t size, size_t* sp) {
+    _assert_(buf && size <= MEMMAXSIZ && sp);
+    return LZ4::compress(buf, size, sp, MODE);
+  }
+  /**
+   * Decompress a serial data.
+   */
+  char* decompress(const void* buf, size_t size, size_t* sp) {
+    _assert_(buf && size <= MEMMAXSIZ && sp);
+    return LZ4::decompress(buf, size, sp, MODE);
+  }
+};
+
+
+/**
+ * Compressor with Zstandard.
+ */
+template <ZSTD::Mode MODE>
+class ZSTDCompressor : public Compressor {
+ private:
+  /**
+   * Compress a serial data.
+   */
+  char* compress(const void* buf, size_t size, size_t* sp) {
+    _assert_(buf && size <= MEMMAXSIZ && sp);
+    return ZSTD::compress(buf, size, sp, MODE);
+  }
+  /**
+   * Decompress a serial data.
+   */
+  char* decompress(const void* buf, size_t size, size_t* sp) {
+    _assert_(buf && size <= MEMMAXSIZ && sp);
+    return ZSTD::decompress(buf, size, sp, MODE);
+  }
+};
+
+
+/**
+ * Compressor with Zstandard and a dictionary.
+ * @note Small records share little redundancy with themselves, so a dictionary trained from
+ * typical records improves the compression ratio of them considerably.  The same dictionary
+ * must be set to decompress the data compressed with it.
+ */
+class ZSTDDictCompressor : public Compressor {
+ public:
+  /**
+   * Constructor.
+   * @param mode the compression mode.
+   */
+  explicit ZSTDDictCompressor(ZSTD::Mode mode = ZSTD::RAW);
+  /**
+   * Destructor.
+   */
+  ~ZSTDDictCompressor();
+  /**
+   * Set the dictionary.
+   * @param buf the pointer to the region of the dictionary.
+   * @param size the size of the region of the dictionary.
+   * @return true on success, or false on failure.
+   * @note This must not be called while the compressor is in use.
+   */
+  bool set_dictionary(const void* buf, size_t size);
+ private:
+  /**
+   * Compress a serial data.
+   */
+  char* compress(const void* buf, size_t size, size_t* sp);
+  /**
+   * Decompress a serial data.
+   */
+  char* decompress(const void* buf, size_t size, size_t* sp);
+  /** Dummy constructor to forbid the use. */
+  ZSTDDictCompressor(const ZSTDDictCompressor&);
+  /** Dummy Operator to forbid the use. */
+  ZSTDDictCompressor& operator =(const ZSTDDictCompressor&);
+  /** Opaque pointer. */
+  void* opq_;
+};
+
+
 /**
  * Compressor with the Arcfour cipher.
  */
@@ -25,6 +25,7 @@
 #include <kcmap.h>
 
 #define KCDBSSMAGICDATA  "KCSS\n"        ///< The magic data of the snapshot file
+#define KCDBSZMAGICDATA  "KCSZ\n"        ///< The magic data of the compressed snapshot file
 
 namespace kyotocabinet {                 // common namespace
 
@@ -486,8 +487,11 @@ class BasicDB : public DB {
   class Logger;
   class MetaTrigger;
  private:
+  class FrameWorker;
   /** The size of the IO buffer. */
   static const size_t IOBUFSIZ = 8192;
+  /** The size of each frame of a compressed snapshot. */
+  static const size_t SSFRAMESIZ = 1 << 20;
  public:
   /**
    * Database types.
@@ -1081,6 +1085,416 @@ class BasicDB : public DB {
      */
     virtual bool process(const std::string& path, int64_t count, int64_t size) = 0;
   };
+  /**
+   * Interface to supply records for bulk loading.
+   */
+  class BulkSource {
+   public:
+    /**
+     * Destructor.
+     */
+    virtual ~BulkSource() {
+      _assert_(true);
+    }
+    /**
+     * Read the next record.
+     * @param ksp the pointer to the variable into which the size of the key is assigned.
+     * @param vbp the pointer to the variable into which the pointer to the value is assigned.
+     * @param vsp the pointer to the variable into which the size of the value is assigned.
+     * @return the pointer to the key region, or NULL if no record remains.
+     * @note The returned regions must be valid until the next call.  Records are loaded fastest
+     * when they are read in ascending order of the keys.
+     */
+    virtual const char* read(size_t* ksp, const char** vbp, size_t* vsp) = 0;
+  };
+  /**
+   * Batch of record updates to be applied atomically.
+   * @note Keys and values are copied into one arena buffer.  Operations on the same key take
+   * effect in the order of addition.  This class is not thread-safe.
+   */
+  class WriteBatch {
+   public:
+    /**
+     * Kinds of operations.
+     */
+    enum Kind {
+      KSET,                              ///< setting the value of a record
+      KREMOVE                            ///< removing a record
+    };
+    /**
+     * Default constructor.
+     */
+    explicit WriteBatch() : arena_(), ops_() {
+      _assert_(true);
+    }
+    /**
+     * Set the value of a record.
+     * @param kbuf the pointer to the key region.
+     * @param ksiz the size of the key region.
+     * @param vbuf the pointer to the value region.
+     * @param vsiz the size of the value region.
+     */
+    void set(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && vbuf && vsiz <= MEMMAXSIZ);
+      Operation op = { KSET, arena_.size(), ksiz, vsiz };
+      arena_.append(kbuf, ksiz);
+      arena_.append(vbuf, vsiz);
+      ops_.push_back(op);
+    }
+    /**
+     * Set the value of a record.
+     * @note Equal to the original WriteBatch::set method except that the parameters are
+     * std::string.
+     */
+    void set(const std::string& key, const std::string& value) {
+      _assert_(true);
+      set(key.data(), key.size(), value.data(), value.size());
+    }
+    /**
+     * Remove a record.
+     * @param kbuf the pointer to the key region.
+     * @param ksiz the size of the key region.
+     * @note Removing a missing record is not an error when the batch is applied.
+     */
+    void remove(const char* kbuf, size_t ksiz) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ);
+      Operation op = { KREMOVE, arena_.size(), ksiz, 0 };
+      arena_.append(kbuf, ksiz);
+      ops_.push_back(op);
+    }
+    /**
+     * Remove a record.
+     * @note Equal to the original WriteBatch::remove method except that the parameter is
+     * std::string.
+     */
+    void remove(const std::string& key) {
+      _assert_(true);
+      remove(key.data(), key.size());
+    }
+    /**
+     * Remove all operations.
+     */
+    void clear() {
+      _assert_(true);
+      arena_.clear();
+      ops_.clear();
+    }
+    /**
+     * Get the number of operations.
+     * @return the number of operations.
+     */
+    size_t count() const {
+      _assert_(true);
+      return ops_.size();
+    }
+    /**
+     * Get the total size of keys and values.
+     * @return the total size of keys and values.
+     */
+    size_t size() const {
+      _assert_(true);
+      return arena_.size();
+    }
+    /**
+     * Get an operation.
+     * @param idx the index of the operation.
+     * @param kbp the pointer to the variable into which the pointer to the key region is
+     * assigned.
+     * @param ksp the pointer to the variable into which the size of the key region is assigned.
+     * @param vbp the pointer to the variable into which the pointer to the value region is
+     * assigned.
+     * @param vsp the pointer to the variable into which the size of the value region is
+     * assigned.
+     * @return the kind of the operation.
+     * @note The returned regions are valid until the batch is modified.
+     */
+    Kind get(size_t idx, const char** kbp, size_t* ksp,
+             const char** vbp, size_t* vsp) const {
+      _assert_(idx < ops_.size() && kbp && ksp && vbp && vsp);
+      const Operation& op = ops_[idx];
+      *kbp = arena_.data() + op.off;
+      *ksp = op.ksiz;
+      *vbp = *kbp + op.ksiz;
+      *vsp = op.vsiz;
+      return op.kind;
+    }
+   private:
+    /**
+     * Operation in the batch.
+     */
+    struct Operation {
+      Kind kind;                         ///< kind of the operation
+      size_t off;                        ///< offset of the key in the arena
+      size_t ksiz;                       ///< size of the key
+      size_t vsiz;                       ///< size of the value
+    };
+    /** The arena of keys and values. */
+    std::string arena_;
+    /** The operations. */
+    std::vector<Operation> ops_;
+  };
+  /**
+   * Read-only view of a database as of the moment of its creation.
+   * @note Before a record is updated, its old image is copied into every snapshot which has not
+   * kept one yet, and reading through a snapshot prefers the kept images to the current
+   * records.  So, the memory usage of a snapshot grows with the number of records updated
+   * while it exists.  A snapshot is invalidated when the database is cleared or closed.  A
+   * snapshot must be deleted before the database object.
+   */
+  class Snapshot {
+   public:
+    /**
+     * Cursor to scan the records of a snapshot.
+     */
+    class Cursor {
+     public:
+      /**
+       * Destructor.
+       */
+      virtual ~Cursor() {
+        _assert_(true);
+      }
+      /**
+       * Jump the cursor to the first record.
+       * @return true on success, or false on failure.
+       */
+      virtual bool jump() = 0;
+      /**
+       * Get a pair of the key and the value of the current record.
+       * @param ksp the pointer to the variable into which the size of the key region of the
+       * return value is assigned.
+       * @param vbp the pointer to the variable into which the pointer to the value region is
+       * assigned.
+       * @param vsp the pointer to the variable into which the size of the value region is
+       * assigned.
+       * @param step true to move the cursor to the next record, or false for no move.
+       * @return the pointer to the pair of the key region, or NULL on failure.
+       * @note If the cursor has reached the end, NULL is returned.  Because an additional zero
+       * code is appended at the end of each region of the key and the value, each region can be
+       * treated as a C-style string.  Because the region of the return value is allocated with
+       * the new[] operator, it should be released with the delete[] operator when it is no
+       * longer in use.
+       */
+      virtual char* get(size_t* ksp, const char** vbp, size_t* vsp, bool step = false) = 0;
+      /**
+       * Get a pair of the key and the value of the current record.
+       * @note Equal to the original Cursor::get method except that the parameters are
+       * std::string.
+       */
+      bool get(std::string* key, std::string* value, bool step = false) {
+        _assert_(key && value);
+        size_t ksiz, vsiz;
+        const char* vbuf;
+        char* kbuf = get(&ksiz, &vbuf, &vsiz, step);
+        if (!kbuf) return false;
+        key->clear();
+        key->append(kbuf, ksiz);
+        value->clear();
+        value->append(vbuf, vsiz);
+        delete[] kbuf;
+        return true;
+      }
+    };
+    /**
+     * Destructor.
+     */
+    virtual ~Snapshot() {
+      _assert_(true);
+    }
+    /**
+     * Retrieve the value of a record.
+     * @param kbuf the pointer to the key region.
+     * @param ksiz the size of the key region.
+     * @param sp the pointer to the variable into which the size of the region of the return
+     * value is assigned.
+     * @return the pointer to the value region of the corresponding record, or NULL on failure.
+     * @note Because the region of the return value is allocated with the new[] operator, it
+     * should be released with the delete[] operator when it is no longer in use.  If the
+     * database object has been deleted, NULL is returned and no error is recorded.
+     */
+    char* get(const char* kbuf, size_t ksiz, size_t* sp) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && sp);
+      if (!db_) return NULL;
+      if (!valid()) {
+        db_->set_error(_KCCODELINE_, Error::INVALID, "invalidated snapshot");
+        return NULL;
+      }
+      char* vbuf = db_->get(kbuf, ksiz, sp);
+      if (!vbuf && db_->error() != Error::NOREC) return NULL;
+      std::string okey;
+      old_key(kbuf, ksiz, &okey);
+      std::string value;
+      int32_t rv = check(okey.data(), okey.size(), &value);
+      if (rv < 0) return vbuf;
+      delete[] vbuf;
+      if (rv < 1) {
+        db_->set_error(_KCCODELINE_, Error::NOREC, "no record");
+        return NULL;
+      }
+      vbuf = new char[value.size()+1];
+      std::memcpy(vbuf, value.data(), value.size());
+      vbuf[value.size()] = '\0';
+      *sp = value.size();
+      return vbuf;
+    }
+    /**
+     * Retrieve the value of a record.
+     * @note Equal to the original Snapshot::get method except that the first parameter is
+     * std::string and the second parameter is the pointer to a std::string object.
+     */
+    bool get(const std::string& key, std::string* value) {
+      _assert_(value);
+      size_t vsiz;
+      char* vbuf = get(key.data(), key.size(), &vsiz);
+      if (!vbuf) return false;
+      value->clear();
+      value->append(vbuf, vsiz);
+      delete[] vbuf;
+      return true;
+    }
+    /**
+     * Create a cursor object.
+     * @return the return value is the created cursor object.
+     * @note Because the object of the return value is allocated by the constructor, it should
+     * be released with the delete operator when it is no longer in use.
+     */
+    virtual Cursor* cursor() = 0;
+    /**
+     * Get the number of the kept old images.
+     * @return the number of the kept old images.
+     */
+    int64_t count() {
+      _assert_(true);
+      ScopedMutex lock(&mutex_);
+      return olds_.size();
+    }
+   protected:
+    /**
+     * Constructor.
+     * @param db the container database object.
+     * @param comp the comparator of the keys of the kept old images.
+     */
+    explicit Snapshot(BasicDB* db, Comparator* comp) :
+        db_(db), mutex_(), valid_(true), olds_(OldComparator(comp)) {
+      _assert_(db && comp);
+    }
+    /**
+     * Make the key of the old image of a record.
+     * @param kbuf the pointer to the key region.
+     * @param ksiz the size of the key region.
+     * @param okey the string object to contain the key of the old image.
+     */
+    virtual void old_key(const char* kbuf, size_t ksiz, std::string* okey) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && okey);
+      okey->assign(kbuf, ksiz);
+    }
+    /**
+     * Keep the old image of a record unless it has been kept.
+     * @param kbuf the pointer to the key region of the old image.
+     * @param ksiz the size of the key region.
+     * @param vbuf the pointer to the value region, or NULL if the record does not exist.
+     * @param vsiz the size of the value region.
+     * @note This must be called while the record is locked for update.
+     */
+    void record(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && vsiz <= MEMMAXSIZ);
+      ScopedMutex lock(&mutex_);
+      std::pair<OldMap::iterator, bool> res =
+          olds_.insert(std::make_pair(std::string(kbuf, ksiz), OldRecord()));
+      if (!res.second) return;
+      OldRecord& orec = res.first->second;
+      orec.exists = vbuf != NULL;
+      if (vbuf) orec.value.append(vbuf, vsiz);
+    }
+    /**
+     * Check the old image of a record.
+     * @param kbuf the pointer to the key region of the old image.
+     * @param ksiz the size of the key region.
+     * @param value the string object to contain the value of the old image.
+     * @return 1 if the record existed, 0 if it did not exist, or -1 if no image is kept.
+     * @note This must be called after the current record is read.
+     */
+    int32_t check(const char* kbuf, size_t ksiz, std::string* value) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && value);
+      ScopedMutex lock(&mutex_);
+      OldMap::const_iterator it = olds_.find(std::string(kbuf, ksiz));
+      if (it == olds_.end()) return -1;
+      if (!it->second.exists) return 0;
+      value->assign(it->second.value);
+      return 1;
+    }
+    /**
+     * Get the next old image in the order of the keys.
+     * @param key the key to start from, or NULL to start from the first image.
+     * @param incl true to include the image of the starting key, or false to exclude it.
+     * @param okey the string object to contain the key of the image.
+     * @param value the string object to contain the value of the image.
+     * @return 1 if the record existed, 0 if it did not exist, or -1 if no image remains.
+     */
+    int32_t next(const std::string* key, bool incl, std::string* okey, std::string* value) {
+      _assert_(okey && value);
+      ScopedMutex lock(&mutex_);
+      OldMap::const_iterator it = !key ? olds_.begin() :
+          incl ? olds_.lower_bound(*key) : olds_.upper_bound(*key);
+      if (it == olds_.end()) return -1;
+      okey->assign(it->first);
+      if (!it->second.exists) return 0;
+      value->assign(it->second.value);
+      return 1;
+    }
+    /**
+     * Invalidate the snapshot.
+     */
+    void invalidate() {
+      _assert_(true);
+      ScopedMutex lock(&mutex_);
+      valid_ = false;
+      olds_.clear();
+    }
+    /**
+     * Check whether the snapshot is valid.
+     * @return true if the snapshot is valid, or false if not.
+     */
+    bool valid() {
+      _assert_(true);
+      ScopedMutex lock(&mutex_);
+      return valid_;
+    }
+    /** The container database object. */
+    BasicDB* db_;
+   private:
+    /**
+     * Old image of a record.
+     */
+    struct OldRecord {
+      bool exists;                       ///< whether the record existed
+      std::string value;                 ///< value of the record
+    };
+    /**
+     * Comparator of the keys of old images.
+     */
+    struct OldComparator {
+      /** constructor */
+      explicit OldComparator(Comparator* comp) : comp_(comp) {}
+      /** comparing operator */
+      bool operator ()(const std::string& a, const std::string& b) const {
+        return comp_->compare(a.data(), a.size(), b.data(), b.size()) < 0;
+      }
+      Comparator* comp_;                 ///< comparator
+    };
+    /** An alias of map of old images. */
+    typedef std::map<std::string, OldRecord, OldComparator> OldMap;
+    /** Dummy constructor to forbid the use. */
+    Snapshot(const Snapshot&);
+    /** Dummy Operator to forbid the use. */
+    Snapshot& operator =(const Snapshot&);
+    /** The mutex for the old images. */
+    Mutex mutex_;
+    /** The flag whether the snapshot is valid. */
+    bool valid_;
+    /** The old images. */
+    OldMap olds_;
+  };
   /**
    * Interface to log internal information and errors.
    */
@@ -1274,8 +1688,10 @@ class BasicDB : public DB {
    * @param dest the path of the destination file.
    * @param checker a progress checker object.  If it is NULL, no checking is performed.
    * @return true on success, or false on failure.
+   * @note Database classes which keep data in other files than the database file override
+   * this to copy them together.
    */
-  bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
+  virtual bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
     _assert_(true);
     class FileProcessorImpl : public FileProcessor {
      public:
@@ -1325,48 +1741,7 @@ class BasicDB : public DB {
           }
           return !err;
         }
-        std::ofstream ofs;
-        ofs.open(dest_.c_str(),
-                 std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
-        if (!ofs) return false;
-        bool err = false;
-        std::ifstream ifs;
-        ifs.open(path.c_str(), std::ios_base::in | std::ios_base::binary);
-        if (checker_ && !checker_->check("copy", "beginning", 0, size)) {
-          db_->set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
-          err = true;
-        }
-        if (ifs) {
-          char buf[IOBUFSIZ];
-          int64_t curcnt = 0;
-          while (!err && !ifs.eof()) {
-            size_t n = ifs.read(buf, sizeof(buf)).gcount();
-            if (n > 0) {
-              ofs.write(buf, n);
-              if (!ofs) {
-                err = true;
-                break;
-              }
-            }
-            curcnt += n;
-            if (checker_ && !checker_->check("copy", "processing", curcnt, size)) {
-              db_->set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
-              err = true;
-              break;
-            }
-          }
-          ifs.close();
-          if (ifs.bad()) err = true;
-        } else {
-          err = true;
-        }
-        if (checker_ && !checker_->check("copy", "ending", -1, size)) {
-          db_->set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
-          err = true;
-        }
-        ofs.close();
-        if (!ofs) err = true;
-        return !err;
+        return db_->copy_file(path, dest_, checker_, size);
       }
       const std::string& dest_;
       ProgressChecker* checker_;
@@ -2262,18 +2637,143 @@ class BasicDB : public DB {
     }
     return recs->size();
   }
+  /**
+   * Store records supplied by a source.
+   * @param src the source of records.
+   * @return true on success, or false on failure.
+   * @note The default implementation stores each record with the set method.  Database classes
+   * which can build their structure directly from sorted records override it.
+   */
+  virtual bool load_bulk(BulkSource* src) {
+    _assert_(src);
+    const char* kbuf;
+    size_t ksiz;
+    const char* vbuf;
+    size_t vsiz;
+    while ((kbuf = src->read(&ksiz, &vbuf, &vsiz)) != NULL) {
+      if (!set(kbuf, ksiz, vbuf, vsiz)) return false;
+    }
+    return true;
+  }
+  /**
+   * Apply a batch of record updates atomically.
+   * @param batch the batch of updates.
+   * @return true on success, or false on failure.
+   * @note The default implementation applies the operations with the accept_bulk method, so
+   * that other threads accessing the same records are blocked while those accessing other
+   * records are not.  Database classes which can also make the whole batch durable at once
+   * override it.
+   */
+  virtual bool apply_batch(const WriteBatch& batch) {
+    _assert_(true);
+    class VisitorImpl : public Visitor {
+     public:
+      explicit VisitorImpl(const WriteBatch* batch) : batch_(batch), idx_(0) {}
+     private:
+      const char* visit_full(const char* kbuf, size_t ksiz,
+                             const char* vbuf, size_t vsiz, size_t* sp) {
+        return visit_next(REMOVE, sp);
+      }
+      const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+        return visit_next(NOP, sp);
+      }
+      const char* visit_next(const char* rmark, size_t* sp) {
+        const char* kbuf;
+        size_t ksiz;
+        const char* vbuf;
+        size_t vsiz;
+        if (batch_->get(idx_++, &kbuf, &ksiz, &vbuf, &vsiz) == WriteBatch::KREMOVE)
+          return rmark;
+        *sp = vsiz;
+        return vbuf;
+      }
+      const WriteBatch* batch_;
+      size_t idx_;
+    };
+    size_t onum = batch.count();
+    if (onum < 1) return true;
+    std::vector<std::string> keys;
+    keys.reserve(onum);
+    for (size_t i = 0; i < onum; i++) {
+      const char* kbuf;
+      size_t ksiz;
+      const char* vbuf;
+      size_t vsiz;
+      batch.get(i, &kbuf, &ksiz, &vbuf, &vsiz);
+      keys.push_back(std::string(kbuf, ksiz));
+    }
+    VisitorImpl visitor(&batch);
+    return accept_bulk(keys, &visitor, true);
+  }
+  /**
+   * Create a snapshot object.
+   * @return the created snapshot object, or NULL on failure.
+   * @note Because the object of the return value is allocated by the constructor, it should be
+   * released with the delete operator when it is no longer in use.  The default implementation
+   * fails.  Database classes which can keep old images of updated records override it.
+   */
+  virtual Snapshot* snapshot() {
+    _assert_(true);
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return NULL;
+  }
+  /**
+   * Remove records in a range of keys.
+   * @param bkbuf the pointer to the key region where the range begins inclusively.  If it is
+   * NULL, the range begins at the first record.
+   * @param bksiz the size of the key region where the range begins.
+   * @param ekbuf the pointer to the key region where the range ends exclusively.  If it is
+   * NULL, the range ends at the last record.
+   * @param eksiz the size of the key region where the range ends.
+   * @return the number of removed records, or -1 on failure.
+   * @note The default implementation fails because the order of keys is not defined.  Database
+   * classes which keep records in order override it.
+   */
+  virtual int64_t remove_range(const char* bkbuf, size_t bksiz,
+                               const char* ekbuf, size_t eksiz) {
+    _assert_(bksiz <= MEMMAXSIZ && eksiz <= MEMMAXSIZ);
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return -1;
+  }
+  /**
+   * Get the number of records in a range of keys.
+   * @param bkbuf the pointer to the key region where the range begins inclusively.  If it is
+   * NULL, the range begins at the first record.
+   * @param bksiz the size of the key region where the range begins.
+   * @param ekbuf the pointer to the key region where the range ends exclusively.  If it is
+   * NULL, the range ends at the last record.
+   * @param eksiz the size of the key region where the range ends.
+   * @return the number of records in the range, or -1 on failure.
+   * @note The default implementation fails because the order of keys is not defined.  Database
+   * classes which keep records in order override it.
+   */
+  virtual int64_t count_range(const char* bkbuf, size_t bksiz,
+                              const char* ekbuf, size_t eksiz) {
+    _assert_(bksiz <= MEMMAXSIZ && eksiz <= MEMMAXSIZ);
+    set_error(_KCCODELINE_, Error::NOIMPL, "not implemented");
+    return -1;
+  }
   /**
    * Dump records into a data stream.
    * @param dest the destination stream.
    * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @param comp the data compressor of the snapshot.  If it is NULL, records are written as
+   * they are.
+   * @param thnum the number of worker threads to compress the snapshot.
    * @return true on success, or false on failure.
+   * @note If a compressor is given, records are gathered into frames of about 1MB and each
+   * frame is compressed independently.  Frames are compressed by the worker threads in
+   * parallel while the records of the following frames are being read, and they are written
+   * in order.  The same compressor must be given to load the snapshot.
    */
-  bool dump_snapshot(std::ostream* dest, ProgressChecker* checker = NULL) {
+  bool dump_snapshot(std::ostream* dest, ProgressChecker* checker = NULL,
+                     Compressor* comp = NULL, int32_t thnum = 1) {
     _assert_(dest);
     if (dest->fail()) {
       set_error(_KCCODELINE_, Error::INVALID, "invalid stream");
       return false;
     }
+    if (comp) return dump_snapshot_frames(dest, checker, comp, thnum);
     class VisitorImpl : public Visitor {
      public:
       explicit VisitorImpl(std::ostream* dest) : dest_(dest), stack_() {}
@@ -2311,9 +2811,13 @@ class BasicDB : public DB {
    * Dump records into a file.
    * @param dest the path of the destination file.
    * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @param comp the data compressor of the snapshot.  If it is NULL, records are written as
+   * they are.
+   * @param thnum the number of worker threads to compress the snapshot.
    * @return true on success, or false on failure.
    */
-  bool dump_snapshot(const std::string& dest, ProgressChecker* checker = NULL) {
+  bool dump_snapshot(const std::string& dest, ProgressChecker* checker = NULL,
+                     Compressor* comp = NULL, int32_t thnum = 1) {
     _assert_(true);
     std::ofstream ofs;
     ofs.open(dest.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
@@ -2322,7 +2826,7 @@ class BasicDB : public DB {
       return false;
     }
     bool err = false;
-    if (!dump_snapshot(&ofs, checker)) err = true;
+    if (!dump_snapshot(&ofs, checker, comp, thnum)) err = true;
     ofs.close();
     if (!ofs) {
       set_error(_KCCODELINE_, Error::SYSTEM, "close failed");
@@ -2334,9 +2838,15 @@ class BasicDB : public DB {
    * Load records from a data stream.
    * @param src the source stream.
    * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @param comp the data compressor of the snapshot.  It is used only if the snapshot is
+   * compressed.
+   * @param thnum the number of worker threads to decompress the snapshot.
    * @return true on success, or false on failure.
+   * @note Frames of a compressed snapshot are decompressed by the worker threads in parallel
+   * while the records of the preceding frames are being stored.
    */
-  bool load_snapshot(std::istream* src, ProgressChecker* checker = NULL) {
+  bool load_snapshot(std::istream* src, ProgressChecker* checker = NULL,
+                     Compressor* comp = NULL, int32_t thnum = 1) {
     _assert_(src);
     if (src->fail()) {
       set_error(_KCCODELINE_, Error::INVALID, "invalid stream");
@@ -2348,60 +2858,96 @@ class BasicDB : public DB {
       set_error(_KCCODELINE_, Error::SYSTEM, "stream input error");
       return false;
     }
-    if (std::memcmp(buf, KCDBSSMAGICDATA, sizeof(KCDBSSMAGICDATA))) {
+    bool framed = false;
+    if (!std::memcmp(buf, KCDBSZMAGICDATA, sizeof(KCDBSZMAGICDATA))) {
+      if (!comp) {
+        set_error(_KCCODELINE_, Error::INVALID, "the snapshot compressor is not given");
+        return false;
+      }
+      framed = true;
+    } else if (std::memcmp(buf, KCDBSSMAGICDATA, sizeof(KCDBSSMAGICDATA))) {
       set_error(_KCCODELINE_, Error::INVALID, "invalid magic data of input stream");
       return false;
     }
-    bool err = false;
-    if (checker && !checker->check("load_snapshot", "beginning", 0, -1)) {
-      set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
-      err = true;
-    }
-    int64_t curcnt = 0;
-    while (!err) {
-      int32_t c = src->get();
-      if (src->fail()) {
-        set_error(_KCCODELINE_, Error::SYSTEM, "stream input error");
-        err = true;
-        break;
+    class SourceImpl : public BulkSource {
+     public:
+      explicit SourceImpl(BasicDB* db, std::istream* src, ProgressChecker* checker) :
+          db_(db), src_(src), checker_(checker), rbuf_(stack_), rsiz_(sizeof(stack_)),
+          curcnt_(0), err_(false) {}
+      ~SourceImpl() {
+        if (rbuf_ != stack_) delete[] rbuf_;
+      }
+      bool error() {
+        return err_;
       }
-      if (c == 0xff) break;
-      if (c == 0x00) {
+     private:
+      const char* read(size_t* ksp, const char** vbp, size_t* vsp) {
+        if (err_) return NULL;
+        int32_t c = src_->get();
+        if (src_->fail()) {
+          db_->set_error(_KCCODELINE_, Error::SYSTEM, "stream input error");
+          err_ = true;
+          return NULL;
+        }
+        if (c == 0xff) return NULL;
+        if (c != 0x00) {
+          db_->set_error(_KCCODELINE_, Error::INVALID, "invalid magic data of input stream");
+          err_ = true;
+          return NULL;
+        }
         size_t ksiz = 0;
         do {
-          c = src->get();
+          c = src_->get();
           ksiz = (ksiz << 7) + (c & 0x7f);
         } while (c >= 0x80);
         size_t vsiz = 0;
         do {
-          c = src->get();
+          c = src_->get();
           vsiz = (vsiz << 7) + (c & 0x7f);
         } while (c >= 0x80);
         size_t rsiz = ksiz + vsiz;
-        char* rbuf = rsiz > sizeof(buf) ? new char[rsiz] : buf;
-        src->read(rbuf, ksiz + vsiz);
-        if (src->fail()) {
-          set_error(_KCCODELINE_, Error::SYSTEM, "stream input error");
-          err = true;
-          if (rbuf != buf) delete[] rbuf;
-          break;
+        if (rsiz > rsiz_) {
+          if (rbuf_ != stack_) delete[] rbuf_;
+          rbuf_ = new char[rsiz];
+          rsiz_ = rsiz;
         }
-        if (!set(rbuf, ksiz, rbuf + ksiz, vsiz)) {
-          err = true;
-          if (rbuf != buf) delete[] rbuf;
-          break;
+        src_->read(rbuf_, rsiz);
+        if (src_->fail()) {
+          db_->set_error(_KCCODELINE_, Error::SYSTEM, "stream input error");
+          err_ = true;
+          return NULL;
         }
-        if (rbuf != buf) delete[] rbuf;
-      } else {
-        set_error(_KCCODELINE_, Error::INVALID, "invalid magic data of input stream");
-        err = true;
-        break;
+        curcnt_++;
+        if (checker_ && !checker_->check("load_snapshot", "processing", curcnt_, -1)) {
+          db_->set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+          err_ = true;
+          return NULL;
+        }
+        *ksp = ksiz;
+        *vbp = rbuf_ + ksiz;
+        *vsp = vsiz;
+        return rbuf_;
       }
-      curcnt++;
-      if (checker && !checker->check("load_snapshot", "processing", curcnt, -1)) {
-        set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
-        err = true;
-        break;
+      BasicDB* db_;
+      std::istream* src_;
+      ProgressChecker* checker_;
+      char stack_[IOBUFSIZ];
+      char* rbuf_;
+      size_t rsiz_;
+      int64_t curcnt_;
+      bool err_;
+    };
+    bool err = false;
+    if (checker && !checker->check("load_snapshot", "beginning", 0, -1)) {
+      set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+      err = true;
+    }
+    if (!err) {
+      if (framed) {
+        if (!load_snapshot_frames(src, checker, comp, thnum)) err = true;
+      } else {
+        SourceImpl source(this, src, checker);
+        if (!load_bulk(&source) || source.error()) err = true;
       }
     }
     if (checker && !checker->check("load_snapshot", "ending", -1, -1)) {
@@ -2414,9 +2960,13 @@ class BasicDB : public DB {
    * Load records from a file.
    * @param src the path of the source file.
    * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @param comp the data compressor of the snapshot.  It is used only if the snapshot is
+   * compressed.
+   * @param thnum the number of worker threads to decompress the snapshot.
    * @return true on success, or false on failure.
    */
-  bool load_snapshot(const std::string& src, ProgressChecker* checker = NULL) {
+  bool load_snapshot(const std::string& src, ProgressChecker* checker = NULL,
+                     Compressor* comp = NULL, int32_t thnum = 1) {
     _assert_(true);
     std::ifstream ifs;
     ifs.open(src.c_str(), std::ios_base::in | std::ios_base::binary);
@@ -2425,7 +2975,7 @@ class BasicDB : public DB {
       return false;
     }
     bool err = false;
-    if (!load_snapshot(&ifs, checker)) err = true;
+    if (!load_snapshot(&ifs, checker, comp, thnum)) err = true;
     ifs.close();
     if (ifs.bad()) {
       set_error(_KCCODELINE_, Error::SYSTEM, "close failed");
@@ -2510,6 +3060,389 @@ class BasicDB : public DB {
     }
     return "unknown";
   }
+ protected:
+  /**
+   * Copy a file.
+   * @param src the path of the source file.
+   * @param dest the path of the destination file.
+   * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @param size the size of the source file.
+   * @return true on success, or false on failure.
+   */
+  bool copy_file(const std::string& src, const std::string& dest, ProgressChecker* checker,
+                 int64_t size) {
+    _assert_(true);
+    std::ofstream ofs;
+    ofs.open(dest.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!ofs) return false;
+    bool err = false;
+    std::ifstream ifs;
+    ifs.open(src.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (checker && !checker->check("copy", "beginning", 0, size)) {
+      set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+      err = true;
+    }
+    if (ifs) {
+      char buf[IOBUFSIZ];
+      int64_t curcnt = 0;
+      while (!err && !ifs.eof()) {
+        size_t n = ifs.read(buf, sizeof(buf)).gcount();
+        if (n > 0) {
+          ofs.write(buf, n);
+          if (!ofs) {
+            err = true;
+            break;
+          }
+        }
+        curcnt += n;
+        if (checker && !checker->check("copy", "processing", curcnt, size)) {
+          set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+          err = true;
+          break;
+        }
+      }
+      ifs.close();
+      if (ifs.bad()) err = true;
+    } else {
+      err = true;
+    }
+    if (checker && !checker->check("copy", "ending", -1, size)) {
+      set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+      err = true;
+    }
+    ofs.close();
+    if (!ofs) err = true;
+    return !err;
+  }
+ private:
+  /**
+   * Worker to compress or decompress a frame of a snapshot.
+   */
+  class FrameWorker : public Thread {
+   public:
+    /** constructor */
+    explicit FrameWorker() : comp_(NULL), pack_(false), src_(), dbuf_(NULL), dsiz_(0) {}
+    /** destructor */
+    ~FrameWorker() {
+      delete[] dbuf_;
+    }
+    /** set the compressor and the direction */
+    void init(Compressor* comp, bool pack) {
+      comp_ = comp;
+      pack_ = pack;
+    }
+    /** get the buffer of the input data */
+    std::string* source() {
+      return &src_;
+    }
+    /** get the output data */
+    const char* result(size_t* sp) {
+      *sp = dsiz_;
+      return dbuf_;
+    }
+   private:
+    /** perform the concrete process */
+    void run() {
+      delete[] dbuf_;
+      dsiz_ = 0;
+      if (pack_) {
+        dbuf_ = comp_->compress(src_.data(), src_.size(), &dsiz_);
+      } else {
+        dbuf_ = comp_->decompress(src_.data(), src_.size(), &dsiz_);
+      }
+    }
+    /** The data compressor. */
+    Compressor* comp_;
+    /** The flag of compression. */
+    bool pack_;
+    /** The input data. */
+    std::string src_;
+    /** The output data. */
+    char* dbuf_;
+    /** The size of the output data. */
+    size_t dsiz_;
+  };
+  /**
+   * Dump records into a data stream as compressed frames.
+   * @param dest the destination stream.
+   * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @param comp the data compressor.
+   * @param thnum the number of worker threads.
+   * @return true on success, or false on failure.
+   */
+  bool dump_snapshot_frames(std::ostream* dest, ProgressChecker* checker,
+                            Compressor* comp, int32_t thnum) {
+    _assert_(dest && comp);
+    if (thnum < 1) thnum = 1;
+    class VisitorImpl : public Visitor {
+     public:
+      explicit VisitorImpl(std::ostream* dest, Compressor* comp, int32_t thnum) :
+          dest_(dest), thnum_(thnum), workers_(NULL), cur_(0), fidx_(0), err_(false) {
+        workers_ = new FrameWorker[thnum*2];
+        for (int32_t i = 0; i < thnum * 2; i++) {
+          workers_[i].init(comp, true);
+        }
+        fnums_[0] = fnums_[1] = 0;
+        runs_[0] = runs_[1] = false;
+      }
+      ~VisitorImpl() {
+        join_group(0);
+        join_group(1);
+        delete[] workers_;
+      }
+      bool finish() {
+        int32_t fnum = fidx_;
+        if (!workers_[cur_*thnum_+fidx_].source()->empty()) fnum++;
+        if (fnum > 0) flip(fnum);
+        write_group(1 - cur_);
+        return !err_;
+      }
+     private:
+      const char* visit_full(const char* kbuf, size_t ksiz,
+                             const char* vbuf, size_t vsiz, size_t* sp) {
+        std::string* buf = workers_[cur_*thnum_+fidx_].source();
+        char* wp = stack_;
+        *(wp++) = 0x00;
+        wp += writevarnum(wp, ksiz);
+        wp += writevarnum(wp, vsiz);
+        buf->append(stack_, wp - stack_);
+        buf->append(kbuf, ksiz);
+        buf->append(vbuf, vsiz);
+        if (buf->size() >= SSFRAMESIZ && ++fidx_ >= thnum_) flip(fidx_);
+        return NOP;
+      }
+      void flip(int32_t fnum) {
+        int32_t back = 1 - cur_;
+        write_group(back);
+        FrameWorker* workers = workers_ + cur_ * thnum_;
+        for (int32_t i = 0; i < fnum; i++) {
+          workers[i].start();
+        }
+        fnums_[cur_] = fnum;
+        runs_[cur_] = true;
+        cur_ = back;
+        fidx_ = 0;
+        workers = workers_ + cur_ * thnum_;
+        for (int32_t i = 0; i < thnum_; i++) {
+          workers[i].source()->clear();
+        }
+      }
+      void join_group(int32_t gidx) {
+        if (!runs_[gidx]) return;
+        FrameWorker* workers = workers_ + gidx * thnum_;
+        for (int32_t i = 0; i < fnums_[gidx]; i++) {
+          workers[i].join();
+        }
+        runs_[gidx] = false;
+      }
+      void write_group(int32_t gidx) {
+        join_group(gidx);
+        FrameWorker* workers = workers_ + gidx * thnum_;
+        for (int32_t i = 0; i < fnums_[gidx]; i++) {
+          size_t zsiz;
+          const char* zbuf = workers[i].result(&zsiz);
+          if (!zbuf) {
+            err_ = true;
+            continue;
+          }
+          char* wp = stack_;
+          *(wp++) = 0x01;
+          wp += writevarnum(wp, workers[i].source()->size());
+          wp += writevarnum(wp, zsiz);
+          dest_->write(stack_, wp - stack_);
+          dest_->write(zbuf, zsiz);
+        }
+        fnums_[gidx] = 0;
+      }
+      std::ostream* dest_;
+      int32_t thnum_;
+      FrameWorker* workers_;
+      int32_t cur_;
+      int32_t fidx_;
+      int32_t fnums_[2];
+      bool runs_[2];
+      bool err_;
+      char stack_[NUMBUFSIZ*2];
+    };
+    bool err = false;
+    dest->write(KCDBSZMAGICDATA, sizeof(KCDBSZMAGICDATA));
+    VisitorImpl visitor(dest, comp, thnum);
+    if (!iterate(&visitor, false, checker)) err = true;
+    if (!visitor.finish()) {
+      set_error(_KCCODELINE_, Error::SYSTEM, "data compression failed");
+      err = true;
+    }
+    if (!err) {
+      unsigned char c = 0xff;
+      dest->write((char*)&c, 1);
+      if (dest->fail()) {
+        set_error(_KCCODELINE_, Error::SYSTEM, "stream output error");
+        err = true;
+      }
+    }
+    return !err;
+  }
+  /**
+   * Load records from a data stream of compressed frames.
+   * @param src the source stream.
+   * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @param comp the data compressor.
+   * @param thnum the number of worker threads.
+   * @return true on success, or false on failure.
+   */
+  bool load_snapshot_frames(std::istream* src, ProgressChecker* checker,
+                            Compressor* comp, int32_t thnum) {
+    _assert_(src && comp);
+    if (thnum < 1) thnum = 1;
+    class SourceImpl : public BulkSource {
+     public:
+      explicit SourceImpl(BasicDB* db, std::istream* src, ProgressChecker* checker,
+                          Compressor* comp, int32_t thnum) :
+          db_(db), src_(src), checker_(checker), thnum_(thnum), workers_(NULL), rsizs_(NULL),
+          cur_(1), fidx_(0), rp_(NULL), ep_(NULL), curcnt_(0), eof_(false), err_(false) {
+        workers_ = new FrameWorker[thnum*2];
+        rsizs_ = new size_t[thnum*2];
+        for (int32_t i = 0; i < thnum * 2; i++) {
+          workers_[i].init(comp, false);
+        }
+        fnums_[0] = fnums_[1] = 0;
+        runs_[0] = runs_[1] = false;
+        fill_group(0);
+      }
+      ~SourceImpl() {
+        join_group(0);
+        join_group(1);
+        delete[] rsizs_;
+        delete[] workers_;
+      }
+      bool error() {
+        return err_;
+      }
+     private:
+      const char* read(size_t* ksp, const char** vbp, size_t* vsp) {
+        while (!err_ && rp_ >= ep_) {
+          if (fidx_ < fnums_[cur_]) {
+            int32_t widx = cur_ * thnum_ + fidx_;
+            size_t rsiz;
+            const char* rbuf = workers_[widx].result(&rsiz);
+            if (!rbuf || rsiz != rsizs_[widx]) {
+              db_->set_error(_KCCODELINE_, Error::INVALID, "invalid frame of input stream");
+              err_ = true;
+              return NULL;
+            }
+            rp_ = rbuf;
+            ep_ = rbuf + rsiz;
+            fidx_++;
+          } else {
+            int32_t back = 1 - cur_;
+            if (!runs_[back]) return NULL;
+            join_group(back);
+            cur_ = back;
+            fidx_ = 0;
+            fill_group(1 - cur_);
+          }
+        }
+        if (err_) return NULL;
+        uint64_t ksiz = 0;
+        uint64_t vsiz = 0;
+        size_t step = *rp_ == 0x00 ? readvarnum(rp_ + 1, ep_ - rp_ - 1, &ksiz) : 0;
+        if (step > 0) {
+          rp_ += step + 1;
+          step = readvarnum(rp_, ep_ - rp_, &vsiz);
+          rp_ += step;
+        }
+        if (step < 1 || ksiz + vsiz > (uint64_t)(ep_ - rp_)) {
+          db_->set_error(_KCCODELINE_, Error::INVALID, "invalid record of input stream");
+          err_ = true;
+          return NULL;
+        }
+        const char* kbuf = rp_;
+        rp_ += ksiz + vsiz;
+        curcnt_++;
+        if (checker_ && !checker_->check("load_snapshot", "processing", curcnt_, -1)) {
+          db_->set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+          err_ = true;
+          return NULL;
+        }
+        *ksp = ksiz;
+        *vbp = kbuf + ksiz;
+        *vsp = vsiz;
+        return kbuf;
+      }
+      void fill_group(int32_t gidx) {
+        int32_t fnum = 0;
+        while (!eof_ && !err_ && fnum < thnum_) {
+          int32_t c = src_->get();
+          if (src_->fail()) {
+            db_->set_error(_KCCODELINE_, Error::SYSTEM, "stream input error");
+            err_ = true;
+            break;
+          }
+          if (c == 0xff) {
+            eof_ = true;
+            break;
+          }
+          if (c != 0x01) {
+            db_->set_error(_KCCODELINE_, Error::INVALID, "invalid magic data of input stream");
+            err_ = true;
+            break;
+          }
+          size_t rsiz = 0;
+          do {
+            c = src_->get();
+            rsiz = (rsiz << 7) + (c & 0x7f);
+          } while (c >= 0x80);
+          size_t zsiz = 0;
+          do {
+            c = src_->get();
+            zsiz = (zsiz << 7) + (c & 0x7f);
+          } while (c >= 0x80);
+          int32_t widx = gidx * thnum_ + fnum;
+          std::string* zbuf = workers_[widx].source();
+          zbuf->resize(zsiz);
+          if (zsiz > 0) src_->read(&(*zbuf)[0], zsiz);
+          if (src_->fail()) {
+            db_->set_error(_KCCODELINE_, Error::SYSTEM, "stream input error");
+            err_ = true;
+            break;
+          }
+          rsizs_[widx] = rsiz;
+          fnum++;
+        }
+        FrameWorker* workers = workers_ + gidx * thnum_;
+        for (int32_t i = 0; i < fnum; i++) {
+          workers[i].start();
+        }
+        fnums_[gidx] = fnum;
+        runs_[gidx] = fnum > 0;
+      }
+      void join_group(int32_t gidx) {
+        if (!runs_[gidx]) return;
+        FrameWorker* workers = workers_ + gidx * thnum_;
+        for (int32_t i = 0; i < fnums_[gidx]; i++) {
+          workers[i].join();
+        }
+        runs_[gidx] = false;
+      }
+      BasicDB* db_;
+      std::istream* src_;
+      ProgressChecker* checker_;
+      int32_t thnum_;
+      FrameWorker* workers_;
+      size_t* rsizs_;
+      int32_t cur_;
+      int32_t fidx_;
+      int32_t fnums_[2];
+      bool runs_[2];
+      const char* rp_;
+      const char* ep_;
+      int64_t curcnt_;
+      bool eof_;
+      bool err_;
+    };
+    SourceImpl source(this, src, checker, comp, thnum);
+    return load_bulk(&source) && !source.error();
+  }
 };
 
 
@@ -362,7 +362,17 @@ class DirDB : public BasicDB {
   enum Option {
     TSMALL = 1 << 0,                     ///< dummy for compatibility
     TLINEAR = 1 << 1,                    ///< dummy for compatibility
-    TCOMPRESS = 1 << 2                   ///< compress each record
+    TCOMPRESS = 1 << 2,                  ///< compress each record
+    TXXHASH = 1 << 3,                    ///< dummy for compatibility
+    TCHECKSUM = 1 << 4                   ///< dummy for compatibility
+  };
+  /**
+   * Options of the memory-mapped region.
+   */
+  enum MapOption {
+    MGROW = 1 << 0,                      ///< dummy for compatibility
+    MPOPULATE = 1 << 1,                  ///< dummy for compatibility
+    MHUGE = 1 << 2                       ///< dummy for compatibility
   };
   /**
    * Status flags.
@@ -1467,6 +1477,13 @@ class DirDB : public BasicDB {
   bool tune_map(int64_t msiz) {
     return true;
   }
+  /**
+   * Set the options of the internal memory-mapped region.
+   * @note This is a dummy implementation for compatibility.
+   */
+  bool tune_map_options(int8_t mopts) {
+    return true;
+  }
   /**
    * Set the unit step number of auto defragmentation.
    * @note This is a dummy implementation for compatibility.
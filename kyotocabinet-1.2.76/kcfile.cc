@@ -16,6 +16,12 @@
 #include "kcfile.h"
 #include "myconf.h"
 
+#if _KC_URING
+extern "C" {
+#include <liburing.h>
+}
+#endif
+
 namespace kyotocabinet {                 // common namespace
 
 
@@ -30,7 +36,15 @@ const int32_t IOBUFSIZ = 16384;          ///< size of the IO buffer
 const int64_t FILEMAXSIZ = INT64MAX - INT32MAX;  // maximum size of a file
 const char* const WALPATHEXT = "wal";    ///< extension of the WAL file
 const char WALMAGICDATA[] = "KW\n";      ///< magic data of the WAL file
+const char WALRDOMAGICDATA[] = "KR\n";   ///< magic data of the WAL file of the redo log
 const uint8_t WALMSGMAGIC = 0xee;        ///< magic data for WAL record
+const uint8_t WALRDOMAGIC = 0xef;        ///< magic data for WAL record of a redo image
+const uint8_t WALTRCMAGIC = 0xec;        ///< magic data for WAL record of truncation
+const uint8_t WALCMTMAGIC = 0xed;        ///< magic data for WAL record of commit
+const int32_t WALBUFSIZ = 1 << 20;       ///< size of the buffer of redo records
+const uint32_t URINGDEPTH = 64;          ///< depth of the submission ring for batch reading
+const int32_t URINGRETRY = 8;            ///< number of retries to reap completions of a batch
+const int32_t GRPSLICENUM = 8;           ///< number of slices of the delay of group commit
 }
 
 
@@ -54,8 +68,23 @@ struct FileCore {
   int64_t walsiz;                        ///< size of WAL
   bool tran;                             ///< whether in transaction
   bool trhard;                           ///< whether hard transaction
+  bool trpre;                            ///< whether logged original data is not synchronized
   int64_t trbase;                        ///< base offset of guarded region
   int64_t trmsiz;                        ///< minimum size during transaction
+  int64_t trmark;                        ///< WAL offset where the joined transaction starts
+  int64_t trmarksiz;                     ///< logical size when the joined transaction starts
+  bool trpend;                           ///< whether committed transactions are pending
+  int64_t grpseq;                        ///< ticket of the last committed transaction
+  int64_t grpdone;                       ///< ticket of the last synchronized transaction
+  int64_t grpbad;                        ///< first ticket of the last failed group
+  int64_t grpbadend;                     ///< last ticket of the last failed group
+  int64_t grplast;                       ///< number of members of the last group
+  bool grpcont;                          ///< whether a transaction waited for the last group
+  bool grpleader;                        ///< whether a group has a leader
+  bool grpsync;                          ///< whether a group is being synchronized
+  CondVar grpcond;                       ///< condition of group commit
+  std::string rdbuf;                     ///< buffer of redo records
+  AtomicInt64 dirty;                     ///< size of the data not written back
 #else
   Mutex alock;                           ///< attribute lock
   TSDKey errmsg;                         ///< error message
@@ -71,8 +100,28 @@ struct FileCore {
   int64_t walsiz;                        ///< size of WAL
   bool tran;                             ///< whether in transaction
   bool trhard;                           ///< whether hard transaction
+  bool trpre;                            ///< whether logged original data is not synchronized
   int64_t trbase;                        ///< base offset of guarded region
   int64_t trmsiz;                        ///< minimum size during transaction
+  int64_t trmark;                        ///< WAL offset where the joined transaction starts
+  int64_t trmarksiz;                     ///< logical size when the joined transaction starts
+  bool trpend;                           ///< whether committed transactions are pending
+  int64_t grpseq;                        ///< ticket of the last committed transaction
+  int64_t grpdone;                       ///< ticket of the last synchronized transaction
+  int64_t grpbad;                        ///< first ticket of the last failed group
+  int64_t grpbadend;                     ///< last ticket of the last failed group
+  int64_t grplast;                       ///< number of members of the last group
+  bool grpcont;                          ///< whether a transaction waited for the last group
+  bool grpleader;                        ///< whether a group has a leader
+  bool grpsync;                          ///< whether a group is being synchronized
+  CondVar grpcond;                       ///< condition of group commit
+  std::string rdbuf;                     ///< buffer of redo records
+  AtomicInt64 dirty;                     ///< size of the data not written back
+  int64_t vsiz;                          ///< size of the reserved address space
+#if _KC_URING
+  Mutex urlock;                          ///< lock of the submission ring
+  ::io_uring* uring;                     ///< submission ring for batch reading
+#endif
 #endif
 };
 
@@ -83,6 +132,7 @@ struct FileCore {
 struct WALMessage {
   int64_t off;                           ///< offset of the region
   std::string body;                      ///< body data
+  bool trunc;                            ///< whether to truncate the file at the offset
 };
 
 
@@ -128,12 +178,85 @@ static std::string walpath(const std::string& path);
 static bool walwrite(FileCore *core, int64_t off, size_t size, int64_t base);
 
 
+/**
+ * Log the original data of a region to be updated in transaction.
+ * @param core the inner condition.
+ * @param off the offset of the region.
+ * @param size the size of the region.
+ * @return true on success, or false on failure.
+ * @note In a hard transaction, the logged original data is synchronized before a region which
+ * existed at the beginning of the transaction is updated, so that the update can be rolled back
+ * even if the page reaches the device before the commit.  Original data logged by
+ * File::write_transaction is synchronized together with the first such update.
+ */
+static bool walguard(FileCore* core, int64_t off, size_t size);
+
+
+/**
+ * Write a redo log message into the buffer of the WAL file.
+ * @param core the inner condition.
+ * @param magic the magic data of the message: WALRDOMAGIC for a redo image, WALTRCMAGIC for
+ * truncation at the offset, or WALCMTMAGIC for commit with the offset as the file size.
+ * @param off the offset of the destination.
+ * @param buf the pointer to the data region of a redo image, or NULL for the others.
+ * @param size the size of the data region.
+ * @return true on success, or false on failure.
+ * @note The attribute lock must be held.  An update outside of transactions is not logged, so
+ * the pending log is checkpointed before it.
+ */
+static bool walredo(FileCore* core, uint8_t magic, int64_t off, const char* buf, size_t size);
+
+
+/**
+ * Write the buffered redo log messages into the WAL file.
+ * @param core the inner condition.
+ * @return true on success, or false on failure.
+ * @note The attribute lock must be held.
+ */
+static bool walflush(FileCore* core);
+
+
 /**
  * Apply log messages in the WAL file.
  * @param core the inner condition.
+ * @param mark the offset of the first message to be applied.  If it is 0, all messages are
+ * applied and the file is truncated to the size at the beginning of the WAL.  Otherwise, the
+ * file is truncated to the size at the beginning of the joined transaction.
+ * @return true on success, or false on failure.
+ * @note In the WAL file of the redo log, the redo images of committed transactions are applied
+ * forward and then the undo images of the last unfinished transaction are applied backward.
+ */
+static bool walapply(FileCore* core, int64_t mark = 0);
+
+
+/**
+ * Write the data of a WAL message into the file.
+ * @param core the inner condition.
+ * @param msg the WAL message.
+ * @return true on success, or false on failure.
+ */
+static bool walput(FileCore* core, const WALMessage& msg);
+
+
+/**
+ * Clear the WAL file and synchronize the file and the WAL file with the device.
+ * @param core the inner condition.
+ * @return true on success, or false on failure.
+ * @note The attribute lock must be held or no transaction must be able to begin.
+ */
+static bool walcommit(FileCore* core);
+
+
+/**
+ * Extend the memory-mapped region within the reserved address space.
+ * @param core the inner condition.
+ * @param end the end offset to be covered.
  * @return true on success, or false on failure.
+ * @note The attribute lock must be held.
  */
-static bool walapply(FileCore* core);
+#if !defined(_SYS_MSVC_) && !defined(_SYS_MINGW_)
+static bool growmap(FileCore* core, int64_t end);
+#endif
 
 
 /**
@@ -220,7 +343,19 @@ File::File() : opq_(NULL) {
   core->walsiz = 0;
   core->tran = false;
   core->trhard = false;
+  core->trpre = false;
   core->trmsiz = 0;
+  core->trmark = 0;
+  core->trmarksiz = 0;
+  core->trpend = false;
+  core->grpseq = 0;
+  core->grpdone = 0;
+  core->grpbad = 0;
+  core->grpbadend = 0;
+  core->grplast = 0;
+  core->grpcont = false;
+  core->grpleader = false;
+  core->grpsync = false;
   opq_ = core;
 #else
   _assert_(true);
@@ -236,7 +371,23 @@ File::File() : opq_(NULL) {
   core->walsiz = 0;
   core->tran = false;
   core->trhard = false;
+  core->trpre = false;
   core->trmsiz = 0;
+  core->trmark = 0;
+  core->trmarksiz = 0;
+  core->trpend = false;
+  core->grpseq = 0;
+  core->grpdone = 0;
+  core->grpbad = 0;
+  core->grpbadend = 0;
+  core->grplast = 0;
+  core->grpcont = false;
+  core->grpleader = false;
+  core->grpsync = false;
+  core->vsiz = 0;
+#if _KC_URING
+  core->uring = NULL;
+#endif
   opq_ = core;
 #endif
 }
@@ -335,7 +486,8 @@ bool File::open(const std::string& path, uint32_t mode, int64_t msiz) {
       if (::GetFileSizeEx(walfh, &li) && li.QuadPart >= (int64_t)sizeof(WALMAGICDATA)) {
         char mbuf[sizeof(WALMAGICDATA)];
         if (myread(walfh, mbuf, sizeof(mbuf)) &&
-            !std::memcmp(mbuf, WALMAGICDATA, sizeof(WALMAGICDATA))) {
+            (!std::memcmp(mbuf, WALMAGICDATA, sizeof(WALMAGICDATA)) ||
+             !std::memcmp(mbuf, WALRDOMAGICDATA, sizeof(WALRDOMAGICDATA)))) {
           ::HANDLE ofh = fh;
           if (!(mode & OWRITER)) ofh = ::CreateFile(wpath.c_str(), GENERIC_WRITE, 0, NULL,
                                                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
@@ -463,7 +615,8 @@ bool File::open(const std::string& path, uint32_t mode, int64_t msiz) {
         if (wsbuf.st_size >= (int64_t)sizeof(WALMAGICDATA)) {
           char mbuf[sizeof(WALMAGICDATA)];
           if (myread(walfd, mbuf, sizeof(mbuf)) &&
-              !std::memcmp(mbuf, WALMAGICDATA, sizeof(WALMAGICDATA))) {
+              (!std::memcmp(mbuf, WALMAGICDATA, sizeof(WALMAGICDATA)) ||
+               !std::memcmp(mbuf, WALRDOMAGICDATA, sizeof(WALRDOMAGICDATA)))) {
             int32_t ofd = mode & OWRITER ? fd : ::open(path.c_str(), O_WRONLY, FILEPERM);
             if (ofd >= 0) {
               core->fd = ofd;
@@ -493,23 +646,55 @@ bool File::open(const std::string& path, uint32_t mode, int64_t msiz) {
   int64_t diff = msiz % PAGESIZ;
   if (diff > 0) msiz += PAGESIZ - diff;
   int32_t mprot = PROT_READ;
+  int64_t vsiz = 0;
   if (mode & OWRITER) {
     mprot |= PROT_WRITE;
+    if ((mode & OMAPGROW) && msiz > lsiz) {
+      vsiz = msiz;
+      msiz = lsiz;
+      diff = msiz % PAGESIZ;
+      if (diff > 0) msiz += PAGESIZ - diff;
+    }
   } else if (msiz > lsiz) {
     msiz = lsiz;
   }
+  int32_t mflags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+  if (mode & OMAPPOPULATE) mflags |= MAP_POPULATE;
+#endif
   void* map = NULL;
-  if (msiz > 0) {
-    map = ::mmap(0, msiz, mprot, MAP_SHARED, fd, 0);
+  if (vsiz > 0) {
+    int32_t rflags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_NORESERVE)
+    rflags |= MAP_NORESERVE;
+#endif
+    map = ::mmap(0, vsiz, PROT_NONE, rflags, -1, 0);
+    if (map == MAP_FAILED) {
+      seterrmsg(core, "mmap failed");
+      ::close(fd);
+      return false;
+    }
+    if (msiz > 0 && ::mmap(map, msiz, mprot, mflags | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      seterrmsg(core, "mmap failed");
+      ::munmap(map, vsiz);
+      ::close(fd);
+      return false;
+    }
+  } else if (msiz > 0) {
+    map = ::mmap(0, msiz, mprot, mflags, fd, 0);
     if (map == MAP_FAILED) {
       seterrmsg(core, "mmap failed");
       ::close(fd);
       return false;
     }
   }
+#if defined(MADV_HUGEPAGE)
+  if ((mode & OMAPHUGE) && msiz > 0) ::madvise(map, msiz, MADV_HUGEPAGE);
+#endif
   core->fd = fd;
   core->map = (char*)map;
   core->msiz = msiz;
+  core->vsiz = vsiz;
   core->lsiz = lsiz;
   core->psiz = psiz;
   core->recov = recov;
@@ -529,6 +714,17 @@ bool File::close() {
   FileCore* core = (FileCore*)opq_;
   bool err = false;
   if (core->tran && !end_transaction(false)) err = true;
+  core->alock.lock();
+  while (core->grpsync) {
+    core->grpcond.wait(&core->alock);
+  }
+  if (core->trpend || ((core->omode & OREDOLOG) && core->walsiz > 0)) {
+    if (!walcommit(core)) err = true;
+    core->trpend = false;
+    core->grpdone = core->grpseq;
+    core->grpcond.broadcast();
+  }
+  core->alock.unlock();
   if (core->walfh) {
     if (!::CloseHandle(core->walfh)) {
       seterrmsg(core, "CloseHandle failed");
@@ -581,6 +777,7 @@ bool File::close() {
   core->path.clear();
   core->walfh = NULL;
   core->walsiz = 0;
+  core->rdbuf.clear();
   core->tran = false;
   core->trhard = false;
   core->trmsiz = 0;
@@ -590,6 +787,17 @@ bool File::close() {
   FileCore* core = (FileCore*)opq_;
   bool err = false;
   if (core->tran && !end_transaction(false)) err = true;
+  core->alock.lock();
+  while (core->grpsync) {
+    core->grpcond.wait(&core->alock);
+  }
+  if (core->trpend || ((core->omode & OREDOLOG) && core->walsiz > 0)) {
+    if (!walcommit(core)) err = true;
+    core->trpend = false;
+    core->grpdone = core->grpseq;
+    core->grpcond.broadcast();
+  }
+  core->alock.unlock();
   if (core->walfd >= 0) {
     if (::close(core->walfd) != 0) {
       seterrmsg(core, "close failed");
@@ -603,7 +811,8 @@ bool File::close() {
       err = true;
     }
   }
-  if (core->msiz > 0 && ::munmap(core->map, core->msiz) != 0) {
+  int64_t usiz = core->vsiz > 0 ? core->vsiz : core->msiz;
+  if (usiz > 0 && ::munmap(core->map, usiz) != 0) {
     seterrmsg(core, "munmap failed");
     err = true;
   }
@@ -627,6 +836,13 @@ bool File::close() {
       }
     }
   }
+#if _KC_URING
+  if (core->uring) {
+    ::io_uring_queue_exit(core->uring);
+    delete core->uring;
+    core->uring = NULL;
+  }
+#endif
   if (::close(core->fd) != 0) {
     seterrmsg(core, "close failed");
     err = true;
@@ -639,9 +855,11 @@ bool File::close() {
   core->path.clear();
   core->walfd = -1;
   core->walsiz = 0;
+  core->rdbuf.clear();
   core->tran = false;
   core->trhard = false;
   core->trmsiz = 0;
+  core->vsiz = 0;
   return !err;
 #endif
 }
@@ -655,9 +873,14 @@ bool File::write(int64_t off, const void* buf, size_t size) {
   _assert_(off >= 0 && off <= FILEMAXSIZ && buf && size <= MEMMAXSIZ);
   if (size < 1) return true;
   FileCore* core = (FileCore*)opq_;
-  if (core->tran && !walwrite(core, off, size, core->trbase)) return false;
+  core->dirty.add(size);
+  if (core->tran && !walguard(core, off, size)) return false;
   int64_t end = off + size;
   core->alock.lock();
+  if ((core->omode & OREDOLOG) && !walredo(core, WALRDOMAGIC, off, (const char*)buf, size)) {
+    core->alock.unlock();
+    return false;
+  }
   if (end <= core->msiz) {
     if (end > core->psiz) {
       int64_t psiz = end + core->psiz / 2;
@@ -710,9 +933,18 @@ bool File::write(int64_t off, const void* buf, size_t size) {
   _assert_(off >= 0 && off <= FILEMAXSIZ && buf && size <= MEMMAXSIZ);
   if (size < 1) return true;
   FileCore* core = (FileCore*)opq_;
-  if (core->tran && !walwrite(core, off, size, core->trbase)) return false;
+  core->dirty.add(size);
+  if (core->tran && !walguard(core, off, size)) return false;
   int64_t end = off + size;
   core->alock.lock();
+  if ((core->omode & OREDOLOG) && !walredo(core, WALRDOMAGIC, off, (const char*)buf, size)) {
+    core->alock.unlock();
+    return false;
+  }
+  if (end > core->msiz && !growmap(core, end)) {
+    core->alock.unlock();
+    return false;
+  }
   if (end <= core->msiz) {
     if (end > core->psiz) {
       int64_t psiz = end + core->psiz / 2;
@@ -772,7 +1004,14 @@ bool File::write_fast(int64_t off, const void* buf, size_t size) {
 #if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
   _assert_(off >= 0 && off <= FILEMAXSIZ && buf && size <= MEMMAXSIZ);
   FileCore* core = (FileCore*)opq_;
-  if (core->tran && !walwrite(core, off, size, core->trbase)) return false;
+  core->dirty.add(size);
+  if (core->tran && !walguard(core, off, size)) return false;
+  if ((core->omode & OREDOLOG) && (core->tran || core->walsiz > 0)) {
+    core->alock.lock();
+    bool ok = walredo(core, WALRDOMAGIC, off, (const char*)buf, size);
+    core->alock.unlock();
+    if (!ok) return false;
+  }
   int64_t end = off + size;
   if (end <= core->msiz) {
     std::memcpy(core->map + off, buf, size);
@@ -793,7 +1032,14 @@ bool File::write_fast(int64_t off, const void* buf, size_t size) {
 #else
   _assert_(off >= 0 && off <= FILEMAXSIZ && buf && size <= MEMMAXSIZ);
   FileCore* core = (FileCore*)opq_;
-  if (core->tran && !walwrite(core, off, size, core->trbase)) return false;
+  core->dirty.add(size);
+  if (core->tran && !walguard(core, off, size)) return false;
+  if ((core->omode & OREDOLOG) && (core->tran || core->walsiz > 0)) {
+    core->alock.lock();
+    bool ok = walredo(core, WALRDOMAGIC, off, (const char*)buf, size);
+    core->alock.unlock();
+    if (!ok) return false;
+  }
   int64_t end = off + size;
   if (end <= core->msiz) {
     std::memcpy(core->map + off, buf, size);
@@ -823,9 +1069,14 @@ bool File::append(const void* buf, size_t size) {
   _assert_(buf && size <= MEMMAXSIZ);
   if (size < 1) return true;
   FileCore* core = (FileCore*)opq_;
+  core->dirty.add(size);
   core->alock.lock();
   int64_t off = core->lsiz;
   int64_t end = off + size;
+  if ((core->omode & OREDOLOG) && !walredo(core, WALRDOMAGIC, off, (const char*)buf, size)) {
+    core->alock.unlock();
+    return false;
+  }
   if (end <= core->msiz) {
     if (end > core->psiz) {
       int64_t psiz = end + core->psiz / 2;
@@ -883,9 +1134,18 @@ bool File::append(const void* buf, size_t size) {
   _assert_(buf && size <= MEMMAXSIZ);
   if (size < 1) return true;
   FileCore* core = (FileCore*)opq_;
+  core->dirty.add(size);
   core->alock.lock();
   int64_t off = core->lsiz;
   int64_t end = off + size;
+  if ((core->omode & OREDOLOG) && !walredo(core, WALRDOMAGIC, off, (const char*)buf, size)) {
+    core->alock.unlock();
+    return false;
+  }
+  if (end > core->msiz && !growmap(core, end)) {
+    core->alock.unlock();
+    return false;
+  }
   if (end <= core->msiz) {
     if (end > core->psiz) {
       int64_t psiz = end + core->psiz / 2;
@@ -1115,6 +1375,168 @@ bool File::read_fast(int64_t off, void* buf, size_t size) {
 }
 
 
+/**
+ * Read multiple regions at once.
+ */
+bool File::read_batch(ReadRequest* reqs, size_t num) {
+#if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
+  _assert_(reqs && num <= MEMMAXSIZ);
+  bool err = false;
+  for (size_t i = 0; i < num; i++) {
+    ReadRequest* req = reqs + i;
+    req->ok = read_fast(req->off, req->buf, req->size);
+    if (!req->ok) err = true;
+  }
+  return !err;
+#else
+  _assert_(reqs && num <= MEMMAXSIZ);
+  FileCore* core = (FileCore*)opq_;
+  std::vector<ReadRequest*> pends;
+  for (size_t i = 0; i < num; i++) {
+    ReadRequest* req = reqs + i;
+    req->ok = false;
+    if (req->off + (int64_t)req->size <= core->msiz) {
+      std::memcpy(req->buf, core->map + req->off, req->size);
+      req->ok = true;
+    } else {
+      pends.push_back(req);
+    }
+  }
+  if (pends.size() > 1) {
+#if _KC_URING
+    core->urlock.lock();
+    if (!core->uring) {
+      ::io_uring* ring = new ::io_uring;
+      if (::io_uring_queue_init(URINGDEPTH, ring, 0) == 0) {
+        core->uring = ring;
+      } else {
+        delete ring;
+      }
+    }
+    size_t pidx = 0;
+    while (core->uring && pidx < pends.size()) {
+      ::io_uring* ring = core->uring;
+      ReadRequest* sreqs[URINGDEPTH];
+      char* sbufs[URINGDEPTH];
+      uint32_t snum = 0;
+      size_t bsiz = 0;
+      while (pidx < pends.size() && snum < URINGDEPTH) {
+        ReadRequest* req = pends[pidx++];
+        if (req->off < core->msiz) continue;
+        sreqs[snum++] = req;
+        bsiz += req->size;
+      }
+      if (snum < 1) continue;
+      char* bbuf = new char[bsiz];
+      char* wp = bbuf;
+      uint32_t pnum = 0;
+      while (pnum < snum) {
+        ::io_uring_sqe* sqe = ::io_uring_get_sqe(ring);
+        if (!sqe) break;
+        ReadRequest* req = sreqs[pnum];
+        sbufs[pnum] = wp;
+        ::io_uring_prep_read(sqe, core->fd, wp, req->size, req->off);
+        ::io_uring_sqe_set_data(sqe, (void*)(intptr_t)pnum);
+        wp += req->size;
+        pnum++;
+      }
+      int32_t rnum = pnum > 0 ? ::io_uring_submit(ring) : 0;
+      if (rnum < 0) rnum = 0;
+      int32_t cnum = 0;
+      int32_t ecnt = 0;
+      while (cnum < rnum) {
+        ::io_uring_cqe* cqe;
+        int32_t ecode = ::io_uring_wait_cqe(ring, &cqe);
+        if (ecode != 0) {
+          if (ecode == -EINTR || ++ecnt < URINGRETRY) continue;
+          break;
+        }
+        uint32_t sidx = (uint32_t)(intptr_t)::io_uring_cqe_get_data(cqe);
+        ReadRequest* req = sreqs[sidx];
+        if (cqe->res == (int32_t)req->size) {
+          std::memcpy(req->buf, sbufs[sidx], req->size);
+          req->ok = true;
+        }
+        ::io_uring_cqe_seen(ring, cqe);
+        cnum++;
+      }
+      if (cnum < rnum) {
+        // reads may still be in flight, so the ring and the bounce buffer are abandoned rather
+        // than released under the kernel
+        core->uring = NULL;
+      } else {
+        delete[] bbuf;
+        if (rnum < (int32_t)pnum) {
+          ::io_uring_queue_exit(ring);
+          delete ring;
+          core->uring = NULL;
+        }
+      }
+    }
+    core->urlock.unlock();
+#elif defined(POSIX_FADV_WILLNEED)
+    for (size_t i = 0; i < pends.size(); i++) {
+      ReadRequest* req = pends[i];
+      ::posix_fadvise(core->fd, req->off, req->size, POSIX_FADV_WILLNEED);
+    }
+#endif
+  }
+  bool err = false;
+  for (size_t i = 0; i < pends.size(); i++) {
+    ReadRequest* req = pends[i];
+    if (req->ok) continue;
+    req->ok = read_fast(req->off, req->buf, req->size);
+    if (!req->ok) err = true;
+  }
+  return !err;
+#endif
+}
+
+
+/**
+ * Advise the kernel of the expected access pattern of a region.
+ */
+bool File::advise(int64_t off, int64_t size, Advice adv) {
+#if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
+  _assert_(off >= 0 && off <= FILEMAXSIZ && size >= 0);
+  return true;
+#else
+  _assert_(off >= 0 && off <= FILEMAXSIZ && size >= 0);
+  FileCore* core = (FileCore*)opq_;
+  bool err = false;
+  if (off < core->msiz) {
+    int64_t moff = off - off % PAGESIZ;
+    int64_t mend = size > 0 && off + size < core->msiz ? off + size : core->msiz;
+    int32_t madv = MADV_NORMAL;
+    switch (adv) {
+      case ASEQUENTIAL: madv = MADV_SEQUENTIAL; break;
+      case ARANDOM: madv = MADV_RANDOM; break;
+      case AWILLNEED: madv = MADV_WILLNEED; break;
+      default: break;
+    }
+    if (::madvise(core->map + moff, mend - moff, madv) != 0) {
+      seterrmsg(core, "madvise failed");
+      err = true;
+    }
+  }
+#if defined(POSIX_FADV_NORMAL)
+  int32_t fadv = POSIX_FADV_NORMAL;
+  switch (adv) {
+    case ASEQUENTIAL: fadv = POSIX_FADV_SEQUENTIAL; break;
+    case ARANDOM: fadv = POSIX_FADV_RANDOM; break;
+    case AWILLNEED: fadv = POSIX_FADV_WILLNEED; break;
+    default: break;
+  }
+  if (::posix_fadvise(core->fd, off, size, fadv) != 0) {
+    seterrmsg(core, "posix_fadvise failed");
+    err = true;
+  }
+#endif
+  return !err;
+#endif
+}
+
+
 /**
  * Truncate the file.
  */
@@ -1123,11 +1545,12 @@ bool File::truncate(int64_t size) {
   _assert_(size >= 0 && size <= FILEMAXSIZ);
   FileCore* core = (FileCore*)opq_;
   if (core->tran && size < core->trmsiz) {
-    if (!walwrite(core, size, core->trmsiz - size, core->trbase)) return false;
+    if (!walguard(core, size, core->trmsiz - size)) return false;
     core->trmsiz = size;
   }
   bool err = false;
   core->alock.lock();
+  if ((core->omode & OREDOLOG) && !walredo(core, WALTRCMAGIC, size, NULL, 0)) err = true;
   if (core->msiz > 0) {
     if (!::UnmapViewOfFile(core->map)) {
       seterrmsg(core, "UnmapViewOfFile failed");
@@ -1176,15 +1599,17 @@ bool File::truncate(int64_t size) {
   _assert_(size >= 0 && size <= FILEMAXSIZ);
   FileCore* core = (FileCore*)opq_;
   if (core->tran && size < core->trmsiz) {
-    if (!walwrite(core, size, core->trmsiz - size, core->trbase)) return false;
+    if (!walguard(core, size, core->trmsiz - size)) return false;
     core->trmsiz = size;
   }
   bool err = false;
   core->alock.lock();
+  if ((core->omode & OREDOLOG) && !walredo(core, WALTRCMAGIC, size, NULL, 0)) err = true;
   if (::ftruncate(core->fd, size) != 0) {
     seterrmsg(core, "ftruncate failed");
     err = true;
   }
+  if (size > core->msiz && !growmap(core, size)) err = true;
   core->lsiz = size;
   core->psiz = size;
   core->alock.unlock();
@@ -1201,6 +1626,7 @@ bool File::synchronize(bool hard) {
   _assert_(true);
   FileCore* core = (FileCore*)opq_;
   bool err = false;
+  int64_t dirty = hard ? core->dirty.get() : 0;
   core->alock.lock();
   if (hard && core->msiz > 0) {
     int64_t msiz = core->msiz;
@@ -1220,11 +1646,13 @@ bool File::synchronize(bool hard) {
     err = true;
   }
   core->alock.unlock();
+  if (!err) core->dirty.add(-dirty);
   return !err;
 #else
   _assert_(true);
   FileCore* core = (FileCore*)opq_;
   bool err = false;
+  int64_t dirty = hard ? core->dirty.get() : 0;
   core->alock.lock();
   if (hard && core->msiz > 0) {
     int64_t msiz = core->msiz;
@@ -1244,6 +1672,61 @@ bool File::synchronize(bool hard) {
     err = true;
   }
   core->alock.unlock();
+  if (!err) core->dirty.add(-dirty);
+  return !err;
+#endif
+}
+
+
+/**
+ * Write back updated contents to the device incrementally.
+ */
+bool File::write_back() {
+#if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
+  _assert_(true);
+  FileCore* core = (FileCore*)opq_;
+  bool err = false;
+  int64_t dirty = core->dirty.get();
+  core->alock.lock();
+  int64_t msiz = core->msiz;
+  if (msiz > core->psiz) msiz = core->psiz;
+  if (msiz > 0 && !::FlushViewOfFile(core->map, msiz)) {
+    seterrmsg(core, "FlushViewOfFile failed");
+    err = true;
+  }
+  core->alock.unlock();
+  if (!::FlushFileBuffers(core->fh)) {
+    seterrmsg(core, "FlushFileBuffers failed");
+    err = true;
+  }
+  if (!err) core->dirty.add(-dirty);
+  return !err;
+#else
+  _assert_(true);
+  FileCore* core = (FileCore*)opq_;
+  bool err = false;
+  int64_t dirty = core->dirty.get();
+#if defined(SYNC_FILE_RANGE_WRITE)
+  if (::sync_file_range(core->fd, 0, 0,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE) != 0) {
+    seterrmsg(core, "sync_file_range failed");
+    err = true;
+  }
+#else
+  core->alock.lock();
+  int64_t msiz = core->msiz;
+  if (msiz > core->psiz) msiz = core->psiz;
+  if (msiz > 0 && ::msync(core->map, msiz, MS_SYNC) != 0) {
+    seterrmsg(core, "msync failed");
+    err = true;
+  }
+  core->alock.unlock();
+  if (::fsync(core->fd) != 0) {
+    seterrmsg(core, "fsync failed");
+    err = true;
+  }
+#endif
+  if (!err) core->dirty.add(-dirty);
   return !err;
 #endif
 }
@@ -1294,6 +1777,23 @@ bool File::begin_transaction(bool hard, int64_t off) {
   _assert_(off >= 0 && off <= FILEMAXSIZ);
   FileCore* core = (FileCore*)opq_;
   core->alock.lock();
+  if (core->grpsync) {
+    core->grpcont = true;
+    do {
+      core->grpcond.wait(&core->alock);
+    } while (core->grpsync);
+  }
+  if (core->trpend || ((core->omode & OREDOLOG) && core->walsiz > 0)) {
+    core->trmark = core->walsiz;
+    core->trmarksiz = core->lsiz;
+    core->tran = true;
+    core->trhard = hard;
+    core->trpre = false;
+    core->trbase = off;
+    core->trmsiz = core->lsiz;
+    core->alock.unlock();
+    return true;
+  }
   if (!core->walfh) {
     const std::string& wpath = walpath(core->path);
     ::DWORD amode = GENERIC_READ | GENERIC_WRITE;
@@ -1315,8 +1815,13 @@ bool File::begin_transaction(bool hard, int64_t off) {
   }
   char wbuf[NUMBUFSIZ];
   char* wp = wbuf;
-  std::memcpy(wp, WALMAGICDATA, sizeof(WALMAGICDATA));
-  wp += sizeof(WALMAGICDATA);
+  if (core->omode & OREDOLOG) {
+    std::memcpy(wp, WALRDOMAGICDATA, sizeof(WALRDOMAGICDATA));
+    wp += sizeof(WALRDOMAGICDATA);
+  } else {
+    std::memcpy(wp, WALMAGICDATA, sizeof(WALMAGICDATA));
+    wp += sizeof(WALMAGICDATA);
+  }
   int64_t num = hton64(core->lsiz);
   std::memcpy(wp, &num, sizeof(num));
   wp += sizeof(num);
@@ -1327,8 +1832,13 @@ bool File::begin_transaction(bool hard, int64_t off) {
     return false;
   }
   core->walsiz = wsiz;
+  if (core->omode & OREDOLOG) {
+    core->trmark = wsiz;
+    core->trmarksiz = core->lsiz;
+  }
   core->tran = true;
   core->trhard = hard;
+  core->trpre = false;
   core->trbase = off;
   core->trmsiz = core->lsiz;
   core->alock.unlock();
@@ -1337,6 +1847,23 @@ bool File::begin_transaction(bool hard, int64_t off) {
   _assert_(off >= 0 && off <= FILEMAXSIZ);
   FileCore* core = (FileCore*)opq_;
   core->alock.lock();
+  if (core->grpsync) {
+    core->grpcont = true;
+    do {
+      core->grpcond.wait(&core->alock);
+    } while (core->grpsync);
+  }
+  if (core->trpend || ((core->omode & OREDOLOG) && core->walsiz > 0)) {
+    core->trmark = core->walsiz;
+    core->trmarksiz = core->lsiz;
+    core->tran = true;
+    core->trhard = hard;
+    core->trpre = false;
+    core->trbase = off;
+    core->trmsiz = core->lsiz;
+    core->alock.unlock();
+    return true;
+  }
   if (core->walfd < 0) {
     const std::string& wpath = walpath(core->path);
     int32_t fd = ::open(wpath.c_str(), O_RDWR | O_CREAT | O_TRUNC, FILEPERM);
@@ -1354,8 +1881,13 @@ bool File::begin_transaction(bool hard, int64_t off) {
   }
   char wbuf[NUMBUFSIZ];
   char* wp = wbuf;
-  std::memcpy(wp, WALMAGICDATA, sizeof(WALMAGICDATA));
-  wp += sizeof(WALMAGICDATA);
+  if (core->omode & OREDOLOG) {
+    std::memcpy(wp, WALRDOMAGICDATA, sizeof(WALRDOMAGICDATA));
+    wp += sizeof(WALRDOMAGICDATA);
+  } else {
+    std::memcpy(wp, WALMAGICDATA, sizeof(WALMAGICDATA));
+    wp += sizeof(WALMAGICDATA);
+  }
   int64_t num = hton64(core->lsiz);
   std::memcpy(wp, &num, sizeof(num));
   wp += sizeof(num);
@@ -1366,8 +1898,13 @@ bool File::begin_transaction(bool hard, int64_t off) {
     return false;
   }
   core->walsiz = wsiz;
+  if (core->omode & OREDOLOG) {
+    core->trmark = wsiz;
+    core->trmarksiz = core->lsiz;
+  }
   core->tran = true;
   core->trhard = hard;
+  core->trpre = false;
   core->trbase = off;
   core->trmsiz = core->lsiz;
   core->alock.unlock();
@@ -1385,7 +1922,40 @@ bool File::end_transaction(bool commit) {
   FileCore* core = (FileCore*)opq_;
   bool err = false;
   core->alock.lock();
-  if (!commit && !walapply(core)) err = true;
+  if (core->omode & OREDOLOG) {
+    if (commit) {
+      if (!walredo(core, WALCMTMAGIC, core->lsiz, NULL, 0) || !walflush(core)) err = true;
+      if (core->trhard && !::FlushFileBuffers(core->walfh)) {
+        seterrmsg(core, "FlushFileBuffers failed");
+        err = true;
+      }
+    } else {
+      core->rdbuf.clear();
+      if (!walapply(core, core->trmark)) err = true;
+      if (!err && win_ftruncate(core->walfh, core->trmark) != 0) {
+        seterrmsg(core, "win_ftruncate failed");
+        err = true;
+      }
+      core->walsiz = core->trmark;
+    }
+    core->tran = false;
+    core->trmark = 0;
+    core->alock.unlock();
+    return !err;
+  }
+  if (!commit && !walapply(core, core->trmark)) err = true;
+  if (!commit && core->trmark > 0) {
+    if (!err && win_ftruncate(core->walfh, core->trmark) != 0) {
+      seterrmsg(core, "win_ftruncate failed");
+      err = true;
+    }
+    core->walsiz = core->trmark;
+    core->tran = false;
+    core->trmark = 0;
+    core->grpcond.broadcast();
+    core->alock.unlock();
+    return !err;
+  }
   if (!err) {
     if (core->walsiz <= IOBUFSIZ) {
       char mbuf[IOBUFSIZ];
@@ -1401,7 +1971,7 @@ bool File::end_transaction(bool commit) {
       }
     }
   }
-  if (core->trhard) {
+  if (core->trhard || core->trpend) {
     int64_t msiz = core->msiz;
     if (msiz > core->psiz) msiz = core->psiz;
     if (msiz > 0 && !::FlushViewOfFile(core->map, msiz)) {
@@ -1417,7 +1987,17 @@ bool File::end_transaction(bool commit) {
       err = true;
     }
   }
+  if (core->trpend) {
+    if (err) {
+      core->grpbad = core->grpdone + 1;
+      core->grpbadend = core->grpseq;
+    }
+    core->trpend = false;
+    core->grpdone = core->grpseq;
+  }
   core->tran = false;
+  core->trmark = 0;
+  core->grpcond.broadcast();
   core->alock.unlock();
   return !err;
 #else
@@ -1425,7 +2005,40 @@ bool File::end_transaction(bool commit) {
   FileCore* core = (FileCore*)opq_;
   bool err = false;
   core->alock.lock();
-  if (!commit && !walapply(core)) err = true;
+  if (core->omode & OREDOLOG) {
+    if (commit) {
+      if (!walredo(core, WALCMTMAGIC, core->lsiz, NULL, 0) || !walflush(core)) err = true;
+      if (core->trhard && ::fsync(core->walfd) != 0) {
+        seterrmsg(core, "fsync failed");
+        err = true;
+      }
+    } else {
+      core->rdbuf.clear();
+      if (!walapply(core, core->trmark)) err = true;
+      if (!err && ::ftruncate(core->walfd, core->trmark) != 0) {
+        seterrmsg(core, "ftruncate failed");
+        err = true;
+      }
+      core->walsiz = core->trmark;
+    }
+    core->tran = false;
+    core->trmark = 0;
+    core->alock.unlock();
+    return !err;
+  }
+  if (!commit && !walapply(core, core->trmark)) err = true;
+  if (!commit && core->trmark > 0) {
+    if (!err && ::ftruncate(core->walfd, core->trmark) != 0) {
+      seterrmsg(core, "ftruncate failed");
+      err = true;
+    }
+    core->walsiz = core->trmark;
+    core->tran = false;
+    core->trmark = 0;
+    core->grpcond.broadcast();
+    core->alock.unlock();
+    return !err;
+  }
   if (!err) {
     if (core->walsiz <= IOBUFSIZ) {
       char mbuf[IOBUFSIZ];
@@ -1441,7 +2054,7 @@ bool File::end_transaction(bool commit) {
       }
     }
   }
-  if (core->trhard) {
+  if (core->trhard || core->trpend) {
     int64_t msiz = core->msiz;
     if (msiz > core->psiz) msiz = core->psiz;
     if (msiz > 0 && ::msync(core->map, msiz, MS_SYNC) != 0) {
@@ -1457,7 +2070,17 @@ bool File::end_transaction(bool commit) {
       err = true;
     }
   }
+  if (core->trpend) {
+    if (err) {
+      core->grpbad = core->grpdone + 1;
+      core->grpbadend = core->grpseq;
+    }
+    core->trpend = false;
+    core->grpdone = core->grpseq;
+  }
   core->tran = false;
+  core->trmark = 0;
+  core->grpcond.broadcast();
   core->alock.unlock();
   return !err;
 #endif
@@ -1465,29 +2088,127 @@ bool File::end_transaction(bool commit) {
 
 
 /**
- * Write a WAL message of transaction explicitly.
+ * Commit transaction and defer the synchronization to a group commit.
  */
-bool File::write_transaction(int64_t off, size_t size) {
-  _assert_(off >= 0 && off <= FILEMAXSIZ && size <= MEMMAXSIZ);
+int64_t File::end_transaction_group() {
+  _assert_(true);
   FileCore* core = (FileCore*)opq_;
-  return walwrite(core, off, size, 0);
+  core->alock.lock();
+  core->trpend = true;
+  int64_t ticket = ++core->grpseq;
+  core->tran = false;
+  core->trmark = 0;
+  core->grpcond.broadcast();
+  core->alock.unlock();
+  return ticket;
 }
 
 
 /**
- * Get the size of the file.
+ * Wait for a transaction committed in a group to be synchronized with the device.
  */
-int64_t File::size() const {
-  _assert_(true);
+bool File::wait_transaction(int64_t ticket, int64_t delay) {
+  _assert_(ticket >= 0 && delay >= 0);
   FileCore* core = (FileCore*)opq_;
-  return core->lsiz;
+  double slice = delay / 1000000.0 / GRPSLICENUM;
+  core->alock.lock();
+  while (core->grpdone < ticket) {
+    if (core->grpleader) {
+      core->grpcond.wait(&core->alock);
+      continue;
+    }
+    core->grpleader = true;
+    double etime = time() + delay / 1000000.0;
+    int64_t seq = -1;
+    while (core->grpdone < ticket && (core->tran || core->grplast > 1 || core->grpcont)) {
+      double rem = etime - time();
+      if (rem <= 0 || (!core->tran && core->grpseq == seq)) break;
+      seq = core->grpseq;
+      core->grpcond.wait(&core->alock, rem < slice ? rem : slice);
+    }
+    if (core->grpdone < ticket) {
+      core->grpsync = true;
+      core->grpcont = false;
+      while (core->tran) {
+        core->grpcond.wait(&core->alock);
+      }
+      if (core->trpend) {
+        int64_t last = core->grpseq;
+        core->alock.unlock();
+        bool ok = walcommit(core);
+        core->alock.lock();
+        if (!ok) {
+          core->grpbad = core->grpdone + 1;
+          core->grpbadend = last;
+        }
+        core->trpend = false;
+        core->grplast = last - core->grpdone;
+        core->grpdone = last;
+      }
+      core->grpsync = false;
+    }
+    core->grpleader = false;
+    core->grpcond.broadcast();
+  }
+  bool err = false;
+  if (ticket >= core->grpbad && ticket <= core->grpbadend) {
+    seterrmsg(core, "group commit failed");
+    err = true;
+  }
+  core->alock.unlock();
+  return !err;
 }
 
 
 /**
- * Get the path of the file.
+ * Write a WAL message of transaction explicitly.
  */
-std::string File::path() const {
+bool File::write_transaction(int64_t off, size_t size) {
+  _assert_(off >= 0 && off <= FILEMAXSIZ && size <= MEMMAXSIZ);
+  FileCore* core = (FileCore*)opq_;
+  return walwrite(core, off, size, 0);
+}
+
+
+/**
+ * Write back the updated region and clear the redo log.
+ */
+bool File::checkpoint(int64_t limit) {
+  _assert_(true);
+  FileCore* core = (FileCore*)opq_;
+  bool err = false;
+  core->alock.lock();
+  if ((core->omode & OREDOLOG) && !core->tran && core->walsiz > limit &&
+      !walcommit(core)) err = true;
+  core->alock.unlock();
+  return !err;
+}
+
+
+/**
+ * Get the size of the file.
+ */
+int64_t File::size() const {
+  _assert_(true);
+  FileCore* core = (FileCore*)opq_;
+  return core->lsiz;
+}
+
+
+/**
+ * Get the size of the data written since the last writeback.
+ */
+int64_t File::dirty_size() const {
+  _assert_(true);
+  FileCore* core = (FileCore*)opq_;
+  return core->dirty.get();
+}
+
+
+/**
+ * Get the path of the file.
+ */
+std::string File::path() const {
   _assert_(true);
   FileCore* core = (FileCore*)opq_;
   return core->path;
@@ -2168,10 +2889,7 @@ static bool walwrite(FileCore *core, int64_t off, size_t size, int64_t base) {
     seterrmsg(core, "mywrite failed");
     err = true;
   }
-  if (core->trhard && !::FlushFileBuffers(core->walfh)) {
-    seterrmsg(core, "FlushFileBuffers failed");
-    err = true;
-  }
+  if (core->trhard) core->trpre = true;
   core->walsiz += rsiz;
   if (rbuf != stack) delete[] rbuf;
   core->alock.unlock();
@@ -2238,10 +2956,7 @@ static bool walwrite(FileCore *core, int64_t off, size_t size, int64_t base) {
     seterrmsg(core, "mywrite failed");
     err = true;
   }
-  if (core->trhard && ::fsync(core->walfd) != 0) {
-    seterrmsg(core, "fsync failed");
-    err = true;
-  }
+  if (core->trhard) core->trpre = true;
   core->walsiz += rsiz;
   if (rbuf != stack) delete[] rbuf;
   core->alock.unlock();
@@ -2250,10 +2965,90 @@ static bool walwrite(FileCore *core, int64_t off, size_t size, int64_t base) {
 }
 
 
+/**
+ * Log the original data of a region to be updated in transaction.
+ */
+static bool walguard(FileCore* core, int64_t off, size_t size) {
+  _assert_(core && off >= 0 && off <= FILEMAXSIZ && size <= MEMMAXSIZ);
+  if (!walwrite(core, off, size, core->trbase)) return false;
+  if (off >= core->trmsiz) return true;
+  bool err = false;
+  core->alock.lock();
+  if (core->trpre) {
+#if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
+    if (!::FlushFileBuffers(core->walfh)) {
+      seterrmsg(core, "FlushFileBuffers failed");
+      err = true;
+    }
+#else
+    if (::fsync(core->walfd) != 0) {
+      seterrmsg(core, "fsync failed");
+      err = true;
+    }
+#endif
+    core->trpre = false;
+  }
+  core->alock.unlock();
+  return !err;
+}
+
+
+/**
+ * Write a redo log message into the buffer of the WAL file.
+ */
+static bool walredo(FileCore* core, uint8_t magic, int64_t off, const char* buf, size_t size) {
+  _assert_(core && off >= 0 && off <= FILEMAXSIZ && size <= MEMMAXSIZ);
+  if (!core->tran) return core->walsiz < 1 || walcommit(core);
+  if (magic == WALRDOMAGIC && size < 1) return true;
+  char hbuf[sizeof(uint8_t) + sizeof(int64_t) * 2];
+  char* wp = hbuf;
+  *(wp++) = magic;
+  int64_t num = hton64(off);
+  std::memcpy(wp, &num, sizeof(num));
+  wp += sizeof(num);
+  num = hton64(size);
+  std::memcpy(wp, &num, sizeof(num));
+  core->rdbuf.append(hbuf, sizeof(hbuf));
+  if (buf) core->rdbuf.append(buf, size);
+  if ((int64_t)core->rdbuf.size() >= WALBUFSIZ) return walflush(core);
+  return true;
+}
+
+
+/**
+ * Write the buffered redo log messages into the WAL file.
+ */
+static bool walflush(FileCore* core) {
+#if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
+  _assert_(core);
+  if (core->rdbuf.empty()) return true;
+  bool err = false;
+  if (!mywrite(core->walfh, core->walsiz, core->rdbuf.data(), core->rdbuf.size())) {
+    seterrmsg(core, "mywrite failed");
+    err = true;
+  }
+  core->walsiz += core->rdbuf.size();
+  core->rdbuf.clear();
+  return !err;
+#else
+  _assert_(core);
+  if (core->rdbuf.empty()) return true;
+  bool err = false;
+  if (!mywrite(core->walfd, core->walsiz, core->rdbuf.data(), core->rdbuf.size())) {
+    seterrmsg(core, "mywrite failed");
+    err = true;
+  }
+  core->walsiz += core->rdbuf.size();
+  core->rdbuf.clear();
+  return !err;
+#endif
+}
+
+
 /**
  * Apply log messages in the WAL file.
  */
-static bool walapply(FileCore* core) {
+static bool walapply(FileCore* core, int64_t mark) {
 #if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
   _assert_(core);
   bool err = false;
@@ -2279,7 +3074,8 @@ static bool walapply(FileCore* core) {
     return false;
   }
   if (*buf == 0) return true;
-  if (std::memcmp(buf, WALMAGICDATA, sizeof(WALMAGICDATA))) {
+  if (std::memcmp(buf, WALMAGICDATA, sizeof(WALMAGICDATA)) &&
+      std::memcmp(buf, WALRDOMAGICDATA, sizeof(WALRDOMAGICDATA))) {
     seterrmsg(core, "invalid magic data of WAL");
     return false;
   }
@@ -2287,8 +3083,18 @@ static bool walapply(FileCore* core) {
   std::memcpy(&osiz, buf + sizeof(WALMAGICDATA), sizeof(osiz));
   osiz = ntoh64(osiz);
   rem -= hsiz;
+  if (mark > hsiz) {
+    li.QuadPart = mark;
+    if (!::SetFilePointerEx(core->walfh, li, NULL, FILE_BEGIN)) {
+      seterrmsg(core, "SetFilePointerEx failed");
+      return false;
+    }
+    rem -= mark - hsiz;
+  }
   hsiz = sizeof(uint8_t) + sizeof(int64_t) * 2;
   std::vector<WALMessage> msgs;
+  std::vector<WALMessage> rmsgs;
+  std::vector<WALMessage> cmsgs;
   int64_t end = 0;
   while (rem >= hsiz) {
     if (!myread(core->walfh, buf, hsiz)) {
@@ -2302,43 +3108,59 @@ static bool walapply(FileCore* core) {
     }
     rem -= hsiz;
     char* rp = buf;
-    if (*(uint8_t*)(rp++) != WALMSGMAGIC) {
+    uint8_t magic = *(uint8_t*)(rp++);
+    if (magic != WALMSGMAGIC && magic != WALRDOMAGIC && magic != WALTRCMAGIC &&
+        magic != WALCMTMAGIC) {
       seterrmsg(core, "invalid magic data of WAL message");
       err = true;
       break;
     }
-    if (rem > 0) {
-      int64_t off;
-      std::memcpy(&off, rp, sizeof(off));
-      off = ntoh64(off);
-      rp += sizeof(off);
-      int64_t size;
-      std::memcpy(&size, rp, sizeof(size));
-      size = ntoh64(size);
-      rp += sizeof(size);
-      if (off < 0 || size < 0) {
-        seterrmsg(core, "invalid meta data of WAL message");
-        err = true;
-        break;
-      }
-      if (rem < size) {
-        seterrmsg(core, "too short WAL message");
-        err = true;
-        break;
-      }
-      char* rbuf = size > (int64_t)sizeof(buf) ? new char[size] : buf;
-      if (!myread(core->walfh, rbuf, size)) {
-        seterrmsg(core, "myread failed");
-        if (rbuf != buf) delete[] rbuf;
-        err = true;
-        break;
-      }
-      rem -= size;
-      WALMessage msg = { off, std::string(rbuf, size) };
+    int64_t off;
+    std::memcpy(&off, rp, sizeof(off));
+    off = ntoh64(off);
+    rp += sizeof(off);
+    int64_t size;
+    std::memcpy(&size, rp, sizeof(size));
+    size = ntoh64(size);
+    rp += sizeof(size);
+    if (off < 0 || size < 0) {
+      seterrmsg(core, "invalid meta data of WAL message");
+      err = true;
+      break;
+    }
+    if (magic == WALCMTMAGIC) {
+      cmsgs.insert(cmsgs.end(), rmsgs.begin(), rmsgs.end());
+      rmsgs.clear();
+      msgs.clear();
+      osiz = off;
+      continue;
+    }
+    if (magic == WALTRCMAGIC) {
+      WALMessage msg = { off, std::string(), true };
+      rmsgs.push_back(msg);
+      continue;
+    }
+    if (rem < size) {
+      seterrmsg(core, "too short WAL message");
+      err = true;
+      break;
+    }
+    char* rbuf = size > (int64_t)sizeof(buf) ? new char[size] : buf;
+    if (!myread(core->walfh, rbuf, size)) {
+      seterrmsg(core, "myread failed");
+      if (rbuf != buf) delete[] rbuf;
+      err = true;
+      break;
+    }
+    rem -= size;
+    WALMessage msg = { off, std::string(rbuf, size), false };
+    if (magic == WALMSGMAGIC) {
       msgs.push_back(msg);
       if (off + size > end) end = off + size;
-      if (rbuf != buf) delete[] rbuf;
+    } else {
+      rmsgs.push_back(msg);
     }
+    if (rbuf != buf) delete[] rbuf;
   }
   if (rem != 0) {
     if (!myread(core->walfh, buf, 1)) {
@@ -2354,42 +3176,13 @@ static bool walapply(FileCore* core) {
     seterrmsg(core, "win_ftruncate failed");
     err = true;
   }
+  for (size_t i = 0; i < cmsgs.size(); i++) {
+    if (!walput(core, cmsgs[i])) err = true;
+  }
   for (int64_t i = (int64_t)msgs.size() - 1; i >= 0; i--) {
-    const WALMessage& msg = msgs[i];
-    int64_t off = msg.off;
-    const char* rbuf = msg.body.c_str();
-    size_t size = msg.body.size();
-    int64_t end = off + size;
-    if (end <= core->msiz) {
-      std::memcpy(core->map + off, rbuf, size);
-    } else {
-      if (off < core->msiz) {
-        size_t hsiz = core->msiz - off;
-        std::memcpy(core->map + off, rbuf, hsiz);
-        off += hsiz;
-        rbuf += hsiz;
-        size -= hsiz;
-      }
-      while (true) {
-        int64_t wb = win_pwrite(core->fh, rbuf, size, off);
-        if (wb >= (int64_t)size) {
-          break;
-        } else if (wb > 0) {
-          rbuf += wb;
-          size -= wb;
-          off += wb;
-        } else if (wb == -1) {
-          seterrmsg(core, "win_pwrite failed");
-          err = true;
-          break;
-        } else if (size > 0) {
-          seterrmsg(core, "pwrite failed");
-          err = true;
-          break;
-        }
-      }
-    }
+    if (!walput(core, msgs[i])) err = true;
   }
+  if (mark > 0) osiz = core->trmarksiz;
   if (win_ftruncate(core->fh, osiz) == 0) {
     core->lsiz = osiz;
     core->psiz = osiz;
@@ -2397,6 +3190,10 @@ static bool walapply(FileCore* core) {
     seterrmsg(core, "win_ftruncate failed");
     err = true;
   }
+  if (!cmsgs.empty() && !::FlushFileBuffers(core->fh)) {
+    seterrmsg(core, "FlushFileBuffers failed");
+    err = true;
+  }
   return !err;
 #else
   _assert_(core);
@@ -2417,7 +3214,8 @@ static bool walapply(FileCore* core) {
     return false;
   }
   if (*buf == 0) return true;
-  if (std::memcmp(buf, WALMAGICDATA, sizeof(WALMAGICDATA))) {
+  if (std::memcmp(buf, WALMAGICDATA, sizeof(WALMAGICDATA)) &&
+      std::memcmp(buf, WALRDOMAGICDATA, sizeof(WALRDOMAGICDATA))) {
     seterrmsg(core, "invalid magic data of WAL");
     return false;
   }
@@ -2425,8 +3223,17 @@ static bool walapply(FileCore* core) {
   std::memcpy(&osiz, buf + sizeof(WALMAGICDATA), sizeof(osiz));
   osiz = ntoh64(osiz);
   rem -= hsiz;
+  if (mark > hsiz) {
+    if (::lseek(core->walfd, mark, SEEK_SET) != mark) {
+      seterrmsg(core, "lseek failed");
+      return false;
+    }
+    rem -= mark - hsiz;
+  }
   hsiz = sizeof(uint8_t) + sizeof(int64_t) * 2;
   std::vector<WALMessage> msgs;
+  std::vector<WALMessage> rmsgs;
+  std::vector<WALMessage> cmsgs;
   int64_t end = 0;
   while (rem >= hsiz) {
     if (!myread(core->walfd, buf, hsiz)) {
@@ -2440,43 +3247,59 @@ static bool walapply(FileCore* core) {
     }
     rem -= hsiz;
     char* rp = buf;
-    if (*(uint8_t*)(rp++) != WALMSGMAGIC) {
+    uint8_t magic = *(uint8_t*)(rp++);
+    if (magic != WALMSGMAGIC && magic != WALRDOMAGIC && magic != WALTRCMAGIC &&
+        magic != WALCMTMAGIC) {
       seterrmsg(core, "invalid magic data of WAL message");
       err = true;
       break;
     }
-    if (rem > 0) {
-      int64_t off;
-      std::memcpy(&off, rp, sizeof(off));
-      off = ntoh64(off);
-      rp += sizeof(off);
-      int64_t size;
-      std::memcpy(&size, rp, sizeof(size));
-      size = ntoh64(size);
-      rp += sizeof(size);
-      if (off < 0 || size < 0) {
-        seterrmsg(core, "invalid meta data of WAL message");
-        err = true;
-        break;
-      }
-      if (rem < size) {
-        seterrmsg(core, "too short WAL message");
-        err = true;
-        break;
-      }
-      char* rbuf = size > (int64_t)sizeof(buf) ? new char[size] : buf;
-      if (!myread(core->walfd, rbuf, size)) {
-        seterrmsg(core, "myread failed");
-        if (rbuf != buf) delete[] rbuf;
-        err = true;
-        break;
-      }
-      rem -= size;
-      WALMessage msg = { off, std::string(rbuf, size) };
+    int64_t off;
+    std::memcpy(&off, rp, sizeof(off));
+    off = ntoh64(off);
+    rp += sizeof(off);
+    int64_t size;
+    std::memcpy(&size, rp, sizeof(size));
+    size = ntoh64(size);
+    rp += sizeof(size);
+    if (off < 0 || size < 0) {
+      seterrmsg(core, "invalid meta data of WAL message");
+      err = true;
+      break;
+    }
+    if (magic == WALCMTMAGIC) {
+      cmsgs.insert(cmsgs.end(), rmsgs.begin(), rmsgs.end());
+      rmsgs.clear();
+      msgs.clear();
+      osiz = off;
+      continue;
+    }
+    if (magic == WALTRCMAGIC) {
+      WALMessage msg = { off, std::string(), true };
+      rmsgs.push_back(msg);
+      continue;
+    }
+    if (rem < size) {
+      seterrmsg(core, "too short WAL message");
+      err = true;
+      break;
+    }
+    char* rbuf = size > (int64_t)sizeof(buf) ? new char[size] : buf;
+    if (!myread(core->walfd, rbuf, size)) {
+      seterrmsg(core, "myread failed");
+      if (rbuf != buf) delete[] rbuf;
+      err = true;
+      break;
+    }
+    rem -= size;
+    WALMessage msg = { off, std::string(rbuf, size), false };
+    if (magic == WALMSGMAGIC) {
       msgs.push_back(msg);
       if (off + size > end) end = off + size;
-      if (rbuf != buf) delete[] rbuf;
+    } else {
+      rmsgs.push_back(msg);
     }
+    if (rbuf != buf) delete[] rbuf;
   }
   if (rem != 0) {
     if (!myread(core->walfd, buf, 1)) {
@@ -2492,44 +3315,13 @@ static bool walapply(FileCore* core) {
     seterrmsg(core, "ftruncate failed");
     err = true;
   }
+  for (size_t i = 0; i < cmsgs.size(); i++) {
+    if (!walput(core, cmsgs[i])) err = true;
+  }
   for (int64_t i = (int64_t)msgs.size() - 1; i >= 0; i--) {
-    const WALMessage& msg = msgs[i];
-    int64_t off = msg.off;
-    const char* rbuf = msg.body.c_str();
-    size_t size = msg.body.size();
-    int64_t end = off + size;
-    if (end <= core->msiz) {
-      std::memcpy(core->map + off, rbuf, size);
-    } else {
-      if (off < core->msiz) {
-        size_t hsiz = core->msiz - off;
-        std::memcpy(core->map + off, rbuf, hsiz);
-        off += hsiz;
-        rbuf += hsiz;
-        size -= hsiz;
-      }
-      while (true) {
-        ssize_t wb = ::pwrite(core->fd, rbuf, size, off);
-        if (wb >= (ssize_t)size) {
-          break;
-        } else if (wb > 0) {
-          rbuf += wb;
-          size -= wb;
-          off += wb;
-        } else if (wb == -1) {
-          if (errno != EINTR) {
-            seterrmsg(core, "pwrite failed");
-            err = true;
-            break;
-          }
-        } else if (size > 0) {
-          seterrmsg(core, "pwrite failed");
-          err = true;
-          break;
-        }
-      }
-    }
+    if (!walput(core, msgs[i])) err = true;
   }
+  if (mark > 0) osiz = core->trmarksiz;
   if (::ftruncate(core->fd, osiz) == 0) {
     core->lsiz = osiz;
     core->psiz = osiz;
@@ -2537,11 +3329,206 @@ static bool walapply(FileCore* core) {
     seterrmsg(core, "ftruncate failed");
     err = true;
   }
+  if (!cmsgs.empty() && ::fsync(core->fd) != 0) {
+    seterrmsg(core, "fsync failed");
+    err = true;
+  }
   return !err;
 #endif
 }
 
 
+/**
+ * Write the data of a WAL message into the file.
+ */
+static bool walput(FileCore* core, const WALMessage& msg) {
+#if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
+  _assert_(core);
+  int64_t off = msg.off;
+  if (msg.trunc) {
+    if (win_ftruncate(core->fh, off) != 0) {
+      seterrmsg(core, "win_ftruncate failed");
+      return false;
+    }
+    return true;
+  }
+  const char* rbuf = msg.body.data();
+  size_t size = msg.body.size();
+  int64_t end = off + size;
+  if (end <= core->msiz) {
+    std::memcpy(core->map + off, rbuf, size);
+    return true;
+  }
+  if (off < core->msiz) {
+    size_t hsiz = core->msiz - off;
+    std::memcpy(core->map + off, rbuf, hsiz);
+    off += hsiz;
+    rbuf += hsiz;
+    size -= hsiz;
+  }
+  while (true) {
+    int64_t wb = win_pwrite(core->fh, rbuf, size, off);
+    if (wb >= (int64_t)size) {
+      return true;
+    } else if (wb > 0) {
+      rbuf += wb;
+      size -= wb;
+      off += wb;
+    } else if (wb == -1) {
+      seterrmsg(core, "win_pwrite failed");
+      return false;
+    } else if (size > 0) {
+      seterrmsg(core, "win_pwrite failed");
+      return false;
+    }
+  }
+  return true;
+#else
+  _assert_(core);
+  int64_t off = msg.off;
+  if (msg.trunc) {
+    if (::ftruncate(core->fd, off) != 0) {
+      seterrmsg(core, "ftruncate failed");
+      return false;
+    }
+    return true;
+  }
+  const char* rbuf = msg.body.data();
+  size_t size = msg.body.size();
+  int64_t end = off + size;
+  if (end <= core->msiz) {
+    std::memcpy(core->map + off, rbuf, size);
+    return true;
+  }
+  if (off < core->msiz) {
+    size_t hsiz = core->msiz - off;
+    std::memcpy(core->map + off, rbuf, hsiz);
+    off += hsiz;
+    rbuf += hsiz;
+    size -= hsiz;
+  }
+  while (true) {
+    ssize_t wb = ::pwrite(core->fd, rbuf, size, off);
+    if (wb >= (ssize_t)size) {
+      return true;
+    } else if (wb > 0) {
+      rbuf += wb;
+      size -= wb;
+      off += wb;
+    } else if (wb == -1) {
+      if (errno != EINTR) {
+        seterrmsg(core, "pwrite failed");
+        return false;
+      }
+    } else if (size > 0) {
+      seterrmsg(core, "pwrite failed");
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+
+/**
+ * Clear the WAL file and synchronize the file and the WAL file with the device.
+ */
+static bool walcommit(FileCore* core) {
+#if defined(_SYS_MSVC_) || defined(_SYS_MINGW_)
+  _assert_(core);
+  bool err = false;
+  int64_t msiz = core->msiz;
+  if (msiz > core->psiz) msiz = core->psiz;
+  if (msiz > 0 && !::FlushViewOfFile(core->map, msiz)) {
+    seterrmsg(core, "FlushViewOfFile failed");
+    err = true;
+  }
+  if (!::FlushFileBuffers(core->fh)) {
+    seterrmsg(core, "FlushFileBuffers failed");
+    err = true;
+  }
+  if (core->walsiz <= IOBUFSIZ) {
+    char mbuf[IOBUFSIZ];
+    std::memset(mbuf, 0, core->walsiz);
+    if (!mywrite(core->walfh, 0, mbuf, core->walsiz)) {
+      seterrmsg(core, "mywrite failed");
+      err = true;
+    }
+  } else if (win_ftruncate(core->walfh, 0) != 0) {
+    seterrmsg(core, "win_ftruncate failed");
+    err = true;
+  }
+  if (!::FlushFileBuffers(core->walfh)) {
+    seterrmsg(core, "FlushFileBuffers failed");
+    err = true;
+  }
+  core->walsiz = 0;
+  return !err;
+#else
+  _assert_(core);
+  bool err = false;
+  int64_t msiz = core->msiz;
+  if (msiz > core->psiz) msiz = core->psiz;
+  if (msiz > 0 && ::msync(core->map, msiz, MS_SYNC) != 0) {
+    seterrmsg(core, "msync failed");
+    err = true;
+  }
+  if (::fsync(core->fd) != 0) {
+    seterrmsg(core, "fsync failed");
+    err = true;
+  }
+  if (core->walsiz <= IOBUFSIZ) {
+    char mbuf[IOBUFSIZ];
+    std::memset(mbuf, 0, core->walsiz);
+    if (!mywrite(core->walfd, 0, mbuf, core->walsiz)) {
+      seterrmsg(core, "mywrite failed");
+      err = true;
+    }
+  } else if (::ftruncate(core->walfd, 0) != 0) {
+    seterrmsg(core, "ftruncate failed");
+    err = true;
+  }
+  if (::fsync(core->walfd) != 0) {
+    seterrmsg(core, "fsync failed");
+    err = true;
+  }
+  core->walsiz = 0;
+  return !err;
+#endif
+}
+
+
+/**
+ * Extend the memory-mapped region within the reserved address space.
+ */
+#if !defined(_SYS_MSVC_) && !defined(_SYS_MINGW_)
+static bool growmap(FileCore* core, int64_t end) {
+  _assert_(core && end >= 0);
+  if (end <= core->msiz || core->msiz >= core->vsiz) return true;
+  int64_t msiz = core->msiz + core->msiz / 2;
+  if (msiz < end) msiz = end;
+  int64_t diff = msiz % PAGESIZ;
+  if (diff > 0) msiz += PAGESIZ - diff;
+  if (msiz > core->vsiz) msiz = core->vsiz;
+  int32_t mflags = MAP_SHARED | MAP_FIXED;
+#if defined(MAP_POPULATE)
+  if (core->omode & File::OMAPPOPULATE) mflags |= MAP_POPULATE;
+#endif
+  char* map = core->map + core->msiz;
+  if (::mmap(map, msiz - core->msiz, PROT_READ | PROT_WRITE, mflags,
+             core->fd, core->msiz) == MAP_FAILED) {
+    seterrmsg(core, "mmap failed");
+    return false;
+  }
+#if defined(MADV_HUGEPAGE)
+  if (core->omode & File::OMAPHUGE) ::madvise(map, msiz - core->msiz, MADV_HUGEPAGE);
+#endif
+  core->msiz = msiz;
+  return true;
+}
+#endif
+
+
 /**
  * Write data into a file.
  */
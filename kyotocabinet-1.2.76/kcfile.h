@@ -29,6 +29,7 @@ namespace kyotocabinet {                 // common namespace
 class File {
  public:
   struct Status;
+  struct ReadRequest;
  public:
   /** Path delimiter character. */
   static const char PATHCHR;
@@ -50,6 +51,15 @@ class File {
     int64_t size;                        ///< file size
     int64_t mtime;                       ///< last modified time
   };
+  /**
+   * Request of batch reading.
+   */
+  struct ReadRequest {
+    int64_t off;                         ///< offset of the source
+    void* buf;                           ///< buffer for the data
+    size_t size;                         ///< size of the data
+    bool ok;                             ///< whether the data was read
+  };
   /**
    * Open modes.
    */
@@ -59,7 +69,20 @@ class File {
     OCREATE = 1 << 2,                    ///< writer creating
     OTRUNCATE = 1 << 3,                  ///< writer truncating
     ONOLOCK = 1 << 4,                    ///< open without locking
-    OTRYLOCK = 1 << 5                    ///< lock without blocking
+    OTRYLOCK = 1 << 5,                   ///< lock without blocking
+    OMAPGROW = 1 << 6,                   ///< grow the mapped region with the file
+    OMAPPOPULATE = 1 << 7,               ///< prefault the mapped region
+    OMAPHUGE = 1 << 8,                   ///< advise huge pages for the mapped region
+    OREDOLOG = 1 << 9                    ///< use the redo log for transactions
+  };
+  /**
+   * Access advices.
+   */
+  enum Advice {
+    ANORMAL,                             ///< no particular access pattern
+    ASEQUENTIAL,                         ///< sequential access
+    ARANDOM,                             ///< random access
+    AWILLNEED                            ///< access in the near future
   };
   /**
    * Default constructor.
@@ -84,7 +107,13 @@ class File {
    * new file regardless if the file exists.  The following may be added to both of the reader
    * mode and the writer mode by bitwise-or: File::ONOLOCK, which means it opens the file
    * without file locking, File::TRYLOCK, which means locking is performed without blocking.
-   * @param msiz the size of the internal memory-mapped region.
+   * File::OMAPGROW, which means the memory-mapped region of a writer follows the file size up to
+   * the given map size, File::OMAPPOPULATE, which means the mapped pages are prefaulted, and
+   * File::OMAPHUGE, which means transparent huge pages are advised for the mapped region, may
+   * also be added.  File::OREDOLOG, which means transactions use the redo log, may be added to
+   * the writer mode.
+   * @param msiz the size of the internal memory-mapped region.  If File::OMAPGROW is specified,
+   * it is the upper limit of the region and the address space is reserved at once.
    * @return true on success, or false on failure.
    */
   bool open(const std::string& path, uint32_t mode = OWRITER | OCREATE, int64_t msiz = 0);
@@ -186,6 +215,30 @@ class File {
     delete[] tbuf;
     return true;
   }
+  /**
+   * Read multiple regions at once.
+   * @param reqs an array of the requests.  The member "ok" of each element is set to indicate
+   * whether its region was read.
+   * @param num the number of the requests.
+   * @return true if all regions were read, or false if any of them was not.
+   * @note Regions may spill from the logical size of the file as with the File::read_fast
+   * method.  If the library is built with io_uring, all regions out of the mapped memory are
+   * submitted to the device at once.  Otherwise, the kernel is told to read them ahead and then
+   * they are read one by one.
+   */
+  bool read_batch(ReadRequest* reqs, size_t num);
+  /**
+   * Advise the kernel of the expected access pattern of a region.
+   * @param off the offset of the region.
+   * @param size the size of the region.  If it is 0, the region extends to the end of the file.
+   * @param adv the advice: File::ANORMAL for no particular pattern, File::ASEQUENTIAL for
+   * sequential access, File::ARANDOM for random access, File::AWILLNEED to start reading the
+   * region ahead.
+   * @return true on success, or false on failure.
+   * @note The advice is applied to both of the file descriptor and the mapped memory.  It is
+   * just a hint and is ignored on platforms which do not support it.
+   */
+  bool advise(int64_t off, int64_t size, Advice adv);
   /**
    * Truncate the file.
    * @param size the new size of the file.
@@ -199,6 +252,16 @@ class File {
    * @return true on success, or false on failure.
    */
   bool synchronize(bool hard);
+  /**
+   * Write back updated contents to the device incrementally.
+   * @return true on success, or false on failure.
+   * @note Writeback of the regions updated since the last call is started and not waited for.
+   * The writeback started by the previous call is waited for first, so that calling this
+   * periodically bounds the amount of data not written yet without blocking the writers.  The
+   * mapped region and the rest of the file are treated alike.  On platforms without
+   * sync_file_range, the file is synchronized with the device physically.
+   */
+  bool write_back();
   /**
    * Refresh the internal state for update by others.
    * @return true on success, or false on failure.
@@ -210,14 +273,43 @@ class File {
    * synchronization with the file system.
    * @param off the beginning offset of the guarded region
    * @return true on success, or false on failure.
+   * @note If transactions committed by File::end_transaction_group are pending, the new
+   * transaction joins their group and shares the WAL file with them.  With File::OREDOLOG,
+   * every transaction appends to the WAL file until the next checkpoint.
    */
   bool begin_transaction(bool hard, int64_t off);
   /**
    * End transaction.
    * @param commit true to commit the transaction, or false to abort the transaction.
    * @return true on success, or false on failure.
+   * @note Aborting a transaction in a group rolls back only the transaction itself.  Committing
+   * a transaction synchronizes the pending group too.  With File::OREDOLOG, committing a hard
+   * transaction synchronizes only the WAL file, which holds the redo images of the updates, and
+   * the file is written back lazily by File::checkpoint.  The original data of updated regions
+   * is still synchronized before they are updated, so that an uncommitted transaction can be
+   * rolled back after a system crash.
    */
   bool end_transaction(bool commit);
+  /**
+   * Commit transaction and defer the synchronization to a group commit.
+   * @return the ticket of the transaction to be passed to File::wait_transaction.
+   * @note The WAL file is kept until the group is synchronized, so that a crash in the meantime
+   * rolls back the whole group.
+   */
+  int64_t end_transaction_group();
+  /**
+   * Wait for a transaction committed in a group to be synchronized with the device.
+   * @param ticket the ticket of the transaction.
+   * @param delay the maximum time in microseconds to wait for other transactions to join the
+   * group.
+   * @return true on success, or false on failure.
+   * @note The first waiting thread leads the group.  Unless it is alone, it keeps waiting as
+   * long as other transactions are running or committing, until the delay elapses.  Then it
+   * blocks new transactions, waits for the running one, and synchronizes the file and the WAL
+   * file once for all members of the group.  A leader is regarded as alone if no transaction
+   * is running, the last group had one member only, and no transaction waited for it.
+   */
+  bool wait_transaction(int64_t ticket, int64_t delay);
   /**
    * Write a WAL message of transaction explicitly.
    * @param off the offset of the source.
@@ -225,11 +317,24 @@ class File {
    * @return true on success, or false on failure.
    */
   bool write_transaction(int64_t off, size_t size);
+  /**
+   * Write back the updated region and clear the redo log.
+   * @param limit the size of the redo log up to which nothing is done.
+   * @return true on success, or false on failure.
+   * @note This works only with File::OREDOLOG and outside of transactions.  An update outside
+   * of transactions checkpoints the pending redo log implicitly.
+   */
+  bool checkpoint(int64_t limit = 0);
   /**
    * Get the size of the file.
    * @return the size of the file, or 0 on failure.
    */
   int64_t size() const;
+  /**
+   * Get the size of the data written since the last writeback.
+   * @return the size of the data written since the last writeback or physical synchronization.
+   */
+  int64_t dirty_size() const;
   /**
    * Get the path of the file.
    * @return the path of the file in bytes, or an empty string on failure.
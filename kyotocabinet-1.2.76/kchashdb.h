@@ -30,6 +30,9 @@
 #define KCHDBMAGICDATA  "KC\n"           ///< magic data of the file
 #define KCHDBCHKSUMSEED  "__kyotocabinet__"  ///< seed of the module checksum
 #define KCHDBTMPPATHEXT  "tmpkch"        ///< extension of the temporary file
+#define KCHDBBLOBPATHEXT  "blob"         ///< extension of the blob file
+#define KCHDBBLOBALTEXT  "blobalt"       ///< extension of the alternative blob file
+#define KCHDBBLOBMAGICDATA  "KCBLOB\n"   ///< magic data of the blob file
 
 namespace kyotocabinet {                 // common namespace
 
@@ -48,16 +51,24 @@ class HashDB : public BasicDB {
   friend class PlantDB<HashDB, BasicDB::TYPETREE>;
  public:
   class Cursor;
+  class Snapshot;
  private:
   struct Record;
   struct FreeBlock;
   struct FreeBlockComparator;
+  struct PackedRecord;
   class Repeater;
   class ScopedVisitor;
+  class Synchronizer;
+  class BlobLog;
   /** An alias of set of free blocks. */
   typedef std::set<FreeBlock> FBP;
   /** An alias of list of cursors. */
   typedef std::list<Cursor*> CursorList;
+  /** An alias of list of snapshots. */
+  typedef std::list<Snapshot*> SnapshotList;
+  /** An alias of list of records with compressed values. */
+  typedef std::vector<PackedRecord> PackedRecordList;
   /** The offset of the library version. */
   static const int64_t MOFFLIBVER = 4;
   /** The offset of the library revision. */
@@ -74,6 +85,8 @@ class HashDB : public BasicDB {
   static const int64_t MOFFFPOW = 10;
   /** The offset of the options. */
   static const int64_t MOFFOPTS = 11;
+  /** The offset of the number of bits of the Bloom filter. */
+  static const int64_t MOFFBLOOM = 12;
   /** The offset of the bucket number. */
   static const int64_t MOFFBNUM = 16;
   /** The offset of the status flags. */
@@ -98,6 +111,14 @@ class HashDB : public BasicDB {
   static const size_t IOBUFSIZ = 1024;
   /** The number of slots of the record lock. */
   static const int32_t RLOCKSLOT = 1024;
+  /** The size of a block of the Bloom filter. */
+  static const int64_t BFBLKSIZ = 64;
+  /** The maximum number of bits of the Bloom filter per bucket. */
+  static const int32_t BFBITSMAX = 64;
+  /** The maximum number of hash functions of the Bloom filter. */
+  static const int32_t BFHNUMMAX = 16;
+  /** The bits of the module checksum flipped if the Bloom filter is used. */
+  static const uint8_t CHKSUMBLOOM = 1 << 7;
   /** The default alignment power. */
   static const uint8_t DEFAPOW = 3;
   /** The maximum alignment power. */
@@ -110,6 +131,14 @@ class HashDB : public BasicDB {
   static const int64_t DEFBNUM = 1048583LL;
   /** The default size of the memory-mapped region. */
   static const int64_t DEFMSIZ = 64LL << 20;
+  /** The default size of the read-ahead window. */
+  static const int64_t DEFRASIZ = 2LL << 20;
+  /** The default threshold of the size of separated values. */
+  static const int64_t DEFBLTHRES = 4LL << 10;
+  /** The minimum threshold of the size of separated values. */
+  static const int64_t MINBLTHRES = 64;
+  /** The size of the header of the blob file. */
+  static const int64_t BLHEADSIZ = 8;
   /** The magic data for record. */
   static const uint8_t RECMAGIC = 0xcc;
   /** The magic data for padding. */
@@ -124,6 +153,10 @@ class HashDB : public BasicDB {
   static const int64_t SLVGWIDTH = 1LL << 20;
   /** The threshold of busy loop and sleep for locking. */
   static const uint32_t LOCKBUSYLOOP = 8192;
+  /** The maximum waiting time in milliseconds of the background synchronizer. */
+  static const int32_t BSWAIT = 50;
+  /** The size of a batch of records compressed in parallel. */
+  static const size_t PACKBATCHSIZ = 4 << 20;
  public:
   /**
    * Cursor to indicate a record.
@@ -135,9 +168,9 @@ class HashDB : public BasicDB {
      * Constructor.
      * @param db the container database object.
      */
-    explicit Cursor(HashDB* db) : db_(db), off_(0), end_(0) {
+    explicit Cursor(HashDB* db) : db_(db), off_(0), end_(0), raoff_(0) {
       _assert_(db);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       db_->curs_.push_back(this);
     }
     /**
@@ -146,7 +179,7 @@ class HashDB : public BasicDB {
     virtual ~Cursor() {
       _assert_(true);
       if (!db_) return;
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       db_->curs_.remove(this);
     }
     /**
@@ -161,7 +194,7 @@ class HashDB : public BasicDB {
      */
     bool accept(Visitor* visitor, bool writable = true, bool step = false) {
       _assert_(visitor);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       if (db_->omode_ == 0) {
         db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
         return false;
@@ -201,7 +234,11 @@ class HashDB : public BasicDB {
         vbuf = zbuf;
         vsiz = zsiz;
       }
-      vbuf = visitor->visit_full(rec.kbuf, rec.ksiz, vbuf, vsiz, &vsiz);
+      const char* obuf = vbuf;
+      size_t osiz = vsiz;
+      vbuf = visitor->visit_full(rec.kbuf, rec.ksiz, obuf, osiz, &vsiz);
+      if (vbuf != Visitor::NOP && !db_->snaps_.empty())
+        db_->record_snapshots(rec.kbuf, rec.ksiz, obuf, osiz);
       delete[] zbuf;
       if (vbuf == Visitor::REMOVE) {
         uint64_t hash = db_->hash_record(rec.kbuf, rec.ksiz);
@@ -280,7 +317,7 @@ class HashDB : public BasicDB {
      */
     bool jump() {
       _assert_(true);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       if (db_->omode_ == 0) {
         db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
         return false;
@@ -302,7 +339,7 @@ class HashDB : public BasicDB {
      */
     bool jump(const char* kbuf, size_t ksiz) {
       _assert_(kbuf && ksiz <= MEMMAXSIZ);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       if (db_->omode_ == 0) {
         db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
         return false;
@@ -366,7 +403,7 @@ class HashDB : public BasicDB {
      */
     bool jump_back() {
       _assert_(true);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       if (db_->omode_ == 0) {
         db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
         return false;
@@ -380,7 +417,7 @@ class HashDB : public BasicDB {
      */
     bool jump_back(const char* kbuf, size_t ksiz) {
       _assert_(kbuf && ksiz <= MEMMAXSIZ);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       if (db_->omode_ == 0) {
         db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
         return false;
@@ -394,7 +431,7 @@ class HashDB : public BasicDB {
      */
     bool jump_back(const std::string& key) {
       _assert_(true);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       if (db_->omode_ == 0) {
         db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
         return false;
@@ -408,7 +445,7 @@ class HashDB : public BasicDB {
      */
     bool step() {
       _assert_(true);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       if (db_->omode_ == 0) {
         db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
         return false;
@@ -433,7 +470,7 @@ class HashDB : public BasicDB {
      */
     bool step_back() {
       _assert_(true);
-      ScopedRWLock lock(&db_->mlock_, true);
+      ScopedDistributedRWLock lock(&db_->mlock_, true);
       if (db_->omode_ == 0) {
         db_->set_error(_KCCODELINE_, Error::INVALID, "not opened");
         return false;
@@ -466,6 +503,7 @@ class HashDB : public BasicDB {
         return false;
       }
       while (off_ < end_) {
+        db_->read_ahead(off_, end_, &raoff_);
         rec->off = off_;
         if (!db_->read_record(rec, rbuf)) return false;
         skip--;
@@ -491,6 +529,249 @@ class HashDB : public BasicDB {
     int64_t off_;
     /** The end offset. */
     int64_t end_;
+    /** The offset of the next read-ahead window. */
+    int64_t raoff_;
+  };
+  /**
+   * Snapshot of the database.
+   * @note The old images are kept with the keys prefixed by the bucket indices, so that the
+   * cursor can merge them into the records read from each bucket.
+   */
+  class Snapshot : public BasicDB::Snapshot {
+    friend class HashDB;
+   public:
+    /**
+     * Cursor to scan the records of a snapshot.
+     * @note The records of each hash bucket are read at once in the order of the buckets.
+     */
+    class Cursor : public BasicDB::Snapshot::Cursor {
+      friend class HashDB::Snapshot;
+     public:
+      /**
+       * Jump the cursor to the first record.
+       * @return true on success, or false on failure.
+       */
+      bool jump() {
+        _assert_(true);
+        bidx_ = 0;
+        recs_.clear();
+        ridx_ = 0;
+        return true;
+      }
+      /**
+       * Get a pair of the key and the value of the current record.
+       * @param ksp the pointer to the variable into which the size of the key region of the
+       * return value is assigned.
+       * @param vbp the pointer to the variable into which the pointer to the value region is
+       * assigned.
+       * @param vsp the pointer to the variable into which the size of the value region is
+       * assigned.
+       * @param step true to move the cursor to the next record, or false for no move.
+       * @return the pointer to the pair of the key region, or NULL on failure.
+       */
+      char* get(size_t* ksp, const char** vbp, size_t* vsp, bool step = false) {
+        _assert_(ksp && vbp && vsp);
+        while (ridx_ >= recs_.size()) {
+          if (!read_bucket()) return NULL;
+        }
+        const std::string& key = recs_[ridx_].first;
+        const std::string& value = recs_[ridx_].second;
+        char* kbuf = new char[key.size()+value.size()+2];
+        std::memcpy(kbuf, key.data(), key.size());
+        kbuf[key.size()] = '\0';
+        char* vbuf = kbuf + key.size() + 1;
+        std::memcpy(vbuf, value.data(), value.size());
+        vbuf[value.size()] = '\0';
+        *ksp = key.size();
+        *vbp = vbuf;
+        *vsp = value.size();
+        if (step) ridx_++;
+        return kbuf;
+      }
+     private:
+      /** An alias of vector of records. */
+      typedef std::vector<std::pair<std::string, std::string> > RecordVector;
+      /**
+       * Constructor.
+       * @param snap the container snapshot object.
+       */
+      explicit Cursor(Snapshot* snap) : snap_(snap), bidx_(0), recs_(), ridx_(0) {
+        _assert_(snap);
+      }
+      /**
+       * Read the records of the next bucket as of the snapshot.
+       * @return true on success, or false on failure.
+       */
+      bool read_bucket() {
+        _assert_(true);
+        HashDB* db = (HashDB*)snap_->db_;
+        recs_.clear();
+        ridx_ = 0;
+        if (!db) return false;
+        ScopedDistributedRWLock lock(&db->mlock_, false);
+        if (db->omode_ == 0) {
+          db->set_error(_KCCODELINE_, Error::INVALID, "not opened");
+          return false;
+        }
+        if (!snap_->valid()) {
+          db->set_error(_KCCODELINE_, Error::INVALID, "invalidated snapshot");
+          return false;
+        }
+        if (bidx_ >= db->bnum_) {
+          db->set_error(_KCCODELINE_, Error::NOREC, "no record");
+          return false;
+        }
+        int64_t bidx = bidx_++;
+        size_t lidx = bidx % RLOCKSLOT;
+        db->rlock_.lock_reader(lidx);
+        bool err = false;
+        std::vector<int64_t> offs;
+        int64_t off = db->get_bucket(bidx);
+        if (off < 0) {
+          err = true;
+        } else if (off > 0) {
+          offs.push_back(off);
+        }
+        while (!err && !offs.empty()) {
+          Record rec;
+          char rbuf[RECBUFSIZ];
+          rec.off = offs.back();
+          offs.pop_back();
+          if (!db->read_record(&rec, rbuf)) {
+            err = true;
+            break;
+          }
+          if (rec.psiz == UINT16MAX) {
+            db->set_error(_KCCODELINE_, Error::BROKEN, "free block in the chain");
+            err = true;
+            break;
+          }
+          if (!rec.vbuf && !db->read_record_body(&rec)) {
+            delete[] rec.bbuf;
+            err = true;
+            break;
+          }
+          const char* vbuf = rec.vbuf;
+          size_t vsiz = rec.vsiz;
+          char* zbuf = NULL;
+          size_t zsiz = 0;
+          if (db->comp_) {
+            zbuf = db->comp_->decompress(vbuf, vsiz, &zsiz);
+            if (!zbuf) {
+              db->set_error(_KCCODELINE_, Error::SYSTEM, "data decompression failed");
+              delete[] rec.bbuf;
+              err = true;
+              break;
+            }
+            vbuf = zbuf;
+            vsiz = zsiz;
+          }
+          recs_.push_back(std::make_pair(std::string(rec.kbuf, rec.ksiz),
+                                         std::string(vbuf, vsiz)));
+          delete[] zbuf;
+          delete[] rec.bbuf;
+          if (rec.left > 0) offs.push_back(rec.left);
+          if (rec.right > 0) offs.push_back(rec.right);
+        }
+        db->rlock_.unlock(lidx);
+        if (err) {
+          recs_.clear();
+          return false;
+        }
+        std::string prefix;
+        snap_->bucket_key(bidx, "", 0, &prefix);
+        std::set<std::string> keys;
+        RecordVector::iterator rit = recs_.begin();
+        while (rit != recs_.end()) {
+          keys.insert(rit->first);
+          std::string okey = prefix + rit->first;
+          int32_t rv = snap_->check(okey.data(), okey.size(), &rit->second);
+          if (rv == 0) {
+            rit = recs_.erase(rit);
+          } else {
+            ++rit;
+          }
+        }
+        std::string okey = prefix;
+        bool incl = true;
+        std::string value;
+        int32_t rv;
+        while ((rv = snap_->next(&okey, incl, &okey, &value)) >= 0 &&
+               okey.compare(0, prefix.size(), prefix) == 0) {
+          std::string key = okey.substr(prefix.size());
+          if (rv > 0 && keys.find(key) == keys.end()) recs_.push_back(std::make_pair(key, value));
+          incl = false;
+        }
+        return true;
+      }
+      /** Dummy constructor to forbid the use. */
+      Cursor(const Cursor&);
+      /** Dummy Operator to forbid the use. */
+      Cursor& operator =(const Cursor&);
+      /** The container snapshot. */
+      Snapshot* snap_;
+      /** The index of the next bucket. */
+      int64_t bidx_;
+      /** The records of the current bucket. */
+      RecordVector recs_;
+      /** The index of the current record. */
+      size_t ridx_;
+    };
+    /**
+     * Destructor.
+     */
+    virtual ~Snapshot() {
+      _assert_(true);
+      if (!db_) return;
+      HashDB* db = (HashDB*)db_;
+      ScopedDistributedRWLock lock(&db->mlock_, true);
+      db->snaps_.remove(this);
+    }
+    /**
+     * Create a cursor object.
+     * @return the return value is the created cursor object.
+     * @note Because the object of the return value is allocated by the constructor, it should
+     * be released with the delete operator before the snapshot is deleted.
+     */
+    Cursor* cursor() {
+      _assert_(true);
+      return new Cursor(this);
+    }
+   private:
+    /**
+     * Constructor.
+     * @param db the container database object.
+     * @note This must be called while the method lock is held exclusively.
+     */
+    explicit Snapshot(HashDB* db) : BasicDB::Snapshot(db, LEXICALCOMP) {
+      _assert_(db);
+      db->snaps_.push_back(this);
+    }
+    /**
+     * Make the key of the old image of a record.
+     * @param kbuf the pointer to the key region.
+     * @param ksiz the size of the key region.
+     * @param okey the string object to contain the key of the old image.
+     */
+    void old_key(const char* kbuf, size_t ksiz, std::string* okey) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && okey);
+      HashDB* db = (HashDB*)db_;
+      bucket_key(db->hash_record(kbuf, ksiz) % db->bnum_, kbuf, ksiz, okey);
+    }
+    /**
+     * Make the key of an old image prefixed by the bucket index.
+     * @param bidx the bucket index.
+     * @param kbuf the pointer to the key region.
+     * @param ksiz the size of the key region.
+     * @param okey the string object to contain the key of the old image.
+     */
+    void bucket_key(int64_t bidx, const char* kbuf, size_t ksiz, std::string* okey) {
+      _assert_(bidx >= 0 && kbuf && ksiz <= MEMMAXSIZ && okey);
+      char buf[sizeof(uint64_t)];
+      writefixnum(buf, bidx, sizeof(buf));
+      okey->assign(buf, sizeof(buf));
+      okey->append(kbuf, ksiz);
+    }
   };
   /**
    * Tuning options.
@@ -498,14 +779,27 @@ class HashDB : public BasicDB {
   enum Option {
     TSMALL = 1 << 0,                     ///< use 32-bit addressing
     TLINEAR = 1 << 1,                    ///< use linear collision chaining
-    TCOMPRESS = 1 << 2                   ///< compress each record
+    TCOMPRESS = 1 << 2,                  ///< compress each record
+    TXXHASH = 1 << 3,                    ///< use XXH64 hashing instead of MurMur hashing
+    TCHECKSUM = 1 << 4,                  ///< add a checksum to each record
+    TBLOB = 1 << 5                       ///< separate large values into the blob file
+  };
+  /**
+   * Options of the memory-mapped region.
+   */
+  enum MapOption {
+    MGROW = 1 << 0,                      ///< grow the region with the file
+    MPOPULATE = 1 << 1,                  ///< prefault the region
+    MHUGE = 1 << 2                       ///< advise transparent huge pages
   };
   /**
    * Status flags.
    */
   enum Flag {
     FOPEN = 1 << 0,                      ///< whether opened
-    FFATAL = 1 << 1                      ///< whether with fatal error
+    FFATAL = 1 << 1,                     ///< whether with fatal error
+    FFILTER = 1 << 2,                    ///< whether the Bloom filter is saved
+    FBLOBALT = 1 << 3                    ///< whether the alternative blob file is used
   };
   /**
    * Default constructor.
@@ -515,13 +809,17 @@ class HashDB : public BasicDB {
       logger_(NULL), logkinds_(0), mtrigger_(NULL),
       omode_(0), writer_(false), autotran_(false), autosync_(false),
       reorg_(false), trim_(false),
-      file_(), fbp_(), curs_(), path_(""),
+      file_(), fbp_(), curs_(), snaps_(), path_(""),
       libver_(0), librev_(0), fmtver_(0), chksum_(0), type_(TYPEHASH),
-      apow_(DEFAPOW), fpow_(DEFFPOW), opts_(0), bnum_(DEFBNUM),
+      apow_(DEFAPOW), fpow_(DEFFPOW), opts_(0), bnum_(DEFBNUM), bfbits_(0),
       flags_(0), flagopen_(false), count_(0), lsiz_(0), psiz_(0), opaque_(),
-      msiz_(DEFMSIZ), dfunit_(0), embcomp_(ZLIBRAWCOMP),
-      align_(0), fbpnum_(0), width_(0), linear_(false),
-      comp_(NULL), rhsiz_(0), boff_(0), roff_(0), dfcur_(0), frgcnt_(0),
+      msiz_(DEFMSIZ), mopts_(0), dfunit_(0), rasiz_(DEFRASIZ), gcdelay_(0), rlsiz_(0),
+      bsint_(0), bslimit_(0), bsth_(NULL), verify_(false), zthnum_(0),
+      blthres_(DEFBLTHRES), embcomp_(ZLIBRAWCOMP),
+      align_(0), fbpnum_(0), width_(0), linear_(false), crcw_(0),
+      comp_(NULL), bfile_(NULL), blob_(this), rhsiz_(0), boff_(0), bfoff_(0), bfnum_(0),
+      bfhnum_(0), roff_(0),
+      dfcur_(0), frgcnt_(0), scancnt_(0), bfbuf_(NULL), bfcheck_(0), bfreject_(0), bffalse_(0),
       tran_(false), trhard_(false), trfbp_(), trcount_(0), trsize_(0) {
     _assert_(true);
   }
@@ -541,6 +839,15 @@ class HashDB : public BasicDB {
         ++cit;
       }
     }
+    if (!snaps_.empty()) {
+      SnapshotList::const_iterator sit = snaps_.begin();
+      SnapshotList::const_iterator sitend = snaps_.end();
+      while (sit != sitend) {
+        Snapshot* snap = *sit;
+        snap->db_ = NULL;
+        ++sit;
+      }
+    }
   }
   /**
    * Accept a visitor to a record.
@@ -582,7 +889,11 @@ class HashDB : public BasicDB {
     } else {
       rlock_.lock_reader(lidx);
     }
-    if (!accept_impl(kbuf, ksiz, visitor, bidx, pivot, false)) err = true;
+    if (!writable && bfbuf_) {
+      if (!accept_filtered(kbuf, ksiz, visitor, bidx, pivot)) err = true;
+    } else {
+      if (!accept_impl(kbuf, ksiz, visitor, bidx, pivot, false)) err = true;
+    }
     rlock_.unlock(lidx);
     mlock_.unlock();
     if (!err && dfunit_ > 0 && frgcnt_ >= dfunit_ && mlock_.lock_writer_try()) {
@@ -662,13 +973,26 @@ class HashDB : public BasicDB {
       }
       ++lit;
     }
+    std::vector<const char*> heads;
+    char* hbuf = NULL;
+    if (knum > 1) {
+      std::vector<int64_t> bidxs;
+      bidxs.reserve(knum);
+      for (size_t i = 0; i < knum; i++) {
+        bidxs.push_back(rkeys[i].bidx);
+      }
+      hbuf = prefetch_chains(bidxs, &heads);
+    }
     for (size_t i = 0; i < knum; i++) {
       RecordKey* rkey = rkeys + i;
-      if (!accept_impl(rkey->kbuf, rkey->ksiz, visitor, rkey->bidx, rkey->pivot, false)) {
+      const char* head = heads.empty() ? NULL : heads[i];
+      if (!accept_impl(rkey->kbuf, rkey->ksiz, visitor, rkey->bidx, rkey->pivot, false,
+                       false, false, head)) {
         err = true;
         break;
       }
     }
+    delete[] hbuf;
     lit = lidxs.begin();
     litend = lidxs.end();
     while (lit != litend) {
@@ -689,6 +1013,239 @@ class HashDB : public BasicDB {
     }
     return !err;
   }
+  /**
+   * Apply a batch of record updates atomically.
+   * @param batch the batch of updates.
+   * @return true on success, or false on failure.
+   * @note The record locks of the touched buckets are taken in ascending order, so that other
+   * threads accessing the other records are not blocked.  If auto transaction is enabled and
+   * no transaction is active, all operations are performed in one auto transaction and are
+   * written into the WAL file at once.
+   */
+  bool apply_batch(const WriteBatch& batch) {
+    _assert_(true);
+    mlock_.lock_reader();
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      mlock_.unlock();
+      return false;
+    }
+    if (!writer_) {
+      set_error(_KCCODELINE_, Error::NOPERM, "permission denied");
+      mlock_.unlock();
+      return false;
+    }
+    if (!(flags_ & FOPEN) && !autotran_ && !tran_ && !set_flag(FOPEN, true)) {
+      mlock_.unlock();
+      return false;
+    }
+    size_t onum = batch.count();
+    if (onum < 1) {
+      mlock_.unlock();
+      return true;
+    }
+    struct RecordOperation {
+      WriteBatch::Kind kind;
+      const char* kbuf;
+      size_t ksiz;
+      const char* vbuf;
+      size_t vsiz;
+      uint32_t pivot;
+      uint64_t bidx;
+    };
+    RecordOperation* rops = new RecordOperation[onum];
+    std::set<size_t> lidxs;
+    std::vector<int64_t> bidxs;
+    bidxs.reserve(onum);
+    for (size_t i = 0; i < onum; i++) {
+      RecordOperation* rop = rops + i;
+      rop->kind = batch.get(i, &rop->kbuf, &rop->ksiz, &rop->vbuf, &rop->vsiz);
+      uint64_t hash = hash_record(rop->kbuf, rop->ksiz);
+      rop->pivot = fold_hash(hash);
+      rop->bidx = hash % bnum_;
+      lidxs.insert(rop->bidx % RLOCKSLOT);
+      bidxs.push_back(rop->bidx);
+    }
+    std::set<size_t>::iterator lit = lidxs.begin();
+    std::set<size_t>::iterator litend = lidxs.end();
+    while (lit != litend) {
+      rlock_.lock_writer(*lit);
+      ++lit;
+    }
+    std::vector<const char*> heads;
+    char* hbuf = onum > 1 ? prefetch_chains(bidxs, &heads) : NULL;
+    bool err = false;
+    bool atran = false;
+    if (autotran_ && !tran_) {
+      if (begin_auto_transaction()) {
+        atran = true;
+      } else {
+        err = true;
+      }
+    }
+    for (size_t i = 0; !err && i < onum; i++) {
+      RecordOperation* rop = rops + i;
+      BatchVisitor visitor(rop->kind, rop->vbuf, rop->vsiz);
+      const char* head = heads.empty() ? NULL : heads[i];
+      if (!accept_impl(rop->kbuf, rop->ksiz, &visitor, rop->bidx, rop->pivot, false, atran,
+                       false, head))
+        err = true;
+    }
+    delete[] hbuf;
+    if (atran) {
+      if (err) {
+        abort_auto_transaction();
+      } else if (!commit_auto_transaction()) {
+        err = true;
+      }
+    }
+    lit = lidxs.begin();
+    litend = lidxs.end();
+    while (lit != litend) {
+      rlock_.unlock(*lit);
+      ++lit;
+    }
+    delete[] rops;
+    mlock_.unlock();
+    if (!err && dfunit_ > 0 && frgcnt_ >= dfunit_ && mlock_.lock_writer_try()) {
+      int64_t unit = frgcnt_;
+      if (unit >= dfunit_) {
+        if (unit > DFRGMAX) unit = DFRGMAX;
+        if (!defrag_impl(unit * DFRGCEF)) err = true;
+        frgcnt_ -= unit;
+      }
+      mlock_.unlock();
+    }
+    return !err;
+  }
+  /**
+   * Store records supplied by a source.
+   * @param src the source of records.
+   * @return true on success, or false on failure.
+   * @note If the data compressor is enabled and multiple threads are set by
+   * tune_compression_threads, records are read in batches of about 4MB.  The values of each
+   * batch are compressed by the worker threads in parallel while the preceding batch is being
+   * written.  Otherwise, records are stored one by one.  The method lock is held as a reader
+   * until all the worker threads have finished, so the database is not closed and the blob
+   * file is not compacted under them.
+   */
+  bool load_bulk(BulkSource* src) {
+    _assert_(src);
+    mlock_.lock_reader();
+    Compressor* comp = omode_ != 0 && writer_ ? comp_ : NULL;
+    int32_t thnum = zthnum_;
+    if (!comp || thnum < 2) {
+      mlock_.unlock();
+      return BasicDB::load_bulk(src);
+    }
+    class ThreadImpl : public Thread {
+     public:
+      explicit ThreadImpl() : comp_(NULL), arena_(NULL), recs_(NULL), begin_(0), end_(0),
+                              err_(false) {}
+      void init(Compressor* comp, const std::string* arena, PackedRecordList* recs,
+                size_t begin, size_t end) {
+        comp_ = comp;
+        arena_ = arena;
+        recs_ = recs;
+        begin_ = begin;
+        end_ = end;
+      }
+      bool error() {
+        return err_;
+      }
+     private:
+      void run() {
+        const char* base = arena_->data();
+        for (size_t i = begin_; i < end_; i++) {
+          PackedRecord* rec = &(*recs_)[i];
+          rec->zbuf = comp_->compress(base + rec->koff + rec->ksiz, rec->vsiz, &rec->zsiz);
+          if (!rec->zbuf) err_ = true;
+        }
+      }
+      Compressor* comp_;
+      const std::string* arena_;
+      PackedRecordList* recs_;
+      size_t begin_;
+      size_t end_;
+      bool err_;
+    };
+    std::string arenas[2];
+    PackedRecordList recsets[2];
+    ThreadImpl* threads = new ThreadImpl[thnum*2];
+    int32_t tnums[2] = { 0, 0 };
+    int32_t cur = 0;
+    bool eof = false;
+    bool err = false;
+    while (true) {
+      std::string* arena = arenas + cur;
+      PackedRecordList* recs = recsets + cur;
+      arena->clear();
+      recs->clear();
+      const char* kbuf;
+      size_t ksiz;
+      const char* vbuf;
+      size_t vsiz;
+      while (!err && !eof && arena->size() < PACKBATCHSIZ) {
+        kbuf = src->read(&ksiz, &vbuf, &vsiz);
+        if (!kbuf) {
+          eof = true;
+          break;
+        }
+        PackedRecord rec = { arena->size(), ksiz, vsiz, NULL, 0 };
+        arena->append(kbuf, ksiz);
+        arena->append(vbuf, vsiz);
+        recs->push_back(rec);
+      }
+      size_t rnum = recs->size();
+      int32_t tnum = 0;
+      if (rnum > 0) {
+        size_t unit = (rnum - 1) / thnum + 1;
+        ThreadImpl* workers = threads + cur * thnum;
+        for (size_t begin = 0; begin < rnum; begin += unit) {
+          size_t end = begin + unit < rnum ? begin + unit : rnum;
+          workers[tnum].init(comp, arena, recs, begin, end);
+          workers[tnum].start();
+          tnum++;
+        }
+      }
+      tnums[cur] = tnum;
+      int32_t back = 1 - cur;
+      ThreadImpl* workers = threads + back * thnum;
+      for (int32_t i = 0; i < tnums[back]; i++) {
+        workers[i].join();
+        if (workers[i].error()) {
+          set_error(_KCCODELINE_, Error::SYSTEM, "data compression failed");
+          err = true;
+        }
+      }
+      PackedRecordList::iterator rit = recsets[back].begin();
+      PackedRecordList::iterator ritend = recsets[back].end();
+      const char* base = arenas[back].data();
+      while (rit != ritend) {
+        if (!err && rit->zbuf && !set_packed(base + rit->koff, rit->ksiz, rit->zbuf, rit->zsiz))
+          err = true;
+        delete[] rit->zbuf;
+        ++rit;
+      }
+      recsets[back].clear();
+      tnums[back] = 0;
+      if (tnum < 1) break;
+      if (err) eof = true;
+      cur = back;
+    }
+    delete[] threads;
+    mlock_.unlock();
+    if (!err && dfunit_ > 0 && frgcnt_ >= dfunit_ && mlock_.lock_writer_try()) {
+      int64_t unit = frgcnt_;
+      if (unit >= dfunit_) {
+        if (unit > DFRGMAX) unit = DFRGMAX;
+        if (!defrag_impl(unit * DFRGCEF)) err = true;
+        frgcnt_ -= unit;
+      }
+      mlock_.unlock();
+    }
+    return !err;
+  }
   /**
    * Iterate to accept a visitor for each record.
    * @param visitor a visitor object.
@@ -700,7 +1257,7 @@ class HashDB : public BasicDB {
    */
   bool iterate(Visitor *visitor, bool writable = true, ProgressChecker* checker = NULL) {
     _assert_(visitor);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -717,7 +1274,9 @@ class HashDB : public BasicDB {
     }
     ScopedVisitor svis(visitor);
     bool err = false;
+    begin_scan();
     if (!iterate_impl(visitor, checker)) err = true;
+    end_scan();
     trigger_meta(MetaTrigger::ITERATE, "iterate");
     return !err;
   }
@@ -733,7 +1292,7 @@ class HashDB : public BasicDB {
    */
   bool scan_parallel(Visitor *visitor, size_t thnum, ProgressChecker* checker = NULL) {
     _assert_(visitor && thnum <= MEMMAXSIZ);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -744,7 +1303,9 @@ class HashDB : public BasicDB {
     ScopedVisitor svis(visitor);
     rlock_.lock_reader_all();
     bool err = false;
+    begin_scan();
     if (!scan_parallel_impl(visitor, thnum, checker)) err = true;
+    end_scan();
     rlock_.unlock_all();
     trigger_meta(MetaTrigger::ITERATE, "scan_parallel");
     return !err;
@@ -798,7 +1359,7 @@ class HashDB : public BasicDB {
    */
   bool open(const std::string& path, uint32_t mode = OWRITER | OCREATE) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -820,6 +1381,10 @@ class HashDB : public BasicDB {
     }
     if (mode & ONOLOCK) fmode |= File::ONOLOCK;
     if (mode & OTRYLOCK) fmode |= File::OTRYLOCK;
+    if (mopts_ & MGROW) fmode |= File::OMAPGROW;
+    if (mopts_ & MPOPULATE) fmode |= File::OMAPPOPULATE;
+    if (mopts_ & MHUGE) fmode |= File::OMAPHUGE;
+    if ((mode & OWRITER) && rlsiz_ > 0) fmode |= File::OREDOLOG;
     if (!file_.open(path, fmode, msiz_)) {
       const char* emsg = file_.error();
       Error::Code code = Error::SYSTEM;
@@ -832,7 +1397,9 @@ class HashDB : public BasicDB {
       return false;
     }
     if (file_.recovered()) report(_KCCODELINE_, Logger::WARN, "recovered by the WAL file");
+    bool created = false;
     if ((mode & OWRITER) && file_.size() < 1) {
+      created = true;
       calc_meta();
       libver_ = LIBVER;
       librev_ = LIBREV;
@@ -868,10 +1435,12 @@ class HashDB : public BasicDB {
       return false;
     }
     if (((flags_ & FOPEN) || (flags_ & FFATAL)) && !(mode & ONOREPAIR) && !(mode & ONOLOCK)) {
-      if (!reorganize_file(path)) {
+      if (!open_blobs(path, false) || !reorganize_file(path)) {
+        close_blobs();
         file_.close();
         return false;
       }
+      close_blobs();
       if (!file_.close()) {
         set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
         return false;
@@ -907,22 +1476,49 @@ class HashDB : public BasicDB {
       file_.close();
       return false;
     }
+    if (bfnum_ > 0 && !load_filter()) {
+      file_.close();
+      return false;
+    }
     if (mode & OWRITER) {
       if (!(flags_ & FOPEN) && !(flags_ & FFATAL) && !load_free_blocks()) {
+        delete[] bfbuf_;
+        bfbuf_ = NULL;
         file_.close();
         return false;
       }
       if (!dump_empty_free_blocks()) {
+        delete[] bfbuf_;
+        bfbuf_ = NULL;
+        file_.close();
+        return false;
+      }
+      if ((flags_ & FFILTER) && !set_flag(FFILTER, false)) {
+        delete[] bfbuf_;
+        bfbuf_ = NULL;
         file_.close();
         return false;
       }
       if (!autotran_ && !set_flag(FOPEN, true)) {
+        delete[] bfbuf_;
+        bfbuf_ = NULL;
         file_.close();
         return false;
       }
     }
+    if (!open_blobs(path, created)) {
+      delete[] bfbuf_;
+      bfbuf_ = NULL;
+      file_.close();
+      return false;
+    }
+    file_.advise(0, 0, File::ARANDOM);
     path_.append(path);
     omode_ = mode;
+    if (writer_ && (bsint_ > 0 || bslimit_ > 0)) {
+      bsth_ = new Synchronizer(this);
+      bsth_->start();
+    }
     trigger_meta(MetaTrigger::OPEN, "open");
     return true;
   }
@@ -932,23 +1528,33 @@ class HashDB : public BasicDB {
    */
   bool close() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    if (bsth_) bsth_->finish();
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
     }
+    if (bsth_) {
+      delete bsth_;
+      bsth_ = NULL;
+    }
     report(_KCCODELINE_, Logger::DEBUG, "closing the database (path=%s)", path_.c_str());
     bool err = false;
     if (tran_ && !abort_transaction()) err = true;
     disable_cursors();
+    disable_snapshots();
     if (writer_) {
       if (!dump_free_blocks()) err = true;
+      if (bfbuf_ && !dump_filter()) err = true;
       if (!dump_meta()) err = true;
     }
+    if (!close_blobs()) err = true;
     if (!file_.close()) {
       set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
       err = true;
     }
+    delete[] bfbuf_;
+    bfbuf_ = NULL;
     fbp_.clear();
     omode_ = 0;
     path_.clear();
@@ -969,7 +1575,7 @@ class HashDB : public BasicDB {
   bool synchronize(bool hard = false, FileProcessor* proc = NULL,
                    ProgressChecker* checker = NULL) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -981,6 +1587,36 @@ class HashDB : public BasicDB {
     rlock_.unlock_all();
     return !err;
   }
+  /**
+   * Create a copy of the database file.
+   * @param dest the path of the destination file.
+   * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @return true on success, or false on failure.
+   * @note If values are separated by HashDB::TBLOB, the blob file of the current generation is
+   * copied together in the same postprocessor so that the copy is consistent.
+   */
+  bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
+    _assert_(true);
+    class FileProcessorImpl : public FileProcessor {
+     public:
+      explicit FileProcessorImpl(const std::string& dest, ProgressChecker* checker,
+                                 HashDB* db) :
+          dest_(dest), checker_(checker), db_(db) {}
+     private:
+      bool process(const std::string& path, int64_t count, int64_t size) {
+        if (!db_->copy_file(path, dest_, checker_, size)) return false;
+        if (!db_->bfile_) return true;
+        bool alt = db_->flags_ & FBLOBALT;
+        return db_->copy_file(blob_path(path, alt), blob_path(dest_, alt), checker_,
+                              db_->bfile_->size());
+      }
+      const std::string& dest_;
+      ProgressChecker* checker_;
+      HashDB* db_;
+    };
+    FileProcessorImpl proc(dest, checker, this);
+    return synchronize(false, &proc, checker);
+  }
   /**
    * Occupy database by locking and do something meanwhile.
    * @param writable true to use writer lock, or false to use reader lock.
@@ -992,7 +1628,7 @@ class HashDB : public BasicDB {
    */
   bool occupy(bool writable = true, FileProcessor* proc = NULL) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, writable);
+    ScopedDistributedRWLock lock(&mlock_, writable);
     bool err = false;
     if (proc && !proc->process(path_, count_, lsiz_)) {
       set_error(_KCCODELINE_, Error::LOGIC, "processing failed");
@@ -1082,23 +1718,31 @@ class HashDB : public BasicDB {
    */
   bool end_transaction(bool commit = true) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    mlock_.lock_writer();
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      mlock_.unlock();
       return false;
     }
     if (!tran_) {
       set_error(_KCCODELINE_, Error::INVALID, "not in transaction");
+      mlock_.unlock();
       return false;
     }
     bool err = false;
+    int64_t ticket = 0;
     if (commit) {
-      if (!commit_transaction()) err = true;
+      if (!commit_transaction(&ticket)) err = true;
     } else {
       if (!abort_transaction()) err = true;
     }
     tran_ = false;
     trigger_meta(commit ? MetaTrigger::COMMITTRAN : MetaTrigger::ABORTTRAN, "end_transaction");
+    mlock_.unlock();
+    if (ticket > 0 && !file_.wait_transaction(ticket, gcdelay_)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
+      err = true;
+    }
     return !err;
   }
   /**
@@ -1107,7 +1751,7 @@ class HashDB : public BasicDB {
    */
   bool clear() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -1117,6 +1761,7 @@ class HashDB : public BasicDB {
       return false;
     }
     disable_cursors();
+    disable_snapshots();
     if (!file_.truncate(HEADSIZ)) {
       set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
       return false;
@@ -1132,11 +1777,13 @@ class HashDB : public BasicDB {
     psiz_ = lsiz_;
     dfcur_ = roff_;
     std::memset(opaque_, 0, sizeof(opaque_));
+    if (bfbuf_) std::memset(bfbuf_, 0, bfnum_ * BFBLKSIZ);
     if (!file_.truncate(lsiz_)) {
       set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
       err = true;
     }
     if (!dump_meta()) err = true;
+    if (bfile_ && (!close_blobs() || !open_blobs(path_, true))) err = true;
     if (!autotran_ && !set_flag(FOPEN, true)) err = true;
     trigger_meta(MetaTrigger::CLEAR, "clear");
     return true;
@@ -1147,7 +1794,7 @@ class HashDB : public BasicDB {
    */
   int64_t count() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return -1;
@@ -1160,7 +1807,7 @@ class HashDB : public BasicDB {
    */
   int64_t size() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return -1;
@@ -1173,7 +1820,7 @@ class HashDB : public BasicDB {
    */
   std::string path() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return "";
@@ -1187,7 +1834,7 @@ class HashDB : public BasicDB {
    */
   bool status(std::map<std::string, std::string>* strmap) {
     _assert_(strmap);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -1204,8 +1851,29 @@ class HashDB : public BasicDB {
     (*strmap)["fpow"] = strprintf("%u", fpow_);
     (*strmap)["opts"] = strprintf("%u", opts_);
     (*strmap)["bnum"] = strprintf("%lld", (long long)bnum_);
+    (*strmap)["bloom"] = strprintf("%u", bfbits_);
+    (*strmap)["bloom_checked"] = strprintf("%lld", (long long)bfcheck_.get());
+    (*strmap)["bloom_rejected"] = strprintf("%lld", (long long)bfreject_.get());
+    (*strmap)["bloom_false"] = strprintf("%lld", (long long)bffalse_.get());
     (*strmap)["msiz"] = strprintf("%lld", (long long)msiz_);
+    (*strmap)["mopts"] = strprintf("%u", mopts_);
     (*strmap)["dfunit"] = strprintf("%lld", (long long)dfunit_);
+    (*strmap)["rasiz"] = strprintf("%lld", (long long)rasiz_);
+    (*strmap)["gcdelay"] = strprintf("%lld", (long long)gcdelay_);
+    (*strmap)["redolog"] = strprintf("%lld", (long long)rlsiz_);
+    (*strmap)["bsint"] = strprintf("%lld", (long long)bsint_);
+    (*strmap)["bslimit"] = strprintf("%lld", (long long)bslimit_);
+    (*strmap)["zthnum"] = strprintf("%d", zthnum_);
+    if (bfile_) {
+      (*strmap)["blob_thres"] = strprintf("%lld", (long long)blthres_);
+      (*strmap)["blob_size"] = strprintf("%lld", (long long)bfile_->size());
+      if (strmap->count("blob_live") > 0) {
+        int64_t live = 0;
+        if (!scan_blobs(NULL, NULL, &live, NULL)) return false;
+        (*strmap)["blob_live"] = strprintf("%lld", (long long)live);
+      }
+    }
+    (*strmap)["dirty"] = strprintf("%lld", (long long)file_.dirty_size());
     (*strmap)["frgcnt"] = strprintf("%lld", (long long)(frgcnt_ > 0 ? (int64_t)frgcnt_ : 0));
     (*strmap)["realsize"] = strprintf("%lld", (long long)file_.size());
     (*strmap)["recovered"] = strprintf("%d", file_.recovered());
@@ -1243,6 +1911,28 @@ class HashDB : public BasicDB {
     _assert_(true);
     return new Cursor(this);
   }
+  /**
+   * Create a snapshot object.
+   * @return the created snapshot object, or NULL on failure.
+   * @note Because the object of the return value is allocated by the constructor, it should be
+   * released with the delete operator when it is no longer in use.  While a snapshot exists,
+   * every update of a record copies its old image into the snapshot.  A snapshot cannot be
+   * created while a transaction is active, because aborting it would restore records without
+   * keeping their images.
+   */
+  Snapshot* snapshot() {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return NULL;
+    }
+    if (tran_) {
+      set_error(_KCCODELINE_, Error::LOGIC, "transaction is active");
+      return NULL;
+    }
+    return new Snapshot(this);
+  }
   /**
    * Write a log message.
    * @param file the file name of the program source code.
@@ -1255,7 +1945,7 @@ class HashDB : public BasicDB {
   void log(const char* file, int32_t line, const char* func, Logger::Kind kind,
            const char* message) {
     _assert_(file && line > 0 && func && message);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (!logger_) return;
     logger_->log(file, line, func, kind, message);
   }
@@ -1269,7 +1959,7 @@ class HashDB : public BasicDB {
    */
   bool tune_logger(Logger* logger, uint32_t kinds = Logger::WARN | Logger::ERROR) {
     _assert_(logger);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1285,7 +1975,7 @@ class HashDB : public BasicDB {
    */
   bool tune_meta_trigger(MetaTrigger* trigger) {
     _assert_(trigger);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1300,7 +1990,7 @@ class HashDB : public BasicDB {
    */
   bool tune_alignment(int8_t apow) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1316,7 +2006,7 @@ class HashDB : public BasicDB {
    */
   bool tune_fbp(int8_t fpow) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1328,12 +2018,26 @@ class HashDB : public BasicDB {
   /**
    * Set the optional features.
    * @param opts the optional features by bitwise-or: HashDB::TSMALL to use 32-bit addressing,
-   * HashDB::TLINEAR to use linear collision chaining, HashDB::TCOMPRESS to compress each record.
+   * HashDB::TLINEAR to use linear collision chaining, HashDB::TCOMPRESS to compress each record,
+   * HashDB::TXXHASH to use XXH64 hashing instead of MurMur hashing, HashDB::TCHECKSUM to add a
+   * CRC32C checksum of the key and the value to each record, HashDB::TBLOB to separate large
+   * values into the blob file.
    * @return true on success, or false on failure.
+   * @note The hash function is recorded in the database file.  A database created with
+   * HashDB::TXXHASH, HashDB::TCHECKSUM, or HashDB::TBLOB is refused by older versions of the
+   * library because its module checksum is altered by these options.  The record checksum is
+   * always written if HashDB::TCHECKSUM is set, and it is verified only if verification is
+   * enabled by HashDB::tune_verification.  If HashDB::TBLOB is set, a value whose stored size
+   * is not less than the threshold is appended to the blob file, whose path is the database
+   * path with the suffix ".blob", and the record keeps a reference to it.  Defragmentation
+   * moves only the references, and the space of overwritten values in the blob file is
+   * reclaimed by HashDB::compact_blobs.  The blob file must be copied or moved together with
+   * the database file, as HashDB::copy does.  A snapshot by BasicDB::dump_snapshot holds the
+   * separated values themselves instead of the references.
    */
   bool tune_options(int8_t opts) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1348,7 +2052,7 @@ class HashDB : public BasicDB {
    */
   bool tune_buckets(int64_t bnum) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1357,6 +2061,29 @@ class HashDB : public BasicDB {
     if (bnum_ > INT16MAX) bnum_ = nearbyprime(bnum_);
     return true;
   }
+  /**
+   * Set the size of the Bloom filter for negative lookups.
+   * @param bits the number of bits of the filter per bucket.  If it is not more than 0, the
+   * filter is not used.
+   * @return true on success, or false on failure.
+   * @note The filter consists of blocks of 512 bits, each of which covers a group of buckets,
+   * and a read-only lookup of a key missing in the filter touches neither the bucket array nor
+   * the records.  As the number of buckets is supposed to be about the number of records, 10
+   * bits per bucket make a false positive rate of about 1%.  The setting is saved in the file
+   * when it is created, and older versions of the library refuse to open a file with the
+   * filter.  The filter is saved when the database is closed and it is rebuilt by scanning the
+   * records when the database was not closed properly.
+   */
+  bool tune_bloom(int32_t bits) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    bfbits_ = bits > 0 ? (bits < BFBITSMAX ? bits : BFBITSMAX) : 0;
+    return true;
+  }
   /**
    * Set the size of the internal memory-mapped region.
    * @param msiz the size of the internal memory-mapped region.
@@ -1364,7 +2091,7 @@ class HashDB : public BasicDB {
    */
   bool tune_map(int64_t msiz) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1372,6 +2099,27 @@ class HashDB : public BasicDB {
     msiz_ = msiz >= 0 ? msiz : DEFMSIZ;
     return true;
   }
+  /**
+   * Set the options of the internal memory-mapped region.
+   * @param mopts the options by bitwise-or: HashDB::MGROW to map the file as it grows instead of
+   * mapping a fixed region, HashDB::MPOPULATE to prefault the mapped pages, HashDB::MHUGE to
+   * advise transparent huge pages for the mapped region.
+   * @return true on success, or false on failure.
+   * @note If HashDB::MGROW is specified, the size given by HashDB::tune_map is the upper limit of
+   * the region and the address space is reserved when the database is opened, so a large limit
+   * costs nothing until the file grows.  These options take effect only on platforms
+   * supporting them.
+   */
+  bool tune_map_options(int8_t mopts) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    mopts_ = mopts;
+    return true;
+  }
   /**
    * Set the unit step number of auto defragmentation.
    * @param dfunit the unit step number of auto defragmentation.
@@ -1379,7 +2127,7 @@ class HashDB : public BasicDB {
    */
   bool tune_defrag(int64_t dfunit) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1387,6 +2135,113 @@ class HashDB : public BasicDB {
     dfunit_ = dfunit > 0 ? dfunit : 0;
     return true;
   }
+  /**
+   * Set the size of the read-ahead window for sequential scans.
+   * @param rasiz the size of the window.  If it is not more than 0, explicit read-ahead is
+   * disabled.
+   * @return true on success, or false on failure.
+   * @note Point lookups advise the kernel of random access, and iteration, parallel scanning,
+   * and cursor stepping ask the kernel to read the window ahead of the current position.
+   */
+  bool tune_readahead(int64_t rasiz) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    rasiz_ = rasiz > 0 ? rasiz : 0;
+    return true;
+  }
+  /**
+   * Set the maximum delay of group commit of hard transactions.
+   * @param delay the maximum delay in microseconds.  If it is not more than 0, group commit is
+   * disabled.  By default, group commit is disabled.
+   * @return true on success, or false on failure.
+   * @note When group commit is enabled, committing a hard transaction releases the database
+   * for the next transaction at once and waits until the changes are synchronized with the
+   * device.  The transactions committed in the meantime share the WAL file and one
+   * synchronization of the file, so that the throughput of durable commits grows with the
+   * number of concurrent writers.  A single writer does not wait for the delay.
+   */
+  bool tune_group_commit(int64_t delay) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    gcdelay_ = delay > 0 ? delay : 0;
+    return true;
+  }
+  /**
+   * Set the redo log of transactions.
+   * @param limit the size of the redo log to trigger a checkpoint.  If it is not more than 0,
+   * the undo log is used.  By default, the undo log is used.
+   * @return true on success, or false on failure.
+   * @note With the undo log, the original data of every updated region is written into the WAL
+   * file before the update, and hard transactions synchronize it before each update of data
+   * which existed at the beginning of the transaction.  With the redo log, the updated data is
+   * appended to the WAL file too, and a hard transaction synchronizes only the WAL file, at
+   * those updates and once at the end.  The database file is written back when the log exceeds
+   * the limit, when an update outside of transactions is done, or when the database is closed.
+   * Recovery replays the updates of committed transactions.  Group commit is not used with the
+   * redo log.
+   */
+  bool tune_redo_log(int64_t limit) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    rlsiz_ = limit > 0 ? limit : 0;
+    return true;
+  }
+  /**
+   * Set the background synchronization.
+   * @param interval the interval in microseconds of writing back updated contents.  If it is
+   * not more than 0, the updated contents are not written back periodically.
+   * @param limit the size of updated contents to trigger writing back.  If it is not more than
+   * 0, the size is not limited.  By default, neither is set and background synchronization is
+   * disabled.
+   * @return true on success, or false on failure.
+   * @note If either is set, a thread is started when the database is opened as a writer.  It
+   * saves the record number and the file size into the header unless a transaction is running,
+   * and it starts writing back the updated regions of the file without waiting for them, after
+   * the writeback started last time is done.  So, the data which can be lost by a crash is
+   * bounded and the explicit synchronization has little to do.  The size of updated contents is
+   * checked every 50 milliseconds at most.
+   */
+  bool tune_background_sync(int64_t interval, int64_t limit) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    bsint_ = interval > 0 ? interval : 0;
+    bslimit_ = limit > 0 ? limit : 0;
+    return true;
+  }
+  /**
+   * Set the verification of checksums on reading.
+   * @param verify true to verify the checksum of each record whose value is read, or false not
+   * to verify.  By default, checksums are not verified.
+   * @return true on success, or false on failure.
+   * @note This is meaningful only for a database created with HashDB::TCHECKSUM.  A record
+   * whose checksum does not match causes the error of Error::BROKEN.
+   */
+  bool tune_verification(bool verify) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    verify_ = verify;
+    return true;
+  }
   /**
    * Set the data compressor.
    * @param comp the data compressor object.
@@ -1394,7 +2249,7 @@ class HashDB : public BasicDB {
    */
   bool tune_compressor(Compressor* comp) {
     _assert_(comp);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1402,13 +2257,51 @@ class HashDB : public BasicDB {
     embcomp_ = comp;
     return true;
   }
+  /**
+   * Set the number of threads to compress records in bulk loading.
+   * @param thnum the number of threads.  If it is not more than 1, records are compressed by
+   * the calling thread.  By default, it is 0.
+   * @return true on success, or false on failure.
+   * @note This is meaningful only if the option of HashDB::TCOMPRESS is set.  It affects the
+   * load_bulk method and the load_snapshot method.  The data compressor must be thread-safe.
+   */
+  bool tune_compression_threads(int32_t thnum) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    zthnum_ = thnum > 0 ? thnum : 0;
+    return true;
+  }
+  /**
+   * Set the threshold of the size of values separated into the blob file.
+   * @param thres the threshold of the size of a value.  If it is not more than 0, the default
+   * setting 4096 is specified.  A value smaller than 64 is raised to 64.
+   * @return true on success, or false on failure.
+   * @note This is meaningful only if the option of HashDB::TBLOB is set.  The threshold is
+   * compared with the size of each value after compression.  It is not recorded in the file
+   * and it can be changed whenever the database is opened.
+   */
+  bool tune_blob(int64_t thres) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    blthres_ = thres > 0 ? thres : DEFBLTHRES;
+    if (blthres_ < MINBLTHRES) blthres_ = MINBLTHRES;
+    return true;
+  }
   /**
    * Get the opaque data.
    * @return the pointer to the opaque data region, whose size is 16 bytes.
    */
   char* opaque() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return NULL;
@@ -1421,7 +2314,7 @@ class HashDB : public BasicDB {
    */
   bool synchronize_opaque() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -1441,7 +2334,7 @@ class HashDB : public BasicDB {
    */
   bool defrag(int64_t step = 0) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -1460,13 +2353,46 @@ class HashDB : public BasicDB {
     frgcnt_ = 0;
     return !err;
   }
+  /**
+   * Reclaim the space of dead values in the blob file.
+   * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @return true on success, or false on failure.
+   * @note This is meaningful only for a database created with HashDB::TBLOB.  Values alive are
+   * copied into a new blob file and the references are rewritten in a hard transaction.  The old
+   * blob file is removed after the transaction is committed.  This waits for running bulk loads,
+   * whose worker threads append values to the blob file.
+   */
+  bool compact_blobs(ProgressChecker* checker = NULL) {
+    _assert_(true);
+    ScopedDistributedRWLock lock(&mlock_, true);
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    if (!writer_) {
+      set_error(_KCCODELINE_, Error::NOPERM, "permission denied");
+      return false;
+    }
+    if (!bfile_) {
+      set_error(_KCCODELINE_, Error::INVALID, "values are not separated");
+      return false;
+    }
+    if (tran_) {
+      set_error(_KCCODELINE_, Error::LOGIC, "transaction is active");
+      return false;
+    }
+    bool err = false;
+    if (!compact_blobs_impl(checker)) err = true;
+    trigger_meta(MetaTrigger::MISC, "compact_blobs");
+    return !err;
+  }
   /**
    * Get the status flags.
    * @return the status flags, or 0 on failure.
    */
   uint8_t flags() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1554,7 +2480,7 @@ class HashDB : public BasicDB {
    */
   bool tune_type(int8_t type) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    ScopedDistributedRWLock lock(&mlock_, true);
     if (omode_ != 0) {
       set_error(_KCCODELINE_, Error::INVALID, "already opened");
       return false;
@@ -1568,7 +2494,7 @@ class HashDB : public BasicDB {
    */
   uint8_t libver() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1581,7 +2507,7 @@ class HashDB : public BasicDB {
    */
   uint8_t librev() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1594,7 +2520,7 @@ class HashDB : public BasicDB {
    */
   uint8_t fmtver() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1607,7 +2533,7 @@ class HashDB : public BasicDB {
    */
   uint8_t chksum() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1620,7 +2546,7 @@ class HashDB : public BasicDB {
    */
   uint8_t type() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1633,7 +2559,7 @@ class HashDB : public BasicDB {
    */
   uint8_t apow() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1646,7 +2572,7 @@ class HashDB : public BasicDB {
    */
   uint8_t fpow() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1659,7 +2585,7 @@ class HashDB : public BasicDB {
    */
   uint8_t opts() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1672,7 +2598,7 @@ class HashDB : public BasicDB {
    */
   int64_t bnum() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1685,7 +2611,7 @@ class HashDB : public BasicDB {
    */
   int64_t msiz() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1698,7 +2624,7 @@ class HashDB : public BasicDB {
    */
   int64_t dfunit() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return 0;
@@ -1711,12 +2637,12 @@ class HashDB : public BasicDB {
    */
   Compressor* comp() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return NULL;
     }
-    return comp_;
+    return (opts_ & TCOMPRESS) ? embcomp_ : NULL;
   }
   /**
    * Check whether the database was recovered or not.
@@ -1724,7 +2650,7 @@ class HashDB : public BasicDB {
    */
   bool recovered() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -1737,7 +2663,7 @@ class HashDB : public BasicDB {
    */
   bool reorganized() {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, false);
+    ScopedDistributedRWLock lock(&mlock_, false);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
@@ -1760,6 +2686,7 @@ class HashDB : public BasicDB {
     const char* vbuf;                    ///< pointer to the value
     int64_t boff;                        ///< offset of the body
     char* bbuf;                          ///< buffer of the body
+    uint32_t crc;                        ///< checksum of the body
   };
   /**
    * Free block data.
@@ -1785,6 +2712,16 @@ class HashDB : public BasicDB {
       return a.off < b.off;
     }
   };
+  /**
+   * Record whose value is compressed in advance.
+   */
+  struct PackedRecord {
+    size_t koff;                         ///< offset of the key in the arena
+    size_t ksiz;                         ///< size of the key
+    size_t vsiz;                         ///< size of the value
+    char* zbuf;                          ///< compressed value
+    size_t zsiz;                         ///< size of the compressed value
+  };
   /**
    * Repeating visitor.
    */
@@ -1806,23 +2743,338 @@ class HashDB : public BasicDB {
     size_t vsiz_;
   };
   /**
-   * Scoped visitor.
+   * Visitor to apply an operation of a write batch.
+   */
+  class BatchVisitor : public Visitor {
+   public:
+    /** constructor */
+    explicit BatchVisitor(WriteBatch::Kind kind, const char* vbuf, size_t vsiz) :
+        kind_(kind), vbuf_(vbuf), vsiz_(vsiz) {
+      _assert_(vbuf);
+    }
+   private:
+    /** visit a record */
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && vbuf && vsiz <= MEMMAXSIZ && sp);
+      if (kind_ == WriteBatch::KREMOVE) return REMOVE;
+      *sp = vsiz_;
+      return vbuf_;
+    }
+    /** visit an empty record */
+    const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && sp);
+      if (kind_ == WriteBatch::KREMOVE) return NOP;
+      *sp = vsiz_;
+      return vbuf_;
+    }
+    WriteBatch::Kind kind_;
+    const char* vbuf_;
+    size_t vsiz_;
+  };
+  /**
+   * Scoped visitor.
+   */
+  class ScopedVisitor {
+   public:
+    /** constructor */
+    explicit ScopedVisitor(Visitor* visitor) : visitor_(visitor) {
+      _assert_(visitor);
+      visitor_->visit_before();
+    }
+    /** destructor */
+    ~ScopedVisitor() {
+      _assert_(true);
+      visitor_->visit_after();
+    }
+   private:
+    Visitor* visitor_;                   ///< visitor
+  };
+  /**
+   * Synchronizer of updated contents in background.
+   */
+  class Synchronizer : public Thread {
+   public:
+    /** constructor */
+    explicit Synchronizer(HashDB* db) : db_(db), lock_(), cond_(), alive_(true) {
+      _assert_(db);
+    }
+    /** destructor */
+    ~Synchronizer() {
+      _assert_(true);
+      finish();
+    }
+    /** stop the thread and wait for it to exit */
+    void finish() {
+      _assert_(true);
+      lock_.lock();
+      bool alive = alive_;
+      alive_ = false;
+      cond_.signal();
+      lock_.unlock();
+      if (alive) join();
+    }
+   private:
+    /** perform the concrete process */
+    void run() {
+      _assert_(true);
+      double wait = db_->bsint_ / 1000000.0;
+      if (db_->bslimit_ > 0 && (wait <= 0 || wait > BSWAIT / 1000.0)) wait = BSWAIT / 1000.0;
+      double stime = time();
+      while (true) {
+        lock_.lock();
+        if (alive_) cond_.wait(&lock_, wait);
+        if (!alive_) {
+          lock_.unlock();
+          break;
+        }
+        lock_.unlock();
+        double etime = time();
+        if ((db_->bsint_ > 0 && (etime - stime) * 1000000 >= db_->bsint_) ||
+            (db_->bslimit_ > 0 && db_->file_.dirty_size() >= db_->bslimit_)) {
+          db_->synchronize_background();
+          stime = etime;
+        }
+      }
+    }
+    HashDB* db_;                         ///< database
+    Mutex lock_;                         ///< lock for the state
+    CondVar cond_;                       ///< condition variable for the state
+    bool alive_;                         ///< whether to be alive
+  };
+  /**
+   * Log of separated values.
+   * @note This is installed as the data compressor of a database with HashDB::TBLOB.  Every
+   * stored value begins with a tag.  A small value follows the tag as is, and a large value is
+   * appended to the blob file and a reference of the offset, the size, and the CRC32C checksum
+   * follows the tag.
+   */
+  class BlobLog : public Compressor {
+   public:
+    /** The tag of an embedded value. */
+    static const uint8_t TAGEMBED = 0x00;
+    /** The tag of a reference. */
+    static const uint8_t TAGREF = 0x01;
+    /** The size of a reference. */
+    static const size_t REFSIZ = 1 + sizeof(uint64_t) * 2 + sizeof(uint32_t);
+    /** constructor */
+    explicit BlobLog(HashDB* db) : db_(db), comp_(NULL), thres_(0), file_(NULL), end_(0) {
+      _assert_(db);
+    }
+    /** set the inner compressor and the threshold */
+    void tune(Compressor* comp, int64_t thres) {
+      _assert_(thres > 0);
+      comp_ = comp;
+      thres_ = thres;
+    }
+    /** attach the blob file */
+    void attach(File* file) {
+      _assert_(true);
+      file_ = file;
+      end_.set(file ? file->size() : 0);
+    }
+    /** check whether a stored value is a reference */
+    static bool reference(const char* buf, size_t size) {
+      _assert_(buf);
+      return size == REFSIZ && *(uint8_t*)buf == TAGREF;
+    }
+    /** get the size of the data of a reference */
+    static size_t data_size(const char* buf) {
+      _assert_(buf);
+      return readfixnum(buf + 1 + sizeof(uint64_t), sizeof(uint64_t));
+    }
+    /** copy the data of a reference to the end of another file */
+    bool relocate(const char* buf, File* dest, int64_t* endp, char* nbuf) {
+      _assert_(buf && dest && endp && nbuf);
+      size_t rsiz;
+      char* rbuf = read_data(buf, &rsiz);
+      if (!rbuf) {
+        db_->set_error(_KCCODELINE_, Error::BROKEN, "reading a separated value failed");
+        return false;
+      }
+      if (!dest->write(*endp, rbuf, rsiz)) {
+        db_->set_error(_KCCODELINE_, Error::SYSTEM, dest->error());
+        delete[] rbuf;
+        return false;
+      }
+      write_reference(nbuf, *endp, rbuf, rsiz);
+      *endp += rsiz;
+      delete[] rbuf;
+      return true;
+    }
+    /** compress a serial data */
+    char* compress(const void* buf, size_t size, size_t* sp) {
+      _assert_(buf && size <= MEMMAXSIZ && sp);
+      const char* rp = (const char*)buf;
+      size_t rsiz = size;
+      char* zbuf = NULL;
+      if (comp_) {
+        zbuf = comp_->compress(buf, size, &rsiz);
+        if (!zbuf) return NULL;
+        rp = zbuf;
+      }
+      char* obuf;
+      if (file_ && (int64_t)rsiz >= thres_) {
+        int64_t off = end_.add(rsiz);
+        if (!file_->write(off, rp, rsiz)) {
+          db_->report(_KCCODELINE_, Logger::WARN, "writing the blob file failed: %s",
+                      file_->error());
+          delete[] zbuf;
+          return NULL;
+        }
+        obuf = new char[REFSIZ];
+        write_reference(obuf, off, rp, rsiz);
+        *sp = REFSIZ;
+      } else {
+        obuf = new char[1+rsiz];
+        *obuf = TAGEMBED;
+        std::memcpy(obuf + 1, rp, rsiz);
+        *sp = 1 + rsiz;
+      }
+      delete[] zbuf;
+      return obuf;
+    }
+    /** decompress a serial data */
+    char* decompress(const void* buf, size_t size, size_t* sp) {
+      _assert_(buf && size <= MEMMAXSIZ && sp);
+      if (size < 1) return NULL;
+      const char* rp = (const char*)buf + 1;
+      size_t rsiz = size - 1;
+      char* rbuf = NULL;
+      if (*(uint8_t*)buf == TAGREF) {
+        rbuf = read_data((const char*)buf, &rsiz);
+        if (!rbuf) return NULL;
+        rp = rbuf;
+      } else if (*(uint8_t*)buf != TAGEMBED) {
+        return NULL;
+      }
+      if (comp_) {
+        char* zbuf = comp_->decompress(rp, rsiz, sp);
+        delete[] rbuf;
+        return zbuf;
+      }
+      if (!rbuf) {
+        rbuf = new char[rsiz+1];
+        std::memcpy(rbuf, rp, rsiz);
+      }
+      rbuf[rsiz] = '\0';
+      *sp = rsiz;
+      return rbuf;
+    }
+   private:
+    /** write a reference */
+    void write_reference(char* obuf, int64_t off, const char* buf, size_t size) {
+      _assert_(obuf && off >= 0 && buf);
+      char* wp = obuf;
+      *(wp++) = TAGREF;
+      writefixnum(wp, off, sizeof(uint64_t));
+      wp += sizeof(uint64_t);
+      writefixnum(wp, size, sizeof(uint64_t));
+      wp += sizeof(uint64_t);
+      writefixnum(wp, hashcrc32c(buf, size), sizeof(uint32_t));
+    }
+    /** read the data of a reference */
+    char* read_data(const char* buf, size_t* sp) {
+      _assert_(buf && sp);
+      if (!reference(buf, REFSIZ) || !file_) return NULL;
+      const char* rp = buf + 1;
+      int64_t off = readfixnum(rp, sizeof(uint64_t));
+      rp += sizeof(uint64_t);
+      uint64_t rsiz = readfixnum(rp, sizeof(uint64_t));
+      rp += sizeof(uint64_t);
+      uint32_t crc = readfixnum(rp, sizeof(uint32_t));
+      if (off < BLHEADSIZ || rsiz > MEMMAXSIZ || off + (int64_t)rsiz > end_.get()) {
+        db_->report(_KCCODELINE_, Logger::WARN, "invalid reference: off=%lld size=%lld",
+                    (long long)off, (long long)rsiz);
+        return NULL;
+      }
+      char* rbuf = new char[rsiz+1];
+      if (!file_->read(off, rbuf, rsiz)) {
+        db_->report(_KCCODELINE_, Logger::WARN, "reading the blob file failed: %s",
+                    file_->error());
+        delete[] rbuf;
+        return NULL;
+      }
+      if (hashcrc32c(rbuf, rsiz) != crc) {
+        db_->report(_KCCODELINE_, Logger::WARN, "checksum mismatch of a separated value:"
+                    " off=%lld size=%lld", (long long)off, (long long)rsiz);
+        delete[] rbuf;
+        return NULL;
+      }
+      *sp = rsiz;
+      return rbuf;
+    }
+    HashDB* db_;                         ///< database
+    Compressor* comp_;                   ///< inner compressor
+    int64_t thres_;                      ///< threshold of the size
+    File* file_;                         ///< blob file
+    AtomicInt64 end_;                    ///< end offset of the blob file
+  };
+  /**
+   * Accept a read-only visitor to a record through the Bloom filter.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @param visitor a visitor object.
+   * @param bidx the bucket index.
+   * @param pivot the second hash value.
+   * @return true on success, or false on failure.
+   */
+  bool accept_filtered(const char* kbuf, size_t ksiz, Visitor* visitor,
+                       int64_t bidx, uint32_t pivot) {
+    _assert_(kbuf && ksiz <= MEMMAXSIZ && visitor && bidx >= 0);
+    bfcheck_ += 1;
+    if (!check_filter(bidx, pivot)) {
+      bfreject_ += 1;
+      size_t vsiz;
+      visitor->visit_empty(kbuf, ksiz, &vsiz);
+      return true;
+    }
+    class VisitorImpl : public Visitor {
+     public:
+      explicit VisitorImpl(Visitor* visitor) : visitor_(visitor), miss_(false) {}
+      bool miss() {
+        return miss_;
+      }
+     private:
+      const char* visit_full(const char* kbuf, size_t ksiz,
+                             const char* vbuf, size_t vsiz, size_t* sp) {
+        return visitor_->visit_full(kbuf, ksiz, vbuf, vsiz, sp);
+      }
+      const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+        miss_ = true;
+        return visitor_->visit_empty(kbuf, ksiz, sp);
+      }
+      Visitor* visitor_;
+      bool miss_;
+    } filtered(visitor);
+    if (!accept_impl(kbuf, ksiz, &filtered, bidx, pivot, false)) return false;
+    if (filtered.miss()) bffalse_ += 1;
+    return true;
+  }
+  /**
+   * Set the value of a record which is compressed in advance.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @param zbuf the pointer to the compressed value region.
+   * @param zsiz the size of the compressed value region.
+   * @return true on success, or false on failure.
+   * @note The caller must hold the method lock as a reader and check that the database is
+   * opened as a writer.
    */
-  class ScopedVisitor {
-   public:
-    /** constructor */
-    explicit ScopedVisitor(Visitor* visitor) : visitor_(visitor) {
-      _assert_(visitor);
-      visitor_->visit_before();
-    }
-    /** destructor */
-    ~ScopedVisitor() {
-      _assert_(true);
-      visitor_->visit_after();
-    }
-   private:
-    Visitor* visitor_;                   ///< visitor
-  };
+  bool set_packed(const char* kbuf, size_t ksiz, const char* zbuf, size_t zsiz) {
+    _assert_(kbuf && ksiz <= MEMMAXSIZ && zbuf && zsiz <= MEMMAXSIZ);
+    if (!(flags_ & FOPEN) && !autotran_ && !tran_ && !set_flag(FOPEN, true)) return false;
+    bool err = false;
+    uint64_t hash = hash_record(kbuf, ksiz);
+    uint32_t pivot = fold_hash(hash);
+    int64_t bidx = hash % bnum_;
+    size_t lidx = bidx % RLOCKSLOT;
+    rlock_.lock_writer(lidx);
+    BatchVisitor visitor(WriteBatch::KSET, zbuf, zsiz);
+    if (!accept_impl(kbuf, ksiz, &visitor, bidx, pivot, false, false, true)) err = true;
+    rlock_.unlock(lidx);
+    return !err;
+  }
   /**
    * Accept a visitor to a record.
    * @param kbuf the pointer to the key region.
@@ -1831,10 +3083,15 @@ class HashDB : public BasicDB {
    * @param bidx the bucket index.
    * @param pivot the second hash value.
    @ @param isiter true for iterator use, or false for direct use.
+   * @param batched true if the caller holds an auto transaction for a batch, or false if not.
+   * @param packed true if the value given by the visitor is already compressed, or false if
+   * not.
+   * @param head the head record of the chain read in advance, or NULL to read it here.
    * @return true on success, or false on failure.
    */
-  bool accept_impl(const char* kbuf, size_t ksiz, Visitor* visitor,
-                   int64_t bidx, uint32_t pivot, bool isiter) {
+  bool accept_impl(const char* kbuf, size_t ksiz, Visitor* visitor, int64_t bidx,
+                   uint32_t pivot, bool isiter, bool batched = false, bool packed = false,
+                   const char* head = NULL) {
     _assert_(kbuf && ksiz <= MEMMAXSIZ && visitor && bidx >= 0);
     int64_t top = get_bucket(bidx);
     int64_t off = top;
@@ -1845,7 +3102,12 @@ class HashDB : public BasicDB {
     char rbuf[RECBUFSIZ];
     while (off > 0) {
       rec.off = off;
-      if (!read_record(&rec, rbuf)) return false;
+      bool loaded = false;
+      if (head && off == top) {
+        std::memcpy(rbuf, head, RECBUFSIZ);
+        loaded = true;
+      }
+      if (!read_record(&rec, rbuf, loaded)) return false;
       if (rec.psiz == UINT16MAX) {
         set_error(_KCCODELINE_, Error::BROKEN, "free block in the chain");
         report(_KCCODELINE_, Logger::WARN, "psiz=%lld off=%lld fsiz=%lld",
@@ -1911,11 +3173,14 @@ class HashDB : public BasicDB {
             vbuf = zbuf;
             vsiz = zsiz;
           }
-          vbuf = visitor->visit_full(kbuf, ksiz, vbuf, vsiz, &vsiz);
+          const char* obuf = vbuf;
+          size_t osiz = vsiz;
+          vbuf = visitor->visit_full(kbuf, ksiz, obuf, osiz, &vsiz);
+          if (vbuf != Visitor::NOP && !snaps_.empty()) record_snapshots(kbuf, ksiz, obuf, osiz);
           delete[] zbuf;
           if (vbuf == Visitor::REMOVE) {
             bool atran = false;
-            if (autotran_ && !tran_) {
+            if (autotran_ && !tran_ && !batched) {
               if (!begin_auto_transaction()) {
                 delete[] rec.bbuf;
                 return false;
@@ -1937,7 +3202,7 @@ class HashDB : public BasicDB {
             count_ -= 1;
             if (atran) {
               if (!commit_auto_transaction()) return false;
-            } else if (autosync_) {
+            } else if (autosync_ && !batched) {
               if (!synchronize_meta()) return false;
             }
           } else if (vbuf == Visitor::NOP) {
@@ -1945,7 +3210,7 @@ class HashDB : public BasicDB {
           } else {
             zbuf = NULL;
             zsiz = 0;
-            if (comp_ && !isiter) {
+            if (comp_ && !isiter && !packed) {
               zbuf = comp_->compress(vbuf, vsiz, &zsiz);
               if (!zbuf) {
                 set_error(_KCCODELINE_, Error::SYSTEM, "data compression failed");
@@ -1956,7 +3221,7 @@ class HashDB : public BasicDB {
               vsiz = zsiz;
             }
             bool atran = false;
-            if (autotran_ && !tran_) {
+            if (autotran_ && !tran_ && !batched) {
               if (!begin_auto_transaction()) {
                 delete[] zbuf;
                 delete[] rec.bbuf;
@@ -2030,7 +3295,7 @@ class HashDB : public BasicDB {
             }
             if (atran) {
               if (!commit_auto_transaction()) return false;
-            } else if (autosync_) {
+            } else if (autosync_ && !batched) {
               if (!synchronize_meta()) return false;
             }
           }
@@ -2041,9 +3306,10 @@ class HashDB : public BasicDB {
     size_t vsiz;
     const char* vbuf = visitor->visit_empty(kbuf, ksiz, &vsiz);
     if (vbuf != Visitor::NOP && vbuf != Visitor::REMOVE) {
+      if (!snaps_.empty()) record_snapshots(kbuf, ksiz, NULL, 0);
       char* zbuf = NULL;
       size_t zsiz = 0;
-      if (comp_) {
+      if (comp_ && !packed) {
         zbuf = comp_->compress(vbuf, vsiz, &zsiz);
         if (!zbuf) {
           set_error(_KCCODELINE_, Error::SYSTEM, "data compression failed");
@@ -2053,7 +3319,7 @@ class HashDB : public BasicDB {
         vsiz = zsiz;
       }
       bool atran = false;
-      if (autotran_ && !tran_) {
+      if (autotran_ && !tran_ && !batched) {
         if (!begin_auto_transaction()) {
           delete[] zbuf;
           return false;
@@ -2123,10 +3389,11 @@ class HashDB : public BasicDB {
           return false;
         }
       }
+      if (bfbuf_) add_filter(bidx, pivot);
       count_ += 1;
       if (atran) {
         if (!commit_auto_transaction()) return false;
-      } else if (autosync_) {
+      } else if (autosync_ && !batched) {
         if (!synchronize_meta()) return false;
       }
     }
@@ -2150,7 +3417,9 @@ class HashDB : public BasicDB {
     Record rec;
     char rbuf[RECBUFSIZ];
     int64_t curcnt = 0;
+    int64_t raoff = 0;
     while (off > 0 && off < end) {
+      read_ahead(off, end, &raoff);
       rec.off = off;
       if (!read_record(&rec, rbuf)) return false;
       if (rec.psiz == UINT16MAX) {
@@ -2174,7 +3443,11 @@ class HashDB : public BasicDB {
           vbuf = zbuf;
           vsiz = zsiz;
         }
-        vbuf = visitor->visit_full(rec.kbuf, rec.ksiz, vbuf, vsiz, &vsiz);
+        const char* obuf = vbuf;
+        size_t osiz = vsiz;
+        vbuf = visitor->visit_full(rec.kbuf, rec.ksiz, obuf, osiz, &vsiz);
+        if (vbuf != Visitor::NOP && !snaps_.empty())
+          record_snapshots(rec.kbuf, rec.ksiz, obuf, osiz);
         delete[] zbuf;
         if (vbuf == Visitor::REMOVE) {
           uint64_t hash = hash_record(rec.kbuf, rec.ksiz);
@@ -2297,7 +3570,9 @@ class HashDB : public BasicDB {
           Compressor* comp = db->comp_;
           Record rec;
           char rbuf[RECBUFSIZ];
+          int64_t raoff = 0;
           while (off > 0 && off < end) {
+            db->read_ahead(off, end, &raoff);
             rec.off = off;
             if (!db->read_record(&rec, rbuf)) {
               error_ = db->error();
@@ -2399,6 +3674,7 @@ class HashDB : public BasicDB {
         set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
         return false;
       }
+      if (!synchronize_blobs(hard)) err = true;
       if (!file_.synchronize(hard)) {
         set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
         err = true;
@@ -2426,12 +3702,41 @@ class HashDB : public BasicDB {
     ScopedMutex lock(&flock_);
     bool err = false;
     if (!dump_meta()) err = true;
+    if (!synchronize_blobs(true)) err = true;
     if (!file_.synchronize(true)) {
       set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
       err = true;
     }
     return !err;
   }
+  /**
+   * Write back the meta data and updated contents by the background synchronizer.
+   * @note The file is written back out of the method lock because the synchronizer is stopped
+   * before the file is closed.
+   */
+  void synchronize_background() {
+    _assert_(true);
+    bool err = false;
+    mlock_.lock_reader();
+    if (omode_ == 0) {
+      mlock_.unlock();
+      return;
+    }
+    if (!tran_ && !autotran_) {
+      ScopedMutex lock(&flock_);
+      if (!dump_auto_meta()) err = true;
+    }
+    if (bfile_ && !bfile_->write_back()) {
+      set_error(_KCCODELINE_, Error::SYSTEM, bfile_->error());
+      err = true;
+    }
+    mlock_.unlock();
+    if (!file_.write_back()) {
+      set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
+      err = true;
+    }
+    if (err) report(_KCCODELINE_, Logger::WARN, "background synchronization failed");
+  }
   /**
    * Perform defragmentation.
    * @param step the number of steps.
@@ -2527,11 +3832,27 @@ class HashDB : public BasicDB {
     width_ = (opts_ & TSMALL) ? sizeof(uint32_t) : sizeof(uint32_t) + 2;
     linear_ = (opts_ & TLINEAR) ? true : false;
     comp_ = (opts_ & TCOMPRESS) ? embcomp_ : NULL;
+    if (opts_ & TBLOB) {
+      blob_.tune(comp_, blthres_);
+      comp_ = &blob_;
+    }
+    crcw_ = (opts_ & TCHECKSUM) ? sizeof(uint32_t) : 0;
     rhsiz_ = sizeof(uint16_t) + sizeof(uint8_t) * 2;
     rhsiz_ += linear_ ? width_ : width_ * 2;
+    rhsiz_ += crcw_;
     boff_ = HEADSIZ + FBPWIDTH * fbpnum_;
     if (fbpnum_ > 0) boff_ += width_ * 2 + sizeof(uint8_t) * 2;
-    roff_ = boff_ + width_ * bnum_;
+    bfoff_ = boff_ + width_ * bnum_;
+    bfnum_ = 0;
+    bfhnum_ = 0;
+    if (bfbits_ > 0) {
+      bfnum_ = (bnum_ * bfbits_ + BFBLKSIZ * 8 - 1) / (BFBLKSIZ * 8);
+      bfnum_ = (bfnum_ + RLOCKSLOT - 1) / RLOCKSLOT * RLOCKSLOT;
+      bfhnum_ = bfbits_ * 69 / 100;
+      if (bfhnum_ < 1) bfhnum_ = 1;
+      if (bfhnum_ > BFHNUMMAX) bfhnum_ = BFHNUMMAX;
+    }
+    roff_ = bfoff_ + bfnum_ * BFBLKSIZ;
     int64_t rem = roff_ % align_;
     if (rem > 0) roff_ += align_ - rem;
     dfcur_ = roff_;
@@ -2541,6 +3862,9 @@ class HashDB : public BasicDB {
   /**
    * Calculate the module checksum.
    * @return the module checksum.
+   * @note The checksum is calculated in the same way as older versions of the library and then
+   * some bits are flipped for each feature which they can not read.  Thus, they refuse such a
+   * file for the invalid module checksum instead of misreading it.
    */
   uint8_t calc_checksum() {
     _assert_(true);
@@ -2548,15 +3872,18 @@ class HashDB : public BasicDB {
     size_t ksiz = sizeof(KCHDBCHKSUMSEED) - 1;
     char* zbuf = NULL;
     size_t zsiz = 0;
-    if (comp_) {
-      zbuf = comp_->compress(kbuf, ksiz, &zsiz);
+    if (opts_ & TCOMPRESS) {
+      zbuf = embcomp_->compress(kbuf, ksiz, &zsiz);
       if (!zbuf) return 0;
       kbuf = zbuf;
       ksiz = zsiz;
     }
-    uint32_t hash = fold_hash(hash_record(kbuf, ksiz));
+    uint32_t hash = fold_hash(hashmurmur(kbuf, ksiz));
     delete[] zbuf;
-    return (hash >> 24) ^ (hash >> 16) ^ (hash >> 8) ^ (hash >> 0);
+    uint8_t chksum = (hash >> 24) ^ (hash >> 16) ^ (hash >> 8) ^ (hash >> 0);
+    chksum ^= opts_ & (TXXHASH | TCHECKSUM | TBLOB);
+    if (bfbits_ > 0) chksum ^= CHKSUMBLOOM;
+    return chksum;
   }
   /**
    * Dump the meta data into the file.
@@ -2575,6 +3902,7 @@ class HashDB : public BasicDB {
     std::memcpy(head + MOFFAPOW, &apow_, sizeof(apow_));
     std::memcpy(head + MOFFFPOW, &fpow_, sizeof(fpow_));
     std::memcpy(head + MOFFOPTS, &opts_, sizeof(opts_));
+    std::memcpy(head + MOFFBLOOM, &bfbits_, sizeof(bfbits_));
     uint64_t num = hton64(bnum_);
     std::memcpy(head + MOFFBNUM, &num, sizeof(num));
     if (!flagopen_) flags_ &= ~FOPEN;
@@ -2654,6 +3982,7 @@ class HashDB : public BasicDB {
     std::memcpy(&apow_, head + MOFFAPOW, sizeof(apow_));
     std::memcpy(&fpow_, head + MOFFFPOW, sizeof(fpow_));
     std::memcpy(&opts_, head + MOFFOPTS, sizeof(opts_));
+    std::memcpy(&bfbits_, head + MOFFBLOOM, sizeof(bfbits_));
     uint64_t num;
     std::memcpy(&num, head + MOFFBNUM, sizeof(num));
     bnum_ = ntoh64(num);
@@ -2696,6 +4025,315 @@ class HashDB : public BasicDB {
     flags_ = flags;
     return true;
   }
+  /**
+   * Add a key to the Bloom filter.
+   * @param bidx the bucket index of the key.
+   * @param pivot the second hash value of the key.
+   * @note The blocks are as many as a multiple of the slots of the record lock so that the
+   * block of a bucket is guarded by the record lock of the bucket.
+   */
+  void add_filter(int64_t bidx, uint32_t pivot) {
+    _assert_(bidx >= 0);
+    uint8_t* blk = (uint8_t*)bfbuf_ + bidx % bfnum_ * BFBLKSIZ;
+    uint32_t step = ((pivot >> 17) | (pivot << 15)) | 1;
+    for (int32_t i = 0; i < bfhnum_; i++) {
+      uint32_t pos = pivot % (BFBLKSIZ * 8);
+      blk[pos>>3] |= 1 << (pos & 7);
+      pivot += step;
+    }
+  }
+  /**
+   * Check whether a key may be in the Bloom filter.
+   * @param bidx the bucket index of the key.
+   * @param pivot the second hash value of the key.
+   * @return true if the key may be stored, or false if it is not stored surely.
+   */
+  bool check_filter(int64_t bidx, uint32_t pivot) {
+    _assert_(bidx >= 0);
+    const uint8_t* blk = (const uint8_t*)bfbuf_ + bidx % bfnum_ * BFBLKSIZ;
+    uint32_t step = ((pivot >> 17) | (pivot << 15)) | 1;
+    for (int32_t i = 0; i < bfhnum_; i++) {
+      uint32_t pos = pivot % (BFBLKSIZ * 8);
+      if (!(blk[pos>>3] & (1 << (pos & 7)))) return false;
+      pivot += step;
+    }
+    return true;
+  }
+  /**
+   * Load the Bloom filter from the file.
+   * @return true on success, or false on failure.
+   * @note If the filter was not saved when the database was closed, it is rebuilt by scanning
+   * the records.  If the scan fails, every key is regarded as a candidate.
+   */
+  bool load_filter() {
+    _assert_(true);
+    int64_t size = bfnum_ * BFBLKSIZ;
+    bfbuf_ = new char[size];
+    if (flags_ & FFILTER) {
+      if (!file_.read(bfoff_, bfbuf_, size)) {
+        set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
+        report(_KCCODELINE_, Logger::WARN, "psiz=%lld off=%lld fsiz=%lld",
+               (long long)psiz_, (long long)bfoff_, (long long)file_.size());
+        delete[] bfbuf_;
+        bfbuf_ = NULL;
+        return false;
+      }
+      return true;
+    }
+    report(_KCCODELINE_, Logger::INFO, "rebuilding the Bloom filter");
+    std::memset(bfbuf_, 0, size);
+    int64_t off = roff_;
+    int64_t end = lsiz_;
+    Record rec;
+    char rbuf[RECBUFSIZ];
+    while (off > 0 && off < end) {
+      rec.off = off;
+      if (!read_record(&rec, rbuf)) {
+        report(_KCCODELINE_, Logger::WARN, "the Bloom filter is disabled");
+        std::memset(bfbuf_, 0xff, size);
+        break;
+      }
+      if (rec.psiz != UINT16MAX) {
+        uint64_t hash = hash_record(rec.kbuf, rec.ksiz);
+        add_filter(hash % bnum_, fold_hash(hash));
+      }
+      delete[] rec.bbuf;
+      off += rec.rsiz;
+    }
+    return true;
+  }
+  /**
+   * Save the Bloom filter into the file.
+   * @return true on success, or false on failure.
+   */
+  bool dump_filter() {
+    _assert_(true);
+    if (!file_.write(bfoff_, bfbuf_, bfnum_ * BFBLKSIZ)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
+      return false;
+    }
+    flags_ |= FFILTER;
+    return true;
+  }
+  /**
+   * Get the path of a blob file.
+   * @param path the path of the database file.
+   * @param alt true for the alternative blob file, or false for the primary one.
+   * @return the path of the blob file.
+   */
+  static std::string blob_path(const std::string& path, bool alt) {
+    _assert_(true);
+    return path + File::EXTCHR + (alt ? KCHDBBLOBALTEXT : KCHDBBLOBPATHEXT);
+  }
+  /**
+   * Open the blob file.
+   * @param path the path of the database file.
+   * @param trunc true to truncate the blob file, or false to keep its contents.
+   * @return true on success, or false on failure.
+   * @note A writer removes the blob file of the other generation left by an interrupted
+   * compaction.
+   */
+  bool open_blobs(const std::string& path, bool trunc) {
+    _assert_(!bfile_);
+    if (!(opts_ & TBLOB)) return true;
+    bool alt = flags_ & FBLOBALT;
+    const std::string& bpath = blob_path(path, alt);
+    uint32_t fmode = File::ONOLOCK;
+    fmode |= writer_ ? File::OWRITER | File::OCREATE : File::OREADER;
+    if (trunc) fmode |= File::OTRUNCATE;
+    File* file = new File;
+    if (!file->open(bpath, fmode, 0)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, file->error());
+      delete file;
+      return false;
+    }
+    char head[BLHEADSIZ];
+    if (file->size() < 1 && writer_) {
+      std::memcpy(head, KCHDBBLOBMAGICDATA, sizeof(head));
+      if (!file->write(0, head, sizeof(head))) {
+        set_error(_KCCODELINE_, Error::SYSTEM, file->error());
+        file->close();
+        delete file;
+        return false;
+      }
+    } else if (!file->read(0, head, sizeof(head)) ||
+               std::memcmp(head, KCHDBBLOBMAGICDATA, sizeof(head))) {
+      set_error(_KCCODELINE_, Error::BROKEN, "invalid magic data of the blob file");
+      report(_KCCODELINE_, Logger::WARN, "path=%s fsiz=%lld",
+             bpath.c_str(), (long long)file->size());
+      file->close();
+      delete file;
+      return false;
+    }
+    const std::string& opath = blob_path(path, !alt);
+    if (writer_ && File::status(opath)) File::remove(opath);
+    bfile_ = file;
+    blob_.attach(bfile_);
+    return true;
+  }
+  /**
+   * Close the blob file.
+   * @return true on success, or false on failure.
+   */
+  bool close_blobs() {
+    _assert_(true);
+    if (!bfile_) return true;
+    bool err = false;
+    if (!bfile_->close()) {
+      set_error(_KCCODELINE_, Error::SYSTEM, bfile_->error());
+      err = true;
+    }
+    delete bfile_;
+    bfile_ = NULL;
+    blob_.attach(NULL);
+    return !err;
+  }
+  /**
+   * Synchronize the blob file with the file system or the device.
+   * @param hard true for physical synchronization with the device, or false for logical
+   * synchronization with the file system.
+   * @return true on success, or false on failure.
+   * @note The blob file is synchronized before the database file so that no durable record
+   * refers to lost data.
+   */
+  bool synchronize_blobs(bool hard) {
+    _assert_(true);
+    if (!bfile_) return true;
+    if (!bfile_->synchronize(hard)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, bfile_->error());
+      return false;
+    }
+    return true;
+  }
+  /**
+   * Scan the references to the blob file.
+   * @param dest the destination file into which the data of every reference is copied.  If it
+   * is NULL, no data is copied.
+   * @param endp the pointer to the variable of the end offset of the destination file.
+   * @param livep the pointer to the variable into which the total size of the data alive is
+   * added.
+   * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @return true on success, or false on failure.
+   * @note References are rewritten in place because they are of the fixed size.
+   */
+  bool scan_blobs(File* dest, int64_t* endp, int64_t* livep, ProgressChecker* checker) {
+    _assert_(livep);
+    int64_t allcnt = count_;
+    if (checker && !checker->check("compact_blobs", "beginning", 0, allcnt)) {
+      set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+      return false;
+    }
+    int64_t off = roff_;
+    int64_t end = lsiz_;
+    int64_t curcnt = 0;
+    Record rec;
+    char rbuf[RECBUFSIZ];
+    while (off > 0 && off < end) {
+      rec.off = off;
+      if (!read_record(&rec, rbuf)) return false;
+      if (rec.psiz == UINT16MAX) {
+        off += rec.rsiz;
+        continue;
+      }
+      if (!rec.vbuf && !read_record_body(&rec)) {
+        delete[] rec.bbuf;
+        return false;
+      }
+      if (BlobLog::reference(rec.vbuf, rec.vsiz)) {
+        *livep += BlobLog::data_size(rec.vbuf);
+        if (dest) {
+          char nbuf[BlobLog::REFSIZ];
+          if (!blob_.relocate(rec.vbuf, dest, endp, nbuf)) {
+            delete[] rec.bbuf;
+            return false;
+          }
+          rec.vbuf = nbuf;
+          if (!write_record(&rec, true)) {
+            delete[] rec.bbuf;
+            return false;
+          }
+        }
+      }
+      delete[] rec.bbuf;
+      off += rec.rsiz;
+      curcnt++;
+      if (checker && !checker->check("compact_blobs", "processing", curcnt, allcnt)) {
+        set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+        return false;
+      }
+    }
+    if (checker && !checker->check("compact_blobs", "ending", -1, allcnt)) {
+      set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
+      return false;
+    }
+    return true;
+  }
+  /**
+   * Reclaim the space of dead values in the blob file.
+   * @param checker a progress checker object.
+   * @return true on success, or false on failure.
+   * @note The flag of the alternative blob file is switched in the same transaction as the
+   * references, so the database refers to either generation consistently after a crash.
+   */
+  bool compact_blobs_impl(ProgressChecker* checker) {
+    _assert_(true);
+    bool alt = flags_ & FBLOBALT;
+    const std::string& npath = blob_path(path_, !alt);
+    File* nfile = new File;
+    if (!nfile->open(npath, File::OWRITER | File::OCREATE | File::OTRUNCATE | File::ONOLOCK,
+                     0)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, nfile->error());
+      delete nfile;
+      return false;
+    }
+    int64_t nend = BLHEADSIZ;
+    if (!nfile->write(0, KCHDBBLOBMAGICDATA, nend)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, nfile->error());
+      nfile->close();
+      delete nfile;
+      File::remove(npath);
+      return false;
+    }
+    trhard_ = true;
+    if (!begin_transaction_impl()) {
+      nfile->close();
+      delete nfile;
+      File::remove(npath);
+      return false;
+    }
+    tran_ = true;
+    bool err = false;
+    int64_t live = 0;
+    if (!scan_blobs(nfile, &nend, &live, checker)) err = true;
+    if (!err && !nfile->synchronize(true)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, nfile->error());
+      err = true;
+    }
+    if (!err && !set_flag(FBLOBALT, !alt)) err = true;
+    if (err) {
+      abort_transaction();
+      tran_ = false;
+      nfile->close();
+      delete nfile;
+      File::remove(npath);
+      return false;
+    }
+    int64_t ticket = 0;
+    if (!commit_transaction(&ticket)) err = true;
+    tran_ = false;
+    if (ticket > 0 && !file_.wait_transaction(ticket, gcdelay_)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
+      err = true;
+    }
+    int64_t osiz = bfile_->size();
+    if (!close_blobs()) err = true;
+    File::remove(blob_path(path_, alt));
+    bfile_ = nfile;
+    blob_.attach(bfile_);
+    report(_KCCODELINE_, Logger::INFO, "compacted the blob file: size=%lld live=%lld",
+           (long long)osiz, (long long)live);
+    return !err;
+  }
   /**
    * Reorganize the whole file.
    * @param path the path of the database file.
@@ -2710,16 +4348,24 @@ class HashDB : public BasicDB {
     db.tune_fbp(fpow_);
     db.tune_options(opts_);
     db.tune_buckets(bnum_);
+    db.tune_bloom(bfbits_);
     db.tune_map(msiz_);
+    db.tune_map_options(mopts_);
+    db.tune_readahead(rasiz_);
+    db.tune_blob(blthres_);
     if (embcomp_) db.tune_compressor(embcomp_);
     const std::string& npath = path + File::EXTCHR + KCHDBTMPPATHEXT;
+    bool alt = flags_ & FBLOBALT;
     if (db.open(npath, OWRITER | OCREATE | OTRUNCATE)) {
       report(_KCCODELINE_, Logger::WARN, "reorganizing the database");
       lsiz_ = file_.size();
       psiz_ = lsiz_;
-      if (copy_records(&db)) {
+      if (copy_records(&db) && (!db.bfile_ || db.set_flag(FBLOBALT, !alt))) {
         if (db.close()) {
-          if (!File::rename(npath, path)) {
+          if ((opts_ & TBLOB) && !File::rename(blob_path(npath, false), blob_path(path, !alt))) {
+            set_error(_KCCODELINE_, Error::SYSTEM, "renaming the blob file failed");
+            err = true;
+          } else if (!File::rename(npath, path)) {
             set_error(_KCCODELINE_, Error::SYSTEM, "renaming the destination failed");
             err = true;
           }
@@ -2732,6 +4378,7 @@ class HashDB : public BasicDB {
         err = true;
       }
       File::remove(npath);
+      if (opts_ & TBLOB) File::remove(blob_path(npath, false));
     } else {
       set_error(_KCCODELINE_, db.error().code(), "opening the destination failed");
       err = true;
@@ -2879,7 +4526,7 @@ class HashDB : public BasicDB {
    */
   uint64_t hash_record(const char* kbuf, size_t ksiz) {
     _assert_(kbuf && ksiz <= MEMMAXSIZ);
-    return hashmurmur(kbuf, ksiz);
+    return (opts_ & TXXHASH) ? hashxx(kbuf, ksiz) : hashmurmur(kbuf, ksiz);
   }
   /**
    * Fold a hash value into a small number.
@@ -2937,6 +4584,82 @@ class HashDB : public BasicDB {
     }
     return readfixnum(buf, width_) << apow_;
   }
+  /**
+   * Advise sequential access to the record section for a scan.
+   * @note Only the first of concurrent scans gives the advice.
+   */
+  void begin_scan() {
+    _assert_(true);
+    if (scancnt_.add(1) == 0) file_.advise(roff_, psiz_ - roff_, File::ASEQUENTIAL);
+  }
+  /**
+   * Restore random access to the record section after a scan.
+   * @note Only the last of concurrent scans restores the advice, so that the read-ahead of the
+   * other scans is kept.
+   */
+  void end_scan() {
+    _assert_(true);
+    if (scancnt_.add(-1) == 1) file_.advise(roff_, psiz_ - roff_, File::ARANDOM);
+  }
+  /**
+   * Ask the kernel to read the region ahead of a sequential scan.
+   * @param off the current offset.
+   * @param end the end offset of the scan.
+   * @param raoff the pointer to the variable of the offset of the next window.  It should be
+   * initialized with 0.
+   */
+  void read_ahead(int64_t off, int64_t end, int64_t* raoff) {
+    _assert_(off >= 0 && end >= 0 && raoff);
+    if (rasiz_ < 1) return;
+    if (*raoff > off + rasiz_) *raoff = 0;
+    if (off + rasiz_ / 2 < *raoff) return;
+    int64_t beg = off > *raoff ? off : *raoff;
+    int64_t size = end - beg;
+    if (size > rasiz_) size = rasiz_;
+    if (size > 0) file_.advise(beg, size, File::AWILLNEED);
+    *raoff = beg + rasiz_;
+  }
+  /**
+   * Read the heads of multiple chains at once.
+   * @param bidxs the indices of the buckets.
+   * @param heads a vector which the head record of each chain is assigned to.  An element is
+   * NULL if the head was not read.
+   * @return the buffer of the head records, which should be released with the delete[]
+   * operator.
+   * @note The device serves the scattered reads in parallel and the heads are given to the
+   * following chain walks.  Only the first appearance of each bucket gets its head, because an
+   * earlier operation on the same bucket may modify the chain.
+   */
+  char* prefetch_chains(const std::vector<int64_t>& bidxs, std::vector<const char*>* heads) {
+    _assert_(heads);
+    size_t num = bidxs.size();
+    heads->assign(num, NULL);
+    File::ReadRequest* reqs = new File::ReadRequest[num];
+    size_t* ridxs = new size_t[num];
+    char* rbufs = new char[num*RECBUFSIZ];
+    std::set<int64_t> done;
+    size_t rnum = 0;
+    for (size_t i = 0; i < num; i++) {
+      if (!done.insert(bidxs[i]).second) continue;
+      int64_t off = get_bucket(bidxs[i]);
+      if (off < roff_ || off + (int64_t)RECBUFSIZ > psiz_) continue;
+      File::ReadRequest* req = reqs + rnum;
+      req->off = off;
+      req->buf = rbufs + rnum * RECBUFSIZ;
+      req->size = RECBUFSIZ;
+      ridxs[rnum] = i;
+      rnum++;
+    }
+    if (rnum > 1) {
+      file_.read_batch(reqs, rnum);
+      for (size_t i = 0; i < rnum; i++) {
+        if (reqs[i].ok) (*heads)[ridxs[i]] = (char*)reqs[i].buf;
+      }
+    }
+    delete[] ridxs;
+    delete[] reqs;
+    return rbufs;
+  }
   /**
    * Set an address into a chain slot.
    * @param entoff the address of the chain slot.
@@ -2957,9 +4680,10 @@ class HashDB : public BasicDB {
    * Read a record from the file.
    * @param rec the record structure.
    * @param rbuf the working buffer.
+   * @param loaded true if the working buffer already holds the head of the record.
    * @return true on success, or false on failure.
    */
-  bool read_record(Record* rec, char* rbuf) {
+  bool read_record(Record* rec, char* rbuf, bool loaded = false) {
     _assert_(rec && rbuf);
     if (rec->off < roff_) {
       set_error(_KCCODELINE_, Error::BROKEN, "invalid record offset");
@@ -2979,7 +4703,7 @@ class HashDB : public BasicDB {
       }
       rsiz = rhsiz_;
     }
-    if (!file_.read_fast(rec->off, rbuf, rsiz)) {
+    if (!loaded && !file_.read_fast(rec->off, rbuf, rsiz)) {
       set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
       report(_KCCODELINE_, Logger::WARN, "psiz=%lld off=%lld rsiz=%lld fsiz=%lld",
              (long long)psiz_, (long long)rec->off, (long long)rsiz, (long long)file_.size());
@@ -3071,6 +4795,20 @@ class HashDB : public BasicDB {
     rec->vsiz = num;
     rp += step;
     rsiz -= step;
+    rec->crc = 0;
+    if (crcw_ > 0) {
+      if (rsiz < crcw_) {
+        set_error(_KCCODELINE_, Error::BROKEN, "invalid checksum of a record");
+        report(_KCCODELINE_, Logger::WARN, "psiz=%lld off=%lld rsiz=%lld fsiz=%lld snum=%04X",
+               (long long)psiz_, (long long)rec->off, (long long)rsiz,
+               (long long)file_.size(), snum);
+        report_binary(_KCCODELINE_, Logger::WARN, "rbuf", rbuf, rsiz);
+        return false;
+      }
+      rec->crc = readfixnum(rp, crcw_);
+      rp += crcw_;
+      rsiz -= crcw_;
+    }
     size_t hsiz = rp - rbuf;
     rec->rsiz = hsiz + rec->ksiz + rec->vsiz + rec->psiz;
     rec->kbuf = NULL;
@@ -3095,6 +4833,7 @@ class HashDB : public BasicDB {
             return false;
           }
         }
+        if (verify_ && crcw_ > 0 && !verify_record(rec)) return false;
       }
     } else {
       if (rec->off + (int64_t)rec->rsiz > psiz_) {
@@ -3131,9 +4870,33 @@ class HashDB : public BasicDB {
       delete[] bbuf;
       return false;
     }
+    rec->kbuf = bbuf;
+    rec->vbuf = bbuf + rec->ksiz;
+    if (verify_ && crcw_ > 0 && !verify_record(rec)) {
+      rec->kbuf = NULL;
+      rec->vbuf = NULL;
+      delete[] bbuf;
+      return false;
+    }
     rec->bbuf = bbuf;
-    rec->kbuf = rec->bbuf;
-    rec->vbuf = rec->bbuf + rec->ksiz;
+    return true;
+  }
+  /**
+   * Verify the checksum of a record.
+   * @param rec the record structure.
+   * @return true on success, or false on failure.
+   */
+  bool verify_record(Record* rec) {
+    _assert_(rec && rec->kbuf && rec->vbuf);
+    uint32_t crc = hashcrc32c(rec->kbuf, rec->ksiz);
+    crc = hashcrc32c(rec->vbuf, rec->vsiz, crc);
+    if (crc != rec->crc) {
+      set_error(_KCCODELINE_, Error::BROKEN, "checksum mismatch of a record");
+      report(_KCCODELINE_, Logger::WARN, "psiz=%lld off=%lld ksiz=%lld vsiz=%lld"
+             " crc=%08X real=%08X", (long long)psiz_, (long long)rec->off,
+             (long long)rec->ksiz, (long long)rec->vsiz, (unsigned)rec->crc, (unsigned)crc);
+      return false;
+    }
     return true;
   }
   /**
@@ -3159,6 +4922,12 @@ class HashDB : public BasicDB {
     }
     wp += writevarnum(wp, rec->ksiz);
     wp += writevarnum(wp, rec->vsiz);
+    if (crcw_ > 0) {
+      uint32_t crc = hashcrc32c(rec->kbuf, rec->ksiz);
+      crc = hashcrc32c(rec->vbuf, rec->vsiz, crc);
+      writefixnum(wp, crc, crcw_);
+      wp += crcw_;
+    }
     std::memcpy(wp, rec->kbuf, rec->ksiz);
     wp += rec->ksiz;
     std::memcpy(wp, rec->vbuf, rec->vsiz);
@@ -3210,7 +4979,7 @@ class HashDB : public BasicDB {
    */
   size_t calc_record_size(size_t ksiz, size_t vsiz) {
     _assert_(true);
-    size_t rsiz = sizeof(uint16_t) + width_;
+    size_t rsiz = sizeof(uint16_t) + width_ + crcw_;
     if (!linear_) rsiz += width_;
     if (ksiz < (1ULL << 7)) {
       rsiz += 1;
@@ -3511,6 +5280,39 @@ class HashDB : public BasicDB {
     delete[] rbuf;
     return true;
   }
+  /**
+   * Keep the old image of a record in every snapshot.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @param vbuf the pointer to the value region, or NULL if the record does not exist.
+   * @param vsiz the size of the value region.
+   */
+  void record_snapshots(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    _assert_(kbuf && ksiz <= MEMMAXSIZ && vsiz <= MEMMAXSIZ);
+    std::string okey;
+    SnapshotList::const_iterator sit = snaps_.begin();
+    SnapshotList::const_iterator sitend = snaps_.end();
+    while (sit != sitend) {
+      Snapshot* snap = *sit;
+      if (okey.empty()) snap->old_key(kbuf, ksiz, &okey);
+      snap->record(okey.data(), okey.size(), vbuf, vsiz);
+      ++sit;
+    }
+  }
+  /**
+   * Invalidate all snapshots.
+   */
+  void disable_snapshots() {
+    _assert_(true);
+    if (snaps_.empty()) return;
+    SnapshotList::const_iterator sit = snaps_.begin();
+    SnapshotList::const_iterator sitend = snaps_.end();
+    while (sit != sitend) {
+      Snapshot* snap = *sit;
+      snap->invalidate();
+      ++sit;
+    }
+  }
   /**
    * Disable all cursors.
    */
@@ -3679,13 +5481,22 @@ class HashDB : public BasicDB {
   }
   /**
    * Commit transaction.
+   * @param ticketp the pointer to the variable into which the ticket of the group commit is
+   * assigned.  It is not modified unless the transaction is committed in a group.
    * @return true on success, or false on failure.
    */
-  bool commit_transaction() {
-    _assert_(true);
+  bool commit_transaction(int64_t* ticketp) {
+    _assert_(ticketp);
     bool err = false;
+    if (trhard_ && !synchronize_blobs(true)) err = true;
     if ((count_ != trcount_ || lsiz_ != trsize_) && !dump_auto_meta()) err = true;
-    if (!file_.end_transaction(true)) {
+    if (trhard_ && gcdelay_ > 0 && rlsiz_ < 1) {
+      *ticketp = file_.end_transaction_group();
+    } else if (!file_.end_transaction(true)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
+      err = true;
+    }
+    if (rlsiz_ > 0 && !file_.checkpoint(rlsiz_)) {
       set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
       err = true;
     }
@@ -3699,11 +5510,16 @@ class HashDB : public BasicDB {
   bool commit_auto_transaction() {
     _assert_(true);
     bool err = false;
+    if (autosync_ && !synchronize_blobs(true)) err = true;
     if ((count_ != trcount_ || lsiz_ != trsize_) && !dump_auto_meta()) err = true;
     if (!file_.end_transaction(true)) {
       set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
       err = true;
     }
+    if (rlsiz_ > 0 && !file_.checkpoint(rlsiz_)) {
+      set_error(_KCCODELINE_, Error::SYSTEM, file_.error());
+      err = true;
+    }
     atlock_.unlock();
     return !err;
   }
@@ -3750,7 +5566,7 @@ class HashDB : public BasicDB {
   /** Dummy Operator to forbid the use. */
   HashDB& operator =(const HashDB&);
   /** The method lock. */
-  RWLock mlock_;
+  DistributedRWLock mlock_;
   /** The record locks. */
   SlottedRWLock rlock_;
   /** The file lock. */
@@ -3783,6 +5599,8 @@ class HashDB : public BasicDB {
   FBP fbp_;
   /** The cursor objects. */
   CursorList curs_;
+  /** The snapshot objects. */
+  SnapshotList snaps_;
   /** The path of the database file. */
   std::string path_;
   /** The library version. */
@@ -3803,6 +5621,8 @@ class HashDB : public BasicDB {
   uint8_t opts_;
   /** The bucket number. */
   int64_t bnum_;
+  /** The number of bits of the Bloom filter per bucket. */
+  uint8_t bfbits_;
   /** The status flags. */
   uint8_t flags_;
   /** The flag for open. */
@@ -3817,8 +5637,28 @@ class HashDB : public BasicDB {
   char opaque_[HEADSIZ-MOFFOPAQUE];
   /** The size of the internal memory-mapped region. */
   int64_t msiz_;
+  /** The options of the memory-mapped region. */
+  uint8_t mopts_;
   /** The unit step number of auto defragmentation. */
   int64_t dfunit_;
+  /** The size of the read-ahead window. */
+  int64_t rasiz_;
+  /** The maximum delay of group commit. */
+  int64_t gcdelay_;
+  /** The size of the redo log to trigger a checkpoint. */
+  int64_t rlsiz_;
+  /** The interval of background synchronization. */
+  int64_t bsint_;
+  /** The size of updated contents to trigger background synchronization. */
+  int64_t bslimit_;
+  /** The background synchronizer. */
+  Synchronizer* bsth_;
+  /** The flag for verification of checksums. */
+  bool verify_;
+  /** The number of threads to compress records in bulk loading. */
+  int32_t zthnum_;
+  /** The threshold of the size of separated values. */
+  int64_t blthres_;
   /** The embedded data compressor. */
   Compressor* embcomp_;
   /** The alignment of records. */
@@ -3829,18 +5669,40 @@ class HashDB : public BasicDB {
   int32_t width_;
   /** The flag for linear collision chaining. */
   bool linear_;
+  /** The width of the checksum of a record. */
+  size_t crcw_;
   /** The data compressor. */
   Compressor* comp_;
+  /** The blob file. */
+  File* bfile_;
+  /** The log of separated values. */
+  BlobLog blob_;
   /** The header size of a record. */
   size_t rhsiz_;
   /** The offset of the buckets section. */
   int64_t boff_;
+  /** The offset of the Bloom filter section. */
+  int64_t bfoff_;
+  /** The number of blocks of the Bloom filter. */
+  int64_t bfnum_;
+  /** The number of hash functions of the Bloom filter. */
+  int32_t bfhnum_;
   /** The offset of the record section. */
   int64_t roff_;
   /** The defrag cursor. */
   int64_t dfcur_;
   /** The count of fragmentation. */
   AtomicInt64 frgcnt_;
+  /** The number of running scans. */
+  AtomicInt64 scancnt_;
+  /** The Bloom filter. */
+  char* bfbuf_;
+  /** The number of lookups checked by the Bloom filter. */
+  AtomicInt64 bfcheck_;
+  /** The number of lookups rejected by the Bloom filter. */
+  AtomicInt64 bfreject_;
+  /** The number of false positives of the Bloom filter. */
+  AtomicInt64 bffalse_;
   /** The flag whether in transaction. */
   bool tran_;
   /** The flag whether hard transaction. */
@@ -56,14 +56,14 @@ static int32_t procimport(const char* path, const char* file, int32_t oflags, bo
 static int32_t proccopy(const char* path, const char* file, int32_t oflags);
 static int32_t procdump(const char* path, const char* file, int32_t oflags);
 static int32_t procload(const char* path, const char* file, int32_t oflags);
-static int32_t procdefrag(const char* path, int32_t oflags);
+static int32_t procdefrag(const char* path, int32_t oflags, bool blob);
 static int32_t procsetbulk(const char* path, int32_t oflags,
                            const std::map<std::string, std::string>& recs);
 static int32_t procremovebulk(const char* path, int32_t oflags,
                               const std::vector<std::string>& keys);
 static int32_t procgetbulk(const char* path, int32_t oflags,
                            const std::vector<std::string>& keys, bool px);
-static int32_t proccheck(const char* path, int32_t oflags);
+static int32_t proccheck(const char* path, int32_t oflags, int32_t thnum);
 
 
 // main routine
@@ -119,8 +119,8 @@ static void usage() {
           g_progname);
   eprintf("\n");
   eprintf("usage:\n");
-  eprintf("  %s create [-otr] [-onl|-otl|-onr] [-apow num] [-fpow num] [-ts] [-tl] [-tc]"
-          " [-bnum num] path\n", g_progname);
+  eprintf("  %s create [-otr] [-onl|-otl|-onr] [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx]"
+          " [-tk] [-tb] [-bnum num] path\n", g_progname);
   eprintf("  %s inform [-onl|-otl|-onr] [-st] path\n", g_progname);
   eprintf("  %s set [-onl|-otl|-onr] [-add|-rep|-app|-inci|-incd] [-sx] path key value\n",
           g_progname);
@@ -133,11 +133,11 @@ static void usage() {
   eprintf("  %s copy [-onl|-otl|-onr] path file\n", g_progname);
   eprintf("  %s dump [-onl|-otl|-onr] path [file]\n", g_progname);
   eprintf("  %s load [-otr] [-onl|-otl|-onr] path [file]\n", g_progname);
-  eprintf("  %s defrag [-onl|-otl|-onr] path\n", g_progname);
+  eprintf("  %s defrag [-onl|-otl|-onr] [-blob] path\n", g_progname);
   eprintf("  %s setbulk [-onl|-otl|-onr] [-sx] path key value ...\n", g_progname);
   eprintf("  %s removebulk [-onl|-otl|-onr] [-sx] path key ...\n", g_progname);
   eprintf("  %s getbulk [-onl|-otl|-onr] [-sx] [-px] path key ...\n", g_progname);
-  eprintf("  %s check [-onl|-otl|-onr] path\n", g_progname);
+  eprintf("  %s check [-onl|-otl|-onr] [-th num] path\n", g_progname);
   eprintf("\n");
   std::exit(1);
 }
@@ -184,6 +184,12 @@ static int32_t runcreate(int argc, char** argv) {
         opts |= kc::HashDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::HashDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::HashDB::TXXHASH;
+      } else if (!std::strcmp(argv[i], "-tk")) {
+        opts |= kc::HashDB::TCHECKSUM;
+      } else if (!std::strcmp(argv[i], "-tb")) {
+        opts |= kc::HashDB::TBLOB;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -649,6 +655,7 @@ static int32_t rundefrag(int argc, char** argv) {
   bool argbrk = false;
   const char* path = NULL;
   int32_t oflags = 0;
+  bool blob = false;
   for (int32_t i = 2; i < argc; i++) {
     if (!argbrk && argv[i][0] == '-') {
       if (!std::strcmp(argv[i], "--")) {
@@ -659,6 +666,8 @@ static int32_t rundefrag(int argc, char** argv) {
         oflags |= kc::HashDB::OTRYLOCK;
       } else if (!std::strcmp(argv[i], "-onr")) {
         oflags |= kc::HashDB::ONOREPAIR;
+      } else if (!std::strcmp(argv[i], "-blob")) {
+        blob = true;
       } else {
         usage();
       }
@@ -670,7 +679,7 @@ static int32_t rundefrag(int argc, char** argv) {
     }
   }
   if (!path) usage();
-  int32_t rv = procdefrag(path, oflags);
+  int32_t rv = procdefrag(path, oflags, blob);
   return rv;
 }
 
@@ -834,6 +843,7 @@ static int32_t runcheck(int argc, char** argv) {
   bool argbrk = false;
   const char* path = NULL;
   int32_t oflags = 0;
+  int32_t thnum = 0;
   for (int32_t i = 2; i < argc; i++) {
     if (!argbrk && argv[i][0] == '-') {
       if (!std::strcmp(argv[i], "--")) {
@@ -844,6 +854,9 @@ static int32_t runcheck(int argc, char** argv) {
         oflags |= kc::HashDB::OTRYLOCK;
       } else if (!std::strcmp(argv[i], "-onr")) {
         oflags |= kc::HashDB::ONOREPAIR;
+      } else if (!std::strcmp(argv[i], "-th")) {
+        if (++i >= argc) usage();
+        thnum = kc::atoix(argv[i]);
       } else {
         usage();
       }
@@ -855,7 +868,7 @@ static int32_t runcheck(int argc, char** argv) {
     }
   }
   if (!path) usage();
-  int32_t rv = proccheck(path, oflags);
+  int32_t rv = proccheck(path, oflags, thnum);
   return rv;
 }
 
@@ -896,6 +909,7 @@ static int32_t procinform(const char* path, int32_t oflags, bool st) {
     status["opaque"] = "";
     status["fbpnum_used"] = "";
     status["bnum_used"] = "";
+    status["blob_live"] = "";
     if (db.status(&status)) {
       uint32_t type = kc::atoi(status["type"].c_str());
       oprintf("type: %s (%s) (type=0x%02X)\n",
@@ -930,6 +944,9 @@ static int32_t procinform(const char* path, int32_t oflags, bool st) {
       if (opts & kc::HashDB::TSMALL) oprintf(" small");
       if (opts & kc::HashDB::TLINEAR) oprintf(" linear");
       if (opts & kc::HashDB::TCOMPRESS) oprintf(" compress");
+      if (opts & kc::HashDB::TXXHASH) oprintf(" xxhash");
+      if (opts & kc::HashDB::TCHECKSUM) oprintf(" checksum");
+      if (opts & kc::HashDB::TBLOB) oprintf(" blob");
       oprintf(" (opts=%d)\n", opts);
       if (status["opaque"].size() >= 16) {
         const char* opaque = status["opaque"].c_str();
@@ -962,6 +979,13 @@ static int32_t procinform(const char* path, int32_t oflags, bool st) {
       oprintf("size: %lld (%s) (map=%lld)", size, sizestr.c_str(), (long long)msiz);
       if (size != realsize) oprintf(" (gap=%lld)", (long long)(realsize - size));
       oprintf("\n");
+      if (status.count("blob_size") > 0) {
+        int64_t bsiz = kc::atoi(status["blob_size"].c_str());
+        int64_t blive = kc::atoi(status["blob_live"].c_str());
+        std::string bsizstr = unitnumstrbyte(bsiz);
+        oprintf("blob: %lld (%s) (live=%lld) (thres=%s)\n", (long long)bsiz, bsizstr.c_str(),
+                (long long)blive, status["blob_thres"].c_str());
+      }
     } else {
       dberrprint(&db, "DB::status failed");
       err = true;
@@ -1351,7 +1375,7 @@ static int32_t procload(const char* path, const char* file, int32_t oflags) {
 
 
 // perform defrag command
-static int32_t procdefrag(const char* path, int32_t oflags) {
+static int32_t procdefrag(const char* path, int32_t oflags, bool blob) {
   kc::HashDB db;
   db.tune_logger(stdlogger(g_progname, &std::cerr));
   if (!db.open(path, kc::HashDB::OWRITER | oflags)) {
@@ -1359,7 +1383,12 @@ static int32_t procdefrag(const char* path, int32_t oflags) {
     return 1;
   }
   bool err = false;
-  if (!db.defrag(0)) {
+  if (blob) {
+    if (!db.compact_blobs()) {
+      dberrprint(&db, "DB::compact_blobs failed");
+      err = true;
+    }
+  } else if (!db.defrag(0)) {
     dberrprint(&db, "DB::defrag failed");
     err = true;
   }
@@ -1449,54 +1478,82 @@ static int32_t procgetbulk(const char* path, int32_t oflags,
 
 
 // perform check command
-static int32_t proccheck(const char* path, int32_t oflags) {
+static int32_t proccheck(const char* path, int32_t oflags, int32_t thnum) {
   kc::HashDB db;
   db.tune_logger(stdlogger(g_progname, &std::cerr));
+  db.tune_verification(true);
   if (!db.open(path, kc::HashDB::OREADER | oflags)) {
     dberrprint(&db, "DB::open failed");
     return 1;
   }
   bool err = false;
-  kc::HashDB::Cursor cur(&db);
-  if (!cur.jump() && db.error() != kc::BasicDB::Error::NOREC) {
-    dberrprint(&db, "DB::jump failed");
-    err = true;
-  }
   int64_t cnt = 0;
-  while (!err) {
-    size_t ksiz;
-    const char* vbuf;
-    size_t vsiz;
-    char* kbuf = cur.get(&ksiz, &vbuf, &vsiz);
-    if (kbuf) {
-      cnt++;
-      size_t rsiz;
-      char* rbuf = db.get(kbuf, ksiz, &rsiz);
-      if (rbuf) {
-        if (rsiz != vsiz || std::memcmp(rbuf, vbuf, rsiz)) {
+  if (thnum > 0) {
+    class VisitorImpl : public kc::DB::Visitor {
+     public:
+      explicit VisitorImpl() : cnt_(0) {}
+      int64_t count() {
+        return cnt_.get();
+      }
+     private:
+      const char* visit_full(const char* kbuf, size_t ksiz,
+                             const char* vbuf, size_t vsiz, size_t* sp) {
+        int64_t cnt = cnt_.add(1) + 1;
+        if (cnt % 1000 == 0) {
+          oputchar('.');
+          if (cnt % 50000 == 0) oprintf(" (%lld)\n", (long long)cnt);
+        }
+        return NOP;
+      }
+      kc::AtomicInt64 cnt_;
+    };
+    VisitorImpl visitor;
+    if (!db.scan_parallel(&visitor, thnum)) {
+      dberrprint(&db, "DB::scan_parallel failed");
+      err = true;
+    }
+    cnt = visitor.count();
+  } else {
+    kc::HashDB::Cursor cur(&db);
+    if (!cur.jump() && db.error() != kc::BasicDB::Error::NOREC) {
+      dberrprint(&db, "DB::jump failed");
+      err = true;
+    }
+    while (!err) {
+      size_t ksiz;
+      const char* vbuf;
+      size_t vsiz;
+      char* kbuf = cur.get(&ksiz, &vbuf, &vsiz);
+      if (kbuf) {
+        cnt++;
+        size_t rsiz;
+        char* rbuf = db.get(kbuf, ksiz, &rsiz);
+        if (rbuf) {
+          if (rsiz != vsiz || std::memcmp(rbuf, vbuf, rsiz)) {
+            dberrprint(&db, "DB::get failed");
+            err = true;
+          }
+          delete[] rbuf;
+        } else {
           dberrprint(&db, "DB::get failed");
           err = true;
         }
-        delete[] rbuf;
+        delete[] kbuf;
+        if (cnt % 1000 == 0) {
+          oputchar('.');
+          if (cnt % 50000 == 0) oprintf(" (%lld)\n", (long long)cnt);
+        }
       } else {
-        dberrprint(&db, "DB::get failed");
-        err = true;
-      }
-      delete[] kbuf;
-      if (cnt % 1000 == 0) {
-        oputchar('.');
-        if (cnt % 50000 == 0) oprintf(" (%lld)\n", (long long)cnt);
+        if (db.error() != kc::BasicDB::Error::NOREC) {
+          dberrprint(&db, "Cursor::get failed");
+          err = true;
+        }
+        break;
       }
-    } else {
-      if (db.error() != kc::BasicDB::Error::NOREC) {
-        dberrprint(&db, "Cursor::get failed");
+      if (!cur.step() && db.error() != kc::BasicDB::Error::NOREC) {
+        dberrprint(&db, "Cursor::step failed");
         err = true;
       }
-      break;
-    }
-    if (!cur.step() && db.error() != kc::BasicDB::Error::NOREC) {
-      dberrprint(&db, "Cursor::step failed");
-      err = true;
     }
   }
   oprintf(" (end)\n");
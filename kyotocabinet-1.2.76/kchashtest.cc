@@ -32,6 +32,7 @@ static int32_t runorder(int argc, char** argv);
 static int32_t runqueue(int argc, char** argv);
 static int32_t runwicked(int argc, char** argv);
 static int32_t runtran(int argc, char** argv);
+static int32_t runlock(int argc, char** argv);
 static int32_t procorder(const char* path, int64_t rnum, int32_t thnum, bool rnd, int32_t mode,
                          bool tran, int32_t oflags, int32_t apow, int32_t fpow,
                          int32_t opts, int64_t bnum, int64_t msiz, int64_t dfunit, bool lv);
@@ -44,6 +45,8 @@ static int32_t procwicked(const char* path, int64_t rnum, int32_t thnum, int32_t
 static int32_t proctran(const char* path, int64_t rnum, int32_t thnum, int32_t itnum, bool hard,
                         int32_t oflags, int32_t apow, int32_t fpow, int32_t opts,
                         int64_t bnum, int64_t msiz, int64_t dfunit, bool lv);
+static int32_t proclock(const char* path, int64_t rnum, int32_t thnum, int32_t itnum,
+                        int64_t bnum, int64_t msiz, bool lv);
 
 
 // main routine
@@ -64,6 +67,8 @@ int main(int argc, char** argv) {
     rv = runwicked(argc, argv);
   } else if (!std::strcmp(argv[1], "tran")) {
     rv = runtran(argc, argv);
+  } else if (!std::strcmp(argv[1], "lock")) {
+    rv = runlock(argc, argv);
   } else {
     usage();
   }
@@ -84,17 +89,18 @@ static void usage() {
   eprintf("\n");
   eprintf("usage:\n");
   eprintf("  %s order [-th num] [-rnd] [-set|-get|-getw|-rem|-etc] [-tran]"
-          " [-oat|-oas|-onl|-otl|-onr] [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-bnum num]"
+          " [-oat|-oas|-onl|-otl|-onr] [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx] [-bnum num]"
           " [-msiz num] [-dfunit num] [-lv] path rnum\n", g_progname);
   eprintf("  %s queue [-th num] [-it num] [-rnd] [-oat|-oas|-onl|-otl|-onr]"
-          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-bnum num] [-msiz num] [-dfunit num]"
+          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx] [-bnum num] [-msiz num] [-dfunit num]"
           " [-lv] path rnum\n", g_progname);
   eprintf("  %s wicked [-th num] [-it num] [-oat|-oas|-onl|-otl|-onr]"
-          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-bnum num] [-msiz num] [-dfunit num]"
+          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx] [-bnum num] [-msiz num] [-dfunit num]"
           " [-lv] path rnum\n", g_progname);
   eprintf("  %s tran [-th num] [-it num] [-hard] [-oat|-oas|-onl|-otl|-onr]"
-          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-bnum num] [-msiz num] [-dfunit num]"
+          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx] [-bnum num] [-msiz num] [-dfunit num]"
           " [-lv] path rnum\n", g_progname);
+  eprintf("  %s lock [-th num] [-it num] [-bnum num] [-msiz num] [-lv] path rnum\n", g_progname);
   eprintf("\n");
   std::exit(1);
 }
@@ -149,6 +155,7 @@ static void dbmetaprint(kc::BasicDB* db, bool verbose) {
       if (opts & kc::HashDB::TSMALL) oprintf(" small");
       if (opts & kc::HashDB::TLINEAR) oprintf(" linear");
       if (opts & kc::HashDB::TCOMPRESS) oprintf(" compress");
+      if (opts & kc::HashDB::TXXHASH) oprintf(" xxhash");
       oprintf(" (opts=%d)\n", opts);
       if (status["opaque"].size() >= 16) {
         const char* opaque = status["opaque"].c_str();
@@ -251,6 +258,8 @@ static int32_t runorder(int argc, char** argv) {
         opts |= kc::HashDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::HashDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::HashDB::TXXHASH;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -334,6 +343,8 @@ static int32_t runqueue(int argc, char** argv) {
         opts |= kc::HashDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::HashDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::HashDB::TXXHASH;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -414,6 +425,8 @@ static int32_t runwicked(int argc, char** argv) {
         opts |= kc::HashDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::HashDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::HashDB::TXXHASH;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -497,6 +510,8 @@ static int32_t runtran(int argc, char** argv) {
         opts |= kc::HashDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::HashDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::HashDB::TXXHASH;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -530,6 +545,55 @@ static int32_t runtran(int argc, char** argv) {
 }
 
 
+// parse arguments of lock command
+static int32_t runlock(int argc, char** argv) {
+  bool argbrk = false;
+  const char* path = NULL;
+  const char* rstr = NULL;
+  int32_t thnum = 1;
+  int32_t itnum = 1;
+  int64_t bnum = -1;
+  int64_t msiz = -1;
+  bool lv = false;
+  for (int32_t i = 2; i < argc; i++) {
+    if (!argbrk && argv[i][0] == '-') {
+      if (!std::strcmp(argv[i], "--")) {
+        argbrk = true;
+      } else if (!std::strcmp(argv[i], "-th")) {
+        if (++i >= argc) usage();
+        thnum = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-it")) {
+        if (++i >= argc) usage();
+        itnum = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-bnum")) {
+        if (++i >= argc) usage();
+        bnum = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-msiz")) {
+        if (++i >= argc) usage();
+        msiz = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-lv")) {
+        lv = true;
+      } else {
+        usage();
+      }
+    } else if (!path) {
+      argbrk = true;
+      path = argv[i];
+    } else if (!rstr) {
+      rstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!path || !rstr) usage();
+  int64_t rnum = kc::atoix(rstr);
+  if (rnum < 1 || thnum < 1 || itnum < 1) usage();
+  if (thnum > THREADMAX) thnum = THREADMAX;
+  int32_t rv = proclock(path, rnum, thnum, itnum, bnum, msiz, lv);
+  return rv;
+}
+
+
 // perform order command
 static int32_t procorder(const char* path, int64_t rnum, int32_t thnum, bool rnd, int32_t mode,
                          bool tran, int32_t oflags, int32_t apow, int32_t fpow,
@@ -2410,5 +2474,111 @@ static int32_t proctran(const char* path, int64_t rnum, int32_t thnum, int32_t i
 }
 
 
+// perform lock command
+static int32_t proclock(const char* path, int64_t rnum, int32_t thnum, int32_t itnum,
+                        int64_t bnum, int64_t msiz, bool lv) {
+  oprintf("<Lock Scalability Test>\n  seed=%u  path=%s  rnum=%lld  thnum=%d  itnum=%d"
+          "  bnum=%lld  msiz=%lld  lv=%d\n\n", g_randseed, path, (long long)rnum, thnum, itnum,
+          (long long)bnum, (long long)msiz, lv);
+  bool err = false;
+  kc::HashDB db;
+  db.tune_logger(stdlogger(g_progname, &std::cout),
+                 lv ? kc::UINT32MAX : kc::BasicDB::Logger::WARN | kc::BasicDB::Logger::ERROR);
+  if (bnum > 0) db.tune_buckets(bnum);
+  if (msiz >= 0) db.tune_map(msiz);
+  oprintf("opening the database:\n");
+  double stime = kc::time();
+  if (!db.open(path, kc::HashDB::OWRITER | kc::HashDB::OCREATE | kc::HashDB::OTRUNCATE)) {
+    dberrprint(&db, __LINE__, "DB::open");
+    err = true;
+  }
+  double etime = kc::time();
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("setting records:\n");
+  stime = kc::time();
+  for (int64_t i = 1; !err && i <= rnum; i++) {
+    char kbuf[RECBUFSIZ];
+    size_t ksiz = std::sprintf(kbuf, "%08lld", (long long)i);
+    if (!db.set(kbuf, ksiz, kbuf, ksiz)) {
+      dberrprint(&db, __LINE__, "DB::set");
+      err = true;
+    }
+    if (rnum > 250 && i % (rnum / 250) == 0) {
+      oputchar('.');
+      if (i == rnum || i % (rnum / 10) == 0) oprintf(" (%08lld)\n", (long long)i);
+    }
+  }
+  etime = kc::time();
+  oprintf("time: %.3f\n", etime - stime);
+  class ThreadGet : public kc::Thread {
+   public:
+    void setparams(int32_t id, kc::HashDB* db, kc::RWLock* glock, int64_t rnum,
+                   int32_t itnum) {
+      id_ = id;
+      db_ = db;
+      glock_ = glock;
+      rnum_ = rnum;
+      itnum_ = itnum;
+      err_ = false;
+    }
+    bool error() {
+      return err_;
+    }
+    void run() {
+      int64_t onum = rnum_ * itnum_;
+      for (int64_t i = 1; !err_ && i <= onum; i++) {
+        char kbuf[RECBUFSIZ];
+        size_t ksiz = std::sprintf(kbuf, "%08lld", (long long)((i * 7 + id_) % rnum_ + 1));
+        if (glock_) glock_->lock_reader();
+        char vbuf[RECBUFSIZ];
+        int32_t vsiz = db_->get(kbuf, ksiz, vbuf, sizeof(vbuf));
+        if (glock_) glock_->unlock();
+        if (vsiz != (int32_t)ksiz || std::memcmp(vbuf, kbuf, ksiz)) {
+          dberrprint(db_, __LINE__, "DB::get");
+          err_ = true;
+        }
+      }
+    }
+   private:
+    int32_t id_;
+    kc::HashDB* db_;
+    kc::RWLock* glock_;
+    int64_t rnum_;
+    int32_t itnum_;
+    bool err_;
+  };
+  kc::RWLock glock;
+  const char* const labels[] = { "shared reader lock", "distributed reader lock" };
+  for (int32_t mode = 0; mode < 2 && !err; mode++) {
+    oprintf("getting records with the %s:\n", labels[mode]);
+    stime = kc::time();
+    ThreadGet threads[THREADMAX];
+    for (int32_t i = 0; i < thnum; i++) {
+      threads[i].setparams(i, &db, mode == 0 ? &glock : NULL, rnum, itnum);
+      threads[i].start();
+    }
+    for (int32_t i = 0; i < thnum; i++) {
+      threads[i].join();
+      if (threads[i].error()) err = true;
+    }
+    etime = kc::time();
+    double onum = (double)rnum * itnum * thnum;
+    oprintf("time: %.3f (%.0f qps)\n", etime - stime,
+            etime > stime ? onum / (etime - stime) : 0.0);
+  }
+  dbmetaprint(&db, false);
+  oprintf("closing the database:\n");
+  stime = kc::time();
+  if (!db.close()) {
+    dberrprint(&db, __LINE__, "DB::close");
+    err = true;
+  }
+  etime = kc::time();
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
 
 // END OF FILE
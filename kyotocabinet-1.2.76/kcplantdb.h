@@ -51,26 +51,40 @@ template <class BASEDB, uint8_t DBTYPE>
 class PlantDB : public BasicDB {
  public:
   class Cursor;
+  class Snapshot;
  private:
   struct Record;
   struct RecordComparator;
+  class RecordArray;
   struct LeafNode;
   struct Link;
   struct LinkComparator;
   struct InnerNode;
   struct LeafSlot;
   struct InnerSlot;
+  class BatchVisitor;
   class ScopedVisitor;
-  /** An alias of array of records. */
-  typedef std::vector<Record*> RecordArray;
+  class FilterVisitor;
+  class Prefetcher;
+  class Flusher;
+  class Synchronizer;
+  class LeafReader;
   /** An alias of array of records. */
   typedef std::vector<Link*> LinkArray;
   /** An alias of leaf node cache. */
   typedef LinkedHashMap<int64_t, LeafNode*> LeafCache;
   /** An alias of inner node cache. */
   typedef LinkedHashMap<int64_t, InnerNode*> InnerCache;
+  /** An alias of history of evicted nodes. */
+  typedef LinkedHashMap<int64_t, bool> NodeHistory;
+  /** An alias of Bloom filters of leaf nodes. */
+  typedef std::map<int64_t, std::string> FilterMap;
+  /** An alias of cache of stored images of leaf nodes. */
+  typedef LinkedHashMap<int64_t, std::string> ImageCache;
   /** An alias of list of cursors. */
   typedef std::list<Cursor*> CursorList;
+  /** An alias of list of snapshots. */
+  typedef std::list<Snapshot*> SnapshotList;
   /** The number of cache slots. */
   static const int32_t SLOTNUM = 16;
   /** The default alignment power. */
@@ -85,12 +99,28 @@ class PlantDB : public BasicDB {
   static const int64_t DEFPCCAP = 64LL << 20;
   /** The size of the header. */
   static const int64_t HEADSIZ = 80;
+  /** The offset of the generation of Bloom filters. */
+  static const int64_t MOFFBFGEN = 3;
+  /** The offset of the flags. */
+  static const int64_t MOFFFLAGS = 7;
+  /** The flag whether Bloom filters are saved. */
+  static const uint8_t MFBFSAVED = 1 << 0;
+  /** The flag whether leaf pages are compressed. */
+  static const uint8_t MFPCOMP = 1 << 1;
   /** The offset of the numbers. */
   static const int64_t MOFFNUMS = 8;
+  /** The mask of the comparator code of a format unknown to older versions. */
+  static const uint8_t MCOMPEXT = 0x40;
   /** The prefix of leaf nodes. */
   static const char LNPREFIX = 'L';
   /** The prefix of inner nodes. */
   static const char INPREFIX = 'I';
+  /** The prefix of Bloom filters of leaf nodes. */
+  static const char BFPREFIX = 'B';
+  /** The maximum number of bits of Bloom filters per record. */
+  static const int32_t BFBITSMAX = 64;
+  /** The maximum number of hash functions of Bloom filters. */
+  static const int32_t BFHNUMMAX = 16;
   /** The average number of ways of each node. */
   static const size_t AVGWAY = 16;
   /** The ratio of the warm cache. */
@@ -105,6 +135,20 @@ class PlantDB : public BasicDB {
   static const int64_t INIDBASE = 1LL << 48;
   /** The minimum number of links in each inner node. */
   static const size_t INLINKMIN = 8;
+  /** The default fill factor of pages built by bulk loading in percent. */
+  static const int32_t DEFBFILL = 100;
+  /** The maximum interval of restart points of front-coded leaf pages. */
+  static const int32_t RSINTMAX = 65535;
+  /** The default percentage of the page cache at which accessing threads evict nodes. */
+  static const int32_t DEFWBHIGH = 100;
+  /** The interval of the background write-back in milliseconds. */
+  static const int32_t WBWAIT = 50;
+  /** The number of leaf nodes written back at once in each slot. */
+  static const int32_t WBBATCH = 8;
+  /** The memory overhead of each cached record besides its body. */
+  static const size_t RECOVERHEAD = sizeof(Record*) + sizeof(uint64_t);
+  /** The memory overhead of each cached link besides its body. */
+  static const size_t LINKOVERHEAD = sizeof(Link*);
   /** The maximum level of B+ tree. */
   static const int32_t LEVELMAX = 16;
   /** The number of cached nodes for auto transaction. */
@@ -123,7 +167,7 @@ class PlantDB : public BasicDB {
      * @param db the container database object.
      */
     explicit Cursor(PlantDB* db) :
-        db_(db), stack_(), kbuf_(NULL), ksiz_(0), lid_(0), back_(false) {
+        db_(db), stack_(), kbuf_(NULL), ksiz_(0), lid_(0), back_(false), scan_(true) {
       _assert_(db);
       ScopedRWLock lock(&db_->mlock_, true);
       db_->curs_.push_back(this);
@@ -281,7 +325,7 @@ class PlantDB : public BasicDB {
       set_position(kbuf, ksiz, 0);
       bool err = false;
       if (adjust_position()) {
-        if (db_->reccomp_.comp->compare(kbuf, ksiz, kbuf_, ksiz_) < 0) {
+        if (db_->reccomp_.compare(kbuf, ksiz, kbuf_, ksiz_) < 0) {
           bool hit = false;
           if (lid_ > 0 && !back_position_spec(&hit)) err = true;
           if (!err && !hit) {
@@ -367,6 +411,17 @@ class PlantDB : public BasicDB {
       _assert_(true);
       return db_;
     }
+    /**
+     * Set the caching priority of leaf nodes loaded by the cursor.
+     * @param scan true to cache leaf nodes the cursor moves into with low priority as a scan, or
+     * false to cache them as ordinary accesses.  By default, the cursor works as a scan.
+     * @note Nodes loaded by a scan are evicted before the working set of other operations.  A
+     * cursor which revisits the same range repeatedly should be set false.
+     */
+    void set_scan_hint(bool scan) {
+      _assert_(true);
+      scan_ = scan;
+    }
    private:
     /**
      * Clear the position.
@@ -408,7 +463,7 @@ class PlantDB : public BasicDB {
     bool set_position(int64_t id) {
       _assert_(true);
       while (id > 0) {
-        LeafNode* node = db_->load_leaf_node(id, false);
+        LeafNode* node = db_->load_leaf_node(id, false, scan_);
         if (!node) {
           db_->set_error(_KCCODELINE_, Error::BROKEN, "missing leaf node");
           db_->db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)id);
@@ -418,6 +473,7 @@ class PlantDB : public BasicDB {
         RecordArray& recs = node->recs;
         if (!recs.empty()) {
           set_position(recs.front(), id);
+          if (db_->pfth_ && node->next > 0) db_->pfth_->push(node->next);
           return true;
         } else {
           id = node->next;
@@ -434,7 +490,7 @@ class PlantDB : public BasicDB {
     bool set_position_back(int64_t id) {
       _assert_(true);
       while (id > 0) {
-        LeafNode* node = db_->load_leaf_node(id, false);
+        LeafNode* node = db_->load_leaf_node(id, false, scan_);
         if (!node) {
           db_->set_error(_KCCODELINE_, Error::BROKEN, "missing leaf node");
           db_->db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)id);
@@ -471,7 +527,7 @@ class PlantDB : public BasicDB {
       rec->ksiz = ksiz_;
       rec->vsiz = 0;
       std::memcpy(rbuf + sizeof(*rec), kbuf_, ksiz_);
-      LeafNode* node = db_->load_leaf_node(lid_, false);
+      LeafNode* node = db_->load_leaf_node(lid_, false, scan_);
       if (node) {
         char lstack[KCPDRECBUFSIZ];
         char* lbuf = NULL;
@@ -490,8 +546,7 @@ class PlantDB : public BasicDB {
           Record* lrec = recs.back();
           if (!db_->reccomp_(rec, frec) && !db_->reccomp_(lrec, rec)) {
             typename RecordArray::iterator ritend = recs.end();
-            typename RecordArray::iterator rit = std::lower_bound(recs.begin(), ritend,
-                                                                  rec, db_->reccomp_);
+            typename RecordArray::iterator rit = recs.lower_bound(rec, db_->reccomp_);
             if (rit != ritend) {
               hit = true;
               if (db_->reccomp_(rec, *rit)) {
@@ -511,10 +566,12 @@ class PlantDB : public BasicDB {
               size_t vsiz;
               const char* vbuf = visitor->visit_full(kbuf, ksiz, kbuf + ksiz,
                                                      rec->vsiz, &vsiz);
+              if (vbuf != Visitor::NOP && !db_->snaps_.empty())
+                db_->record_snapshots(kbuf, ksiz, kbuf + ksiz, rec->vsiz);
               if (vbuf == Visitor::REMOVE) {
                 rsiz = sizeof(*rec) + rec->ksiz + rec->vsiz;
                 db_->count_ -= 1;
-                db_->cusage_ -= rsiz;
+                db_->cusage_ -= rsiz + RECOVERHEAD;
                 node->size -= rsiz;
                 node->dirty = true;
                 if (recs.size() <= 1) {
@@ -597,9 +654,8 @@ class PlantDB : public BasicDB {
           }
         }
         if (hit) {
-          bool flush = db_->cusage_ > db_->pccap_;
+          bool flush = db_->cusage_ > db_->pclimit_;
           if (link || flush || async) {
-            int64_t id = node->id;
             if (atran && !link && !db_->fix_auto_transaction_leaf(node)) err = true;
             db_->mlock_.unlock();
             db_->mlock_.lock_writer();
@@ -613,12 +669,7 @@ class PlantDB : public BasicDB {
                 err = true;
               }
             } else if (flush) {
-              int32_t idx = id % SLOTNUM;
-              LeafSlot* lslot = db_->lslots_ + idx;
-              if (!db_->flush_leaf_cache_part(lslot)) err = true;
-              InnerSlot* islot = db_->islots_ + idx;
-              if (islot->warm->count() > lslot->warm->count() + lslot->hot->count() + 1 &&
-                  !db_->flush_inner_cache_part(islot)) err = true;
+              if (!db_->flush_cache_part()) err = true;
             }
             if (async && !db_->fix_auto_synchronization()) err = true;
           } else {
@@ -662,7 +713,7 @@ class PlantDB : public BasicDB {
         if (lbuf != lstack) delete[] lbuf;
         clear_position();
         if (!set_position(node->next)) return false;
-        node = db_->load_leaf_node(lid_, false);
+        node = db_->load_leaf_node(lid_, false, scan_);
         if (!node) {
           db_->set_error(_KCCODELINE_, Error::BROKEN, "search failed");
           return false;
@@ -689,8 +740,7 @@ class PlantDB : public BasicDB {
       std::memcpy(rbuf + sizeof(*rec), kbuf_, ksiz_);
       RecordArray& recs = node->recs;
       typename RecordArray::iterator ritend = recs.end();
-      typename RecordArray::iterator rit = std::lower_bound(recs.begin(), ritend,
-                                                            rec, db_->reccomp_);
+      typename RecordArray::iterator rit = recs.lower_bound(rec, db_->reccomp_);
       if (rit != ritend) {
         if (db_->reccomp_(rec, *rit)) {
           clear_position();
@@ -709,10 +759,12 @@ class PlantDB : public BasicDB {
         size_t vsiz;
         const char* vbuf = visitor->visit_full(kbuf, ksiz, kbuf + ksiz,
                                                rec->vsiz, &vsiz);
+        if (vbuf != Visitor::NOP && !db_->snaps_.empty())
+          db_->record_snapshots(kbuf, ksiz, kbuf + ksiz, rec->vsiz);
         if (vbuf == Visitor::REMOVE) {
           rsiz = sizeof(*rec) + rec->ksiz + rec->vsiz;
           db_->count_ -= 1;
-          db_->cusage_ -= rsiz;
+          db_->cusage_ -= rsiz + RECOVERHEAD;
           node->size -= rsiz;
           node->dirty = true;
           xfree(rec);
@@ -773,13 +825,8 @@ class PlantDB : public BasicDB {
         if (reorg) {
           if (!db_->reorganize_tree(node, hist, hnum)) err = true;
           if (atran && !db_->fix_auto_transaction_tree()) err = true;
-        } else if (db_->cusage_ > db_->pccap_) {
-          int32_t idx = node->id % SLOTNUM;
-          LeafSlot* lslot = db_->lslots_ + idx;
-          if (!db_->flush_leaf_cache_part(lslot)) err = true;
-          InnerSlot* islot = db_->islots_ + idx;
-          if (islot->warm->count() > lslot->warm->count() + lslot->hot->count() + 1 &&
-              !db_->flush_inner_cache_part(islot)) err = true;
+        } else if (db_->cusage_ > db_->pclimit_) {
+          if (!db_->flush_cache_part()) err = true;
         }
         if (async && !db_->fix_auto_synchronization()) err = true;
       } else {
@@ -847,8 +894,7 @@ class PlantDB : public BasicDB {
       node->lock.lock_reader();
       const RecordArray& recs = node->recs;
       typename RecordArray::const_iterator ritend = node->recs.end();
-      typename RecordArray::const_iterator rit = std::lower_bound(recs.begin(), ritend,
-                                                                  rec, db_->reccomp_);
+      typename RecordArray::const_iterator rit = recs.lower_bound(rec, db_->reccomp_);
       clear_position();
       if (rit == ritend) {
         node->lock.unlock();
@@ -877,7 +923,7 @@ class PlantDB : public BasicDB {
       rec->ksiz = ksiz_;
       rec->vsiz = 0;
       std::memcpy(rbuf + sizeof(*rec), kbuf_, ksiz_);
-      LeafNode* node = db_->load_leaf_node(lid_, false);
+      LeafNode* node = db_->load_leaf_node(lid_, false, scan_);
       if (node) {
         node->lock.lock_reader();
         RecordArray& recs = node->recs;
@@ -897,8 +943,7 @@ class PlantDB : public BasicDB {
             hit = true;
             typename RecordArray::iterator ritbeg = recs.begin();
             typename RecordArray::iterator ritend = recs.end();
-            typename RecordArray::iterator rit = std::lower_bound(recs.begin(), ritend,
-                                                                  rec, db_->reccomp_);
+            typename RecordArray::iterator rit = recs.lower_bound(rec, db_->reccomp_);
             clear_position();
             if (rit == ritbeg) {
               node->lock.unlock();
@@ -948,8 +993,7 @@ class PlantDB : public BasicDB {
       const RecordArray& recs = node->recs;
       typename RecordArray::const_iterator ritbeg = node->recs.begin();
       typename RecordArray::const_iterator ritend = node->recs.end();
-      typename RecordArray::const_iterator rit = std::lower_bound(recs.begin(), ritend,
-                                                                  rec, db_->reccomp_);
+      typename RecordArray::const_iterator rit = recs.lower_bound(rec, db_->reccomp_);
       clear_position();
       if (rit == ritbeg) {
         node->lock.unlock();
@@ -983,6 +1027,197 @@ class PlantDB : public BasicDB {
     int64_t lid_;
     /** The backward flag. */
     bool back_;
+    /** The flag to load leaf nodes as a scan. */
+    bool scan_;
+  };
+  /**
+   * Snapshot of the database.
+   */
+  class Snapshot : public BasicDB::Snapshot {
+    friend class PlantDB;
+   public:
+    /**
+     * Cursor to scan the records of a snapshot.
+     * @note The records are scanned in the order of the keys by merging the kept old images
+     * into the records read by an inner cursor.
+     */
+    class Cursor : public BasicDB::Snapshot::Cursor {
+      friend class PlantDB::Snapshot;
+     public:
+      /**
+       * Destructor.
+       */
+      virtual ~Cursor() {
+        _assert_(true);
+        delete cur_;
+      }
+      /**
+       * Jump the cursor to the first record.
+       * @return true on success, or false on failure.
+       */
+      bool jump() {
+        _assert_(true);
+        pos_.clear();
+        started_ = false;
+        incl_ = true;
+        synced_ = false;
+        return true;
+      }
+      /**
+       * Get a pair of the key and the value of the current record.
+       * @param ksp the pointer to the variable into which the size of the key region of the
+       * return value is assigned.
+       * @param vbp the pointer to the variable into which the pointer to the value region is
+       * assigned.
+       * @param vsp the pointer to the variable into which the size of the value region is
+       * assigned.
+       * @param step true to move the cursor to the next record, or false for no move.
+       * @return the pointer to the pair of the key region, or NULL on failure.
+       */
+      char* get(size_t* ksp, const char** vbp, size_t* vsp, bool step = false) {
+        _assert_(ksp && vbp && vsp);
+        PlantDB* db = (PlantDB*)snap_->db_;
+        if (!db) return NULL;
+        if (!snap_->valid()) {
+          db->set_error(_KCCODELINE_, Error::INVALID, "invalidated snapshot");
+          return NULL;
+        }
+        Comparator* comp = db->reccomp_.comp;
+        while (true) {
+          size_t rksiz, rvsiz;
+          const char* rvbuf;
+          char* rkbuf = read_inner(&rksiz, &rvbuf, &rvsiz);
+          if (!rkbuf && db->error() != Error::NOREC) return NULL;
+          std::string okey, value;
+          int32_t orv = snap_->next(started_ ? &pos_ : NULL, incl_, &okey, &value);
+          if (orv < 0 && !rkbuf) return NULL;
+          int32_t cmp = orv < 0 ? 1 : rkbuf ?
+              comp->compare(okey.data(), okey.size(), rkbuf, rksiz) : -1;
+          if (cmp > 0) {
+            pos_.assign(rkbuf, rksiz);
+            started_ = true;
+            incl_ = !step;
+            *ksp = rksiz;
+            *vbp = rvbuf;
+            *vsp = rvsiz;
+            return rkbuf;
+          }
+          delete[] rkbuf;
+          if (cmp < 0) synced_ = false;
+          pos_ = okey;
+          started_ = true;
+          if (orv < 1) {
+            incl_ = false;
+            continue;
+          }
+          incl_ = !step;
+          char* kbuf = new char[okey.size()+value.size()+2];
+          std::memcpy(kbuf, okey.data(), okey.size());
+          kbuf[okey.size()] = '\0';
+          char* vbuf = kbuf + okey.size() + 1;
+          std::memcpy(vbuf, value.data(), value.size());
+          vbuf[value.size()] = '\0';
+          *ksp = okey.size();
+          *vbp = vbuf;
+          *vsp = value.size();
+          return kbuf;
+        }
+      }
+     private:
+      /**
+       * Constructor.
+       * @param snap the container snapshot object.
+       */
+      explicit Cursor(Snapshot* snap) :
+          snap_(snap),
+          cur_(snap->db_ ? new typename PlantDB::Cursor((PlantDB*)snap->db_) : NULL),
+          pos_(), started_(false), incl_(true), synced_(false) {
+        _assert_(snap);
+      }
+      /**
+       * Read the first current record after the position with the inner cursor.
+       * @param ksp the pointer to the variable into which the size of the key region of the
+       * return value is assigned.
+       * @param vbp the pointer to the variable into which the pointer to the value region is
+       * assigned.
+       * @param vsp the pointer to the variable into which the size of the value region is
+       * assigned.
+       * @return the pointer to the pair of the key region, or NULL on failure.
+       * @note The inner cursor is always stepped by reading because stepping from a record
+       * removed by another thread would pass over its successor.  It is jumped again before
+       * reporting the end because aborting a transaction clears its position.
+       */
+      char* read_inner(size_t* ksp, const char** vbp, size_t* vsp) {
+        _assert_(ksp && vbp && vsp);
+        PlantDB* db = (PlantDB*)snap_->db_;
+        Comparator* comp = db->reccomp_.comp;
+        for (int32_t i = 0; i < 2; i++) {
+          if (!synced_ || i > 0) {
+            if (started_) {
+              cur_->jump(pos_.data(), pos_.size());
+            } else {
+              cur_->jump();
+            }
+            synced_ = true;
+          }
+          char* kbuf = cur_->get(ksp, vbp, vsp, true);
+          while (kbuf && started_) {
+            int32_t rv = comp->compare(kbuf, *ksp, pos_.data(), pos_.size());
+            if (rv > 0 || (rv == 0 && incl_)) break;
+            delete[] kbuf;
+            kbuf = cur_->get(ksp, vbp, vsp, true);
+          }
+          if (kbuf || !started_ || db->error() != Error::NOREC) return kbuf;
+        }
+        return NULL;
+      }
+      /** Dummy constructor to forbid the use. */
+      Cursor(const Cursor&);
+      /** Dummy Operator to forbid the use. */
+      Cursor& operator =(const Cursor&);
+      /** The container snapshot. */
+      Snapshot* snap_;
+      /** The inner cursor. */
+      typename PlantDB::Cursor* cur_;
+      /** The key of the current position. */
+      std::string pos_;
+      /** The flag whether the position is set. */
+      bool started_;
+      /** The flag whether the record at the position is included. */
+      bool incl_;
+      /** The flag whether the inner cursor is near the position. */
+      bool synced_;
+    };
+    /**
+     * Destructor.
+     */
+    virtual ~Snapshot() {
+      _assert_(true);
+      if (!db_) return;
+      PlantDB* db = (PlantDB*)db_;
+      ScopedRWLock lock(&db->mlock_, true);
+      db->snaps_.remove(this);
+    }
+    /**
+     * Create a cursor object.
+     * @return the return value is the created cursor object.
+     * @note Because the object of the return value is allocated by the constructor, it should
+     * be released with the delete operator before the snapshot is deleted.
+     */
+    Cursor* cursor() {
+      _assert_(true);
+      return new Cursor(this);
+    }
+   private:
+    /**
+     * Constructor.
+     * @param db the container database object.
+     * @note This must be called while the method lock is held exclusively.
+     */
+    explicit Snapshot(PlantDB* db) : BasicDB::Snapshot(db, db->reccomp_.comp) {
+      _assert_(db);
+      db->snaps_.push_back(this);
+    }
   };
   /**
    * Tuning options.
@@ -990,7 +1225,17 @@ class PlantDB : public BasicDB {
   enum Option {
     TSMALL = BASEDB::TSMALL,             ///< use 32-bit addressing
     TLINEAR = BASEDB::TLINEAR,           ///< use linear collision chaining
-    TCOMPRESS = BASEDB::TCOMPRESS        ///< compress each record
+    TCOMPRESS = BASEDB::TCOMPRESS,       ///< compress each record
+    TXXHASH = BASEDB::TXXHASH,           ///< use XXH64 hashing instead of MurMur hashing
+    TCHECKSUM = BASEDB::TCHECKSUM        ///< add a checksum to each page
+  };
+  /**
+   * Options of the memory-mapped region.
+   */
+  enum MapOption {
+    MGROW = BASEDB::MGROW,               ///< grow the region with the file
+    MPOPULATE = BASEDB::MPOPULATE,       ///< prefault the region
+    MHUGE = BASEDB::MHUGE                ///< advise transparent huge pages
   };
   /**
    * Status flags.
@@ -1003,9 +1248,13 @@ class PlantDB : public BasicDB {
    * Default constructor.
    */
   explicit PlantDB() :
-      mlock_(), mtrigger_(NULL), omode_(0), writer_(false), autotran_(false), autosync_(false),
-      db_(), curs_(), apow_(DEFAPOW), fpow_(DEFFPOW), opts_(0), bnum_(DEFBNUM),
-      psiz_(DEFPSIZ), pccap_(DEFPCCAP),
+      mlock_(), smlock_(), smcnt_(0), mtrigger_(NULL), omode_(0), writer_(false),
+      autotran_(false), autosync_(false),
+      db_(), curs_(), snaps_(), apow_(DEFAPOW), fpow_(DEFFPOW), opts_(0), bnum_(DEFBNUM),
+      gcdelay_(0), psiz_(DEFPSIZ), pccap_(DEFPCCAP), pclimit_(DEFPCCAP), pcwbmark_(0),
+      wblow_(0), wbhigh_(DEFWBHIGH), wbth_(NULL), pfdepth_(0), pfth_(NULL), bsint_(0), bsth_(NULL),
+      rsint_(0), bfill_(DEFBFILL), pcomp_(NULL), zccap_(0),
+      bfbits_(0), bfon_(false), bfgen_(0), bfsaved_(false), bfcheck_(0), bfreject_(0), bffalse_(0),
       root_(0), first_(0), last_(0), lcnt_(0), icnt_(0), count_(0), cusage_(0),
       lslots_(), islots_(), reccomp_(), linkcomp_(),
       tran_(false), trclock_(0), trlcnt_(0), trcount_(0) {
@@ -1027,6 +1276,15 @@ class PlantDB : public BasicDB {
         ++cit;
       }
     }
+    if (!snaps_.empty()) {
+      typename SnapshotList::const_iterator sit = snaps_.begin();
+      typename SnapshotList::const_iterator sitend = snaps_.end();
+      while (sit != sitend) {
+        Snapshot* snap = *sit;
+        snap->db_ = NULL;
+        ++sit;
+      }
+    }
   }
   /**
    * Accept a visitor to a record.
@@ -1066,7 +1324,30 @@ class PlantDB : public BasicDB {
     std::memcpy(lbuf + sizeof(*link), kbuf, ksiz);
     int64_t hist[LEVELMAX];
     int32_t hnum = 0;
-    LeafNode* node = search_tree(link, true, hist, &hnum);
+    int64_t smcnt = smcnt_.get();
+    LeafNode* node = NULL;
+    FilterVisitor filtered(visitor);
+    if (!writable && (bfon_ || (rsint_ > 0 && cusage_ > pclimit_))) {
+      int64_t id = search_leaf_id(link, hist, &hnum);
+      int32_t rv = id > 0 && bfon_ ? check_leaf_filter(id, kbuf, ksiz, visitor) : -1;
+      if (rv > 0) {
+        if (lbuf != lstack) delete[] lbuf;
+        mlock_.unlock();
+        return true;
+      }
+      if (rv == 0) visitor = &filtered;
+      rv = id > 0 && rsint_ > 0 && cusage_ > pclimit_ ?
+          peek_leaf_node(id, kbuf, ksiz, visitor) : -1;
+      if (rv >= 0) {
+        if (filtered.miss()) bffalse_ += 1;
+        if (lbuf != lstack) delete[] lbuf;
+        mlock_.unlock();
+        return rv > 0;
+      }
+      if (id > 0) node = load_leaf_node(id, true);
+    } else {
+      node = search_tree(link, true, hist, &hnum);
+    }
     if (!node) {
       set_error(_KCCODELINE_, Error::BROKEN, "search failed");
       if (lbuf != lstack) delete[] lbuf;
@@ -1085,20 +1366,21 @@ class PlantDB : public BasicDB {
     } else {
       node->lock.lock_reader();
     }
+    if (smcnt_.get() != smcnt) node = chase_leaf_node(node, rec, writable);
     bool reorg = accept_impl(node, rec, visitor);
+    if (filtered.miss()) bffalse_ += 1;
     bool atran = autotran_ && !tran_ && node->dirty;
     bool async = autosync_ && !autotran_ && !tran_ && node->dirty;
     node->lock.unlock();
     bool flush = false;
     bool err = false;
-    int64_t id = node->id;
     if (atran && !reorg && !fix_auto_transaction_leaf(node)) err = true;
-    if (cusage_ > pccap_) {
-      int32_t idx = id % SLOTNUM;
-      LeafSlot* lslot = lslots_ + idx;
+    if (cusage_ > pclimit_) {
+      LeafSlot* lslot = lslots_ + select_leaf_slot();
       if (!clean_leaf_cache_part(lslot)) err = true;
       flush = true;
     }
+    if (reorg && !wrlock && divide_leaf_node_locally(link)) reorg = false;
     if (reorg) {
       if (!wrlock) {
         mlock_.unlock();
@@ -1115,12 +1397,7 @@ class PlantDB : public BasicDB {
         mlock_.unlock();
         mlock_.lock_writer();
       }
-      int32_t idx = id % SLOTNUM;
-      LeafSlot* lslot = lslots_ + idx;
-      if (!flush_leaf_cache_part(lslot)) err = true;
-      InnerSlot* islot = islots_ + idx;
-      if (islot->warm->count() > lslot->warm->count() + lslot->hot->count() + 1 &&
-          !flush_inner_cache_part(islot)) err = true;
+      if (!flush_cache_part()) err = true;
       mlock_.unlock();
     } else {
       mlock_.unlock();
@@ -1194,13 +1471,8 @@ class PlantDB : public BasicDB {
       if (reorg) {
         if (!reorganize_tree(node, hist, hnum)) err = true;
         if (atran && !fix_auto_transaction_tree()) err = true;
-      } else if (cusage_ > pccap_) {
-        int32_t idx = node->id % SLOTNUM;
-        LeafSlot* lslot = lslots_ + idx;
-        if (!flush_leaf_cache_part(lslot)) err = true;
-        InnerSlot* islot = islots_ + idx;
-        if (islot->warm->count() > lslot->warm->count() + lslot->hot->count() + 1 &&
-            !flush_inner_cache_part(islot)) err = true;
+      } else if (cusage_ > pclimit_) {
+        if (!flush_cache_part()) err = true;
       }
       if (rbuf != rstack) delete[] rbuf;
       if (lbuf != lstack) delete[] lbuf;
@@ -1209,6 +1481,163 @@ class PlantDB : public BasicDB {
     }
     return !err;
   }
+  /**
+   * Apply a batch of record updates atomically.
+   * @param batch the batch of updates.
+   * @return true on success, or false on failure.
+   * @note The operations are applied in order under the writer lock of the whole tree, so that
+   * other threads are blocked until the batch is applied.  If auto transaction is enabled and
+   * no transaction is active, the whole batch is applied in one transaction and it is rolled
+   * back on failure.  In a transaction, the batch is committed or aborted with it.  Otherwise,
+   * a crash can leave the batch partially applied.
+   */
+  bool apply_batch(const WriteBatch& batch) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    if (!writer_) {
+      set_error(_KCCODELINE_, Error::NOPERM, "permission denied");
+      return false;
+    }
+    size_t onum = batch.count();
+    if (onum < 1) return true;
+    bool atran = autotran_ && !tran_;
+    bool async = autosync_ && !autotran_ && !tran_;
+    if (atran) {
+      if (!begin_transaction_impl(autosync_)) return false;
+      tran_ = true;
+    }
+    bool err = false;
+    for (size_t i = 0; !err && i < onum; i++) {
+      const char* kbuf;
+      size_t ksiz;
+      const char* vbuf;
+      size_t vsiz;
+      WriteBatch::Kind kind = batch.get(i, &kbuf, &ksiz, &vbuf, &vsiz);
+      char lstack[KCPDRECBUFSIZ];
+      size_t lsiz = sizeof(Link) + ksiz;
+      char* lbuf = lsiz > sizeof(lstack) ? new char[lsiz] : lstack;
+      Link* link = (Link*)lbuf;
+      link->child = 0;
+      link->ksiz = ksiz;
+      std::memcpy(lbuf + sizeof(*link), kbuf, ksiz);
+      int64_t hist[LEVELMAX];
+      int32_t hnum = 0;
+      LeafNode* node = search_tree(link, true, hist, &hnum);
+      if (!node) {
+        set_error(_KCCODELINE_, Error::BROKEN, "search failed");
+        if (lbuf != lstack) delete[] lbuf;
+        err = true;
+        break;
+      }
+      char rstack[KCPDRECBUFSIZ];
+      size_t rsiz = sizeof(Record) + ksiz;
+      char* rbuf = rsiz > sizeof(rstack) ? new char[rsiz] : rstack;
+      Record* rec = (Record*)rbuf;
+      rec->ksiz = ksiz;
+      rec->vsiz = 0;
+      std::memcpy(rbuf + sizeof(*rec), kbuf, ksiz);
+      BatchVisitor visitor(kind, vbuf, vsiz);
+      if (accept_impl(node, rec, &visitor)) {
+        if (!reorganize_tree(node, hist, hnum)) err = true;
+      } else if (cusage_ > pclimit_) {
+        if (!flush_cache_part()) err = true;
+      }
+      if (rbuf != rstack) delete[] rbuf;
+      if (lbuf != lstack) delete[] lbuf;
+    }
+    if (atran) {
+      if (err) {
+        abort_transaction();
+      } else if (!commit_transaction(true)) {
+        err = true;
+      }
+      tran_ = false;
+    } else if (async && !fix_auto_synchronization()) {
+      err = true;
+    }
+    return !err;
+  }
+  /**
+   * Store records supplied by a source.
+   * @param src the source of records.
+   * @return true on success, or false on failure.
+   * @note If the database is empty and neither transaction nor auto transaction is active,
+   * records read in ascending order are appended to leaf pages filled up to the bulk fill
+   * factor, and the inner nodes are built bottom-up without searching the tree.  Once a record
+   * out of order is read, it and the rest are stored one by one.
+   */
+  bool load_bulk(BulkSource* src) {
+    _assert_(src);
+    mlock_.lock_writer();
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      mlock_.unlock();
+      return false;
+    }
+    if (!writer_) {
+      set_error(_KCCODELINE_, Error::NOPERM, "permission denied");
+      mlock_.unlock();
+      return false;
+    }
+    if (tran_ || autotran_ || count_ > 0 || root_ != first_ || !snaps_.empty()) {
+      mlock_.unlock();
+      return BasicDB::load_bulk(src);
+    }
+    LeafNode* node = load_leaf_node(first_, false);
+    if (!node) {
+      set_error(_KCCODELINE_, Error::BROKEN, "missing leaf node");
+      db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)first_);
+      mlock_.unlock();
+      return false;
+    }
+    int64_t limit = (int64_t)psiz_ * bfill_ / 100;
+    std::vector<int64_t> opens;
+    std::vector<int64_t> heads;
+    const char* kbuf;
+    size_t ksiz;
+    const char* vbuf;
+    size_t vsiz;
+    bool rest = false;
+    bool err = false;
+    while (!err && (kbuf = src->read(&ksiz, &vbuf, &vsiz)) != NULL) {
+      size_t rsiz = sizeof(Record) + ksiz + vsiz;
+      Record* rec = (Record*)xmalloc(rsiz);
+      rec->ksiz = ksiz;
+      rec->vsiz = vsiz;
+      char* dbuf = (char*)rec + sizeof(*rec);
+      std::memcpy(dbuf, kbuf, ksiz);
+      std::memcpy(dbuf + ksiz, vbuf, vsiz);
+      RecordArray& recs = node->recs;
+      if (!recs.empty() && !reccomp_(recs.back(), rec)) {
+        xfree(rec);
+        rest = true;
+        break;
+      }
+      if (!recs.empty() && node->size + (int64_t)rsiz > limit) {
+        LeafNode* newnode = create_leaf_node(node->id, 0);
+        node->next = newnode->id;
+        if (!add_bulk_link(&opens, &heads, 0, newnode->id, dbuf, ksiz, limit)) err = true;
+        if (cusage_ > pclimit_ && !flush_leaf_node(node, true)) err = true;
+        node = newnode;
+      }
+      node->recs.push_back(rec);
+      node->size += rsiz;
+      node->dirty = true;
+      cusage_ += rsiz + RECOVERHEAD;
+      count_ += 1;
+    }
+    last_ = node->id;
+    if (!opens.empty()) root_ = opens.back();
+    mlock_.unlock();
+    if (rest && !err) {
+      if (!set(kbuf, ksiz, vbuf, vsiz) || !BasicDB::load_bulk(src)) err = true;
+    }
+    return !err;
+  }
   /**
    * Iterate to accept a visitor for each record.
    * @param visitor a visitor object.
@@ -1248,7 +1677,7 @@ class PlantDB : public BasicDB {
     int64_t flcnt = 0;
     int64_t curcnt = 0;
     while (!err && id > 0) {
-      LeafNode* node = load_leaf_node(id, false);
+      LeafNode* node = load_leaf_node(id, false, true);
       if (!node) {
         set_error(_KCCODELINE_, Error::BROKEN, "missing leaf node");
         db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)id);
@@ -1307,7 +1736,7 @@ class PlantDB : public BasicDB {
         }
         if (lbuf != lstack) delete[] lbuf;
       }
-      if (cusage_ > pccap_) {
+      if (cusage_ > pclimit_) {
         for (int32_t i = 0; i < SLOTNUM; i++) {
           LeafSlot* lslot = lslots_ + i;
           if (!flush_leaf_cache_part(lslot)) err = true;
@@ -1325,7 +1754,7 @@ class PlantDB : public BasicDB {
       set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
       err = true;
     }
-    if (atran && !commit_transaction()) err = true;
+    if (atran && !commit_transaction(true)) err = true;
     if (autosync_ && !autotran_ && writable && !fix_auto_synchronization()) err = true;
     trigger_meta(MetaTrigger::ITERATE, "iterate");
     return !err;
@@ -1390,34 +1819,14 @@ class PlantDB : public BasicDB {
       const char* visit_full(const char* kbuf, size_t ksiz,
                              const char* vbuf, size_t vsiz, size_t* sp) {
         if (ksiz < 2 || ksiz >= NUMBUFSIZ || kbuf[0] != LNPREFIX) return NOP;
-        uint64_t prev;
-        size_t step = readvarnum(vbuf, vsiz, &prev);
-        if (step < 1) return NOP;
-        vbuf += step;
-        vsiz -= step;
-        uint64_t next;
-        step = readvarnum(vbuf, vsiz, &next);
-        if (step < 1) return NOP;
-        vbuf += step;
-        vsiz -= step;
-        while (vsiz > 1) {
-          uint64_t rksiz;
-          step = readvarnum(vbuf, vsiz, &rksiz);
-          if (step < 1) break;
-          vbuf += step;
-          vsiz -= step;
-          uint64_t rvsiz;
-          step = readvarnum(vbuf, vsiz, &rvsiz);
-          if (step < 1) break;
-          vbuf += step;
-          vsiz -= step;
-          if (vsiz < rksiz + rvsiz) break;
+        LeafReader reader(vbuf, vsiz, db_->rsint_ > 0, db_->pcomp_);
+        const char* rkbuf;
+        size_t rksiz;
+        const char* rvbuf;
+        size_t rvsiz;
+        while (reader.read(&rkbuf, &rksiz, &rvbuf, &rvsiz)) {
           size_t xvsiz;
-          visitor_->visit_full(vbuf, rksiz, vbuf + rksiz, rvsiz, &xvsiz);
-          vbuf += rksiz;
-          vsiz -= rksiz;
-          vbuf += rvsiz;
-          vsiz -= rvsiz;
+          visitor_->visit_full(rkbuf, rksiz, rvbuf, rvsiz, &xvsiz);
           if (checker_ && !checker_->check("scan_parallel", "processing", -1, allcnt_)) {
             db_->set_error(_KCCODELINE_, Error::LOGIC, "checker failed");
             error_ = db_->error();
@@ -1549,6 +1958,8 @@ class PlantDB : public BasicDB {
       lcnt_ = 1;
       icnt_ = 0;
       count_ = 0;
+      bfgen_ = 0;
+      bfsaved_ = false;
       if (!reccomp_.comp) reccomp_.comp = LEXICALCOMP;
       if (!dump_meta() || !flush_leaf_cache(true) || !load_meta()) {
         delete_inner_cache();
@@ -1576,10 +1987,37 @@ class PlantDB : public BasicDB {
       db_.close();
       return false;
     }
+    int32_t kind = reccomp_.kind;
+    bfon_ = bfbits_ > 0 && kind != CKCUSTOM && kind != CKDEC && kind != CKDECDESC;
+    if (writer_ && (bfsaved_ || bfon_)) {
+      if (!bfsaved_) bfgen_++;
+      bfsaved_ = false;
+      if (!dump_meta()) {
+        delete_inner_cache();
+        delete_leaf_cache();
+        db_.close();
+        return false;
+      }
+    } else if (bfon_ && !bfsaved_) {
+      bfgen_++;
+    }
     omode_ = mode;
     cusage_ = 0;
     tran_ = false;
     trclock_ = 0;
+    set_cache_marks();
+    if (pfdepth_ > 0) {
+      pfth_ = new Prefetcher(this);
+      pfth_->start();
+    }
+    if (pcwbmark_ > 0) {
+      wbth_ = new Flusher(this);
+      wbth_->start();
+    }
+    if (writer_ && bsint_ > 0) {
+      bsth_ = new Synchronizer(this);
+      bsth_->start();
+    }
     trigger_meta(MetaTrigger::OPEN, "open");
     return true;
   }
@@ -1589,15 +2027,31 @@ class PlantDB : public BasicDB {
    */
   bool close() {
     _assert_(true);
+    if (pfth_) pfth_->finish();
+    if (wbth_) wbth_->finish();
+    if (bsth_) bsth_->finish();
     ScopedRWLock lock(&mlock_, true);
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
       return false;
     }
+    if (pfth_) {
+      delete pfth_;
+      pfth_ = NULL;
+    }
+    if (wbth_) {
+      delete wbth_;
+      wbth_ = NULL;
+    }
+    if (bsth_) {
+      delete bsth_;
+      bsth_ = NULL;
+    }
     const std::string& path = db_.path();
     report(_KCCODELINE_, Logger::DEBUG, "closing the database (path=%s)", path.c_str());
     bool err = false;
     disable_cursors();
+    disable_snapshots();
     int64_t lsiz = calc_leaf_cache_size();
     int64_t isiz = calc_inner_cache_size();
     if (cusage_ != lsiz + isiz) {
@@ -1621,8 +2075,10 @@ class PlantDB : public BasicDB {
     }
     delete_inner_cache();
     delete_leaf_cache();
+    bfsaved_ = bfon_ && !err;
     if (writer_ && !dump_meta()) err = true;
     if (!db_.close()) err = true;
+    bfon_ = false;
     omode_ = 0;
     trigger_meta(MetaTrigger::CLOSE, "close");
     return !err;
@@ -1797,23 +2253,28 @@ class PlantDB : public BasicDB {
    */
   bool end_transaction(bool commit = true) {
     _assert_(true);
-    ScopedRWLock lock(&mlock_, true);
+    mlock_.lock_writer();
     if (omode_ == 0) {
       set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      mlock_.unlock();
       return false;
     }
     if (!tran_) {
       set_error(_KCCODELINE_, Error::INVALID, "not in transaction");
+      mlock_.unlock();
       return false;
     }
     bool err = false;
+    bool group = commit && gcdelay_ > 0;
     if (commit) {
-      if (!commit_transaction()) err = true;
+      if (!commit_transaction(!group)) err = true;
     } else {
       if (!abort_transaction()) err = true;
     }
     tran_ = false;
     trigger_meta(commit ? MetaTrigger::COMMITTRAN : MetaTrigger::ABORTTRAN, "end_transaction");
+    mlock_.unlock();
+    if (group && !db_.end_transaction(true)) err = true;
     return !err;
   }
   /**
@@ -1832,10 +2293,12 @@ class PlantDB : public BasicDB {
       return false;
     }
     disable_cursors();
+    disable_snapshots();
     flush_leaf_cache(false);
     flush_inner_cache(false);
     bool err = false;
     if (!db_.clear()) err = true;
+    clear_leaf_filters();
     lcnt_ = 0;
     create_leaf_node(0, 0);
     root_ = 1;
@@ -1850,6 +2313,183 @@ class PlantDB : public BasicDB {
     trigger_meta(MetaTrigger::CLEAR, "clear");
     return !err;
   }
+  /**
+   * Remove records in a range of keys.
+   * @param bkbuf the pointer to the key region where the range begins inclusively.  If it is
+   * NULL, the range begins at the first record.
+   * @param bksiz the size of the key region where the range begins.
+   * @param ekbuf the pointer to the key region where the range ends exclusively.  If it is
+   * NULL, the range ends at the last record.
+   * @param eksiz the size of the key region where the range ends.
+   * @return the number of removed records, or -1 on failure.
+   * @note The cost is linear in the number of records in the range.  Every leaf node in the
+   * range is loaded and its records in the range are released one by one and erased from the
+   * record array at once.  Each emptied leaf node is detached from the tree and removed from
+   * the file.  Inner nodes whose subtrees are covered by the range are not dropped as a whole.
+   */
+  int64_t remove_range(const char* bkbuf, size_t bksiz, const char* ekbuf, size_t eksiz) {
+    _assert_(bksiz <= MEMMAXSIZ && eksiz <= MEMMAXSIZ);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return -1;
+    }
+    if (!writer_) {
+      set_error(_KCCODELINE_, Error::NOPERM, "permission denied");
+      return -1;
+    }
+    Record* brec = bkbuf ? create_key_record(bkbuf, bksiz) : NULL;
+    Record* erec = ekbuf ? create_key_record(ekbuf, eksiz) : NULL;
+    bool err = false;
+    int64_t hist[LEVELMAX];
+    int32_t hnum = 0;
+    LeafNode* node = NULL;
+    if (!brec || !erec || reccomp_(brec, erec)) {
+      node = search_range_head(bkbuf, bksiz, hist, &hnum);
+      if (!node) err = true;
+    }
+    int64_t num = 0;
+    bool head = true;
+    while (node) {
+      RecordArray& recs = node->recs;
+      typename RecordArray::iterator rit =
+          head && brec ? recs.lower_bound(brec, reccomp_) : recs.begin();
+      typename RecordArray::iterator ritend =
+          erec ? recs.lower_bound(erec, reccomp_) : recs.end();
+      bool done = ritend != recs.end() || node->next < 1;
+      if (rit < ritend) {
+        for (typename RecordArray::iterator it = rit; it != ritend; ++it) {
+          Record* rec = *it;
+          if (!snaps_.empty()) {
+            char* kbuf = (char*)rec + sizeof(*rec);
+            record_snapshots(kbuf, rec->ksiz, kbuf + rec->ksiz, rec->vsiz);
+          }
+          size_t rsiz = sizeof(*rec) + rec->ksiz + rec->vsiz;
+          count_ -= 1;
+          cusage_ -= rsiz + RECOVERHEAD;
+          node->size -= rsiz;
+          xfree(rec);
+          num++;
+        }
+        recs.erase(rit, ritend);
+        node->dirty = true;
+      }
+      int64_t next = node->next;
+      if (recs.empty() && hnum > 0) {
+        if (!reorganize_tree(node, hist, hnum)) err = true;
+        if (node->dead && !flush_leaf_node(node, true)) err = true;
+      }
+      if (err || done) break;
+      if (cusage_ > pclimit_ && !flush_cache_part()) err = true;
+      node = load_leaf_node(next, false, true);
+      if (!node || node->recs.empty()) {
+        set_error(_KCCODELINE_, Error::BROKEN, "missing leaf node");
+        db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)next);
+        err = true;
+        break;
+      }
+      Record* rec = node->recs.front();
+      node = search_tree_key((char*)rec + sizeof(*rec), rec->ksiz, hist, &hnum);
+      if (!node) {
+        set_error(_KCCODELINE_, Error::BROKEN, "search failed");
+        err = true;
+      }
+      head = false;
+    }
+    if (erec) xfree(erec);
+    if (brec) xfree(brec);
+    if (autotran_ && !tran_ && !fix_auto_transaction_tree()) err = true;
+    if (autosync_ && !autotran_ && !tran_ && !fix_auto_synchronization()) err = true;
+    return err ? -1 : num;
+  }
+  /**
+   * Get the number of records in a range of keys.
+   * @param bkbuf the pointer to the key region where the range begins inclusively.  If it is
+   * NULL, the range begins at the first record.
+   * @param bksiz the size of the key region where the range begins.
+   * @param ekbuf the pointer to the key region where the range ends exclusively.  If it is
+   * NULL, the range ends at the last record.
+   * @param eksiz the size of the key region where the range ends.
+   * @return the number of records in the range, or -1 on failure.
+   * @note The cost is linear in the number of leaf nodes in the range, because inner nodes do
+   * not keep the numbers of records of their subtrees.  Every leaf node in the range is loaded
+   * and counted by the size of its record array.  The ones loaded only for counting are kept
+   * in the cold cache.
+   */
+  int64_t count_range(const char* bkbuf, size_t bksiz, const char* ekbuf, size_t eksiz) {
+    _assert_(bksiz <= MEMMAXSIZ && eksiz <= MEMMAXSIZ);
+    ScopedRWLock lock(&mlock_, false);
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return -1;
+    }
+    Record* brec = bkbuf ? create_key_record(bkbuf, bksiz) : NULL;
+    Record* erec = ekbuf ? create_key_record(ekbuf, eksiz) : NULL;
+    bool err = false;
+    LeafNode* node = NULL;
+    if (!brec || !erec || reccomp_(brec, erec)) {
+      if (bkbuf) {
+        int64_t hist[LEVELMAX];
+        int32_t hnum = 0;
+        node = search_tree_key(bkbuf, bksiz, hist, &hnum);
+      } else {
+        node = load_leaf_node(first_, false, true);
+      }
+      if (!node) {
+        set_error(_KCCODELINE_, Error::BROKEN, "search failed");
+        err = true;
+      }
+    }
+    int64_t num = 0;
+    bool head = true;
+    while (node) {
+      node->lock.lock_reader();
+      RecordArray& recs = node->recs;
+      typename RecordArray::iterator rit =
+          head && brec ? recs.lower_bound(brec, reccomp_) : recs.begin();
+      typename RecordArray::iterator ritend =
+          erec ? recs.lower_bound(erec, reccomp_) : recs.end();
+      if (rit < ritend) num += ritend - rit;
+      bool done = ritend != recs.end();
+      int64_t next = node->next;
+      node->lock.unlock();
+      if (done || next < 1) break;
+      node = load_leaf_node(next, false, true);
+      if (!node) {
+        set_error(_KCCODELINE_, Error::BROKEN, "missing leaf node");
+        db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)next);
+        err = true;
+      }
+      head = false;
+    }
+    if (erec) xfree(erec);
+    if (brec) xfree(brec);
+    return err ? -1 : num;
+  }
+  /**
+   * Change the capacity size of the page cache of the opened database.
+   * @param pccap the capacity size of the page cache.  If it is not more than 0, the default
+   * value is specified.
+   * @return true on success, or false on failure.
+   * @note If the current usage exceeds the new limit, nodes are evicted until it fits.
+   */
+  bool resize_page_cache(int64_t pccap) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    pccap_ = pccap > 0 ? pccap : DEFPCCAP;
+    set_cache_marks();
+    bool err = false;
+    while (cusage_ > pclimit_) {
+      int64_t usage = cusage_;
+      if (!flush_cache_part()) err = true;
+      if (cusage_ >= usage) break;
+    }
+    return !err;
+  }
   /**
    * Get the number of records.
    * @return the number of records, or -1 on failure.
@@ -1905,6 +2545,18 @@ class PlantDB : public BasicDB {
     (*strmap)["type"] = strprintf("%u", (unsigned)DBTYPE);
     (*strmap)["psiz"] = strprintf("%d", psiz_);
     (*strmap)["pccap"] = strprintf("%lld", (long long)pccap_);
+    (*strmap)["pcomp"] = strprintf("%d", pcomp_ ? 1 : 0);
+    (*strmap)["zccap"] = strprintf("%lld", (long long)zccap_);
+    (*strmap)["pfdepth"] = strprintf("%d", (int)pfdepth_);
+    (*strmap)["bfill"] = strprintf("%d", (int)bfill_);
+    (*strmap)["wblow"] = strprintf("%d", (int)wblow_);
+    (*strmap)["wbhigh"] = strprintf("%d", (int)wbhigh_);
+    (*strmap)["bsint"] = strprintf("%lld", (long long)bsint_);
+    (*strmap)["rsint"] = strprintf("%d", (int)rsint_);
+    (*strmap)["bloom"] = strprintf("%d", (int)(bfon_ ? bfbits_ : 0));
+    (*strmap)["bloom_checked"] = strprintf("%lld", (long long)bfcheck_.get());
+    (*strmap)["bloom_rejected"] = strprintf("%lld", (long long)bfreject_.get());
+    (*strmap)["bloom_false"] = strprintf("%lld", (long long)bffalse_.get());
     const char* compname = "external";
     if (reccomp_.comp == LEXICALCOMP) {
       compname = "lexical";
@@ -1914,6 +2566,12 @@ class PlantDB : public BasicDB {
       compname = "lexicaldesc";
     } else if (reccomp_.comp == DECIMALDESCCOMP) {
       compname = "decimaldesc";
+    } else if (reccomp_.comp == INTEGERCOMP) {
+      compname = "integer";
+    } else if (reccomp_.comp == UNSIGNEDCOMP) {
+      compname = "unsigned";
+    } else if (reccomp_.comp == FLOATCOMP) {
+      compname = "float";
     }
     (*strmap)["rcomp"] = compname;
     (*strmap)["root"] = strprintf("%lld", (long long)root_);
@@ -1933,6 +2591,40 @@ class PlantDB : public BasicDB {
       (*strmap)["cusage_icnt"] = strprintf("%lld", (long long)calc_inner_cache_count());
     if (strmap->count("cusage_isiz") > 0)
       (*strmap)["cusage_isiz"] = strprintf("%lld", (long long)calc_inner_cache_size());
+    int64_t lhits = 0;
+    int64_t lmisses = 0;
+    int64_t levicts = 0;
+    int64_t ihits = 0;
+    int64_t imisses = 0;
+    int64_t ievicts = 0;
+    int64_t zcusage = 0;
+    int64_t zchits = 0;
+    for (int32_t i = 0; i < SLOTNUM; i++) {
+      LeafSlot* lslot = lslots_ + i;
+      lslot->lock.lock();
+      lhits += lslot->hits;
+      lmisses += lslot->misses;
+      levicts += lslot->evicts;
+      zchits += lslot->imhits;
+      lslot->imlock.lock();
+      zcusage += lslot->imsize;
+      lslot->imlock.unlock();
+      lslot->lock.unlock();
+      InnerSlot* islot = islots_ + i;
+      islot->lock.lock();
+      ihits += islot->hits;
+      imisses += islot->misses;
+      ievicts += islot->evicts;
+      islot->lock.unlock();
+    }
+    (*strmap)["lhit"] = strprintf("%lld", (long long)lhits);
+    (*strmap)["lmiss"] = strprintf("%lld", (long long)lmisses);
+    (*strmap)["levict"] = strprintf("%lld", (long long)levicts);
+    (*strmap)["ihit"] = strprintf("%lld", (long long)ihits);
+    (*strmap)["imiss"] = strprintf("%lld", (long long)imisses);
+    (*strmap)["ievict"] = strprintf("%lld", (long long)ievicts);
+    (*strmap)["zcusage"] = strprintf("%lld", (long long)zcusage);
+    (*strmap)["zchit"] = strprintf("%lld", (long long)zchits);
     if (strmap->count("tree_level") > 0) {
       Link link;
       link.ksiz = 0;
@@ -1954,10 +2646,32 @@ class PlantDB : public BasicDB {
     return new Cursor(this);
   }
   /**
-   * Write a log message.
-   * @param file the file name of the program source code.
-   * @param line the line number of the program source code.
-   * @param func the function name of the program source code.
+   * Create a snapshot object.
+   * @return the created snapshot object, or NULL on failure.
+   * @note Because the object of the return value is allocated by the constructor, it should be
+   * released with the delete operator when it is no longer in use.  While a snapshot exists,
+   * every update of a record copies its old image into the snapshot and bulk loading into an
+   * empty database stores records one by one.  A snapshot cannot be created while a
+   * transaction is active.
+   */
+  Snapshot* snapshot() {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ == 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return NULL;
+    }
+    if (tran_) {
+      set_error(_KCCODELINE_, Error::LOGIC, "transaction is active");
+      return NULL;
+    }
+    return new Snapshot(this);
+  }
+  /**
+   * Write a log message.
+   * @param file the file name of the program source code.
+   * @param line the line number of the program source code.
+   * @param func the function name of the program source code.
    * @param kind the kind of the event.  Logger::DEBUG for debugging, Logger::INFO for normal
    * information, Logger::WARN for warning, and Logger::ERROR for fatal error.
    * @param message the supplement message.
@@ -2034,7 +2748,8 @@ class PlantDB : public BasicDB {
    * Set the optional features.
    * @param opts the optional features by bitwise-or: BasicDB::TSMALL to use 32-bit addressing,
    * BasicDB::TLINEAR to use linear collision chaining, BasicDB::TCOMPRESS to compress each
-   * record.
+   * record, BasicDB::TXXHASH to use XXH64 hashing, BasicDB::TCHECKSUM to add a CRC32C
+   * checksum to each page.
    * @return true on success, or false on failure.
    */
   bool tune_options(int8_t opts) {
@@ -2091,6 +2806,22 @@ class PlantDB : public BasicDB {
     }
     return db_.tune_map(msiz);
   }
+  /**
+   * Set the options of the internal memory-mapped region.
+   * @param mopts the options by bitwise-or: PlantDB::MGROW to map the file as it grows,
+   * PlantDB::MPOPULATE to prefault the mapped pages, PlantDB::MHUGE to advise transparent huge
+   * pages.
+   * @return true on success, or false on failure.
+   */
+  bool tune_map_options(int8_t mopts) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    return db_.tune_map_options(mopts);
+  }
   /**
    * Set the unit step number of auto defragmentation.
    * @param dfunit the unit step number of auto defragmentation.
@@ -2105,6 +2836,80 @@ class PlantDB : public BasicDB {
     }
     return db_.tune_defrag(dfunit);
   }
+  /**
+   * Set the maximum delay of group commit of hard transactions.
+   * @param delay the maximum delay in microseconds.  If it is not more than 0, group commit is
+   * disabled.  By default, group commit is disabled.
+   * @return true on success, or false on failure.
+   * @note The internal database is committed after the tree is released for the next
+   * transaction, so that hard transactions of concurrent writers share synchronization.
+   */
+  bool tune_group_commit(int64_t delay) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    gcdelay_ = delay > 0 ? delay : 0;
+    return db_.tune_group_commit(delay);
+  }
+  /**
+   * Set the redo log of transactions.
+   * @param limit the size of the redo log to trigger a checkpoint.  If it is not more than 0,
+   * the undo log is used.  By default, the undo log is used.
+   * @return true on success, or false on failure.
+   */
+  bool tune_redo_log(int64_t limit) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    return db_.tune_redo_log(limit);
+  }
+  /**
+   * Set the background synchronization.
+   * @param interval the interval in microseconds of writing back dirty nodes of the page cache
+   * and the updated contents of the file.  If it is not more than 0, they are not written back
+   * periodically.
+   * @param limit the size of updated contents of the file to trigger writing back.  If it is
+   * not more than 0, the size is not limited.  By default, neither is set and background
+   * synchronization is disabled.
+   * @return true on success, or false on failure.
+   * @note If the interval is set, a thread is started when the database is opened as a writer.
+   * It saves dirty nodes without evicting them and dumps the meta data unless a transaction is
+   * running.  The file of the internal database is written back as with
+   * HashDB::tune_background_sync.
+   */
+  bool tune_background_sync(int64_t interval, int64_t limit) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    bsint_ = interval > 0 ? interval : 0;
+    return db_.tune_background_sync(interval, limit);
+  }
+  /**
+   * Set the verification of checksums on reading.
+   * @param verify true to verify the checksum of each page which is read, or false not to
+   * verify.  By default, checksums are not verified.
+   * @return true on success, or false on failure.
+   * @note This is meaningful only for a database created with BasicDB::TCHECKSUM.  See
+   * HashDB::tune_verification.
+   */
+  bool tune_verification(bool verify) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    return db_.tune_verification(verify);
+  }
   /**
    * Set the capacity size of the page cache.
    * @param pccap the capacity size of the page cache.
@@ -2120,6 +2925,113 @@ class PlantDB : public BasicDB {
     pccap_ = pccap > 0 ? pccap : DEFPCCAP;
     return true;
   }
+  /**
+   * Set the watermarks of the page cache.
+   * @param lowmark the percentage of the capacity at which a background thread starts writing
+   * back dirty leaf nodes and evicting them.  If it is not more than 0 or not less than the high
+   * watermark, the background write-back is disabled.  By default, it is disabled.
+   * @param highmark the percentage of the capacity at which accessing threads evict nodes by
+   * themselves.  If it is not more than 0, the default value is specified.  The default value
+   * is 100.
+   * @return true on success, or false on failure.
+   * @note If the background write-back is enabled, a thread is started when the database is
+   * opened and it keeps the usage of the page cache around the low watermark so that updating
+   * threads seldom block on writing pages until the usage reaches the high watermark.
+   */
+  bool tune_write_back(int32_t lowmark, int32_t highmark) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    wbhigh_ = highmark > 0 ? (highmark < 100 ? highmark : 100) : DEFWBHIGH;
+    wblow_ = lowmark > 0 && lowmark < wbhigh_ ? lowmark : 0;
+    return true;
+  }
+  /**
+   * Set the size of Bloom filters of leaf nodes for negative lookups.
+   * @param bits the number of bits of each filter per record.  If it is not more than 0, no
+   * filter is used.  By default, no filter is used.
+   * @return true on success, or false on failure.
+   * @note A filter is built for each leaf node when the node is written back or evicted, and it
+   * is saved beside the node.  A read-only access to a leaf node which is not cached does not
+   * load the node if the key is missing in the filter.  10 bits per record make a false
+   * positive rate of about 1%.  The filters of the leaf nodes which are not cached are kept in
+   * memory apart from the page cache.  The filters are not used with the decimal comparators
+   * and custom comparators, which can regard different keys as equivalent.  A database which
+   * has been opened with filters is refused by older versions of the library, which would
+   * update records without updating the saved filters.
+   */
+  bool tune_bloom(int32_t bits) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    bfbits_ = bits > 0 ? (bits < BFBITSMAX ? bits : BFBITSMAX) : 0;
+    return true;
+  }
+  /**
+   * Set the interval of restart points of front-coded leaf pages.
+   * @param rsint the number of records between restart points.  If it is not more than 0, leaf
+   * pages are stored with full keys.  By default, front coding is disabled.
+   * @return true on success, or false on failure.
+   * @note If front coding is enabled, each key of a stored leaf page is written as the length of
+   * the prefix shared with the previous key and the rest, and every rsint-th key is written in
+   * full as a restart point.  When the page cache is full, a read-only access to a leaf node
+   * which is not cached searches the restart points of the stored page directly instead of
+   * loading it.  The format is fixed when the database is created and the tuning is ignored
+   * for an existing database.  A front-coded database is refused by older versions of the
+   * library, whose comparator codes do not include the one marking the format.
+   */
+  bool tune_front_coding(int32_t rsint) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    rsint_ = rsint > 0 ? (rsint < RSINTMAX ? rsint : RSINTMAX) : 0;
+    return true;
+  }
+  /**
+   * Set the fill factor of pages built by bulk loading.
+   * @param bfill the percentage of the page size filled by records loaded in order.  If it is
+   * not more than 0, the default value is specified.  The default value is 100.
+   * @return true on success, or false on failure.
+   * @note A lower fill factor leaves room in each page for records inserted later.
+   */
+  bool tune_bulk_fill(int32_t bfill) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    bfill_ = bfill > 0 ? (bfill < 100 ? bfill : 100) : DEFBFILL;
+    return true;
+  }
+  /**
+   * Set the depth of leaf prefetching for cursor scans.
+   * @param pfdepth the number of leaf nodes loaded ahead of a cursor moving forward.  If it is
+   * not more than 0, prefetching is disabled.  By default, prefetching is disabled.
+   * @return true on success, or false on failure.
+   * @note If prefetching is enabled, a background thread is started when the database is opened
+   * and it loads the following leaf nodes into the page cache whenever a cursor moves to a new
+   * leaf node.  Prefetching stops while the page cache is over its capacity.
+   */
+  bool tune_prefetch(int32_t pfdepth) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    pfdepth_ = pfdepth > 0 ? pfdepth : 0;
+    return true;
+  }
   /**
    * Set the data compressor.
    * @param comp the data compressor object.
@@ -2134,6 +3046,46 @@ class PlantDB : public BasicDB {
     }
     return db_.tune_compressor(comp);
   }
+  /**
+   * Set the compressor of leaf pages.
+   * @param comp the compressor object.
+   * @return true on success, or false on failure.
+   * @note Each leaf page is compressed as a whole when it is written to the internal database,
+   * independently of the compressor of the internal database.  Whether leaf pages are
+   * compressed is fixed when the database is created, and a compressor of the same kind must
+   * be given to open the database again.  A database with compressed leaf pages is refused by
+   * older versions of the library.
+   */
+  bool tune_page_compressor(Compressor* comp) {
+    _assert_(comp);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    pcomp_ = comp;
+    return true;
+  }
+  /**
+   * Set the capacity size of the cache of compressed leaf pages.
+   * @param zccap the capacity size of the cache.  If it is not more than 0, the cache is not
+   * used.  By default, the cache is not used.
+   * @return true on success, or false on failure.
+   * @note The stored images of leaf nodes evicted from the page cache are kept in this cache
+   * apart from the page cache, so that a miss of the page cache costs decompression instead of
+   * reading the internal database.  It is useful with the page compressor, whose images are
+   * much smaller than the deserialized nodes.
+   */
+  bool tune_compressed_cache(int64_t zccap) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, true);
+    if (omode_ != 0) {
+      set_error(_KCCODELINE_, Error::INVALID, "already opened");
+      return false;
+    }
+    zccap_ = zccap > 0 ? zccap : 0;
+    return true;
+  }
   /**
    * Set the record comparator.
    * @param rcomp the record comparator object.
@@ -2141,6 +3093,10 @@ class PlantDB : public BasicDB {
    * @note Several built-in comparators are provided.  LEXICALCOMP for the default lexical
    * comparator.  DECIMALCOMP for the decimal comparator.  LEXICALDESCCOMP for the lexical
    * descending comparator.  DECIMALDESCCOMP for the lexical descending comparator.
+   * INTEGERCOMP, UNSIGNEDCOMP, and FLOATCOMP for the comparators of signed integers, unsigned
+   * integers, and floating-point numbers in big-endian binary.  The built-in comparators are
+   * called directly by the binary searches while a custom comparator is called through the
+   * virtual function.
    */
   bool tune_comparator(Comparator* rcomp) {
     _assert_(rcomp);
@@ -2150,6 +3106,7 @@ class PlantDB : public BasicDB {
       return false;
     }
     reccomp_.comp = rcomp;
+    reccomp_.specialize();
     return true;
   }
   /**
@@ -2295,21 +3252,226 @@ class PlantDB : public BasicDB {
     uint32_t ksiz;                       ///< size of the key
     uint32_t vsiz;                       ///< size of the value
   };
+  /**
+   * Kinds of comparators.
+   */
+  enum ComparatorKind {
+    CKCUSTOM,                            ///< custom comparator
+    CKLEX,                               ///< lexical comparator
+    CKDEC,                               ///< decimal comparator
+    CKLEXDESC,                           ///< lexical descending comparator
+    CKDECDESC,                           ///< decimal descending comparator
+    CKINT,                               ///< signed integer comparator
+    CKUINT,                              ///< unsigned integer comparator
+    CKFLT                                ///< floating-point number comparator
+  };
+  /**
+   * Get the kind of a comparator.
+   * @param comp the comparator.
+   * @return the kind of the comparator.
+   */
+  static int32_t comparator_kind(Comparator* comp) {
+    _assert_(true);
+    if (comp == LEXICALCOMP) return CKLEX;
+    if (comp == DECIMALCOMP) return CKDEC;
+    if (comp == LEXICALDESCCOMP) return CKLEXDESC;
+    if (comp == DECIMALDESCCOMP) return CKDECDESC;
+    if (comp == INTEGERCOMP) return CKINT;
+    if (comp == UNSIGNEDCOMP) return CKUINT;
+    if (comp == FLOATCOMP) return CKFLT;
+    return CKCUSTOM;
+  }
+  /**
+   * Compare two keys.
+   * @param comp the comparator.
+   * @param kind the kind of the comparator.
+   * @param akbuf the pointer to the region of one key.
+   * @param aksiz the size of the region of one key.
+   * @param bkbuf the pointer to the region of the other key.
+   * @param bksiz the size of the region of the other key.
+   * @return positive if the former is big, negative if the latter is big, 0 if both are
+   * equivalent.
+   * @note The built-in comparators are called directly so that the comparison is inlined into
+   * the binary searches instead of going through the virtual function.
+   */
+  static int32_t compare_keys(Comparator* comp, int32_t kind, const char* akbuf, size_t aksiz,
+                              const char* bkbuf, size_t bksiz) {
+    _assert_(comp && akbuf && bkbuf);
+    switch (kind) {
+      case CKLEX: {
+        return LEXICALCOMP->LexicalComparator::compare(akbuf, aksiz, bkbuf, bksiz);
+      }
+      case CKDEC: {
+        return DECIMALCOMP->DecimalComparator::compare(akbuf, aksiz, bkbuf, bksiz);
+      }
+      case CKLEXDESC: {
+        return -LEXICALCOMP->LexicalComparator::compare(akbuf, aksiz, bkbuf, bksiz);
+      }
+      case CKDECDESC: {
+        return -DECIMALCOMP->DecimalComparator::compare(akbuf, aksiz, bkbuf, bksiz);
+      }
+      case CKINT: {
+        return INTEGERCOMP->IntegerComparator::compare(akbuf, aksiz, bkbuf, bksiz);
+      }
+      case CKUINT: {
+        return UNSIGNEDCOMP->UnsignedComparator::compare(akbuf, aksiz, bkbuf, bksiz);
+      }
+      case CKFLT: {
+        return FLOATCOMP->FloatComparator::compare(akbuf, aksiz, bkbuf, bksiz);
+      }
+    }
+    return comp->compare(akbuf, aksiz, bkbuf, bksiz);
+  }
   /**
    * Comparator for records.
    */
   struct RecordComparator {
     Comparator* comp;                    ///< comparator
+    int32_t kind;                        ///< kind of the comparator
     /** constructor */
-    explicit RecordComparator() : comp(NULL) {}
+    explicit RecordComparator() : comp(NULL), kind(CKCUSTOM) {}
+    /** select the specialized path for the comparator */
+    void specialize() {
+      _assert_(true);
+      kind = comparator_kind(comp);
+    }
+    /** compare two keys */
+    int32_t compare(const char* akbuf, size_t aksiz, const char* bkbuf, size_t bksiz) const {
+      _assert_(akbuf && bkbuf);
+      return compare_keys(comp, kind, akbuf, aksiz, bkbuf, bksiz);
+    }
     /** comparing operator */
     bool operator ()(const Record* const& a, const Record* const& b) const {
       _assert_(true);
       char* akbuf = (char*)a + sizeof(*a);
       char* bkbuf = (char*)b + sizeof(*b);
-      return comp->compare(akbuf, a->ksiz, bkbuf, b->ksiz) < 0;
+      return compare_keys(comp, kind, akbuf, a->ksiz, bkbuf, b->ksiz) < 0;
     }
   };
+  /**
+   * Sorted array of records with inline key prefixes.
+   * @note The first bytes of each key are kept in a contiguous array beside the pointers so that
+   * a binary search with the lexical comparators narrows the range without dereferencing the
+   * records.
+   */
+  class RecordArray {
+   public:
+    /** iterator */
+    typedef typename std::vector<Record*>::iterator iterator;
+    /** constant iterator */
+    typedef typename std::vector<Record*>::const_iterator const_iterator;
+    /** constructor */
+    explicit RecordArray() : recs_(), pfxs_() {}
+    /** the iterator of the first record */
+    iterator begin() {
+      return recs_.begin();
+    }
+    /** the constant iterator of the first record */
+    const_iterator begin() const {
+      return recs_.begin();
+    }
+    /** the iterator of the end */
+    iterator end() {
+      return recs_.end();
+    }
+    /** the constant iterator of the end */
+    const_iterator end() const {
+      return recs_.end();
+    }
+    /** the number of records */
+    size_t size() const {
+      return recs_.size();
+    }
+    /** whether there is no record */
+    bool empty() const {
+      return recs_.empty();
+    }
+    /** the first record */
+    Record* front() const {
+      return recs_.front();
+    }
+    /** the last record */
+    Record* back() const {
+      return recs_.back();
+    }
+    /** the record at a position */
+    Record* operator [](size_t idx) const {
+      return recs_[idx];
+    }
+    /** reserve the capacity */
+    void reserve(size_t num) {
+      recs_.reserve(num);
+      pfxs_.reserve(num);
+    }
+    /** add a record at the end */
+    void push_back(Record* rec) {
+      recs_.push_back(rec);
+      pfxs_.push_back(prefix(rec));
+    }
+    /** insert a record before a position */
+    iterator insert(iterator pos, Record* rec) {
+      size_t idx = pos - recs_.begin();
+      pfxs_.insert(pfxs_.begin() + idx, prefix(rec));
+      return recs_.insert(pos, rec);
+    }
+    /** remove the record at a position */
+    iterator erase(iterator pos) {
+      size_t idx = pos - recs_.begin();
+      pfxs_.erase(pfxs_.begin() + idx);
+      return recs_.erase(pos);
+    }
+    /** remove the records in a range */
+    iterator erase(iterator first, iterator last) {
+      size_t bidx = first - recs_.begin();
+      size_t eidx = last - recs_.begin();
+      pfxs_.erase(pfxs_.begin() + bidx, pfxs_.begin() + eidx);
+      return recs_.erase(first, last);
+    }
+    /** the first position whose record is not less than the given one */
+    iterator lower_bound(Record* rec, const RecordComparator& comp) {
+      size_t lo, hi;
+      narrow(rec, comp, &lo, &hi);
+      return std::lower_bound(recs_.begin() + lo, recs_.begin() + hi, rec, comp);
+    }
+    /** the first position whose record is not less than the given one */
+    const_iterator lower_bound(Record* rec, const RecordComparator& comp) const {
+      size_t lo, hi;
+      narrow(rec, comp, &lo, &hi);
+      return std::lower_bound(recs_.begin() + lo, recs_.begin() + hi, rec, comp);
+    }
+   private:
+    /** get the key prefix of a record */
+    static uint64_t prefix(const Record* rec) {
+      const unsigned char* kbuf = (const unsigned char*)rec + sizeof(*rec);
+      size_t ksiz = rec->ksiz < sizeof(uint64_t) ? rec->ksiz : sizeof(uint64_t);
+      uint64_t pfx = 0;
+      for (size_t i = 0; i < sizeof(uint64_t); i++) {
+        pfx = (pfx << 8) | (i < ksiz ? kbuf[i] : 0);
+      }
+      return pfx;
+    }
+    /** narrow the range of records sharing the prefix with the given one */
+    void narrow(Record* rec, const RecordComparator& comp, size_t* lop, size_t* hip) const {
+      *lop = 0;
+      *hip = recs_.size();
+      if (comp.kind == CKLEX) {
+        uint64_t pfx = prefix(rec);
+        typename std::vector<uint64_t>::const_iterator lit =
+            std::lower_bound(pfxs_.begin(), pfxs_.end(), pfx);
+        *lop = lit - pfxs_.begin();
+        *hip = std::upper_bound(lit, pfxs_.end(), pfx) - pfxs_.begin();
+      } else if (comp.kind == CKLEXDESC) {
+        uint64_t pfx = prefix(rec);
+        std::greater<uint64_t> gt;
+        typename std::vector<uint64_t>::const_iterator lit =
+            std::lower_bound(pfxs_.begin(), pfxs_.end(), pfx, gt);
+        *lop = lit - pfxs_.begin();
+        *hip = std::upper_bound(lit, pfxs_.end(), pfx, gt) - pfxs_.begin();
+      }
+    }
+    std::vector<Record*> recs_;          ///< pointers to the records
+    std::vector<uint64_t> pfxs_;         ///< key prefixes of the records
+  };
   /**
    * Leaf node of B+ tree.
    */
@@ -2321,6 +3483,7 @@ class PlantDB : public BasicDB {
     int64_t prev;                        ///< previous leaf node
     int64_t next;                        ///< next leaf node
     bool hot;                            ///< whether in the hot cache
+    bool cold;                           ///< whether in the cold cache
     bool dirty;                          ///< whether to be written back
     bool dead;                           ///< whether to be removed
   };
@@ -2336,23 +3499,29 @@ class PlantDB : public BasicDB {
    */
   struct LinkComparator {
     Comparator* comp;                    ///< comparator
+    int32_t kind;                        ///< kind of the comparator
     /** constructor */
-    explicit LinkComparator() : comp(NULL) {
+    explicit LinkComparator() : comp(NULL), kind(CKCUSTOM) {
       _assert_(true);
     }
+    /** select the specialized path for the comparator */
+    void specialize() {
+      _assert_(true);
+      kind = comparator_kind(comp);
+    }
     /** comparing operator */
     bool operator ()(const Link* const& a, const Link* const& b) const {
       _assert_(true);
       char* akbuf = (char*)a + sizeof(*a);
       char* bkbuf = (char*)b + sizeof(*b);
-      return comp->compare(akbuf, a->ksiz, bkbuf, b->ksiz) < 0;
+      return compare_keys(comp, kind, akbuf, a->ksiz, bkbuf, b->ksiz) < 0;
     }
   };
   /**
    * Inner node of B+ tree.
    */
   struct InnerNode {
-    RWLock lock;                         ///< lock
+    SpinRWLock lock;                     ///< lock
     int64_t id;                          ///< page ID numger
     int64_t heir;                        ///< child before the first link
     LinkArray links;                     ///< sorted array of links
@@ -2367,6 +3536,17 @@ class PlantDB : public BasicDB {
     Mutex lock;                          ///< lock
     LeafCache* hot;                      ///< hot cache
     LeafCache* warm;                     ///< warm cache
+    LeafCache* cold;                     ///< cold cache of scanned nodes
+    NodeHistory* ghost;                  ///< history of nodes evicted from the warm cache
+    FilterMap* filters;                  ///< Bloom filters of nodes out of the cache
+    Mutex imlock;                        ///< lock of the stored images
+    ImageCache* images;                  ///< stored images of nodes
+    int64_t imsize;                      ///< total size of the stored images
+    AtomicInt64 count;                   ///< number of cached nodes, readable without the lock
+    int64_t hits;                        ///< number of cache hits
+    int64_t misses;                      ///< number of cache misses
+    int64_t evicts;                      ///< number of evictions
+    int64_t imhits;                      ///< number of hits of the stored images
   };
   /**
    * Slot cache of inner nodes.
@@ -2374,6 +3554,39 @@ class PlantDB : public BasicDB {
   struct InnerSlot {
     Mutex lock;                          ///< lock
     InnerCache* warm;                    ///< warm cache
+    int64_t hits;                        ///< number of cache hits
+    int64_t misses;                      ///< number of cache misses
+    int64_t evicts;                      ///< number of evictions
+  };
+  /**
+   * Visitor to apply an operation of a write batch.
+   */
+  class BatchVisitor : public Visitor {
+   public:
+    /** constructor */
+    explicit BatchVisitor(WriteBatch::Kind kind, const char* vbuf, size_t vsiz) :
+        kind_(kind), vbuf_(vbuf), vsiz_(vsiz) {
+      _assert_(vbuf);
+    }
+   private:
+    /** visit a record */
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && vbuf && vsiz <= MEMMAXSIZ && sp);
+      if (kind_ == WriteBatch::KREMOVE) return REMOVE;
+      *sp = vsiz_;
+      return vbuf_;
+    }
+    /** visit an empty record */
+    const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && sp);
+      if (kind_ == WriteBatch::KREMOVE) return NOP;
+      *sp = vsiz_;
+      return vbuf_;
+    }
+    WriteBatch::Kind kind_;
+    const char* vbuf_;
+    size_t vsiz_;
   };
   /**
    * Scoped visitor.
@@ -2393,6 +3606,334 @@ class PlantDB : public BasicDB {
    private:
     Visitor* visitor_;                   ///< visitor
   };
+  /**
+   * Visitor wrapper to detect false positives of Bloom filters.
+   */
+  class FilterVisitor : public Visitor {
+   public:
+    /** constructor */
+    explicit FilterVisitor(Visitor* visitor) : visitor_(visitor), miss_(false) {
+      _assert_(visitor);
+    }
+    /** whether the record was missing */
+    bool miss() {
+      return miss_;
+    }
+   private:
+    /** visit a record */
+    const char* visit_full(const char* kbuf, size_t ksiz,
+                           const char* vbuf, size_t vsiz, size_t* sp) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && vbuf && vsiz <= MEMMAXSIZ && sp);
+      return visitor_->visit_full(kbuf, ksiz, vbuf, vsiz, sp);
+    }
+    /** visit an empty record */
+    const char* visit_empty(const char* kbuf, size_t ksiz, size_t* sp) {
+      _assert_(kbuf && ksiz <= MEMMAXSIZ && sp);
+      miss_ = true;
+      return visitor_->visit_empty(kbuf, ksiz, sp);
+    }
+    Visitor* visitor_;                   ///< visitor
+    bool miss_;                          ///< whether the record was missing
+  };
+  /**
+   * Prefetcher of leaf nodes.
+   */
+  class Prefetcher : public Thread {
+   public:
+    /** constructor */
+    explicit Prefetcher(PlantDB* db) : db_(db), lock_(), cond_(), ids_(), alive_(true) {
+      _assert_(db);
+    }
+    /** destructor */
+    ~Prefetcher() {
+      _assert_(true);
+      finish();
+    }
+    /** request loading of leaf nodes */
+    void push(int64_t id) {
+      _assert_(id > 0);
+      ScopedMutex lock(&lock_);
+      if (!alive_ || (int64_t)ids_.size() >= db_->pfdepth_) return;
+      ids_.push_back(id);
+      cond_.signal();
+    }
+    /** stop the thread and wait for it to exit */
+    void finish() {
+      _assert_(true);
+      lock_.lock();
+      bool alive = alive_;
+      alive_ = false;
+      cond_.signal();
+      lock_.unlock();
+      if (alive) join();
+    }
+   private:
+    /** perform the concrete process */
+    void run() {
+      _assert_(true);
+      while (true) {
+        lock_.lock();
+        while (alive_ && ids_.empty()) {
+          cond_.wait(&lock_);
+        }
+        if (!alive_) {
+          lock_.unlock();
+          break;
+        }
+        int64_t id = ids_.front();
+        ids_.pop_front();
+        lock_.unlock();
+        db_->prefetch_leaf_nodes(id);
+      }
+    }
+    PlantDB* db_;                        ///< database
+    Mutex lock_;                         ///< lock for the queue
+    CondVar cond_;                       ///< condition variable for the queue
+    std::deque<int64_t> ids_;            ///< queue of node IDs
+    bool alive_;                         ///< whether to be alive
+  };
+  /**
+   * Writer of dirty leaf nodes in background.
+   */
+  class Flusher : public Thread {
+   public:
+    /** constructor */
+    explicit Flusher(PlantDB* db) : db_(db), lock_(), cond_(), alive_(true) {
+      _assert_(db);
+    }
+    /** destructor */
+    ~Flusher() {
+      _assert_(true);
+      finish();
+    }
+    /** stop the thread and wait for it to exit */
+    void finish() {
+      _assert_(true);
+      lock_.lock();
+      bool alive = alive_;
+      alive_ = false;
+      cond_.signal();
+      lock_.unlock();
+      if (alive) join();
+    }
+   private:
+    /** perform the concrete process */
+    void run() {
+      _assert_(true);
+      while (true) {
+        lock_.lock();
+        if (alive_) cond_.wait(&lock_, WBWAIT / 1000.0);
+        if (!alive_) {
+          lock_.unlock();
+          break;
+        }
+        lock_.unlock();
+        db_->write_back_leaf_nodes();
+      }
+    }
+    PlantDB* db_;                        ///< database
+    Mutex lock_;                         ///< lock for the state
+    CondVar cond_;                       ///< condition variable for the state
+    bool alive_;                         ///< whether to be alive
+  };
+  /**
+   * Synchronizer of dirty nodes in background.
+   */
+  class Synchronizer : public Thread {
+   public:
+    /** constructor */
+    explicit Synchronizer(PlantDB* db) : db_(db), lock_(), cond_(), alive_(true) {
+      _assert_(db);
+    }
+    /** destructor */
+    ~Synchronizer() {
+      _assert_(true);
+      finish();
+    }
+    /** stop the thread and wait for it to exit */
+    void finish() {
+      _assert_(true);
+      lock_.lock();
+      bool alive = alive_;
+      alive_ = false;
+      cond_.signal();
+      lock_.unlock();
+      if (alive) join();
+    }
+   private:
+    /** perform the concrete process */
+    void run() {
+      _assert_(true);
+      while (true) {
+        lock_.lock();
+        if (alive_) cond_.wait(&lock_, db_->bsint_ / 1000000.0);
+        if (!alive_) {
+          lock_.unlock();
+          break;
+        }
+        lock_.unlock();
+        db_->synchronize_background();
+      }
+    }
+    PlantDB* db_;                        ///< database
+    Mutex lock_;                         ///< lock for the state
+    CondVar cond_;                       ///< condition variable for the state
+    bool alive_;                         ///< whether to be alive
+  };
+  /**
+   * Reader of serialized leaf nodes.
+   */
+  class LeafReader {
+   public:
+    /** constructor */
+    explicit LeafReader(const char* vbuf, size_t vsiz, bool fcode, Compressor* comp = NULL) :
+        rp_(vbuf), ep_(vbuf + vsiz), base_(NULL), fcode_(fcode), prev_(0), next_(0),
+        rnum_(0), key_(), zbuf_(NULL), ok_(false) {
+      _assert_(vbuf);
+      if (comp) {
+        size_t zsiz;
+        zbuf_ = comp->decompress(vbuf, vsiz, &zsiz);
+        if (!zbuf_) return;
+        rp_ = zbuf_;
+        ep_ = zbuf_ + zsiz;
+      }
+      size_t step = readvarnum(rp_, ep_ - rp_, &prev_);
+      if (step < 1) return;
+      rp_ += step;
+      step = readvarnum(rp_, ep_ - rp_, &next_);
+      if (step < 1) return;
+      rp_ += step;
+      if (fcode_) {
+        if (ep_ - rp_ < (int64_t)sizeof(uint32_t)) return;
+        ep_ -= sizeof(uint32_t);
+        rnum_ = readfixnum(ep_, sizeof(uint32_t));
+        if ((uint64_t)(ep_ - rp_) < rnum_ * sizeof(uint32_t)) return;
+        ep_ -= rnum_ * sizeof(uint32_t);
+        base_ = rp_;
+      }
+      ok_ = true;
+    }
+    /** destructor */
+    ~LeafReader() {
+      delete[] zbuf_;
+    }
+    /** whether the header is valid */
+    bool ok() {
+      return ok_;
+    }
+    /** the ID of the previous node */
+    int64_t prev() {
+      return prev_;
+    }
+    /** the ID of the next node */
+    int64_t next() {
+      return next_;
+    }
+    /** whether all records have been read */
+    bool done() {
+      return ok_ && rp_ == ep_;
+    }
+    /** read the next record */
+    bool read(const char** kbp, size_t* ksp, const char** vbp, size_t* vsp) {
+      _assert_(kbp && ksp && vbp && vsp);
+      if (!ok_) return false;
+      const char* rp = rp_;
+      size_t rsiz = ep_ - rp;
+      uint64_t shared = 0;
+      if (fcode_) {
+        if (rsiz < 1) return false;
+        size_t step = readvarnum(rp, rsiz, &shared);
+        if (step < 1 || shared > key_.size()) return false;
+        rp += step;
+        rsiz -= step;
+      } else if (rsiz < 2) {
+        return false;
+      }
+      uint64_t rksiz;
+      size_t step = readvarnum(rp, rsiz, &rksiz);
+      if (step < 1) return false;
+      rp += step;
+      rsiz -= step;
+      uint64_t rvsiz;
+      step = readvarnum(rp, rsiz, &rvsiz);
+      if (step < 1) return false;
+      rp += step;
+      rsiz -= step;
+      if (rsiz < rksiz + rvsiz) return false;
+      if (fcode_) {
+        key_.resize(shared);
+        key_.append(rp, rksiz);
+        *kbp = key_.data();
+        *ksp = key_.size();
+      } else {
+        *kbp = rp;
+        *ksp = rksiz;
+      }
+      rp += rksiz;
+      *vbp = rp;
+      *vsp = rvsiz;
+      rp_ = rp + rvsiz;
+      return true;
+    }
+    /** move to the last restart point whose key is not greater than the given key */
+    void seek(const RecordComparator* comp, const char* kbuf, size_t ksiz) {
+      _assert_(comp && kbuf);
+      if (!fcode_ || !ok_ || rnum_ < 1) return;
+      uint64_t lo = 0;
+      uint64_t hi = rnum_;
+      while (hi - lo > 1) {
+        uint64_t mid = (lo + hi) / 2;
+        const char* rp = restart(mid);
+        if (!rp) return;
+        size_t rsiz = ep_ - rp;
+        uint64_t shared, rksiz;
+        size_t step = readvarnum(rp, rsiz, &shared);
+        if (step < 1 || shared != 0) return;
+        rp += step;
+        rsiz -= step;
+        step = readvarnum(rp, rsiz, &rksiz);
+        if (step < 1) return;
+        rp += step;
+        rsiz -= step;
+        uint64_t rvsiz;
+        step = readvarnum(rp, rsiz, &rvsiz);
+        if (step < 1) return;
+        rp += step;
+        rsiz -= step;
+        if (rsiz < rksiz) return;
+        if (comp->compare(rp, rksiz, kbuf, ksiz) > 0) {
+          hi = mid;
+        } else {
+          lo = mid;
+        }
+      }
+      const char* rp = restart(lo);
+      if (!rp) return;
+      rp_ = rp;
+      key_.clear();
+    }
+   private:
+    /** Dummy constructor to forbid the use. */
+    LeafReader(const LeafReader&);
+    /** Dummy Operator to forbid the use. */
+    LeafReader& operator =(const LeafReader&);
+    /** get the position of a restart point */
+    const char* restart(uint64_t idx) {
+      uint64_t off = readfixnum(ep_ + idx * sizeof(uint32_t), sizeof(uint32_t));
+      if (off > (uint64_t)(ep_ - base_)) return NULL;
+      return base_ + off;
+    }
+    const char* rp_;                     ///< reading pointer
+    const char* ep_;                     ///< end of the records
+    const char* base_;                   ///< beginning of the records
+    bool fcode_;                         ///< whether front-coded
+    uint64_t prev_;                      ///< ID of the previous node
+    uint64_t next_;                      ///< ID of the next node
+    uint64_t rnum_;                      ///< number of restart points
+    std::string key_;                    ///< decoded key
+    char* zbuf_;                         ///< decompressed image
+    bool ok_;                            ///< whether the header is valid
+  };
   /**
    * Open the leaf cache.
    */
@@ -2404,8 +3945,129 @@ class PlantDB : public BasicDB {
     for (int32_t i = 0; i < SLOTNUM; i++) {
       lslots_[i].hot = new LeafCache(bnum);
       lslots_[i].warm = new LeafCache(bnum);
+      lslots_[i].cold = new LeafCache(INT8MAX);
+      lslots_[i].ghost = new NodeHistory(bnum);
+      lslots_[i].filters = new FilterMap;
+      lslots_[i].images = new ImageCache(bnum);
+      lslots_[i].imsize = 0;
+      lslots_[i].count.set(0);
+      lslots_[i].hits = 0;
+      lslots_[i].misses = 0;
+      lslots_[i].evicts = 0;
+      lslots_[i].imhits = 0;
+    }
+  }
+  /**
+   * Load leaf nodes following a leaf node into the leaf cache.
+   * @param id the ID of the first leaf node to be loaded.
+   */
+  void prefetch_leaf_nodes(int64_t id) {
+    _assert_(true);
+    ScopedRWLock lock(&mlock_, false);
+    if (omode_ == 0) return;
+    for (int32_t i = 0; i < pfdepth_ && id > 0 && cusage_ <= pclimit_; i++) {
+      LeafNode* node = load_leaf_node(id, false, true);
+      if (!node) break;
+      node->lock.lock_reader();
+      id = node->next;
+      node->lock.unlock();
     }
   }
+  /**
+   * Set the usages of the page cache at which nodes are evicted.
+   */
+  void set_cache_marks() {
+    _assert_(true);
+    pclimit_ = pccap_ / 100 * wbhigh_ + pccap_ % 100 * wbhigh_ / 100;
+    pcwbmark_ = wblow_ > 0 ? pccap_ / 100 * wblow_ + pccap_ % 100 * wblow_ / 100 : 0;
+  }
+  /**
+   * Write back dirty leaf nodes and evict them while the page cache is over the low watermark.
+   */
+  void write_back_leaf_nodes() {
+    _assert_(true);
+    bool err = false;
+    mlock_.lock_reader();
+    if (omode_ == 0 || pcwbmark_ < 1 || cusage_ <= pcwbmark_) {
+      mlock_.unlock();
+      return;
+    }
+    for (int32_t i = 0; i < SLOTNUM; i++) {
+      if (!clean_leaf_cache_part(lslots_ + i, WBBATCH)) err = true;
+    }
+    mlock_.unlock();
+    mlock_.lock_writer();
+    int32_t num = SLOTNUM * WBBATCH;
+    while (omode_ != 0 && pcwbmark_ > 0 && cusage_ > pcwbmark_ && num-- > 0) {
+      int64_t usage = cusage_;
+      if (!flush_cache_part()) err = true;
+      if (cusage_ >= usage) break;
+    }
+    mlock_.unlock();
+    if (err) report(_KCCODELINE_, Logger::WARN, "writing back leaf nodes failed");
+  }
+  /**
+   * Save dirty nodes and the meta data by the background synchronizer.
+   */
+  void synchronize_background() {
+    _assert_(true);
+    bool err = false;
+    mlock_.lock_reader();
+    if (omode_ == 0 || tran_) {
+      mlock_.unlock();
+      return;
+    }
+    if (!clean_leaf_cache()) err = true;
+    if (!clean_inner_cache()) err = true;
+    mlock_.unlock();
+    mlock_.lock_writer();
+    if (omode_ != 0 && !tran_ && !dump_meta()) err = true;
+    mlock_.unlock();
+    if (err) report(_KCCODELINE_, Logger::WARN, "background synchronization failed");
+  }
+  /**
+   * Flush a part of the page cache.
+   * @return true on success, or false on failure.
+   * @note The slot holding the most nodes is chosen so that a slot which is rarely accessed is
+   * not drained while the others keep growing.
+   */
+  bool flush_cache_part() {
+    _assert_(true);
+    bool err = false;
+    if (!flush_leaf_cache_part(lslots_ + select_leaf_slot())) err = true;
+    int32_t iidx = 0;
+    int64_t imax = -1;
+    for (int32_t i = 0; i < SLOTNUM; i++) {
+      LeafSlot* lslot = lslots_ + i;
+      InnerSlot* islot = islots_ + i;
+      int64_t icnt = (int64_t)islot->warm->count() -
+        (int64_t)(lslot->warm->count() + lslot->hot->count() + lslot->cold->count());
+      if (icnt > imax) {
+        iidx = i;
+        imax = icnt;
+      }
+    }
+    if (imax > 1 && !flush_inner_cache_part(islots_ + iidx)) err = true;
+    return !err;
+  }
+  /**
+   * Select the slot of the leaf cache holding the most nodes.
+   * @return the index of the slot.
+   * @note The counters are read without locking the slots, so the choice may be slightly stale.
+   */
+  int32_t select_leaf_slot() {
+    _assert_(true);
+    int32_t idx = 0;
+    int64_t max = -1;
+    for (int32_t i = 0; i < SLOTNUM; i++) {
+      int64_t cnt = lslots_[i].count.get();
+      if (cnt > max) {
+        idx = i;
+        max = cnt;
+      }
+    }
+    return idx;
+  }
   /**
    * Close the leaf cache.
    */
@@ -2413,6 +4075,10 @@ class PlantDB : public BasicDB {
     _assert_(true);
     for (int32_t i = SLOTNUM - 1; i >= 0; i--) {
       LeafSlot* slot = lslots_ + i;
+      delete slot->images;
+      delete slot->filters;
+      delete slot->ghost;
+      delete slot->cold;
       delete slot->warm;
       delete slot->hot;
     }
@@ -2441,6 +4107,18 @@ class PlantDB : public BasicDB {
         ++it;
         if (!flush_leaf_node(node, save)) err = true;
       }
+      it = slot->cold->begin();
+      itend = slot->cold->end();
+      while (it != itend) {
+        LeafNode* node = it.value();
+        ++it;
+        if (!flush_leaf_node(node, save)) err = true;
+      }
+      slot->ghost->clear();
+      slot->imlock.lock();
+      slot->images->clear();
+      slot->imsize = 0;
+      slot->imlock.unlock();
     }
     return !err;
   }
@@ -2452,12 +4130,26 @@ class PlantDB : public BasicDB {
   bool flush_leaf_cache_part(LeafSlot* slot) {
     _assert_(slot);
     bool err = false;
-    if (slot->warm->count() > 0) {
+    if (slot->cold->count() > 1) {
+      LeafNode* node = slot->cold->first_value();
+      if (!flush_leaf_node(node, true)) err = true;
+      slot->evicts++;
+    } else if (slot->warm->count() > 0) {
       LeafNode* node = slot->warm->first_value();
+      int64_t id = node->id;
       if (!flush_leaf_node(node, true)) err = true;
+      slot->ghost->set(id, true, NodeHistory::MLAST);
+      if ((int64_t)slot->ghost->count() > pccap_ / psiz_ / SLOTNUM / 2 + 1)
+        slot->ghost->remove(slot->ghost->first_key());
+      slot->evicts++;
     } else if (slot->hot->count() > 0) {
       LeafNode* node = slot->hot->first_value();
       if (!flush_leaf_node(node, true)) err = true;
+      slot->evicts++;
+    } else if (slot->cold->count() > 0) {
+      LeafNode* node = slot->cold->first_value();
+      if (!flush_leaf_node(node, true)) err = true;
+      slot->evicts++;
     }
     return !err;
   }
@@ -2485,24 +4177,40 @@ class PlantDB : public BasicDB {
         if (!save_leaf_node(node)) err = true;
         ++it;
       }
+      it = slot->cold->begin();
+      itend = slot->cold->end();
+      while (it != itend) {
+        LeafNode* node = it.value();
+        if (!save_leaf_node(node)) err = true;
+        ++it;
+      }
     }
     return !err;
   }
   /**
    * Clean a part of the leaf cache.
    * @param slot a slot of leaf nodes.
+   * @param num the number of nodes to be saved in the order of eviction.
    * @return true on success, or false on failure.
    */
-  bool clean_leaf_cache_part(LeafSlot* slot) {
-    _assert_(slot);
+  bool clean_leaf_cache_part(LeafSlot* slot, int32_t num = 1) {
+    _assert_(slot && num >= 0);
     bool err = false;
     ScopedMutex lock(&slot->lock);
-    if (slot->warm->count() > 0) {
-      LeafNode* node = slot->warm->first_value();
-      if (!save_leaf_node(node)) err = true;
-    } else if (slot->hot->count() > 0) {
-      LeafNode* node = slot->hot->first_value();
-      if (!save_leaf_node(node)) err = true;
+    LeafCache* caches[3];
+    int32_t cnum = 0;
+    if (slot->cold->count() > 1) caches[cnum++] = slot->cold;
+    caches[cnum++] = slot->warm;
+    caches[cnum++] = slot->hot;
+    for (int32_t i = 0; i < cnum && num > 0; i++) {
+      typename LeafCache::Iterator it = caches[i]->begin();
+      typename LeafCache::Iterator itend = caches[i]->end();
+      while (it != itend && num > 0) {
+        LeafNode* node = it.value();
+        if (!save_leaf_node(node)) err = true;
+        num--;
+        ++it;
+      }
     }
     return !err;
   }
@@ -2521,12 +4229,15 @@ class PlantDB : public BasicDB {
     node->prev = prev;
     node->next = next;
     node->hot = false;
+    node->cold = false;
     node->dirty = true;
     node->dead = false;
     int32_t sidx = node->id % SLOTNUM;
     LeafSlot* slot = lslots_ + sidx;
+    ScopedMutex lock(&slot->lock);
     slot->warm->set(node->id, node, LeafCache::MLAST);
-    cusage_ += node->size;
+    slot->count += 1;
+    cusage_ += calc_leaf_node_usage(node);
     return node;
   }
   /**
@@ -2539,6 +4250,7 @@ class PlantDB : public BasicDB {
     _assert_(node);
     bool err = false;
     if (save && !save_leaf_node(node)) err = true;
+    if (bfon_ && !node->dead && !node->dirty && !store_leaf_filter(node, false)) err = true;
     typename RecordArray::const_iterator rit = node->recs.begin();
     typename RecordArray::const_iterator ritend = node->recs.end();
     while (rit != ritend) {
@@ -2548,15 +4260,56 @@ class PlantDB : public BasicDB {
     }
     int32_t sidx = node->id % SLOTNUM;
     LeafSlot* slot = lslots_ + sidx;
+    if (node->dirty && zccap_ > 0) remove_leaf_image(slot, node->id);
     if (node->hot) {
       slot->hot->remove(node->id);
+    } else if (node->cold) {
+      slot->cold->remove(node->id);
     } else {
       slot->warm->remove(node->id);
     }
-    cusage_ -= node->size;
+    slot->count -= 1;
+    cusage_ -= calc_leaf_node_usage(node);
     delete node;
     return !err;
   }
+  /**
+   * Keep the stored image of a leaf node in the cache of images.
+   * @param slot the slot of the leaf node.
+   * @param id the ID number of the leaf node.
+   * @param buf the pointer to the stored image.
+   * @param size the size of the stored image.
+   */
+  void store_leaf_image(LeafSlot* slot, int64_t id, const char* buf, size_t size) {
+    _assert_(slot && id > 0 && buf);
+    ScopedMutex lock(&slot->imlock);
+    std::string* image = slot->images->get(id, ImageCache::MCURRENT);
+    if (image) {
+      slot->imsize -= image->size();
+      slot->images->remove(id);
+    }
+    int64_t limit = zccap_ / SLOTNUM;
+    if ((int64_t)size > limit) return;
+    slot->images->set(id, std::string(buf, size), ImageCache::MLAST);
+    slot->imsize += size;
+    while (slot->imsize > limit) {
+      slot->imsize -= slot->images->first_value().size();
+      slot->images->remove(slot->images->first_key());
+    }
+  }
+  /**
+   * Remove the stored image of a leaf node from the cache of images.
+   * @param slot the slot of the leaf node.
+   * @param id the ID number of the leaf node.
+   */
+  void remove_leaf_image(LeafSlot* slot, int64_t id) {
+    _assert_(slot && id > 0);
+    ScopedMutex lock(&slot->imlock);
+    std::string* image = slot->images->get(id, ImageCache::MCURRENT);
+    if (!image) return;
+    slot->imsize -= image->size();
+    slot->images->remove(id);
+  }
   /**
    * Save a leaf node.
    * @param node the leaf node.
@@ -2570,7 +4323,52 @@ class PlantDB : public BasicDB {
     char hbuf[NUMBUFSIZ];
     size_t hsiz = write_key(hbuf, LNPREFIX, node->id);
     if (node->dead) {
+      if (zccap_ > 0) remove_leaf_image(lslots_ + node->id % SLOTNUM, node->id);
       if (!db_.remove(hbuf, hsiz) && db_.error().code() != Error::NOREC) err = true;
+    } else if (rsint_ > 0) {
+      size_t rnum = node->recs.size();
+      char* rbuf = new char[node->size + rnum * sizeof(uint32_t) * 3 + NUMBUFSIZ];
+      char* wp = rbuf;
+      wp += writevarnum(wp, node->prev);
+      wp += writevarnum(wp, node->next);
+      char* base = wp;
+      std::vector<uint32_t> rsts;
+      rsts.reserve(rnum / rsint_ + 1);
+      const char* pkbuf = NULL;
+      size_t pksiz = 0;
+      for (size_t i = 0; i < rnum; i++) {
+        Record* rec = node->recs[i];
+        char* dbuf = (char*)rec + sizeof(*rec);
+        size_t shared = 0;
+        if (i % rsint_ == 0) {
+          rsts.push_back(wp - base);
+        } else {
+          size_t msiz = pksiz < rec->ksiz ? pksiz : rec->ksiz;
+          while (shared < msiz && pkbuf[shared] == dbuf[shared]) {
+            shared++;
+          }
+        }
+        wp += writevarnum(wp, shared);
+        wp += writevarnum(wp, rec->ksiz - shared);
+        wp += writevarnum(wp, rec->vsiz);
+        std::memcpy(wp, dbuf + shared, rec->ksiz - shared);
+        wp += rec->ksiz - shared;
+        std::memcpy(wp, dbuf + rec->ksiz, rec->vsiz);
+        wp += rec->vsiz;
+        pkbuf = dbuf;
+        pksiz = rec->ksiz;
+      }
+      std::vector<uint32_t>::const_iterator it = rsts.begin();
+      std::vector<uint32_t>::const_iterator itend = rsts.end();
+      while (it != itend) {
+        writefixnum(wp, *it, sizeof(uint32_t));
+        wp += sizeof(uint32_t);
+        ++it;
+      }
+      writefixnum(wp, rsts.size(), sizeof(uint32_t));
+      wp += sizeof(uint32_t);
+      if (!write_leaf_image(node, hbuf, hsiz, rbuf, wp - rbuf)) err = true;
+      delete[] rbuf;
     } else {
       char* rbuf = new char[node->size];
       char* wp = rbuf;
@@ -2589,116 +4387,390 @@ class PlantDB : public BasicDB {
         wp += rec->vsiz;
         ++rit;
       }
-      if (!db_.set(hbuf, hsiz, rbuf, wp - rbuf)) err = true;
+      if (!write_leaf_image(node, hbuf, hsiz, rbuf, wp - rbuf)) err = true;
       delete[] rbuf;
     }
+    if (node->dead) {
+      if ((bfon_ || bfgen_ > 0) && !remove_leaf_filter(node->id)) err = true;
+    } else if (bfon_ && !store_leaf_filter(node, true)) {
+      err = true;
+    }
     node->dirty = false;
     return !err;
   }
+  /**
+   * Write the serialized image of a leaf node.
+   * @param node the leaf node.
+   * @param hbuf the key of the node.
+   * @param hsiz the size of the key.
+   * @param rbuf the serialized image.
+   * @param rsiz the size of the serialized image.
+   * @return true on success, or false on failure.
+   * @note The written image replaces the one in the cache of images.
+   */
+  bool write_leaf_image(LeafNode* node, const char* hbuf, size_t hsiz,
+                        const char* rbuf, size_t rsiz) {
+    _assert_(node && hbuf && rbuf);
+    char* zbuf = NULL;
+    if (pcomp_) {
+      size_t zsiz;
+      zbuf = pcomp_->compress(rbuf, rsiz, &zsiz);
+      if (!zbuf) {
+        set_error(_KCCODELINE_, Error::SYSTEM, "page compression failed");
+        return false;
+      }
+      rbuf = zbuf;
+      rsiz = zsiz;
+    }
+    bool err = false;
+    if (!db_.set(hbuf, hsiz, rbuf, rsiz)) err = true;
+    if (zccap_ > 0) {
+      LeafSlot* slot = lslots_ + node->id % SLOTNUM;
+      if (err) {
+        remove_leaf_image(slot, node->id);
+      } else {
+        store_leaf_image(slot, node->id, rbuf, rsiz);
+      }
+    }
+    delete[] zbuf;
+    return !err;
+  }
   /**
    * Load a leaf node.
    * @param id the ID number of the leaf node.
    * @param prom whether to promote the warm cache.
+   * @param scan whether the node is visited by a sequential scan.
    * @return the loaded leaf node.
+   * @note A node loaded by a scan is kept in the cold cache, which is evicted first, and a scan
+   * does not refresh the recency of nodes in the other caches.  A node which is missed again
+   * soon after eviction from the warm cache is loaded into the hot cache directly.
+   */
+  LeafNode* load_leaf_node(int64_t id, bool prom, bool scan = false) {
+    _assert_(id > 0);
+    int32_t sidx = id % SLOTNUM;
+    LeafSlot* slot = lslots_ + sidx;
+    ScopedMutex lock(&slot->lock);
+    typename LeafCache::MoveMode mmode = scan ? LeafCache::MCURRENT : LeafCache::MLAST;
+    LeafNode** np = slot->hot->get(id, mmode);
+    if (np) {
+      slot->hits++;
+      return *np;
+    }
+    if (prom) {
+      if (slot->hot->count() * WARMRATIO > slot->warm->count() + WARMRATIO) {
+        slot->hot->first_value()->hot = false;
+        slot->hot->migrate(slot->hot->first_key(), slot->warm, LeafCache::MLAST);
+      }
+      np = slot->warm->migrate(id, slot->hot, LeafCache::MLAST);
+      if (!np) np = slot->cold->migrate(id, slot->hot, LeafCache::MLAST);
+      if (np) {
+        (*np)->hot = true;
+        (*np)->cold = false;
+        slot->hits++;
+        return *np;
+      }
+    } else {
+      np = slot->warm->get(id, mmode);
+      if (!np) {
+        if (scan) {
+          np = slot->cold->get(id, LeafCache::MLAST);
+        } else {
+          np = slot->cold->migrate(id, slot->warm, LeafCache::MLAST);
+          if (np) (*np)->cold = false;
+        }
+      }
+      if (np) {
+        slot->hits++;
+        return *np;
+      }
+    }
+    slot->misses++;
+    LeafNode* node = NULL;
+    if (zccap_ > 0) {
+      ScopedMutex imlock(&slot->imlock);
+      std::string* image =
+          slot->images->get(id, scan ? ImageCache::MCURRENT : ImageCache::MLAST);
+      if (image) {
+        node = read_leaf_node(image->data(), image->size());
+        if (node) slot->imhits++;
+      }
+    }
+    if (!node) {
+      char hbuf[NUMBUFSIZ];
+      size_t hsiz = write_key(hbuf, LNPREFIX, id);
+      class VisitorImpl : public DB::Visitor {
+       public:
+        explicit VisitorImpl(PlantDB* db, LeafSlot* slot, int64_t id, bool keep) :
+            db_(db), slot_(slot), id_(id), keep_(keep), node_(NULL) {}
+        LeafNode* pop() {
+          return node_;
+        }
+       private:
+        const char* visit_full(const char* kbuf, size_t ksiz,
+                               const char* vbuf, size_t vsiz, size_t* sp) {
+          node_ = db_->read_leaf_node(vbuf, vsiz);
+          if (node_ && keep_) db_->store_leaf_image(slot_, id_, vbuf, vsiz);
+          return NOP;
+        }
+        PlantDB* db_;
+        LeafSlot* slot_;
+        int64_t id_;
+        bool keep_;
+        LeafNode* node_;
+      } visitor(this, slot, id, zccap_ > 0 && !scan);
+      if (!db_.accept(hbuf, hsiz, &visitor, false)) return NULL;
+      node = visitor.pop();
+      if (!node) return NULL;
+    }
+    node->id = id;
+    node->hot = false;
+    node->cold = scan;
+    node->dirty = false;
+    node->dead = false;
+    if (scan) {
+      slot->cold->set(id, node, LeafCache::MLAST);
+    } else if (slot->ghost->remove(id)) {
+      node->hot = true;
+      slot->hot->set(id, node, LeafCache::MLAST);
+    } else {
+      slot->warm->set(id, node, LeafCache::MLAST);
+    }
+    slot->count += 1;
+    cusage_ += calc_leaf_node_usage(node);
+    return node;
+  }
+  /**
+   * Deserialize the stored image of a leaf node.
+   * @param vbuf the pointer to the stored image.
+   * @param vsiz the size of the stored image.
+   * @return the deserialized leaf node, or NULL on failure.
+   * @note The node is not registered in the cache and its ID is not set.
+   */
+  LeafNode* read_leaf_node(const char* vbuf, size_t vsiz) {
+    _assert_(vbuf);
+    LeafReader reader(vbuf, vsiz, rsint_ > 0, pcomp_);
+    if (!reader.ok()) return NULL;
+    LeafNode* node = new LeafNode;
+    node->size = sizeof(int32_t) * 2;
+    node->prev = reader.prev();
+    node->next = reader.next();
+    const char* rkbuf;
+    size_t rksiz;
+    const char* rvbuf;
+    size_t rvsiz;
+    while (reader.read(&rkbuf, &rksiz, &rvbuf, &rvsiz)) {
+      size_t rsiz = sizeof(Record) + rksiz + rvsiz;
+      Record* rec = (Record*)xmalloc(rsiz);
+      rec->ksiz = rksiz;
+      rec->vsiz = rvsiz;
+      char* dbuf = (char*)rec + sizeof(*rec);
+      std::memcpy(dbuf, rkbuf, rksiz);
+      std::memcpy(dbuf + rksiz, rvbuf, rvsiz);
+      node->recs.push_back(rec);
+      node->size += rsiz;
+    }
+    if (!reader.done()) {
+      typename RecordArray::const_iterator rit = node->recs.begin();
+      typename RecordArray::const_iterator ritend = node->recs.end();
+      while (rit != ritend) {
+        Record* rec = *rit;
+        xfree(rec);
+        ++rit;
+      }
+      delete node;
+      return NULL;
+    }
+    return node;
+  }
+  /**
+   * Accept a visitor to a record in a stored leaf node without loading it into the cache.
+   * @param id the ID number of the leaf node.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @param visitor a visitor object.
+   * @return 1 on success, 0 on failure, or -1 if the node is cached or cannot be searched.
+   * @note The slot lock is held while the stored page is read so that the node is not loaded
+   * and modified in the meantime.
    */
-  LeafNode* load_leaf_node(int64_t id, bool prom) {
-    _assert_(id > 0);
+  int32_t peek_leaf_node(int64_t id, const char* kbuf, size_t ksiz, Visitor* visitor) {
+    _assert_(id > 0 && kbuf && ksiz <= MEMMAXSIZ && visitor);
     int32_t sidx = id % SLOTNUM;
     LeafSlot* slot = lslots_ + sidx;
     ScopedMutex lock(&slot->lock);
-    LeafNode** np = slot->hot->get(id, LeafCache::MLAST);
-    if (np) return *np;
-    if (prom) {
-      if (slot->hot->count() * WARMRATIO > slot->warm->count() + WARMRATIO) {
-        slot->hot->first_value()->hot = false;
-        slot->hot->migrate(slot->hot->first_key(), slot->warm, LeafCache::MLAST);
-      }
-      np = slot->warm->migrate(id, slot->hot, LeafCache::MLAST);
-      if (np) {
-        (*np)->hot = true;
-        return *np;
-      }
-    } else {
-      LeafNode** np = slot->warm->get(id, LeafCache::MLAST);
-      if (np) return *np;
-    }
+    if (slot->hot->get(id, LeafCache::MCURRENT) || slot->warm->get(id, LeafCache::MCURRENT) ||
+        slot->cold->get(id, LeafCache::MCURRENT)) return -1;
     char hbuf[NUMBUFSIZ];
     size_t hsiz = write_key(hbuf, LNPREFIX, id);
     class VisitorImpl : public DB::Visitor {
      public:
-      explicit VisitorImpl() : node_(NULL) {}
-      LeafNode* pop() {
-        return node_;
+      explicit VisitorImpl(const RecordComparator* comp, Compressor* pcomp,
+                           const char* kbuf, size_t ksiz, Visitor* visitor) :
+          comp_(comp), pcomp_(pcomp), kbuf_(kbuf), ksiz_(ksiz), visitor_(visitor),
+          found_(false) {}
+      bool found() {
+        return found_;
       }
      private:
       const char* visit_full(const char* kbuf, size_t ksiz,
                              const char* vbuf, size_t vsiz, size_t* sp) {
-        uint64_t prev;
-        size_t step = readvarnum(vbuf, vsiz, &prev);
-        if (step < 1) return NOP;
-        vbuf += step;
-        vsiz -= step;
-        uint64_t next;
-        step = readvarnum(vbuf, vsiz, &next);
-        if (step < 1) return NOP;
-        vbuf += step;
-        vsiz -= step;
-        LeafNode* node = new LeafNode;
-        node->size = sizeof(int32_t) * 2;
-        node->prev = prev;
-        node->next = next;
-        while (vsiz > 1) {
-          uint64_t rksiz;
-          step = readvarnum(vbuf, vsiz, &rksiz);
-          if (step < 1) break;
-          vbuf += step;
-          vsiz -= step;
-          uint64_t rvsiz;
-          step = readvarnum(vbuf, vsiz, &rvsiz);
-          if (step < 1) break;
-          vbuf += step;
-          vsiz -= step;
-          if (vsiz < rksiz + rvsiz) break;
-          size_t rsiz = sizeof(Record) + rksiz + rvsiz;
-          Record* rec = (Record*)xmalloc(rsiz);
-          rec->ksiz = rksiz;
-          rec->vsiz = rvsiz;
-          char* dbuf = (char*)rec + sizeof(*rec);
-          std::memcpy(dbuf, vbuf, rksiz);
-          vbuf += rksiz;
-          vsiz -= rksiz;
-          std::memcpy(dbuf + rksiz, vbuf, rvsiz);
-          vbuf += rvsiz;
-          vsiz -= rvsiz;
-          node->recs.push_back(rec);
-          node->size += rsiz;
-        }
-        if (vsiz != 0) {
-          typename RecordArray::const_iterator rit = node->recs.begin();
-          typename RecordArray::const_iterator ritend = node->recs.end();
-          while (rit != ritend) {
-            Record* rec = *rit;
-            xfree(rec);
-            ++rit;
+        LeafReader reader(vbuf, vsiz, true, pcomp_);
+        if (!reader.ok()) return NOP;
+        found_ = true;
+        reader.seek(comp_, kbuf_, ksiz_);
+        const char* rkbuf;
+        size_t rksiz;
+        const char* rvbuf;
+        size_t rvsiz;
+        while (reader.read(&rkbuf, &rksiz, &rvbuf, &rvsiz)) {
+          int32_t rv = comp_->compare(rkbuf, rksiz, kbuf_, ksiz_);
+          if (rv < 0) continue;
+          if (rv == 0) {
+            size_t xvsiz;
+            visitor_->visit_full(rkbuf, rksiz, rvbuf, rvsiz, &xvsiz);
+            return NOP;
           }
-          delete node;
-          return NOP;
+          break;
         }
-        node_ = node;
+        size_t xvsiz;
+        visitor_->visit_empty(kbuf_, ksiz_, &xvsiz);
         return NOP;
       }
-      LeafNode* node_;
-    } visitor;
-    if (!db_.accept(hbuf, hsiz, &visitor, false)) return NULL;
-    LeafNode* node = visitor.pop();
-    if (!node) return NULL;
-    node->id = id;
-    node->hot = false;
-    node->dirty = false;
-    node->dead = false;
-    slot->warm->set(id, node, LeafCache::MLAST);
-    cusage_ += node->size;
-    return node;
+      const RecordComparator* comp_;
+      Compressor* pcomp_;
+      const char* kbuf_;
+      size_t ksiz_;
+      Visitor* visitor_;
+      bool found_;
+    } pvisitor(&reccomp_, pcomp_, kbuf, ksiz, visitor);
+    if (!db_.accept(hbuf, hsiz, &pvisitor, false)) return 0;
+    return pvisitor.found() ? 1 : -1;
+  }
+  /**
+   * Check a key with the Bloom filter of a stored leaf node.
+   * @param id the ID number of the leaf node.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @param visitor a visitor object.
+   * @return 1 if the key is missing and the visitor has been called, 0 if the key may exist,
+   * or -1 if the node is cached or has no valid filter.
+   */
+  int32_t check_leaf_filter(int64_t id, const char* kbuf, size_t ksiz, Visitor* visitor) {
+    _assert_(id > 0 && kbuf && ksiz <= MEMMAXSIZ && visitor);
+    int32_t sidx = id % SLOTNUM;
+    LeafSlot* slot = lslots_ + sidx;
+    ScopedMutex lock(&slot->lock);
+    if (slot->hot->get(id, LeafCache::MCURRENT) || slot->warm->get(id, LeafCache::MCURRENT) ||
+        slot->cold->get(id, LeafCache::MCURRENT)) return -1;
+    FilterMap::iterator it = slot->filters->find(id);
+    if (it == slot->filters->end()) {
+      std::string filter;
+      char hbuf[NUMBUFSIZ];
+      size_t hsiz = write_key(hbuf, BFPREFIX, id);
+      size_t vsiz;
+      char* vbuf = db_.get(hbuf, hsiz, &vsiz);
+      if (vbuf) {
+        uint64_t gen;
+        size_t step = readvarnum(vbuf, vsiz, &gen);
+        if (step > 0 && gen == bfgen_ && vsiz > step + 1) filter.append(vbuf + step, vsiz - step);
+        delete[] vbuf;
+      }
+      it = slot->filters->insert(std::make_pair(id, filter)).first;
+    }
+    const std::string& filter = it->second;
+    if (filter.empty()) return -1;
+    bfcheck_ += 1;
+    uint64_t hash = hashmurmur(kbuf, ksiz);
+    uint32_t hone = (uint32_t)hash;
+    uint32_t htwo = (uint32_t)(hash >> 32) | 1;
+    const uint8_t* bits = (const uint8_t*)filter.data() + 1;
+    uint32_t nbits = (filter.size() - 1) * 8;
+    int32_t hnum = *(uint8_t*)filter.data();
+    for (int32_t i = 0; i < hnum; i++) {
+      uint32_t pos = (hone + (uint32_t)i * htwo) % nbits;
+      if (!(bits[pos>>3] & (1 << (pos & 7)))) {
+        bfreject_ += 1;
+        size_t vsiz;
+        visitor->visit_empty(kbuf, ksiz, &vsiz);
+        return 1;
+      }
+    }
+    return 0;
+  }
+  /**
+   * Build the Bloom filter of a leaf node.
+   * @param node the leaf node.
+   * @param filter the string to store the filter.
+   */
+  void build_leaf_filter(LeafNode* node, std::string* filter) {
+    _assert_(node && filter);
+    const RecordArray& recs = node->recs;
+    int32_t hnum = bfbits_ * 69 / 100;
+    if (hnum < 1) hnum = 1;
+    if (hnum > BFHNUMMAX) hnum = BFHNUMMAX;
+    size_t size = (recs.size() * bfbits_ + 7) / 8;
+    if (size < sizeof(uint64_t)) size = sizeof(uint64_t);
+    filter->clear();
+    filter->resize(size + 1, 0);
+    (*filter)[0] = hnum;
+    uint8_t* bits = (uint8_t*)&(*filter)[1];
+    uint32_t nbits = size * 8;
+    typename RecordArray::const_iterator rit = recs.begin();
+    typename RecordArray::const_iterator ritend = recs.end();
+    while (rit != ritend) {
+      Record* rec = *rit;
+      uint64_t hash = hashmurmur((char*)rec + sizeof(*rec), rec->ksiz);
+      uint32_t hone = (uint32_t)hash;
+      uint32_t htwo = (uint32_t)(hash >> 32) | 1;
+      for (int32_t i = 0; i < hnum; i++) {
+        uint32_t pos = (hone + (uint32_t)i * htwo) % nbits;
+        bits[pos>>3] |= 1 << (pos & 7);
+      }
+      ++rit;
+    }
+  }
+  /**
+   * Store the Bloom filter of a leaf node.
+   * @param node the leaf node.
+   * @param force true to rebuild the filter even if a valid one exists.
+   * @return true on success, or false on failure.
+   * @note The caller must hold the lock of the slot of the node or the exclusive lock of the
+   * database.
+   */
+  bool store_leaf_filter(LeafNode* node, bool force) {
+    _assert_(node);
+    FilterMap* filters = lslots_[node->id%SLOTNUM].filters;
+    std::string& filter = (*filters)[node->id];
+    if (!force && !filter.empty()) return true;
+    build_leaf_filter(node, &filter);
+    if (!writer_) return true;
+    char hbuf[NUMBUFSIZ];
+    size_t hsiz = write_key(hbuf, BFPREFIX, node->id);
+    char nbuf[NUMBUFSIZ];
+    size_t nsiz = writevarnum(nbuf, bfgen_);
+    std::string value(nbuf, nsiz);
+    value.append(filter);
+    return db_.set(hbuf, hsiz, value.data(), value.size());
+  }
+  /**
+   * Remove the Bloom filter of a leaf node.
+   * @param id the ID number of the leaf node.
+   * @return true on success, or false on failure.
+   */
+  bool remove_leaf_filter(int64_t id) {
+    _assert_(id > 0);
+    lslots_[id%SLOTNUM].filters->erase(id);
+    char hbuf[NUMBUFSIZ];
+    size_t hsiz = write_key(hbuf, BFPREFIX, id);
+    return db_.remove(hbuf, hsiz) || db_.error().code() == Error::NOREC;
+  }
+  /**
+   * Discard the Bloom filters kept in memory.
+   */
+  void clear_leaf_filters() {
+    _assert_(true);
+    for (int32_t i = 0; i < SLOTNUM; i++) {
+      lslots_[i].filters->clear();
+    }
   }
   /**
    * Check whether a record is in the range of a leaf node.
@@ -2726,17 +4798,19 @@ class PlantDB : public BasicDB {
     bool reorg = false;
     RecordArray& recs = node->recs;
     typename RecordArray::iterator ritend = recs.end();
-    typename RecordArray::iterator rit = std::lower_bound(recs.begin(), ritend, rec, reccomp_);
+    typename RecordArray::iterator rit = recs.lower_bound(rec, reccomp_);
     if (rit != ritend && !reccomp_(rec, *rit)) {
       Record* rec = *rit;
       char* kbuf = (char*)rec + sizeof(*rec);
       size_t ksiz = rec->ksiz;
       size_t vsiz;
       const char* vbuf = visitor->visit_full(kbuf, ksiz, kbuf + ksiz, rec->vsiz, &vsiz);
+      if (vbuf != Visitor::NOP && !snaps_.empty())
+        record_snapshots(kbuf, ksiz, kbuf + ksiz, rec->vsiz);
       if (vbuf == Visitor::REMOVE) {
         size_t rsiz = sizeof(*rec) + rec->ksiz + rec->vsiz;
         count_ -= 1;
-        cusage_ -= rsiz;
+        cusage_ -= rsiz + RECOVERHEAD;
         node->size -= rsiz;
         node->dirty = true;
         xfree(rec);
@@ -2762,9 +4836,10 @@ class PlantDB : public BasicDB {
       size_t vsiz;
       const char* vbuf = visitor->visit_empty(kbuf, ksiz, &vsiz);
       if (vbuf != Visitor::NOP && vbuf != Visitor::REMOVE) {
+        if (!snaps_.empty()) record_snapshots(kbuf, ksiz, NULL, 0);
         size_t rsiz = sizeof(*rec) + ksiz + vsiz;
         count_ += 1;
-        cusage_ += rsiz;
+        cusage_ += rsiz + RECOVERHEAD;
         node->size += rsiz;
         node->dirty = true;
         rec = (Record*)xmalloc(rsiz);
@@ -2786,14 +4861,29 @@ class PlantDB : public BasicDB {
    */
   LeafNode* divide_leaf_node(LeafNode* node) {
     _assert_(node);
-    LeafNode* newnode = create_leaf_node(node->id, node->next);
-    if (newnode->next > 0) {
-      LeafNode* nextnode = load_leaf_node(newnode->next, false);
+    LeafNode* nextnode = NULL;
+    if (node->next > 0) {
+      nextnode = load_leaf_node(node->next, false);
       if (!nextnode) {
         set_error(_KCCODELINE_, Error::BROKEN, "missing leaf node");
-        db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)newnode->next);
+        db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)node->next);
         return NULL;
       }
+    }
+    LeafNode* newnode = create_leaf_node(node->id, node->next);
+    split_leaf_node(node, newnode, nextnode);
+    return newnode;
+  }
+  /**
+   * Move the latter half of the records of a leaf node into a new node.
+   * @param node the leaf node.
+   * @param newnode the new node, which is linked next to the leaf node.
+   * @param nextnode the node next to the leaf node, or NULL if there is none.
+   * @note No slot of the leaf cache is locked here, so the nodes can be locked by the caller.
+   */
+  void split_leaf_node(LeafNode* node, LeafNode* newnode, LeafNode* nextnode) {
+    _assert_(node && newnode);
+    if (nextnode) {
       nextnode->prev = newnode->id;
       nextnode->dirty = true;
     }
@@ -2812,9 +4902,159 @@ class PlantDB : public BasicDB {
       newnode->size += rsiz;
       ++rit;
     }
+    newnode->dirty = true;
     escape_cursors(node->id, node->next, *mid);
     recs.erase(mid, ritend);
-    return newnode;
+  }
+  /**
+   * Move to the right siblings of a leaf node divided after the search.
+   * @param node the leaf node locked by the caller.
+   * @param rec the record containing the key only.
+   * @param writable true to lock the sibling as a writer, or false as a reader.
+   * @return the locked leaf node whose range covers the key.
+   * @note The node is unlocked while its sibling is loaded, because a slot of the leaf cache
+   * must not be locked after a node.  If the key does not belong to the sibling, the node is
+   * locked again and kept unless it was divided in the meantime.
+   */
+  LeafNode* chase_leaf_node(LeafNode* node, Record* rec, bool writable) {
+    _assert_(node && rec);
+    while (node->next > 0 && (node->recs.empty() || reccomp_(node->recs.back(), rec))) {
+      int64_t next = node->next;
+      node->lock.unlock();
+      LeafNode* nextnode = load_leaf_node(next, false);
+      if (nextnode) {
+        if (writable) {
+          nextnode->lock.lock_writer();
+        } else {
+          nextnode->lock.lock_reader();
+        }
+        if (!nextnode->recs.empty() && !reccomp_(rec, nextnode->recs.front())) {
+          node = nextnode;
+          continue;
+        }
+        nextnode->lock.unlock();
+      }
+      if (writable) {
+        node->lock.lock_writer();
+      } else {
+        node->lock.lock_reader();
+      }
+      if (node->next == next) break;
+    }
+    return node;
+  }
+  /**
+   * Divide a leaf node locking only the node and its parent.
+   * @param link the link containing the key only.
+   * @return true if the node was divided or no longer needs it, or false if the whole tree must
+   * be reorganized under the method lock.
+   * @note The method lock must be held as a reader.  Readers which routed to the node before
+   * the new link was added move to the new sibling by chase_leaf_node.  The links between leaf
+   * nodes and the inner nodes are modified only by this function, under the mutex for local
+   * divisions, or under the writer method lock.  Therefore, the sibling can be loaded and the
+   * new node can be created before the nodes are locked, and no slot of the leaf cache is
+   * locked and no I/O is done while the nodes are locked.
+   */
+  bool divide_leaf_node_locally(Link* link) {
+    _assert_(link);
+    if (tran_ || autotran_ || !curs_.empty()) return false;
+    ScopedMutex lock(&smlock_);
+    int64_t hist[LEVELMAX];
+    int32_t hnum = 0;
+    int64_t id = search_leaf_id(link, hist, &hnum);
+    if (id < 1 || hnum < 1) return false;
+    InnerNode* inode = load_inner_node(hist[hnum-1]);
+    if (!inode) return false;
+    LeafNode* node = load_leaf_node(id, false);
+    if (!node) return false;
+    if (node->dead) return false;
+    node->lock.lock_reader();
+    int32_t rv = check_local_division(inode, node);
+    node->lock.unlock();
+    if (rv <= 0) return rv == 0;
+    LeafNode* nextnode = NULL;
+    if (node->next > 0) {
+      nextnode = load_leaf_node(node->next, false);
+      if (!nextnode) {
+        set_error(_KCCODELINE_, Error::BROKEN, "missing leaf node");
+        db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)node->next);
+        return false;
+      }
+    }
+    LeafNode* newnode = create_leaf_node(node->id, node->next);
+    ScopedSpinRWLock ilock(&inode->lock, true);
+    ScopedRWLock nlock(&node->lock, true);
+    rv = check_local_division(inode, node);
+    if (rv <= 0) {
+      newnode->dead = true;
+      return rv == 0;
+    }
+    ScopedRWLock wlock(&newnode->lock, true);
+    if (nextnode) nextnode->lock.lock_writer();
+    split_leaf_node(node, newnode, nextnode);
+    if (nextnode) nextnode->lock.unlock();
+    if (node->id == last_) last_ = newnode->id;
+    Record* rec = newnode->recs.front();
+    add_link_inner_node(inode, newnode->id, (char*)rec + sizeof(*rec), rec->ksiz);
+    smcnt_ += 1;
+    return true;
+  }
+  /**
+   * Check whether a leaf node can be divided locally.
+   * @param inode the parent inner node.
+   * @param node the leaf node locked by the caller.
+   * @return 1 if the node should be divided, 0 if it no longer needs it, or -1 if the whole
+   * tree must be reorganized.
+   */
+  int32_t check_local_division(InnerNode* inode, LeafNode* node) {
+    _assert_(inode && node);
+    RecordArray& recs = node->recs;
+    if (recs.empty()) return -1;
+    if (node->size <= psiz_ || recs.size() < 2) return 0;
+    Record* mrec = recs[recs.size()/2];
+    if (inode->size + (int64_t)(sizeof(Link) + mrec->ksiz) > psiz_ &&
+        inode->links.size() >= INLINKMIN) return -1;
+    return 1;
+  }
+  /**
+   * Add a link to the rightmost inner nodes built by bulk loading.
+   * @param opens the IDs of the rightmost inner node of each level.
+   * @param heads the IDs of the leftmost inner node of each level.
+   * @param level the level of the inner node, 0 for the parents of leaf nodes.
+   * @param child the ID number of the child.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @param limit the size limit of each inner node.
+   * @return true on success, or false on failure.
+   */
+  bool add_bulk_link(std::vector<int64_t>* opens, std::vector<int64_t>* heads, size_t level,
+                     int64_t child, const char* kbuf, size_t ksiz, int64_t limit) {
+    _assert_(opens && heads && kbuf);
+    if (level >= opens->size()) {
+      if (level >= (size_t)LEVELMAX - 1) {
+        set_error(_KCCODELINE_, Error::BROKEN, "too deep tree");
+        return false;
+      }
+      InnerNode* inode = create_inner_node(level > 0 ? (*heads)[level-1] : first_);
+      add_link_inner_node(inode, child, kbuf, ksiz);
+      opens->push_back(inode->id);
+      heads->push_back(inode->id);
+      return true;
+    }
+    InnerNode* inode = load_inner_node((*opens)[level]);
+    if (!inode) {
+      set_error(_KCCODELINE_, Error::BROKEN, "missing inner node");
+      db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)(*opens)[level]);
+      return false;
+    }
+    if (inode->size + (int64_t)(sizeof(Link) + ksiz) > limit &&
+        inode->links.size() >= INLINKMIN) {
+      InnerNode* newinode = create_inner_node(child);
+      (*opens)[level] = newinode->id;
+      return add_bulk_link(opens, heads, level + 1, newinode->id, kbuf, ksiz, limit);
+    }
+    add_link_inner_node(inode, child, kbuf, ksiz);
+    return true;
   }
   /**
    * Open the inner cache.
@@ -2826,6 +5066,9 @@ class PlantDB : public BasicDB {
     bnum = nearbyprime(bnum);
     for (int32_t i = 0; i < SLOTNUM; i++) {
       islots_[i].warm = new InnerCache(bnum);
+      islots_[i].hits = 0;
+      islots_[i].misses = 0;
+      islots_[i].evicts = 0;
     }
   }
   /**
@@ -2869,6 +5112,7 @@ class PlantDB : public BasicDB {
     if (slot->warm->count() > 0) {
       InnerNode* node = slot->warm->first_value();
       if (!flush_inner_node(node, true)) err = true;
+      slot->evicts++;
     }
     return !err;
   }
@@ -2909,7 +5153,7 @@ class PlantDB : public BasicDB {
     int32_t sidx = node->id % SLOTNUM;
     InnerSlot* slot = islots_ + sidx;
     slot->warm->set(node->id, node, InnerCache::MLAST);
-    cusage_ += node->size;
+    cusage_ += calc_inner_node_usage(node);
     return node;
   }
   /**
@@ -2932,7 +5176,7 @@ class PlantDB : public BasicDB {
     int32_t sidx = node->id % SLOTNUM;
     InnerSlot* slot = islots_ + sidx;
     slot->warm->remove(node->id);
-    cusage_ -= node->size;
+    cusage_ -= calc_inner_node_usage(node);
     delete node;
     return !err;
   }
@@ -2981,7 +5225,11 @@ class PlantDB : public BasicDB {
     InnerSlot* slot = islots_ + sidx;
     ScopedMutex lock(&slot->lock);
     InnerNode** np = slot->warm->get(id, InnerCache::MLAST);
-    if (np) return *np;
+    if (np) {
+      slot->hits++;
+      return *np;
+    }
+    slot->misses++;
     char hbuf[NUMBUFSIZ];
     size_t hsiz = write_key(hbuf, INPREFIX, id - INIDBASE);
     class VisitorImpl : public DB::Visitor {
@@ -3046,7 +5294,68 @@ class PlantDB : public BasicDB {
     node->dirty = false;
     node->dead = false;
     slot->warm->set(id, node, InnerCache::MLAST);
-    cusage_ += node->size;
+    cusage_ += calc_inner_node_usage(node);
+    return node;
+  }
+  /**
+   * Create a record containing a key only.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @return the created record, which should be released with the xfree function.
+   */
+  Record* create_key_record(const char* kbuf, size_t ksiz) {
+    _assert_(kbuf && ksiz <= MEMMAXSIZ);
+    Record* rec = (Record*)xmalloc(sizeof(*rec) + ksiz);
+    rec->ksiz = ksiz;
+    rec->vsiz = 0;
+    std::memcpy((char*)rec + sizeof(*rec), kbuf, ksiz);
+    return rec;
+  }
+  /**
+   * Search the B+ tree by a key.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @param hist the array of visiting history.
+   * @param hnp the pointer to the variable into which the number of the history is assigned.
+   * @return the corresponding leaf node, or NULL on failure.
+   */
+  LeafNode* search_tree_key(const char* kbuf, size_t ksiz, int64_t* hist, int32_t* hnp) {
+    _assert_(kbuf && ksiz <= MEMMAXSIZ && hist && hnp);
+    char lstack[KCPDRECBUFSIZ];
+    size_t lsiz = sizeof(Link) + ksiz;
+    char* lbuf = lsiz > sizeof(lstack) ? new char[lsiz] : lstack;
+    Link* link = (Link*)lbuf;
+    link->child = 0;
+    link->ksiz = ksiz;
+    std::memcpy(lbuf + sizeof(*link), kbuf, ksiz);
+    LeafNode* node = search_tree(link, false, hist, hnp);
+    if (lbuf != lstack) delete[] lbuf;
+    return node;
+  }
+  /**
+   * Search the leaf node where a range of keys begins.
+   * @param kbuf the pointer to the key region where the range begins.  If it is NULL, the
+   * first leaf node is searched.
+   * @param ksiz the size of the key region.
+   * @param hist the array of visiting history.
+   * @param hnp the pointer to the variable into which the number of the history is assigned.
+   * @return the corresponding leaf node, or NULL on failure.
+   */
+  LeafNode* search_range_head(const char* kbuf, size_t ksiz, int64_t* hist, int32_t* hnp) {
+    _assert_(hist && hnp);
+    LeafNode* node = NULL;
+    if (kbuf) {
+      node = search_tree_key(kbuf, ksiz, hist, hnp);
+    } else {
+      node = load_leaf_node(first_, false, true);
+      if (node && !node->recs.empty()) {
+        Record* rec = node->recs.front();
+        node = search_tree_key((char*)rec + sizeof(*rec), rec->ksiz, hist, hnp);
+      } else {
+        *hnp = 0;
+      }
+    }
+    if (!node) set_error(_KCCODELINE_, Error::BROKEN, "search failed");
     return node;
   }
   /**
@@ -3058,6 +5367,19 @@ class PlantDB : public BasicDB {
    * @return the corresponding leaf node, or NULL on failure.
    */
   LeafNode* search_tree(Link* link, bool prom, int64_t* hist, int32_t* hnp) {
+    _assert_(link && hist && hnp);
+    int64_t id = search_leaf_id(link, hist, hnp);
+    if (id < 1) return NULL;
+    return load_leaf_node(id, prom);
+  }
+  /**
+   * Search the B+ tree for the ID of the leaf node containing a key.
+   * @param link the link containing the key only.
+   * @param hist the array of visiting history.
+   * @param hnp the pointer to the variable into which the number of the history is assigned.
+   * @return the ID of the corresponding leaf node, or 0 on failure.
+   */
+  int64_t search_leaf_id(Link* link, int64_t* hist, int32_t* hnp) {
     _assert_(link && hist && hnp);
     int64_t id = root_;
     int32_t hnum = 0;
@@ -3066,9 +5388,10 @@ class PlantDB : public BasicDB {
       if (!node) {
         set_error(_KCCODELINE_, Error::BROKEN, "missing inner node");
         db_.report(_KCCODELINE_, Logger::WARN, "id=%lld", (long long)id);
-        return NULL;
+        return 0;
       }
       hist[hnum++] = id;
+      node->lock.lock_reader();
       const LinkArray& links = node->links;
       typename LinkArray::const_iterator litbeg = links.begin();
       typename LinkArray::const_iterator litend = links.end();
@@ -3080,9 +5403,10 @@ class PlantDB : public BasicDB {
         Link* link = *lit;
         id = link->child;
       }
+      node->lock.unlock();
     }
     *hnp = hnum;
-    return load_leaf_node(id, prom);
+    return id;
   }
   /**
    * Reorganize the B+ tree.
@@ -3146,7 +5470,7 @@ class PlantDB : public BasicDB {
         for (int32_t i = 0; i <= num; i++) {
           Link* link = links.back();
           size_t rsiz = sizeof(*link) + link->ksiz;
-          cusage_ -= rsiz;
+          cusage_ -= rsiz + LINKOVERHEAD;
           inode->size -= rsiz;
           xfree(link);
           links.pop_back();
@@ -3210,7 +5534,7 @@ class PlantDB : public BasicDB {
     links.insert(lit, link);
     node->size += rsiz;
     node->dirty = true;
-    cusage_ += rsiz;
+    cusage_ += rsiz + LINKOVERHEAD;
   }
   /**
    * Subtract a link from the B+ tree.
@@ -3229,6 +5553,9 @@ class PlantDB : public BasicDB {
     if (node->heir == child) {
       if (!links.empty()) {
         Link* link = *lit;
+        size_t rsiz = sizeof(*link) + link->ksiz;
+        cusage_ -= rsiz + LINKOVERHEAD;
+        node->size -= rsiz;
         node->heir = link->child;
         xfree(link);
         links.erase(lit);
@@ -3264,6 +5591,9 @@ class PlantDB : public BasicDB {
     while (lit != litend) {
       Link* link = *lit;
       if (link->child == child) {
+        size_t rsiz = sizeof(*link) + link->ksiz;
+        cusage_ -= rsiz + LINKOVERHEAD;
+        node->size -= rsiz;
         xfree(link);
         links.erase(lit);
         return true;
@@ -3290,9 +5620,22 @@ class PlantDB : public BasicDB {
       *(uint8_t*)(wp++) = 0x18;
     } else if (reccomp_.comp == DECIMALDESCCOMP) {
       *(uint8_t*)(wp++) = 0x19;
+    } else if (reccomp_.comp == INTEGERCOMP) {
+      *(uint8_t*)(wp++) = 0x12;
+    } else if (reccomp_.comp == UNSIGNEDCOMP) {
+      *(uint8_t*)(wp++) = 0x13;
+    } else if (reccomp_.comp == FLOATCOMP) {
+      *(uint8_t*)(wp++) = 0x14;
     } else {
       *(uint8_t*)(wp++) = 0xff;
     }
+    if (rsint_ > 0 || bfgen_ > 0 || pcomp_) *(uint8_t*)head ^= MCOMPEXT;
+    writefixnum(wp, rsint_, sizeof(uint16_t));
+    writefixnum(head + MOFFBFGEN, bfgen_, sizeof(uint32_t));
+    uint8_t flags = 0;
+    if (bfsaved_) flags |= MFBFSAVED;
+    if (pcomp_) flags |= MFPCOMP;
+    *(uint8_t*)(head + MOFFFLAGS) = flags;
     wp = head + MOFFNUMS;
     uint64_t num = hton64(psiz_);
     std::memcpy(wp, &num, sizeof(num));
@@ -3340,19 +5683,31 @@ class PlantDB : public BasicDB {
       return false;
     }
     const char* rp = head;
-    if (*(uint8_t*)rp == 0x10) {
+    uint8_t code = *(uint8_t*)rp;
+    bool ext = (code & 0xf0) == (0x10 | MCOMPEXT) || code == (0xff ^ MCOMPEXT);
+    if (ext) code ^= MCOMPEXT;
+    if (code == 0x10) {
       reccomp_.comp = LEXICALCOMP;
       linkcomp_.comp = LEXICALCOMP;
-    } else if (*(uint8_t*)rp == 0x11) {
+    } else if (code == 0x11) {
       reccomp_.comp = DECIMALCOMP;
       linkcomp_.comp = DECIMALCOMP;
-    } else if (*(uint8_t*)rp == 0x18) {
+    } else if (code == 0x18) {
       reccomp_.comp = LEXICALDESCCOMP;
       linkcomp_.comp = LEXICALDESCCOMP;
-    } else if (*(uint8_t*)rp == 0x19) {
+    } else if (code == 0x19) {
       reccomp_.comp = DECIMALDESCCOMP;
       linkcomp_.comp = DECIMALDESCCOMP;
-    } else if (*(uint8_t*)rp == 0xff) {
+    } else if (code == 0x12) {
+      reccomp_.comp = INTEGERCOMP;
+      linkcomp_.comp = INTEGERCOMP;
+    } else if (code == 0x13) {
+      reccomp_.comp = UNSIGNEDCOMP;
+      linkcomp_.comp = UNSIGNEDCOMP;
+    } else if (code == 0x14) {
+      reccomp_.comp = FLOATCOMP;
+      linkcomp_.comp = FLOATCOMP;
+    } else if (code == 0xff) {
       if (!reccomp_.comp) {
         set_error(_KCCODELINE_, Error::INVALID, "the custom comparator is not given");
         return false;
@@ -3362,6 +5717,29 @@ class PlantDB : public BasicDB {
       set_error(_KCCODELINE_, Error::BROKEN, "comparator is invalid");
       return false;
     }
+    reccomp_.specialize();
+    linkcomp_.specialize();
+    rsint_ = readfixnum(rp + 1, sizeof(uint16_t));
+    if (rsint_ > 0 && !ext) {
+      set_error(_KCCODELINE_, Error::BROKEN, "invalid format marker");
+      return false;
+    }
+    bfgen_ = readfixnum(head + MOFFBFGEN, sizeof(uint32_t));
+    uint8_t flags = *(uint8_t*)(head + MOFFFLAGS);
+    bfsaved_ = flags & MFBFSAVED;
+    if ((bfgen_ > 0 || bfsaved_) && !ext) {
+      set_error(_KCCODELINE_, Error::BROKEN, "invalid format marker");
+      return false;
+    }
+    if ((flags & MFPCOMP) && !ext) {
+      set_error(_KCCODELINE_, Error::BROKEN, "invalid format marker");
+      return false;
+    }
+    if (!(flags & MFPCOMP) != !pcomp_) {
+      set_error(_KCCODELINE_, Error::INVALID, pcomp_ ? "the leaf pages are not compressed" :
+                "the page compressor is not given");
+      return false;
+    }
     rp = head + MOFFNUMS;
     uint64_t num;
     std::memcpy(&num, rp, sizeof(num));
@@ -3403,6 +5781,7 @@ class PlantDB : public BasicDB {
       LeafSlot* slot = lslots_ + i;
       sum += slot->warm->count();
       sum += slot->hot->count();
+      sum += slot->cold->count();
     }
     return sum;
   }
@@ -3419,19 +5798,44 @@ class PlantDB : public BasicDB {
       typename LeafCache::Iterator itend = slot->warm->end();
       while (it != itend) {
         LeafNode* node = it.value();
-        sum += node->size;
+        sum += calc_leaf_node_usage(node);
         ++it;
       }
       it = slot->hot->begin();
       itend = slot->hot->end();
       while (it != itend) {
         LeafNode* node = it.value();
-        sum += node->size;
+        sum += calc_leaf_node_usage(node);
+        ++it;
+      }
+      it = slot->cold->begin();
+      itend = slot->cold->end();
+      while (it != itend) {
+        LeafNode* node = it.value();
+        sum += calc_leaf_node_usage(node);
         ++it;
       }
     }
     return sum;
   }
+  /**
+   * Calculate the amount of memory charged for a leaf node in the cache.
+   * @param node the leaf node.
+   * @return the amount of memory including the node itself and the record pointers.
+   */
+  int64_t calc_leaf_node_usage(LeafNode* node) {
+    _assert_(node);
+    return sizeof(*node) + node->size + (int64_t)node->recs.size() * RECOVERHEAD;
+  }
+  /**
+   * Calculate the amount of memory charged for an inner node in the cache.
+   * @param node the inner node.
+   * @return the amount of memory including the node itself and the link pointers.
+   */
+  int64_t calc_inner_node_usage(InnerNode* node) {
+    _assert_(node);
+    return sizeof(*node) + node->size + (int64_t)node->links.size() * LINKOVERHEAD;
+  }
   /**
    * Caluculate the total number of nodes in the inner cache.
    * @return the total number of nodes in the inner cache.
@@ -3458,7 +5862,7 @@ class PlantDB : public BasicDB {
       typename InnerCache::Iterator itend = slot->warm->end();
       while (it != itend) {
         InnerNode* node = it.value();
-        sum += node->size;
+        sum += calc_inner_node_usage(node);
         ++it;
       }
     }
@@ -3478,6 +5882,37 @@ class PlantDB : public BasicDB {
       ++cit;
     }
   }
+  /**
+   * Keep the old image of a record in every snapshot.
+   * @param kbuf the pointer to the key region.
+   * @param ksiz the size of the key region.
+   * @param vbuf the pointer to the value region, or NULL if the record does not exist.
+   * @param vsiz the size of the value region.
+   */
+  void record_snapshots(const char* kbuf, size_t ksiz, const char* vbuf, size_t vsiz) {
+    _assert_(kbuf && ksiz <= MEMMAXSIZ && vsiz <= MEMMAXSIZ);
+    typename SnapshotList::const_iterator sit = snaps_.begin();
+    typename SnapshotList::const_iterator sitend = snaps_.end();
+    while (sit != sitend) {
+      Snapshot* snap = *sit;
+      snap->record(kbuf, ksiz, vbuf, vsiz);
+      ++sit;
+    }
+  }
+  /**
+   * Invalidate all snapshots.
+   */
+  void disable_snapshots() {
+    _assert_(true);
+    if (snaps_.empty()) return;
+    typename SnapshotList::const_iterator sit = snaps_.begin();
+    typename SnapshotList::const_iterator sitend = snaps_.end();
+    while (sit != sitend) {
+      Snapshot* snap = *sit;
+      snap->invalidate();
+      ++sit;
+    }
+  }
   /**
    * Escape cursors on a divided leaf node.
    * @param src the ID of the source node.
@@ -3494,7 +5929,7 @@ class PlantDB : public BasicDB {
       Cursor* cur = *cit;
       if (cur->lid_ == src) {
         char* dbuf = (char*)rec + sizeof(*rec);
-        if (reccomp_.comp->compare(cur->kbuf_, cur->ksiz_, dbuf, rec->ksiz) >= 0)
+        if (reccomp_.compare(cur->kbuf_, cur->ksiz_, dbuf, rec->ksiz) >= 0)
           cur->lid_ = dest;
       }
       ++cit;
@@ -3535,9 +5970,9 @@ class PlantDB : public BasicDB {
     std::set<int64_t> nexts;
     class VisitorImpl : public DB::Visitor {
      public:
-      explicit VisitorImpl(std::set<int64_t>* ids,
-                           std::set<int64_t>* prevs, std::set<int64_t>* nexts) :
-          ids_(ids), prevs_(prevs), nexts_(nexts), count_(0) {}
+      explicit VisitorImpl(std::set<int64_t>* ids, std::set<int64_t>* prevs,
+                           std::set<int64_t>* nexts, bool fcode, Compressor* pcomp) :
+          ids_(ids), prevs_(prevs), nexts_(nexts), fcode_(fcode), pcomp_(pcomp), count_(0) {}
       int64_t count() {
         return count_;
       }
@@ -3551,35 +5986,16 @@ class PlantDB : public BasicDB {
         std::memcpy(tkbuf, kbuf, ksiz);
         tkbuf[ksiz] = '\0';
         int64_t id = atoih(tkbuf);
-        uint64_t prev;
-        size_t step = readvarnum(vbuf, vsiz, &prev);
-        if (step < 1) return NOP;
-        vbuf += step;
-        vsiz -= step;
-        uint64_t next;
-        step = readvarnum(vbuf, vsiz, &next);
-        if (step < 1) return NOP;
-        vbuf += step;
-        vsiz -= step;
+        LeafReader reader(vbuf, vsiz, fcode_, pcomp_);
+        if (!reader.ok()) return NOP;
         ids_->insert(id);
-        if (prev > 0) prevs_->insert(prev);
-        if (next > 0) nexts_->insert(next);
-        while (vsiz > 1) {
-          uint64_t rksiz;
-          step = readvarnum(vbuf, vsiz, &rksiz);
-          if (step < 1) break;
-          vbuf += step;
-          vsiz -= step;
-          uint64_t rvsiz;
-          step = readvarnum(vbuf, vsiz, &rvsiz);
-          if (step < 1) break;
-          vbuf += step;
-          vsiz -= step;
-          if (vsiz < rksiz + rvsiz) break;
-          vbuf += rksiz;
-          vsiz -= rksiz;
-          vbuf += rvsiz;
-          vsiz -= rvsiz;
+        if (reader.prev() > 0) prevs_->insert(reader.prev());
+        if (reader.next() > 0) nexts_->insert(reader.next());
+        const char* rkbuf;
+        size_t rksiz;
+        const char* rvbuf;
+        size_t rvsiz;
+        while (reader.read(&rkbuf, &rksiz, &rvbuf, &rvsiz)) {
           count_++;
         }
         return NOP;
@@ -3587,8 +6003,10 @@ class PlantDB : public BasicDB {
       std::set<int64_t>* ids_;
       std::set<int64_t>* prevs_;
       std::set<int64_t>* nexts_;
+      bool fcode_;
+      Compressor* pcomp_;
       int64_t count_;
-    } visitor(&ids, &prevs, &nexts);
+    } visitor(&ids, &prevs, &nexts, rsint_ > 0, pcomp_);
     if (!db_.iterate(&visitor, false)) err = true;
     int64_t count = visitor.count();
     db_.report(_KCCODELINE_, Logger::WARN, "recalculated the record count from %lld to %lld",
@@ -3620,21 +6038,32 @@ class PlantDB : public BasicDB {
    * Reorganize the database file.
    * @param mode the connection mode of the internal database.
    * @return true on success, or false on failure.
+   * @note If the meta data is valid but the tuning does not match it, the database is not
+   * reorganized, since the leaf pages can not be read.
    */
   bool reorganize_file(uint32_t mode) {
     _assert_(true);
     if (!load_meta()) {
+      if (error().code() == Error::INVALID) {
+        db_.close();
+        return false;
+      }
       if (reccomp_.comp) {
         linkcomp_.comp = reccomp_.comp;
       } else {
         reccomp_.comp = LEXICALCOMP;
         linkcomp_.comp = LEXICALCOMP;
       }
+      reccomp_.specialize();
+      linkcomp_.specialize();
     }
     const std::string& path = db_.path();
     const std::string& npath = path + File::EXTCHR + KCPDBTMPPATHEXT;
     PlantDB tdb;
     tdb.tune_comparator(reccomp_.comp);
+    tdb.tune_front_coding(rsint_);
+    tdb.tune_bloom(bfbits_);
+    if (pcomp_) tdb.tune_page_compressor(pcomp_);
     if (!tdb.open(npath, OWRITER | OCREATE | OTRUNCATE)) {
       set_error(_KCCODELINE_, tdb.error().code(), "opening the destination failed");
       return false;
@@ -3651,7 +6080,7 @@ class PlantDB : public BasicDB {
       if (*kbuf == LNPREFIX) {
         int64_t id = std::strtol(kbuf + 1, NULL, 16);
         if (id > 0 && id < INIDBASE) {
-          LeafNode* node = load_leaf_node(id, false);
+          LeafNode* node = load_leaf_node(id, false, true);
           if (node) {
             const RecordArray& recs = node->recs;
             typename RecordArray::const_iterator rit = recs.begin();
@@ -3757,7 +6186,8 @@ class PlantDB : public BasicDB {
     if (!clean_inner_cache()) return false;
     int32_t idx = trclock_++ % SLOTNUM;
     LeafSlot* lslot = lslots_ + idx;
-    if (lslot->warm->count() + lslot->hot->count() > 1) flush_leaf_cache_part(lslot);
+    if (lslot->warm->count() + lslot->hot->count() + lslot->cold->count() > 1)
+      flush_leaf_cache_part(lslot);
     InnerSlot* islot = islots_ + idx;
     if (islot->warm->count() > 1) flush_inner_cache_part(islot);
     if ((trlcnt_ != lcnt_ || count_ != trcount_) && !dump_meta()) return false;
@@ -3766,15 +6196,17 @@ class PlantDB : public BasicDB {
   }
   /**
    * Commit transaction.
+   * @param end true to end the transaction of the internal database, or false to leave it to
+   * the caller.
    * @return true on success, or false on failure.
    */
-  bool commit_transaction() {
+  bool commit_transaction(bool end) {
     _assert_(true);
     bool err = false;
     if (!clean_leaf_cache()) return false;
     if (!clean_inner_cache()) return false;
     if ((trlcnt_ != lcnt_ || count_ != trcount_) && !dump_meta()) err = true;
-    if (!db_.end_transaction(true)) return false;
+    if (end && !db_.end_transaction(true)) return false;
     return !err;
   }
   /**
@@ -3787,6 +6219,7 @@ class PlantDB : public BasicDB {
     flush_leaf_cache(false);
     flush_inner_cache(false);
     if (!db_.end_transaction(false)) err = true;
+    clear_leaf_filters();
     if (!load_meta()) err = true;
     disable_cursors();
     return !err;
@@ -3804,7 +6237,8 @@ class PlantDB : public BasicDB {
     size_t cnum = ATRANCNUM / SLOTNUM;
     int32_t idx = trclock_++ % SLOTNUM;
     LeafSlot* lslot = lslots_ + idx;
-    if (lslot->warm->count() + lslot->hot->count() > cnum) flush_leaf_cache_part(lslot);
+    if (lslot->warm->count() + lslot->hot->count() + lslot->cold->count() > cnum)
+      flush_leaf_cache_part(lslot);
     InnerSlot* islot = islots_ + idx;
     if (islot->warm->count() > cnum) flush_inner_cache_part(islot);
     if (!dump_meta()) err = true;
@@ -3877,6 +6311,10 @@ class PlantDB : public BasicDB {
   PlantDB& operator =(const PlantDB&);
   /** The method lock. */
   RWLock mlock_;
+  /** The lock for structure modifications under the reader method lock. */
+  Mutex smlock_;
+  /** The count of structure modifications under the reader method lock. */
+  AtomicInt64 smcnt_;
   /** The internal meta operation trigger. */
   MetaTrigger* mtrigger_;
   /** The open mode. */
@@ -3891,6 +6329,8 @@ class PlantDB : public BasicDB {
   BASEDB db_;
   /** The cursor objects. */
   CursorList curs_;
+  /** The snapshot objects. */
+  SnapshotList snaps_;
   /** The alignment power. */
   uint8_t apow_;
   /** The free block pool power. */
@@ -3899,10 +6339,52 @@ class PlantDB : public BasicDB {
   uint8_t opts_;
   /** The bucket number. */
   int64_t bnum_;
+  /** The maximum delay of group commit. */
+  int64_t gcdelay_;
   /** The page size. */
   int32_t psiz_;
   /** The capacity of page cache. */
   int64_t pccap_;
+  /** The usage of page cache at which accessing threads evict nodes. */
+  int64_t pclimit_;
+  /** The usage of page cache at which the write-back thread evicts nodes. */
+  int64_t pcwbmark_;
+  /** The low watermark of the page cache in percent. */
+  int32_t wblow_;
+  /** The high watermark of the page cache in percent. */
+  int32_t wbhigh_;
+  /** The write-back thread. */
+  Flusher* wbth_;
+  /** The depth of leaf prefetching. */
+  int32_t pfdepth_;
+  /** The prefetcher thread. */
+  Prefetcher* pfth_;
+  /** The interval of background synchronization. */
+  int64_t bsint_;
+  /** The background synchronizer. */
+  Synchronizer* bsth_;
+  /** The interval of restart points of front-coded leaf pages. */
+  int32_t rsint_;
+  /** The fill factor of pages built by bulk loading. */
+  int32_t bfill_;
+  /** The compressor of leaf pages. */
+  Compressor* pcomp_;
+  /** The capacity of the cache of compressed leaf pages. */
+  int64_t zccap_;
+  /** The number of bits of Bloom filters per record. */
+  int32_t bfbits_;
+  /** The flag whether Bloom filters are used. */
+  bool bfon_;
+  /** The generation of Bloom filters. */
+  uint32_t bfgen_;
+  /** The flag whether Bloom filters are saved. */
+  bool bfsaved_;
+  /** The number of lookups checked by Bloom filters. */
+  AtomicInt64 bfcheck_;
+  /** The number of lookups rejected by Bloom filters. */
+  AtomicInt64 bfreject_;
+  /** The number of false positives of Bloom filters. */
+  AtomicInt64 bffalse_;
   /** The root node. */
   int64_t root_;
   /** The first node. */
@@ -235,7 +235,7 @@ class PolyDB : public BasicDB {
   explicit PolyDB() :
       type_(TYPEVOID), db_(NULL), error_(),
       stdlogstrm_(NULL), stdlogger_(NULL), logger_(NULL), logkinds_(0),
-      stdmtrgstrm_(NULL), stdmtrigger_(NULL), mtrigger_(NULL), zcomp_(NULL) {
+      stdmtrgstrm_(NULL), stdmtrigger_(NULL), mtrigger_(NULL), zcomp_(NULL), pcomp_(NULL) {
     _assert_(true);
   }
   /**
@@ -245,6 +245,7 @@ class PolyDB : public BasicDB {
   virtual ~PolyDB() {
     _assert_(true);
     if (type_ != TYPEVOID) close();
+    delete pcomp_;
     delete zcomp_;
     delete stdmtrigger_;
     delete stdmtrgstrm_;
@@ -322,6 +323,86 @@ class PolyDB : public BasicDB {
     }
     return db_->iterate(visitor, writable, checker);
   }
+  /**
+   * Store records supplied by a source.
+   * @param src the source of records.
+   * @return true on success, or false on failure.
+   */
+  bool load_bulk(BulkSource* src) {
+    _assert_(src);
+    if (type_ == TYPEVOID) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    return db_->load_bulk(src);
+  }
+  /**
+   * Create a copy of the database file.
+   * @param dest the path of the destination file.
+   * @param checker a progress checker object.  If it is NULL, no checking is performed.
+   * @return true on success, or false on failure.
+   */
+  bool copy(const std::string& dest, ProgressChecker* checker = NULL) {
+    _assert_(true);
+    if (type_ == TYPEVOID) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    return db_->copy(dest, checker);
+  }
+  /**
+   * Apply a batch of record updates atomically.
+   * @param batch the batch of updates.
+   * @return true on success, or false on failure.
+   */
+  bool apply_batch(const WriteBatch& batch) {
+    _assert_(true);
+    if (type_ == TYPEVOID) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return false;
+    }
+    return db_->apply_batch(batch);
+  }
+  /**
+   * Remove records in a range of keys.
+   * @param bkbuf the pointer to the key region where the range begins inclusively.  If it is
+   * NULL, the range begins at the first record.
+   * @param bksiz the size of the key region where the range begins.
+   * @param ekbuf the pointer to the key region where the range ends exclusively.  If it is
+   * NULL, the range ends at the last record.
+   * @param eksiz the size of the key region where the range ends.
+   * @return the number of removed records, or -1 on failure.
+   * @note Only the tree databases support this method.  The cost is linear in the number of
+   * records in the range.
+   */
+  int64_t remove_range(const char* bkbuf, size_t bksiz, const char* ekbuf, size_t eksiz) {
+    _assert_(bksiz <= MEMMAXSIZ && eksiz <= MEMMAXSIZ);
+    if (type_ == TYPEVOID) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return -1;
+    }
+    return db_->remove_range(bkbuf, bksiz, ekbuf, eksiz);
+  }
+  /**
+   * Get the number of records in a range of keys.
+   * @param bkbuf the pointer to the key region where the range begins inclusively.  If it is
+   * NULL, the range begins at the first record.
+   * @param bksiz the size of the key region where the range begins.
+   * @param ekbuf the pointer to the key region where the range ends exclusively.  If it is
+   * NULL, the range ends at the last record.
+   * @param eksiz the size of the key region where the range ends.
+   * @return the number of records in the range, or -1 on failure.
+   * @note Only the tree databases support this method.  The cost is linear in the number of
+   * leaf nodes in the range.
+   */
+  int64_t count_range(const char* bkbuf, size_t bksiz, const char* ekbuf, size_t eksiz) {
+    _assert_(bksiz <= MEMMAXSIZ && eksiz <= MEMMAXSIZ);
+    if (type_ == TYPEVOID) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return -1;
+    }
+    return db_->count_range(bkbuf, bksiz, ekbuf, eksiz);
+  }
   /**
    * Scan each record in parallel.
    * @param visitor a visitor object.
@@ -395,15 +476,19 @@ class PolyDB : public BasicDB {
    * "kcd", kcf", and "kcx".  All database types support the logging parameters of "log",
    * "logkinds", and "logpx".  The prototype hash database and the prototype tree database do
    * not support any other tuning parameter.  The stash database supports "bnum".  The cache
-   * hash database supports "opts", "bnum", "zcomp", "capcnt", "capsiz", and "zkey".  The cache
-   * tree database supports all parameters of the cache hash database except for capacity
-   * limitation, and supports "psiz", "rcomp", "pccap" in addition.  The file hash database
-   * supports "apow", "fpow", "opts", "bnum", "msiz", "dfunit", "zcomp", and "zkey".  The file
-   * tree database supports all parameters of the file hash database and "psiz", "rcomp",
-   * "pccap" in addition.  The directory hash database supports "opts", "zcomp", and "zkey".
-   * The directory tree database supports all parameters of the directory hash database and
-   * "psiz", "rcomp", "pccap" in addition.  The plain text database does not support any other
-   * tuning parameter.
+   * hash database supports "opts", "bnum", "zcomp", "capcnt", "capsiz", "zkey", and "zdict".  The
+   * cache tree database supports all parameters of the cache hash database except for capacity
+   * limitation, and supports "psiz", "rcomp", "pccap", "rsint", "bfill", "bloom", "pcomp",
+   * "zccap" in addition.
+   * The file hash database supports "apow", "fpow", "opts", "bnum", "msiz", "mopts", "dfunit",
+   * "rasiz", "zcomp", "zkey", "zdict", "bloom", "gcdelay", "redolog", "bsint", "bslimit",
+   * "verify", "zthnum", and "bthres".  The file tree database supports all parameters of the
+   * file hash database except for "zthnum" and "bthres", and supports "psiz", "rcomp",
+   * "pccap", "pfdepth", "rsint", "bfill", "wblow", "wbhigh", "pcomp", "zccap" in addition.  The
+   * directory hash database supports "opts", "zcomp", "zkey", and "zdict".  The directory tree
+   * database supports all parameters of the directory hash database and "psiz", "rcomp",
+   * "pccap", "rsint", "bfill", "wblow", "wbhigh", "bloom", "pcomp", "zccap" in addition.  The
+   * plain text database does not support any other tuning parameter.
    * @param mode the connection mode.  PolyDB::OWRITER as a writer, PolyDB::OREADER as a
    * reader.  The following may be added to the writer mode by bitwise-or: PolyDB::OCREATE,
    * which means it creates a new database if the file does not exist, PolyDB::OTRUNCATE, which
@@ -420,20 +505,36 @@ class PolyDB : public BasicDB {
    * the path of the log file, or "-" for the standard output, or "+" for the standard error.
    * "logkinds" specifies kinds of logged messages and the value can be "debug", "info", "warn",
    * or "error".  "logpx" specifies the prefix of each log message.  "opts" is for "tune_options"
-   * and the value can contain "s" for the small option, "l" for the linear option, and "c" for
-   * the compress option.  "bnum" corresponds to "tune_bucket".  "zcomp" is for "tune_compressor"
+   * and the value can contain "s" for the small option, "l" for the linear option, "c" for the
+   * compress option, "x" for the XXH64 hashing option, "k" for the checksum option, and "b" for
+   * the blob option of the file hash database.  "bnum" corresponds to
+   * "tune_bucket".  "zcomp" is for "tune_compressor"
    * and the value can be "zlib" for the ZLIB raw compressor, "def" for the ZLIB deflate
    * compressor, "gz" for the ZLIB gzip compressor, "lzo" for the LZO compressor, "lzma" for the
-   * LZMA compressor, or "arc" for the Arcfour cipher.  "zkey" specifies the cipher key of the
-   * compressor.  "capcnt" is for "cap_count".  "capsiz" is for "cap_size".  "psiz" is for
-   * "tune_page".  "rcomp" is for "tune_comparator" and the value can be "lex" for the lexical
+   * LZMA compressor, "lz4" for the LZ4 compressor, "zstd" for the Zstandard compressor, or "arc"
+   * for the Arcfour cipher.  "zkey" specifies the cipher key of the compressor.  "zdict"
+   * specifies the path of the dictionary file of the Zstandard compressor.  "capcnt" is for
+   * "cap_count".  "capsiz" is for "cap_size".  "psiz" is for "tune_page".  "rcomp" is for
+   * "tune_comparator" and the value can be "lex" for the lexical
    * comparator, "dec" for the decimal comparator, "lexdesc" for the lexical descending
-   * comparator, or "decdesc" for the decimal descending comparator.  "pccap" is for
-   * "tune_page_cache".  "apow" is for "tune_alignment".  "fpow" is for "tune_fbp".  "msiz" is
-   * for "tune_map".  "dfunit" is for "tune_defrag".  Every opened database must be closed by
-   * the PolyDB::close method when it is no longer in use.  It is not allowed for two or more
-   * database objects in the same process to keep their connections to the same database file at
-   * the same time.
+   * comparator, "decdesc" for the decimal descending comparator, "int" for the signed integer
+   * comparator, "uint" for the unsigned integer comparator, or "flt" for the floating-point
+   * number comparator.  "pccap" is for "tune_page_cache".  "apow" is for "tune_alignment".
+   * "fpow" is for "tune_fbp".  "msiz" is for "tune_map".  "mopts" is for "tune_map_options" and
+   * the value can contain "g" for the growing option, "p" for the populating option, and "h"
+   * for the huge page option.  "dfunit" is for "tune_defrag".  "rasiz" is for
+   * "tune_readahead".  "pfdepth" is for "tune_prefetch".
+   * "rsint" is for "tune_front_coding".  "bfill" is for "tune_bulk_fill".  "wblow" and "wbhigh"
+   * are for "tune_write_back".  "bloom" is for "tune_bloom".  "gcdelay" is for
+   * "tune_group_commit" and the value is in microseconds.  "redolog" is for "tune_redo_log".
+   * "bsint" and "bslimit" are for "tune_background_sync" and the interval is in microseconds.
+   * "verify" is for "tune_verification" and the value is 1 to verify checksums.  "pcomp" is for
+   * "tune_page_compressor" and the value can be the same as "zcomp" except for the ciphers.
+   * "zccap" is for "tune_compressed_cache".  "zthnum" is for "tune_compression_threads".
+   * "bthres" is for "tune_blob".
+   * Every opened database must be closed by the PolyDB::close method when it is no longer in
+   * use.  It is not allowed for two or more database objects in
+   * the same process to keep their connections to the same database file at the same time.
    */
   bool open(const std::string& path = ":", uint32_t mode = OWRITER | OCREATE) {
     _assert_(true);
@@ -463,13 +564,36 @@ class PolyDB : public BasicDB {
     bool tsmall = false;
     bool tlinear = false;
     bool tcompress = false;
+    bool txxhash = false;
+    bool tchecksum = false;
+    bool tblob = false;
     int64_t msiz = -1;
+    bool mgrow = false;
+    bool mpopulate = false;
+    bool mhuge = false;
     int64_t dfunit = -1;
+    int64_t rasiz = -1;
     std::string zcompname = "";
     int64_t psiz = -1;
     Comparator* rcomp = NULL;
     int64_t pccap = 0;
+    std::string pcompname = "";
+    int64_t zccap = -1;
+    int32_t pfdepth = -1;
+    int32_t rsint = -1;
+    int32_t bfill = -1;
+    int32_t wblow = -1;
+    int32_t wbhigh = -1;
+    int32_t bloom = -1;
+    int64_t gcdelay = -1;
+    int64_t redolog = -1;
+    int64_t bsint = -1;
+    int64_t bslimit = -1;
+    int32_t verify = -1;
+    int32_t zthnum = -1;
+    int64_t bthres = -1;
     std::string zkey = "";
+    std::string zdict = "";
     std::vector<std::string>::iterator it = elems.begin();
     std::vector<std::string>::iterator itend = elems.end();
     if (it != itend) {
@@ -592,16 +716,55 @@ class PolyDB : public BasicDB {
           if (std::strchr(value, 's')) tsmall = true;
           if (std::strchr(value, 'l')) tlinear = true;
           if (std::strchr(value, 'c')) tcompress = true;
+          if (std::strchr(value, 'x')) txxhash = true;
+          if (std::strchr(value, 'k')) tchecksum = true;
+          if (std::strchr(value, 'b')) tblob = true;
         } else if (!std::strcmp(key, "msiz") || !std::strcmp(key, "map")) {
           msiz = atoix(value);
+        } else if (!std::strcmp(key, "mopts") || !std::strcmp(key, "mapopts")) {
+          if (std::strchr(value, 'g')) mgrow = true;
+          if (std::strchr(value, 'p')) mpopulate = true;
+          if (std::strchr(value, 'h')) mhuge = true;
         } else if (!std::strcmp(key, "dfunit") || !std::strcmp(key, "defrag")) {
           dfunit = atoix(value);
+        } else if (!std::strcmp(key, "rasiz") || !std::strcmp(key, "readahead")) {
+          rasiz = atoix(value);
         } else if (!std::strcmp(key, "zcomp") || !std::strcmp(key, "compressor")) {
           zcompname = value;
         } else if (!std::strcmp(key, "psiz") || !std::strcmp(key, "page")) {
           psiz = atoix(value);
         } else if (!std::strcmp(key, "pccap") || !std::strcmp(key, "cache")) {
           pccap = atoix(value);
+        } else if (!std::strcmp(key, "pcomp") || !std::strcmp(key, "pagecomp")) {
+          pcompname = value;
+        } else if (!std::strcmp(key, "zccap") || !std::strcmp(key, "zcache")) {
+          zccap = atoix(value);
+        } else if (!std::strcmp(key, "pfdepth") || !std::strcmp(key, "prefetch")) {
+          pfdepth = atoix(value);
+        } else if (!std::strcmp(key, "rsint") || !std::strcmp(key, "restart")) {
+          rsint = atoix(value);
+        } else if (!std::strcmp(key, "bfill") || !std::strcmp(key, "fill")) {
+          bfill = atoix(value);
+        } else if (!std::strcmp(key, "wblow") || !std::strcmp(key, "lowmark")) {
+          wblow = atoix(value);
+        } else if (!std::strcmp(key, "wbhigh") || !std::strcmp(key, "highmark")) {
+          wbhigh = atoix(value);
+        } else if (!std::strcmp(key, "bloom") || !std::strcmp(key, "bloomfilter")) {
+          bloom = atoix(value);
+        } else if (!std::strcmp(key, "gcdelay") || !std::strcmp(key, "groupcommit")) {
+          gcdelay = atoix(value);
+        } else if (!std::strcmp(key, "redolog")) {
+          redolog = atoix(value);
+        } else if (!std::strcmp(key, "bsint") || !std::strcmp(key, "syncinterval")) {
+          bsint = atoix(value);
+        } else if (!std::strcmp(key, "bslimit") || !std::strcmp(key, "synclimit")) {
+          bslimit = atoix(value);
+        } else if (!std::strcmp(key, "verify") || !std::strcmp(key, "verification")) {
+          verify = atoix(value);
+        } else if (!std::strcmp(key, "zthnum") || !std::strcmp(key, "compthreads")) {
+          zthnum = atoix(value);
+        } else if (!std::strcmp(key, "bthres") || !std::strcmp(key, "blobthres")) {
+          bthres = atoix(value);
         } else if (!std::strcmp(key, "rcomp") || !std::strcmp(key, "comparator")) {
           if (!std::strcmp(value, "lex") || !std::strcmp(value, "lexical")) {
             rcomp = LEXICALCOMP;
@@ -611,10 +774,18 @@ class PolyDB : public BasicDB {
             rcomp = LEXICALDESCCOMP;
           } else if (!std::strcmp(value, "decdesc") || !std::strcmp(value, "decimaldesc")) {
             rcomp = DECIMALDESCCOMP;
+          } else if (!std::strcmp(value, "int") || !std::strcmp(value, "integer")) {
+            rcomp = INTEGERCOMP;
+          } else if (!std::strcmp(value, "uint") || !std::strcmp(value, "unsigned")) {
+            rcomp = UNSIGNEDCOMP;
+          } else if (!std::strcmp(value, "flt") || !std::strcmp(value, "float")) {
+            rcomp = FLOATCOMP;
           }
         } else if (!std::strcmp(key, "zkey") || !std::strcmp(key, "pass") ||
                    !std::strcmp(key, "password")) {
           zkey = value;
+        } else if (!std::strcmp(key, "zdict") || !std::strcmp(key, "dictionary")) {
+          zdict = value;
         }
       }
       ++it;
@@ -669,33 +840,40 @@ class PolyDB : public BasicDB {
     }
     delete zcomp_;
     zcomp_ = NULL;
+    delete pcomp_;
+    pcomp_ = NULL;
     ArcfourCompressor* arccomp = NULL;
     if (!zcompname.empty()) {
-      if (zcompname == "zlib" || zcompname == "raw") {
-        zcomp_ = new ZLIBCompressor<ZLIB::RAW>;
-      } else if (zcompname == "def" || zcompname == "deflate") {
-        zcomp_ = new ZLIBCompressor<ZLIB::DEFLATE>;
-      } else if (zcompname == "gz" || zcompname == "gzip") {
-        zcomp_ = new ZLIBCompressor<ZLIB::GZIP>;
-      } else if (zcompname == "lzo" || zcompname == "oz") {
-        zcomp_ = new LZOCompressor<LZO::RAW>;
-      } else if (zcompname == "lzocrc" || zcompname == "ozcrc") {
-        zcomp_ = new LZOCompressor<LZO::CRC>;
-      } else if (zcompname == "lzma" || zcompname == "xz") {
-        zcomp_ = new LZMACompressor<LZMA::RAW>;
-      } else if (zcompname == "lzmacrc" || zcompname == "xzcrc") {
-        zcomp_ = new LZMACompressor<LZMA::CRC>;
-      } else if (zcompname == "lzmasha" || zcompname == "xzsha") {
-        zcomp_ = new LZMACompressor<LZMA::SHA>;
-      } else if (zcompname == "arc" || zcompname == "rc4") {
+      if (zcompname == "arc" || zcompname == "rc4") {
         arccomp = new ArcfourCompressor();
         zcomp_ = arccomp;
       } else if (zcompname == "arcz" || zcompname == "rc4z") {
         arccomp = new ArcfourCompressor();
         arccomp->set_compressor(ZLIBRAWCOMP);
         zcomp_ = arccomp;
+      } else if (!zdict.empty() && (zcompname == "zstd" || zcompname == "zst" ||
+                                    zcompname == "zstdcrc" || zcompname == "zstcrc")) {
+        ZSTD::Mode zmode = zcompname.find("crc") == std::string::npos ? ZSTD::RAW : ZSTD::CRC;
+        int64_t dsiz;
+        char* dbuf = File::read_file(zdict, &dsiz);
+        if (!dbuf) {
+          set_error(_KCCODELINE_, Error::NOREPOS, "reading the dictionary failed");
+          return false;
+        }
+        ZSTDDictCompressor* dictcomp = new ZSTDDictCompressor(zmode);
+        bool ok = dictcomp->set_dictionary(dbuf, dsiz);
+        delete[] dbuf;
+        if (!ok) {
+          set_error(_KCCODELINE_, Error::INVALID, "invalid dictionary");
+          delete dictcomp;
+          return false;
+        }
+        zcomp_ = dictcomp;
+      } else {
+        zcomp_ = new_compressor(zcompname);
       }
     }
+    if (!pcompname.empty()) pcomp_ = new_compressor(pcompname);
     BasicDB *db;
     switch (type) {
       default: {
@@ -751,6 +929,7 @@ class PolyDB : public BasicDB {
       case TYPECACHE: {
         int8_t opts = 0;
         if (tcompress) opts |= CacheDB::TCOMPRESS;
+        if (txxhash) opts |= CacheDB::TXXHASH;
         CacheDB* cdb = new CacheDB();
         if (stdlogger_) {
           cdb->tune_logger(stdlogger_, logkinds);
@@ -773,6 +952,7 @@ class PolyDB : public BasicDB {
       case TYPEGRASS: {
         int8_t opts = 0;
         if (tcompress) opts |= GrassDB::TCOMPRESS;
+        if (txxhash) opts |= GrassDB::TXXHASH;
         GrassDB* gdb = new GrassDB();
         if (stdlogger_) {
           gdb->tune_logger(stdlogger_, logkinds);
@@ -789,6 +969,11 @@ class PolyDB : public BasicDB {
         if (psiz > 0) gdb->tune_page(psiz);
         if (zcomp_) gdb->tune_compressor(zcomp_);
         if (pccap > 0) gdb->tune_page_cache(pccap);
+        if (pcomp_) gdb->tune_page_compressor(pcomp_);
+        if (zccap >= 0) gdb->tune_compressed_cache(zccap);
+        if (rsint >= 0) gdb->tune_front_coding(rsint);
+        if (bfill >= 0) gdb->tune_bulk_fill(bfill);
+        if (bloom >= 0) gdb->tune_bloom(bloom);
         if (rcomp) gdb->tune_comparator(rcomp);
         db = gdb;
         break;
@@ -798,6 +983,13 @@ class PolyDB : public BasicDB {
         if (tsmall) opts |= HashDB::TSMALL;
         if (tlinear) opts |= HashDB::TLINEAR;
         if (tcompress) opts |= HashDB::TCOMPRESS;
+        if (txxhash) opts |= HashDB::TXXHASH;
+        if (tchecksum) opts |= HashDB::TCHECKSUM;
+        if (tblob) opts |= HashDB::TBLOB;
+        int8_t mopts = 0;
+        if (mgrow) mopts |= HashDB::MGROW;
+        if (mpopulate) mopts |= HashDB::MPOPULATE;
+        if (mhuge) mopts |= HashDB::MHUGE;
         HashDB* hdb = new HashDB();
         if (stdlogger_) {
           hdb->tune_logger(stdlogger_, logkinds);
@@ -814,8 +1006,17 @@ class PolyDB : public BasicDB {
         if (opts > 0) hdb->tune_options(opts);
         if (bnum > 0) hdb->tune_buckets(bnum);
         if (msiz >= 0) hdb->tune_map(msiz);
+        if (mopts > 0) hdb->tune_map_options(mopts);
         if (dfunit > 0) hdb->tune_defrag(dfunit);
+        if (rasiz >= 0) hdb->tune_readahead(rasiz);
         if (zcomp_) hdb->tune_compressor(zcomp_);
+        if (bloom >= 0) hdb->tune_bloom(bloom);
+        if (gcdelay >= 0) hdb->tune_group_commit(gcdelay);
+        if (redolog >= 0) hdb->tune_redo_log(redolog);
+        if (bsint >= 0 || bslimit >= 0) hdb->tune_background_sync(bsint, bslimit);
+        if (verify >= 0) hdb->tune_verification(verify > 0);
+        if (zthnum >= 0) hdb->tune_compression_threads(zthnum);
+        if (bthres > 0) hdb->tune_blob(bthres);
         db = hdb;
         break;
       }
@@ -824,6 +1025,12 @@ class PolyDB : public BasicDB {
         if (tsmall) opts |= TreeDB::TSMALL;
         if (tlinear) opts |= TreeDB::TLINEAR;
         if (tcompress) opts |= TreeDB::TCOMPRESS;
+        if (txxhash) opts |= TreeDB::TXXHASH;
+        if (tchecksum) opts |= TreeDB::TCHECKSUM;
+        int8_t mopts = 0;
+        if (mgrow) mopts |= TreeDB::MGROW;
+        if (mpopulate) mopts |= TreeDB::MPOPULATE;
+        if (mhuge) mopts |= TreeDB::MHUGE;
         TreeDB* tdb = new TreeDB();
         if (stdlogger_) {
           tdb->tune_logger(stdlogger_, logkinds);
@@ -841,9 +1048,21 @@ class PolyDB : public BasicDB {
         if (bnum > 0) tdb->tune_buckets(bnum);
         if (psiz > 0) tdb->tune_page(psiz);
         if (msiz >= 0) tdb->tune_map(msiz);
+        if (mopts > 0) tdb->tune_map_options(mopts);
         if (dfunit > 0) tdb->tune_defrag(dfunit);
         if (zcomp_) tdb->tune_compressor(zcomp_);
         if (pccap > 0) tdb->tune_page_cache(pccap);
+        if (pcomp_) tdb->tune_page_compressor(pcomp_);
+        if (zccap >= 0) tdb->tune_compressed_cache(zccap);
+        if (rsint >= 0) tdb->tune_front_coding(rsint);
+        if (bfill >= 0) tdb->tune_bulk_fill(bfill);
+        if (wblow >= 0 || wbhigh >= 0) tdb->tune_write_back(wblow, wbhigh);
+        if (pfdepth >= 0) tdb->tune_prefetch(pfdepth);
+        if (bloom >= 0) tdb->tune_bloom(bloom);
+        if (gcdelay >= 0) tdb->tune_group_commit(gcdelay);
+        if (redolog >= 0) tdb->tune_redo_log(redolog);
+        if (bsint >= 0 || bslimit >= 0) tdb->tune_background_sync(bsint, bslimit);
+        if (verify >= 0) tdb->tune_verification(verify > 0);
         if (rcomp) tdb->tune_comparator(rcomp);
         db = tdb;
         break;
@@ -886,6 +1105,12 @@ class PolyDB : public BasicDB {
         if (psiz > 0) fdb->tune_page(psiz);
         if (zcomp_) fdb->tune_compressor(zcomp_);
         if (pccap > 0) fdb->tune_page_cache(pccap);
+        if (pcomp_) fdb->tune_page_compressor(pcomp_);
+        if (zccap >= 0) fdb->tune_compressed_cache(zccap);
+        if (rsint >= 0) fdb->tune_front_coding(rsint);
+        if (bfill >= 0) fdb->tune_bulk_fill(bfill);
+        if (wblow >= 0 || wbhigh >= 0) fdb->tune_write_back(wblow, wbhigh);
+        if (bloom >= 0) fdb->tune_bloom(bloom);
         if (rcomp) fdb->tune_comparator(rcomp);
         db = fdb;
         break;
@@ -939,6 +1164,7 @@ class PolyDB : public BasicDB {
       set_error(_KCCODELINE_, error.code(), error.message());
       err = true;
     }
+    delete pcomp_;
     delete zcomp_;
     delete stdmtrigger_;
     delete stdmtrgstrm_;
@@ -952,6 +1178,7 @@ class PolyDB : public BasicDB {
     stdmtrgstrm_ = NULL;
     stdmtrigger_ = NULL;
     zcomp_ = NULL;
+    pcomp_ = NULL;
     return !err;
   }
   /**
@@ -1480,6 +1707,20 @@ class PolyDB : public BasicDB {
     _assert_(true);
     return new Cursor(this);
   }
+  /**
+   * Create a snapshot object.
+   * @return the created snapshot object, or NULL on failure.
+   * @note Because the object of the return value is allocated by the constructor, it should be
+   * released with the delete operator when it is no longer in use.
+   */
+  Snapshot* snapshot() {
+    _assert_(true);
+    if (type_ == TYPEVOID) {
+      set_error(_KCCODELINE_, Error::INVALID, "not opened");
+      return NULL;
+    }
+    return db_->snapshot();
+  }
   /**
    * Write a log message.
    * @param file the file name of the program source code.
@@ -1620,6 +1861,27 @@ class PolyDB : public BasicDB {
       return comp->compare(kbuf, ksiz, right.kbuf, right.ksiz) > 0;
     }
   };
+  /**
+   * Create a compressor by name.
+   * @param name the name of the compressor.
+   * @return the new compressor object, or NULL if the name is unknown.
+   */
+  static Compressor* new_compressor(const std::string& name) {
+    _assert_(true);
+    if (name == "zlib" || name == "raw") return new ZLIBCompressor<ZLIB::RAW>;
+    if (name == "def" || name == "deflate") return new ZLIBCompressor<ZLIB::DEFLATE>;
+    if (name == "gz" || name == "gzip") return new ZLIBCompressor<ZLIB::GZIP>;
+    if (name == "lzo" || name == "oz") return new LZOCompressor<LZO::RAW>;
+    if (name == "lzocrc" || name == "ozcrc") return new LZOCompressor<LZO::CRC>;
+    if (name == "lzma" || name == "xz") return new LZMACompressor<LZMA::RAW>;
+    if (name == "lzmacrc" || name == "xzcrc") return new LZMACompressor<LZMA::CRC>;
+    if (name == "lzmasha" || name == "xzsha") return new LZMACompressor<LZMA::SHA>;
+    if (name == "lz4") return new LZ4Compressor<LZ4::RAW>;
+    if (name == "lz4crc") return new LZ4Compressor<LZ4::CRC>;
+    if (name == "zstd" || name == "zst") return new ZSTDCompressor<ZSTD::RAW>;
+    if (name == "zstdcrc" || name == "zstcrc") return new ZSTDCompressor<ZSTD::CRC>;
+    return NULL;
+  }
   /** Dummy constructor to forbid the use. */
   PolyDB(const PolyDB&);
   /** Dummy Operator to forbid the use. */
@@ -1646,6 +1908,8 @@ class PolyDB : public BasicDB {
   MetaTrigger* mtrigger_;
   /** The custom compressor. */
   Compressor* zcomp_;
+  /** The compressor of leaf pages. */
+  Compressor* pcomp_;
 };
 
 
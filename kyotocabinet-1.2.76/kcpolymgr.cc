@@ -25,6 +25,7 @@ const char* g_progname;                  // program name
 int main(int argc, char** argv);
 static void usage();
 static void dberrprint(kc::BasicDB* db, const char* info);
+static kc::Compressor* snapcomp(int32_t zmode);
 static int32_t runcreate(int argc, char** argv);
 static int32_t runinform(int argc, char** argv);
 static int32_t runset(int argc, char** argv);
@@ -41,6 +42,7 @@ static int32_t runsetbulk(int argc, char** argv);
 static int32_t runremovebulk(int argc, char** argv);
 static int32_t rungetbulk(int argc, char** argv);
 static int32_t runcheck(int argc, char** argv);
+static int32_t runzdict(int argc, char** argv);
 static int32_t proccreate(const char* path, int32_t oflags);
 static int32_t procinform(const char* path, int32_t oflags, bool st);
 static int32_t procset(const char* path, const char* kbuf, size_t ksiz,
@@ -53,8 +55,10 @@ static int32_t proclist(const char* path, const char*kbuf, size_t ksiz, int32_t
 static int32_t procclear(const char* path, int32_t oflags);
 static int32_t procimport(const char* path, const char* file, int32_t oflags, bool sx);
 static int32_t proccopy(const char* path, const char* file, int32_t oflags);
-static int32_t procdump(const char* path, const char* file, int32_t oflags);
-static int32_t procload(const char* path, const char* file, int32_t oflags);
+static int32_t procdump(const char* path, const char* file, int32_t oflags,
+                        int32_t zmode, int32_t thnum);
+static int32_t procload(const char* path, const char* file, int32_t oflags,
+                        int32_t zmode, int32_t thnum);
 static int32_t procmerge(const char* path, int32_t oflags, kc::PolyDB::MergeMode mode,
                          const std::vector<std::string>& srcpaths);
 static int32_t procsetbulk(const char* path, int32_t oflags,
@@ -64,6 +68,8 @@ static int32_t procremovebulk(const char* path, int32_t oflags,
 static int32_t procgetbulk(const char* path, int32_t oflags,
                            const std::vector<std::string>& keys, bool px);
 static int32_t proccheck(const char* path, int32_t oflags);
+static int32_t proczdict(const char* path, const char* file, int32_t oflags,
+                         int64_t cap, int64_t max);
 
 
 // main routine
@@ -104,6 +110,8 @@ int main(int argc, char** argv) {
     rv = rungetbulk(argc, argv);
   } else if (!std::strcmp(argv[1], "check")) {
     rv = runcheck(argc, argv);
+  } else if (!std::strcmp(argv[1], "zdict")) {
+    rv = runzdict(argc, argv);
   } else if (!std::strcmp(argv[1], "version") || !std::strcmp(argv[1], "--version")) {
     printversion();
   } else {
@@ -130,13 +138,16 @@ static void usage() {
   eprintf("  %s clear [-onl|-otl|-onr] path\n", g_progname);
   eprintf("  %s import [-onl|-otl|-onr] [-sx] path [file]\n", g_progname);
   eprintf("  %s copy [-onl|-otl|-onr] path file\n", g_progname);
-  eprintf("  %s dump [-onl|-otl|-onr] path [file]\n", g_progname);
-  eprintf("  %s load [-otr] [-onl|-otl|-onr] path [file]\n", g_progname);
+  eprintf("  %s dump [-onl|-otl|-onr] [-zlib|-lz4|-zstd] [-th num] path [file]\n",
+          g_progname);
+  eprintf("  %s load [-otr] [-onl|-otl|-onr] [-zlib|-lz4|-zstd] [-th num] path [file]\n",
+          g_progname);
   eprintf("  %s merge [-onl|-otl|-onr] [-add|-rep|-app] path src...\n", g_progname);
   eprintf("  %s setbulk [-onl|-otl|-onr] [-sx] path key value ...\n", g_progname);
   eprintf("  %s removebulk [-onl|-otl|-onr] [-sx] path key ...\n", g_progname);
   eprintf("  %s getbulk [-onl|-otl|-onr] [-sx] [-px] path key ...\n", g_progname);
   eprintf("  %s check [-onl|-otl|-onr] path\n", g_progname);
+  eprintf("  %s zdict [-onl|-otl|-onr] [-cap num] [-max num] path file\n", g_progname);
   eprintf("\n");
   std::exit(1);
 }
@@ -150,6 +161,20 @@ static void dberrprint(kc::BasicDB* db, const char* info) {
 }
 
 
+// get the compressor of snapshots
+static kc::Compressor* snapcomp(int32_t zmode) {
+  static kc::ZLIBCompressor<kc::ZLIB::RAW> zlibcomp;
+  static kc::LZ4Compressor<kc::LZ4::CRC> lz4comp;
+  static kc::ZSTDCompressor<kc::ZSTD::CRC> zstdcomp;
+  switch (zmode) {
+    case 1: return &zlibcomp;
+    case 2: return &lz4comp;
+    case 3: return &zstdcomp;
+  }
+  return NULL;
+}
+
+
 // parse arguments of create command
 static int32_t runcreate(int argc, char** argv) {
   bool argbrk = false;
@@ -570,6 +595,8 @@ static int32_t rundump(int argc, char** argv) {
   const char* path = NULL;
   const char* file = NULL;
   int32_t oflags = 0;
+  int32_t zmode = 0;
+  int32_t thnum = 1;
   for (int32_t i = 2; i < argc; i++) {
     if (!argbrk && argv[i][0] == '-') {
       if (!std::strcmp(argv[i], "--")) {
@@ -580,6 +607,15 @@ static int32_t rundump(int argc, char** argv) {
         oflags |= kc::PolyDB::OTRYLOCK;
       } else if (!std::strcmp(argv[i], "-onr")) {
         oflags |= kc::PolyDB::ONOREPAIR;
+      } else if (!std::strcmp(argv[i], "-zlib")) {
+        zmode = 1;
+      } else if (!std::strcmp(argv[i], "-lz4")) {
+        zmode = 2;
+      } else if (!std::strcmp(argv[i], "-zstd")) {
+        zmode = 3;
+      } else if (!std::strcmp(argv[i], "-th")) {
+        if (++i >= argc) usage();
+        thnum = kc::atoix(argv[i]);
       } else {
         usage();
       }
@@ -592,8 +628,8 @@ static int32_t rundump(int argc, char** argv) {
       usage();
     }
   }
-  if (!path) usage();
-  int32_t rv = procdump(path, file, oflags);
+  if (!path || thnum < 1) usage();
+  int32_t rv = procdump(path, file, oflags, zmode, thnum);
   return rv;
 }
 
@@ -604,6 +640,8 @@ static int32_t runload(int argc, char** argv) {
   const char* path = NULL;
   const char* file = NULL;
   int32_t oflags = 0;
+  int32_t zmode = 0;
+  int32_t thnum = 1;
   for (int32_t i = 2; i < argc; i++) {
     if (!argbrk && argv[i][0] == '-') {
       if (!std::strcmp(argv[i], "--")) {
@@ -616,6 +654,15 @@ static int32_t runload(int argc, char** argv) {
         oflags |= kc::PolyDB::OTRYLOCK;
       } else if (!std::strcmp(argv[i], "-onr")) {
         oflags |= kc::PolyDB::ONOREPAIR;
+      } else if (!std::strcmp(argv[i], "-zlib")) {
+        zmode = 1;
+      } else if (!std::strcmp(argv[i], "-lz4")) {
+        zmode = 2;
+      } else if (!std::strcmp(argv[i], "-zstd")) {
+        zmode = 3;
+      } else if (!std::strcmp(argv[i], "-th")) {
+        if (++i >= argc) usage();
+        thnum = kc::atoix(argv[i]);
       } else {
         usage();
       }
@@ -628,8 +675,8 @@ static int32_t runload(int argc, char** argv) {
       usage();
     }
   }
-  if (!path) usage();
-  int32_t rv = procload(path, file, oflags);
+  if (!path || thnum < 1) usage();
+  int32_t rv = procload(path, file, oflags, zmode, thnum);
   return rv;
 }
 
@@ -858,6 +905,48 @@ static int32_t runcheck(int argc, char** argv) {
 }
 
 
+// parse arguments of zdict command
+static int32_t runzdict(int argc, char** argv) {
+  bool argbrk = false;
+  const char* path = NULL;
+  const char* file = NULL;
+  int32_t oflags = 0;
+  int64_t cap = 1LL << 16;
+  int64_t max = 1LL << 14;
+  for (int32_t i = 2; i < argc; i++) {
+    if (!argbrk && argv[i][0] == '-') {
+      if (!std::strcmp(argv[i], "--")) {
+        argbrk = true;
+      } else if (!std::strcmp(argv[i], "-onl")) {
+        oflags |= kc::PolyDB::ONOLOCK;
+      } else if (!std::strcmp(argv[i], "-otl")) {
+        oflags |= kc::PolyDB::OTRYLOCK;
+      } else if (!std::strcmp(argv[i], "-onr")) {
+        oflags |= kc::PolyDB::ONOREPAIR;
+      } else if (!std::strcmp(argv[i], "-cap")) {
+        if (++i >= argc) usage();
+        cap = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-max")) {
+        if (++i >= argc) usage();
+        max = kc::atoix(argv[i]);
+      } else {
+        usage();
+      }
+    } else if (!path) {
+      argbrk = true;
+      path = argv[i];
+    } else if (!file) {
+      file = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!path || !file || cap < 1 || max < 1) usage();
+  int32_t rv = proczdict(path, file, oflags, cap, max);
+  return rv;
+}
+
+
 // perform create command
 static int32_t proccreate(const char* path, int32_t oflags) {
   kc::PolyDB db;
@@ -1302,7 +1391,8 @@ static int32_t proccopy(const char* path, const char* file, int32_t oflags) {
 
 
 // perform dump command
-static int32_t procdump(const char* path, const char* file, int32_t oflags) {
+static int32_t procdump(const char* path, const char* file, int32_t oflags,
+                        int32_t zmode, int32_t thnum) {
   kc::PolyDB db;
   db.tune_logger(stdlogger(g_progname, &std::cerr));
   if (!db.open(path, kc::PolyDB::OREADER | oflags)) {
@@ -1312,14 +1402,14 @@ static int32_t procdump(const char* path, const char* file, int32_t oflags) {
   bool err = false;
   if (file) {
     DotChecker checker(&std::cout, 1000);
-    if (!db.dump_snapshot(file, &checker)) {
+    if (!db.dump_snapshot(file, &checker, snapcomp(zmode), thnum)) {
       dberrprint(&db, "DB::dump_snapshot");
       err = true;
     }
     oprintf(" (end)\n");
     if (!err) oprintf("%lld records were dumped successfully\n", (long long)checker.count());
   } else {
-    if (!db.dump_snapshot(&std::cout)) {
+    if (!db.dump_snapshot(&std::cout, NULL, snapcomp(zmode), thnum)) {
       dberrprint(&db, "DB::dump_snapshot");
       err = true;
     }
@@ -1333,7 +1423,8 @@ static int32_t procdump(const char* path, const char* file, int32_t oflags) {
 
 
 // perform load command
-static int32_t procload(const char* path, const char* file, int32_t oflags) {
+static int32_t procload(const char* path, const char* file, int32_t oflags,
+                        int32_t zmode, int32_t thnum) {
   kc::PolyDB db;
   db.tune_logger(stdlogger(g_progname, &std::cerr));
   if (!db.open(path, kc::PolyDB::OWRITER | kc::PolyDB::OCREATE | oflags)) {
@@ -1343,7 +1434,7 @@ static int32_t procload(const char* path, const char* file, int32_t oflags) {
   bool err = false;
   if (file) {
     DotChecker checker(&std::cout, -1000);
-    if (!db.load_snapshot(file, &checker)) {
+    if (!db.load_snapshot(file, &checker, snapcomp(zmode), thnum)) {
       dberrprint(&db, "DB::load_snapshot");
       err = true;
     }
@@ -1351,7 +1442,7 @@ static int32_t procload(const char* path, const char* file, int32_t oflags) {
     if (!err) oprintf("%lld records were loaded successfully\n", (long long)checker.count());
   } else {
     DotChecker checker(&std::cout, -1000);
-    if (!db.load_snapshot(&std::cin)) {
+    if (!db.load_snapshot(&std::cin, &checker, snapcomp(zmode), thnum)) {
       dberrprint(&db, "DB::load_snapshot");
       err = true;
     }
@@ -1569,5 +1660,58 @@ static int32_t proccheck(const char* path, int32_t oflags) {
 }
 
 
+// perform zdict command
+static int32_t proczdict(const char* path, const char* file, int32_t oflags,
+                         int64_t cap, int64_t max) {
+  kc::PolyDB db;
+  db.tune_logger(stdlogger(g_progname, &std::cerr));
+  if (!db.open(path, kc::PolyDB::OREADER | oflags)) {
+    dberrprint(&db, "DB::open failed");
+    return 1;
+  }
+  bool err = false;
+  std::vector<std::string> samples;
+  kc::PolyDB::Cursor cur(&db);
+  if (!cur.jump() && db.error() != kc::BasicDB::Error::NOREC) {
+    dberrprint(&db, "DB::jump failed");
+    err = true;
+  }
+  while (!err && (int64_t)samples.size() < max) {
+    size_t ksiz;
+    const char* vbuf;
+    size_t vsiz;
+    char* kbuf = cur.get(&ksiz, &vbuf, &vsiz, true);
+    if (!kbuf) {
+      if (db.error() != kc::BasicDB::Error::NOREC) {
+        dberrprint(&db, "Cursor::get failed");
+        err = true;
+      }
+      break;
+    }
+    samples.push_back(std::string(vbuf, vsiz));
+    delete[] kbuf;
+  }
+  if (!db.close()) {
+    dberrprint(&db, "DB::close failed");
+    err = true;
+  }
+  if (err) return 1;
+  size_t dsiz;
+  char* dbuf = kc::ZSTD::train_dictionary(samples, cap, &dsiz);
+  if (!dbuf) {
+    eprintf("%s: %s: training the dictionary failed\n", g_progname, path);
+    return 1;
+  }
+  if (!kc::File::write_file(file, dbuf, dsiz)) {
+    eprintf("%s: %s: writing failed\n", g_progname, file);
+    err = true;
+  }
+  delete[] dbuf;
+  if (!err) oprintf("%lld bytes were trained from %lld records\n",
+                    (long long)dsiz, (long long)samples.size());
+  return err ? 1 : 0;
+}
+
+
 
 // END OF FILE
@@ -2034,6 +2034,23 @@ static int32_t procwicked(const char* path, int64_t rnum, int32_t thnum, int32_t
               }
             }
           }
+          if (myrand(200) == 0) {
+            int32_t jnum = myrand(10);
+            kc::BasicDB::WriteBatch batch;
+            for (int32_t j = 0; j < jnum; j++) {
+              char jbuf[RECBUFSIZ];
+              size_t jsiz = std::sprintf(jbuf, "%lld", (long long)(myrand(range) + 1));
+              if (myrand(3) == 0) {
+                batch.remove(jbuf, jsiz);
+              } else {
+                batch.set(jbuf, jsiz, kbuf, ksiz);
+              }
+            }
+            if (!db_->apply_batch(batch)) {
+              dberrprint(db_, __LINE__, "DB::apply_batch");
+              err_ = true;
+            }
+          }
           if (i == rnum_ / 2) {
             if (myrand(thnum_ * 4) == 0 && !db_->clear()) {
               dberrprint(db_, __LINE__, "DB::clear");
@@ -2956,6 +2973,95 @@ static int32_t procmisc(const char* path) {
       keys.clear();
     }
   }
+  oprintf("applying batches:\n");
+  if (!err) {
+    int64_t onum = db->count();
+    int64_t bnum = rnum < 100 ? rnum : 100;
+    kc::BasicDB::WriteBatch batch;
+    for (int64_t i = 1; i <= bnum; i++) {
+      char kbuf[RECBUFSIZ];
+      size_t ksiz = std::sprintf(kbuf, "batch:%08lld", (long long)i);
+      batch.set(kbuf, ksiz, kbuf, ksiz);
+      if (i % 2 == 0) batch.remove(kbuf, ksiz);
+    }
+    if (db->apply_batch(batch)) {
+      if (db->count() != onum + bnum - bnum / 2) {
+        dberrprint(db, __LINE__, "DB::apply_batch");
+        err = true;
+      }
+    } else {
+      dberrprint(db, __LINE__, "DB::apply_batch");
+      err = true;
+    }
+    batch.clear();
+    for (int64_t i = 1; i <= bnum; i++) {
+      char kbuf[RECBUFSIZ];
+      size_t ksiz = std::sprintf(kbuf, "batch:%08lld", (long long)i);
+      batch.remove(kbuf, ksiz);
+    }
+    if (!db->apply_batch(batch) || db->count() != onum) {
+      dberrprint(db, __LINE__, "DB::apply_batch");
+      err = true;
+    }
+  }
+  oprintf("reading snapshots:\n");
+  kc::BasicDB::Snapshot* snap = err ? NULL : db->snapshot();
+  if (snap) {
+    std::map<std::string, std::string> recs;
+    kc::DB::Cursor* cur = db->cursor();
+    cur->jump();
+    std::string key, value;
+    while (cur->get(&key, &value, true)) {
+      recs[key] = value;
+    }
+    delete cur;
+    for (int64_t i = 1; !err && i <= rnum; i++) {
+      char kbuf[RECBUFSIZ];
+      size_t ksiz = std::sprintf(kbuf, "%08lld", (long long)i);
+      bool ok = true;
+      switch (i % 4) {
+        case 0: ok = db->set(kbuf, ksiz, "snapshot", 8); break;
+        case 1: ok = db->remove(kbuf, ksiz) || db->error() == kc::BasicDB::Error::NOREC; break;
+        case 2: ok = db->append(kbuf, ksiz, "!", 1); break;
+      }
+      if (!ok) {
+        dberrprint(db, __LINE__, "DB::set");
+        err = true;
+      }
+      ksiz = std::sprintf(kbuf, "snapshot:%08lld", (long long)i);
+      if (i % 3 == 0 && !db->set(kbuf, ksiz, kbuf, ksiz)) {
+        dberrprint(db, __LINE__, "DB::set");
+        err = true;
+      }
+    }
+    int64_t cnt = 0;
+    kc::BasicDB::Snapshot::Cursor* scur = snap->cursor();
+    scur->jump();
+    while (!err && scur->get(&key, &value, true)) {
+      std::map<std::string, std::string>::iterator it = recs.find(key);
+      if (it == recs.end() || it->second != value) {
+        dberrprint(db, __LINE__, "Snapshot::Cursor::get");
+        err = true;
+      }
+      cnt++;
+    }
+    if (!err && (db->error() != kc::BasicDB::Error::NOREC || cnt != (int64_t)recs.size())) {
+      dberrprint(db, __LINE__, "Snapshot::Cursor::get");
+      err = true;
+    }
+    delete scur;
+    for (int64_t i = 1; !err && i <= rnum; i += 7) {
+      char kbuf[RECBUFSIZ];
+      size_t ksiz = std::sprintf(kbuf, "%08lld", (long long)i);
+      std::map<std::string, std::string>::iterator it = recs.find(std::string(kbuf, ksiz));
+      if (snap->get(std::string(kbuf, ksiz), &value) ?
+          it == recs.end() || it->second != value : it != recs.end()) {
+        dberrprint(db, __LINE__, "Snapshot::get");
+        err = true;
+      }
+    }
+    delete snap;
+  }
   kc::PolyDB* pdb = dynamic_cast<kc::PolyDB*>(db);
   if (pdb) {
     kc::BasicDB* idb = pdb->reveal_inner_db();
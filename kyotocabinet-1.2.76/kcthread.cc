@@ -25,6 +25,8 @@ namespace kyotocabinet {                 // common namespace
 namespace {
 const uint32_t LOCKBUSYLOOP = 8192;      ///< threshold of busy loop and sleep for locking
 const size_t LOCKSEMNUM = 256;           ///< number of semaphores for locking
+const size_t DRWLOCKSLOTNUM = 64;        ///< number of reader slots of distributed locks
+const size_t CACHELINESIZ = 64;          ///< size of a cache line
 }
 
 
@@ -1760,6 +1762,217 @@ static void slottedspinrwlockunlock(SlottedSpinRWLockCore* core, size_t idx) {
 }
 
 
+/**
+ * DistributedRWLock internal.
+ */
+#if _KC_GCCATOMIC
+struct DistributedRWLockSlot {
+  volatile int64_t cnt;                  ///< count of readers
+  char pad[CACHELINESIZ-sizeof(int64_t)];  ///< padding to occupy a cache line
+};
+struct DistributedRWLockCore {
+  char* rbuf;                            ///< region of the slots
+  DistributedRWLockSlot* slots;          ///< aligned reader slots
+  RWLock wlock;                          ///< lock for writers and blocked readers
+  volatile int32_t wflag;                ///< flag of a waiting or active writer
+  volatile int32_t wown;                 ///< flag of the active writer
+};
+#else
+struct DistributedRWLockCore {
+  RWLock rwlock;                         ///< primitive
+};
+#endif
+
+
+#if _KC_GCCATOMIC
+/**
+ * Get the index of the reader slot of the current thread.
+ * @return the index of the reader slot.
+ */
+static size_t distrwlockslot();
+#endif
+
+
+/**
+ * Default constructor.
+ */
+DistributedRWLock::DistributedRWLock() : opq_(NULL) {
+#if _KC_GCCATOMIC
+  _assert_(true);
+  DistributedRWLockCore* core = new DistributedRWLockCore;
+  core->rbuf = new char[sizeof(DistributedRWLockSlot)*DRWLOCKSLOTNUM+CACHELINESIZ];
+  size_t pad = CACHELINESIZ - (size_t)((uintptr_t)core->rbuf % CACHELINESIZ);
+  core->slots = (DistributedRWLockSlot*)(core->rbuf + pad);
+  for (size_t i = 0; i < DRWLOCKSLOTNUM; i++) {
+    core->slots[i].cnt = 0;
+  }
+  core->wflag = 0;
+  core->wown = 0;
+  opq_ = (void*)core;
+#else
+  _assert_(true);
+  DistributedRWLockCore* core = new DistributedRWLockCore;
+  opq_ = (void*)core;
+#endif
+}
+
+
+/**
+ * Destructor.
+ */
+DistributedRWLock::~DistributedRWLock() {
+#if _KC_GCCATOMIC
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  delete[] core->rbuf;
+  delete core;
+#else
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  delete core;
+#endif
+}
+
+
+/**
+ * Get the writer lock.
+ */
+void DistributedRWLock::lock_writer() {
+#if _KC_GCCATOMIC
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  core->wlock.lock_writer();
+  __sync_lock_test_and_set(&core->wflag, 1);
+  __sync_synchronize();
+  for (size_t i = 0; i < DRWLOCKSLOTNUM; i++) {
+    DistributedRWLockSlot* slot = core->slots + i;
+    uint32_t wcnt = 0;
+    while (slot->cnt > 0) {
+      if (wcnt >= LOCKBUSYLOOP) {
+        Thread::chill();
+      } else {
+        Thread::yield();
+        wcnt++;
+      }
+    }
+  }
+  core->wown = 1;
+#else
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  core->rwlock.lock_writer();
+#endif
+}
+
+
+/**
+ * Try to get the writer lock.
+ */
+bool DistributedRWLock::lock_writer_try() {
+#if _KC_GCCATOMIC
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  if (!core->wlock.lock_writer_try()) return false;
+  __sync_lock_test_and_set(&core->wflag, 1);
+  __sync_synchronize();
+  for (size_t i = 0; i < DRWLOCKSLOTNUM; i++) {
+    if (core->slots[i].cnt > 0) {
+      __sync_lock_release(&core->wflag);
+      core->wlock.unlock();
+      return false;
+    }
+  }
+  core->wown = 1;
+  return true;
+#else
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  return core->rwlock.lock_writer_try();
+#endif
+}
+
+
+/**
+ * Get a reader lock.
+ */
+void DistributedRWLock::lock_reader() {
+#if _KC_GCCATOMIC
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  DistributedRWLockSlot* slot = core->slots + distrwlockslot();
+  while (true) {
+    __sync_fetch_and_add(&slot->cnt, 1);
+    if (!core->wflag) break;
+    __sync_fetch_and_sub(&slot->cnt, 1);
+    core->wlock.lock_reader();
+    core->wlock.unlock();
+  }
+#else
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  core->rwlock.lock_reader();
+#endif
+}
+
+
+/**
+ * Try to get a reader lock.
+ */
+bool DistributedRWLock::lock_reader_try() {
+#if _KC_GCCATOMIC
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  DistributedRWLockSlot* slot = core->slots + distrwlockslot();
+  __sync_fetch_and_add(&slot->cnt, 1);
+  if (!core->wflag) return true;
+  __sync_fetch_and_sub(&slot->cnt, 1);
+  return false;
+#else
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  return core->rwlock.lock_reader_try();
+#endif
+}
+
+
+/**
+ * Release the lock.
+ */
+void DistributedRWLock::unlock() {
+#if _KC_GCCATOMIC
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  if (core->wown) {
+    core->wown = 0;
+    __sync_synchronize();
+    __sync_lock_release(&core->wflag);
+    core->wlock.unlock();
+  } else {
+    __sync_fetch_and_sub(&core->slots[distrwlockslot()].cnt, 1);
+  }
+#else
+  _assert_(true);
+  DistributedRWLockCore* core = (DistributedRWLockCore*)opq_;
+  core->rwlock.unlock();
+#endif
+}
+
+
+#if _KC_GCCATOMIC
+/**
+ * Get the index of the reader slot of the current thread.
+ */
+static size_t distrwlockslot() {
+  _assert_(true);
+  uint64_t hash = Thread::hash();
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash % DRWLOCKSLOTNUM;
+}
+#endif
+
+
 /**
  * Default constructor.
  */
@@ -575,6 +575,91 @@ class SlottedSpinRWLock {
 };
 
 
+/**
+ * Reader-writer locking device with distributed reader counters.
+ * @note Each reader touches only the counter of the slot assigned to the calling thread, so
+ * readers on different cores do not share a cache line.  Writers are expensive because they
+ * have to wait for all slots to drain.  It is suitable for locks acquired by readers very
+ * frequently and by writers very rarely.  A thread must not get a reader lock recursively.
+ */
+class DistributedRWLock {
+ public:
+  /**
+   * Default constructor.
+   */
+  explicit DistributedRWLock();
+  /**
+   * Destructor.
+   */
+  ~DistributedRWLock();
+  /**
+   * Get the writer lock.
+   */
+  void lock_writer();
+  /**
+   * Try to get the writer lock.
+   * @return true on success, or false on failure.
+   */
+  bool lock_writer_try();
+  /**
+   * Get a reader lock.
+   */
+  void lock_reader();
+  /**
+   * Try to get a reader lock.
+   * @return true on success, or false on failure.
+   */
+  bool lock_reader_try();
+  /**
+   * Release the lock.
+   */
+  void unlock();
+ private:
+  /** Dummy constructor to forbid the use. */
+  DistributedRWLock(const DistributedRWLock&);
+  /** Dummy Operator to forbid the use. */
+  DistributedRWLock& operator =(const DistributedRWLock&);
+  /** Opaque pointer. */
+  void* opq_;
+};
+
+
+/**
+ * Scoped distributed reader-writer locking device.
+ */
+class ScopedDistributedRWLock {
+ public:
+  /**
+   * Constructor.
+   * @param drwlock a distributed rwlock to lock the block.
+   * @param writer true for writer lock, or false for reader lock.
+   */
+  explicit ScopedDistributedRWLock(DistributedRWLock* drwlock, bool writer) :
+      drwlock_(drwlock) {
+    _assert_(drwlock);
+    if (writer) {
+      drwlock_->lock_writer();
+    } else {
+      drwlock_->lock_reader();
+    }
+  }
+  /**
+   * Destructor.
+   */
+  ~ScopedDistributedRWLock() {
+    _assert_(true);
+    drwlock_->unlock();
+  }
+ private:
+  /** Dummy constructor to forbid the use. */
+  ScopedDistributedRWLock(const ScopedDistributedRWLock&);
+  /** Dummy Operator to forbid the use. */
+  ScopedDistributedRWLock& operator =(const ScopedDistributedRWLock&);
+  /** The inner device. */
+  DistributedRWLock* drwlock_;
+};
+
+
 /**
  * Condition variable.
  */
@@ -63,7 +63,7 @@ static int32_t procremovebulk(const char* path, int32_t oflags,
                               const std::vector<std::string>& keys);
 static int32_t procgetbulk(const char* path, int32_t oflags,
                            const std::vector<std::string>& keys, bool px);
-static int32_t proccheck(const char* path, int32_t oflags);
+static int32_t proccheck(const char* path, int32_t oflags, int32_t thnum);
 
 
 // main routine
@@ -119,8 +119,8 @@ static void usage() {
           g_progname);
   eprintf("\n");
   eprintf("usage:\n");
-  eprintf("  %s create [-otr] [-onl|-otl|-onr] [-apow num] [-fpow num] [-ts] [-tl] [-tc]"
-          " [-bnum num] [-psiz num] [-rcd|-rcld|-rcdd] path\n", g_progname);
+  eprintf("  %s create [-otr] [-onl|-otl|-onr] [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx]"
+          " [-tk] [-bnum num] [-psiz num] [-rcd|-rcld|-rcdd|-rci|-rcu|-rcf] path\n", g_progname);
   eprintf("  %s inform [-onl|-otl|-onr] [-st] path\n", g_progname);
   eprintf("  %s set [-onl|-otl|-onr] [-add|-rep|-app|-inci|-incd] [-sx] path key value\n",
           g_progname);
@@ -137,7 +137,7 @@ static void usage() {
   eprintf("  %s setbulk [-onl|-otl|-onr] [-sx] path key value ...\n", g_progname);
   eprintf("  %s removebulk [-onl|-otl|-onr] [-sx] path key ...\n", g_progname);
   eprintf("  %s getbulk [-onl|-otl|-onr] [-sx] [-px] path key ...\n", g_progname);
-  eprintf("  %s check [-onl|-otl|-onr] path\n", g_progname);
+  eprintf("  %s check [-onl|-otl|-onr] [-th num] path\n", g_progname);
   eprintf("\n");
   std::exit(1);
 }
@@ -186,6 +186,10 @@ static int32_t runcreate(int argc, char** argv) {
         opts |= kc::TreeDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::TreeDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::TreeDB::TXXHASH;
+      } else if (!std::strcmp(argv[i], "-tk")) {
+        opts |= kc::TreeDB::TCHECKSUM;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -198,6 +202,12 @@ static int32_t runcreate(int argc, char** argv) {
         rcomp = kc::LEXICALDESCCOMP;
       } else if (!std::strcmp(argv[i], "-rcdd")) {
         rcomp = kc::DECIMALDESCCOMP;
+      } else if (!std::strcmp(argv[i], "-rci")) {
+        rcomp = kc::INTEGERCOMP;
+      } else if (!std::strcmp(argv[i], "-rcu")) {
+        rcomp = kc::UNSIGNEDCOMP;
+      } else if (!std::strcmp(argv[i], "-rcf")) {
+        rcomp = kc::FLOATCOMP;
       } else {
         usage();
       }
@@ -848,6 +858,7 @@ static int32_t runcheck(int argc, char** argv) {
   bool argbrk = false;
   const char* path = NULL;
   int32_t oflags = 0;
+  int32_t thnum = 0;
   for (int32_t i = 2; i < argc; i++) {
     if (!argbrk && argv[i][0] == '-') {
       if (!std::strcmp(argv[i], "--")) {
@@ -858,6 +869,9 @@ static int32_t runcheck(int argc, char** argv) {
         oflags |= kc::TreeDB::OTRYLOCK;
       } else if (!std::strcmp(argv[i], "-onr")) {
         oflags |= kc::TreeDB::ONOREPAIR;
+      } else if (!std::strcmp(argv[i], "-th")) {
+        if (++i >= argc) usage();
+        thnum = kc::atoix(argv[i]);
       } else {
         usage();
       }
@@ -869,7 +883,7 @@ static int32_t runcheck(int argc, char** argv) {
     }
   }
   if (!path) usage();
-  int32_t rv = proccheck(path, oflags);
+  int32_t rv = proccheck(path, oflags, thnum);
   return rv;
 }
 
@@ -947,6 +961,8 @@ static int32_t procinform(const char* path, int32_t oflags, bool st) {
       if (opts & kc::TreeDB::TSMALL) oprintf(" small");
       if (opts & kc::TreeDB::TLINEAR) oprintf(" linear");
       if (opts & kc::TreeDB::TCOMPRESS) oprintf(" compress");
+      if (opts & kc::TreeDB::TXXHASH) oprintf(" xxhash");
+      if (opts & kc::TreeDB::TCHECKSUM) oprintf(" checksum");
       oprintf(" (opts=%d)\n", opts);
       oprintf("comparator: %s\n", status["rcomp"].c_str());
       if (status["opaque"].size() >= 16) {
@@ -987,6 +1003,14 @@ static int32_t procinform(const char* path, int32_t oflags, bool st) {
       oprintf("cache: %lld (cap=%lld) (ratio=%.2f) (leaf=%lld:%lld) (inner=%lld:%lld)\n",
               (long long)cusage, (long long)pccap, (double)cusage / pccap,
               (long long)culsiz, (long long)culcnt, (long long)cuisiz, (long long)cuicnt);
+      oprintf("cache access: (leaf hit=%lld miss=%lld evict=%lld)"
+              " (inner hit=%lld miss=%lld evict=%lld)\n",
+              (long long)kc::atoi(status["lhit"].c_str()),
+              (long long)kc::atoi(status["lmiss"].c_str()),
+              (long long)kc::atoi(status["levict"].c_str()),
+              (long long)kc::atoi(status["ihit"].c_str()),
+              (long long)kc::atoi(status["imiss"].c_str()),
+              (long long)kc::atoi(status["ievict"].c_str()));
       std::string cntstr = unitnumstr(count);
       oprintf("count: %lld (%s)\n", count, cntstr.c_str());
       int64_t size = kc::atoi(status["size"].c_str());
@@ -1272,45 +1296,76 @@ static int32_t procimport(const char* path, const char* file, int32_t oflags, bo
     dberrprint(&db, "DB::open failed");
     return 1;
   }
-  bool err = false;
-  int64_t cnt = 0;
-  std::string line;
-  std::vector<std::string> fields;
-  while (!err && mygetline(is, &line)) {
-    cnt++;
-    kc::strsplit(line, '\t', &fields);
-    if (sx) {
-      std::vector<std::string>::iterator it = fields.begin();
-      std::vector<std::string>::iterator itend = fields.end();
-      while (it != itend) {
-        size_t esiz;
-        char* ebuf = kc::hexdecode(it->c_str(), &esiz);
-        it->clear();
-        it->append(ebuf, esiz);
-        delete[] ebuf;
-        ++it;
-      }
+  class SourceImpl : public kc::BasicDB::BulkSource {
+   public:
+    explicit SourceImpl(std::istream* is, bool sx) :
+        is_(is), sx_(sx), line_(), fields_(), cnt_(0), rmkey_(false) {}
+    int64_t count() {
+      return cnt_;
     }
-    switch (fields.size()) {
-      case 2: {
-        if (!db.set(fields[0], fields[1])) {
-          dberrprint(&db, "DB::set failed");
-          err = true;
+    bool removal(std::string* key) {
+      if (!rmkey_) return false;
+      rmkey_ = false;
+      key->swap(fields_[0]);
+      return true;
+    }
+   private:
+    const char* read(size_t* ksp, const char** vbp, size_t* vsp) {
+      while (mygetline(is_, &line_)) {
+        cnt_++;
+        kc::strsplit(line_, '\t', &fields_);
+        if (sx_) {
+          std::vector<std::string>::iterator it = fields_.begin();
+          std::vector<std::string>::iterator itend = fields_.end();
+          while (it != itend) {
+            size_t esiz;
+            char* ebuf = kc::hexdecode(it->c_str(), &esiz);
+            it->clear();
+            it->append(ebuf, esiz);
+            delete[] ebuf;
+            ++it;
+          }
         }
-        break;
-      }
-      case 1: {
-        if (!db.remove(fields[0]) && db.error() != kc::BasicDB::Error::NOREC) {
-          dberrprint(&db, "DB::remove failed");
-          err = true;
+        oputchar('.');
+        if (cnt_ % 50 == 0) oprintf(" (%lld)\n", (long long)cnt_);
+        switch (fields_.size()) {
+          case 2: {
+            *ksp = fields_[0].size();
+            *vbp = fields_[1].data();
+            *vsp = fields_[1].size();
+            return fields_[0].data();
+          }
+          case 1: {
+            rmkey_ = true;
+            return NULL;
+          }
         }
-        break;
       }
+      return NULL;
+    }
+    std::istream* is_;
+    bool sx_;
+    std::string line_;
+    std::vector<std::string> fields_;
+    int64_t cnt_;
+    bool rmkey_;
+  };
+  SourceImpl source(is, sx);
+  bool err = false;
+  while (!err) {
+    if (!db.load_bulk(&source)) {
+      dberrprint(&db, "DB::load_bulk failed");
+      err = true;
+      break;
+    }
+    std::string key;
+    if (!source.removal(&key)) break;
+    if (!db.remove(key) && db.error() != kc::BasicDB::Error::NOREC) {
+      dberrprint(&db, "DB::remove failed");
+      err = true;
     }
-    oputchar('.');
-    if (cnt % 50 == 0) oprintf(" (%lld)\n", (long long)cnt);
   }
-  if (cnt % 50 > 0) oprintf(" (%lld)\n", (long long)cnt);
+  if (source.count() % 50 > 0) oprintf(" (%lld)\n", (long long)source.count());
   if (!db.close()) {
     dberrprint(&db, "DB::close failed");
     err = true;
@@ -1507,54 +1562,82 @@ static int32_t procgetbulk(const char* path, int32_t oflags,
 
 
 // perform check command
-static int32_t proccheck(const char* path, int32_t oflags) {
+static int32_t proccheck(const char* path, int32_t oflags, int32_t thnum) {
   kc::TreeDB db;
   db.tune_logger(stdlogger(g_progname, &std::cerr));
+  db.tune_verification(true);
   if (!db.open(path, kc::TreeDB::OREADER | oflags)) {
     dberrprint(&db, "DB::open failed");
     return 1;
   }
   bool err = false;
-  kc::TreeDB::Cursor cur(&db);
-  if (!cur.jump() && db.error() != kc::BasicDB::Error::NOREC) {
-    dberrprint(&db, "DB::jump failed");
-    err = true;
-  }
   int64_t cnt = 0;
-  while (!err) {
-    size_t ksiz;
-    const char* vbuf;
-    size_t vsiz;
-    char* kbuf = cur.get(&ksiz, &vbuf, &vsiz);
-    if (kbuf) {
-      cnt++;
-      size_t rsiz;
-      char* rbuf = db.get(kbuf, ksiz, &rsiz);
-      if (rbuf) {
-        if (rsiz != vsiz || std::memcmp(rbuf, vbuf, rsiz)) {
+  if (thnum > 0) {
+    class VisitorImpl : public kc::DB::Visitor {
+     public:
+      explicit VisitorImpl() : cnt_(0) {}
+      int64_t count() {
+        return cnt_.get();
+      }
+     private:
+      const char* visit_full(const char* kbuf, size_t ksiz,
+                             const char* vbuf, size_t vsiz, size_t* sp) {
+        int64_t cnt = cnt_.add(1) + 1;
+        if (cnt % 1000 == 0) {
+          oputchar('.');
+          if (cnt % 50000 == 0) oprintf(" (%lld)\n", (long long)cnt);
+        }
+        return NOP;
+      }
+      kc::AtomicInt64 cnt_;
+    };
+    VisitorImpl visitor;
+    if (!db.scan_parallel(&visitor, thnum)) {
+      dberrprint(&db, "DB::scan_parallel failed");
+      err = true;
+    }
+    cnt = visitor.count();
+  } else {
+    kc::TreeDB::Cursor cur(&db);
+    if (!cur.jump() && db.error() != kc::BasicDB::Error::NOREC) {
+      dberrprint(&db, "DB::jump failed");
+      err = true;
+    }
+    while (!err) {
+      size_t ksiz;
+      const char* vbuf;
+      size_t vsiz;
+      char* kbuf = cur.get(&ksiz, &vbuf, &vsiz);
+      if (kbuf) {
+        cnt++;
+        size_t rsiz;
+        char* rbuf = db.get(kbuf, ksiz, &rsiz);
+        if (rbuf) {
+          if (rsiz != vsiz || std::memcmp(rbuf, vbuf, rsiz)) {
+            dberrprint(&db, "DB::get failed");
+            err = true;
+          }
+          delete[] rbuf;
+        } else {
           dberrprint(&db, "DB::get failed");
           err = true;
         }
-        delete[] rbuf;
+        delete[] kbuf;
+        if (cnt % 1000 == 0) {
+          oputchar('.');
+          if (cnt % 50000 == 0) oprintf(" (%lld)\n", (long long)cnt);
+        }
       } else {
-        dberrprint(&db, "DB::get failed");
-        err = true;
-      }
-      delete[] kbuf;
-      if (cnt % 1000 == 0) {
-        oputchar('.');
-        if (cnt % 50000 == 0) oprintf(" (%lld)\n", (long long)cnt);
+        if (db.error() != kc::BasicDB::Error::NOREC) {
+          dberrprint(&db, "Cursor::get failed");
+          err = true;
+        }
+        break;
       }
-    } else {
-      if (db.error() != kc::BasicDB::Error::NOREC) {
-        dberrprint(&db, "Cursor::get failed");
+      if (!cur.step() && db.error() != kc::BasicDB::Error::NOREC) {
+        dberrprint(&db, "Cursor::step failed");
         err = true;
       }
-      break;
-    }
-    if (!cur.step() && db.error() != kc::BasicDB::Error::NOREC) {
-      dberrprint(&db, "Cursor::step failed");
-      err = true;
     }
   }
   oprintf(" (end)\n");
@@ -23,6 +23,33 @@ uint32_t g_randseed;                     // random seed
 int64_t g_memusage;                      // memory usage
 
 
+// record of the comparator test
+struct CompRecord {
+  std::string key;                       // encoded key
+  uint64_t num;                          // integral value in the unsigned order
+  double fnum;                           // floating-point value
+  bool neg;                              // whether the sign bit is set
+};
+
+
+// expected order of records of the comparator test
+struct CompRecordLess {
+  explicit CompRecordLess(bool flt) : flt_(flt) {}
+  bool operator ()(const CompRecord& a, const CompRecord& b) const {
+    if (flt_) {
+      if (a.fnum != b.fnum) return a.fnum < b.fnum;
+      if (a.neg != b.neg) return a.neg;
+    } else if (a.num != b.num) {
+      return a.num < b.num;
+    }
+    size_t msiz = a.key.size() < b.key.size() ? a.key.size() : b.key.size();
+    int32_t rv = std::memcmp(a.key.data(), b.key.data(), msiz);
+    if (rv != 0) return rv < 0;
+    return a.key.size() < b.key.size();
+  }
+  bool flt_;
+};
+
 // function prototypes
 int main(int argc, char** argv);
 static void usage();
@@ -32,6 +59,8 @@ static int32_t runorder(int argc, char** argv);
 static int32_t runqueue(int argc, char** argv);
 static int32_t runwicked(int argc, char** argv);
 static int32_t runtran(int argc, char** argv);
+static int32_t runcomp(int argc, char** argv);
+static int32_t runscan(int argc, char** argv);
 static int32_t procorder(const char* path, int64_t rnum, int32_t thnum, bool rnd, int32_t mode,
                          bool tran, int32_t oflags, int32_t apow, int32_t fpow,
                          int32_t opts, int64_t bnum, int32_t psiz, int64_t msiz,
@@ -48,6 +77,9 @@ static int32_t proctran(const char* path, int64_t rnum, int32_t thnum, int32_t i
                         int32_t oflags, int32_t apow, int32_t fpow, int32_t opts, int64_t bnum,
                         int32_t psiz, int64_t msiz, int64_t dfunit, int64_t pccap,
                         kc::Comparator* rcomp, bool lv);
+static int32_t proccomp(const char* path, int64_t rnum, int32_t psiz, int64_t pccap,
+                        kc::Comparator* rcomp, bool lv);
+static int32_t procscan(const char* path, int64_t rnum, int32_t psiz, int64_t pccap, bool lv);
 
 
 // main routine
@@ -68,6 +100,10 @@ int main(int argc, char** argv) {
     rv = runwicked(argc, argv);
   } else if (!std::strcmp(argv[1], "tran")) {
     rv = runtran(argc, argv);
+  } else if (!std::strcmp(argv[1], "comp")) {
+    rv = runcomp(argc, argv);
+  } else if (!std::strcmp(argv[1], "scan")) {
+    rv = runscan(argc, argv);
   } else {
     usage();
   }
@@ -88,18 +124,23 @@ static void usage() {
   eprintf("\n");
   eprintf("usage:\n");
   eprintf("  %s order [-th num] [-rnd] [-set|-get|-getw|-rem|-etc] [-tran]"
-          " [-oat|-oas|-onl|-otl|-onr] [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-bnum num]"
-          " [-psiz num] [-msiz num] [-dfunit num] [-pccap num] [-rcd|-rcld|-rcdd] [-lv]"
-          " path rnum\n", g_progname);
+          " [-oat|-oas|-onl|-otl|-onr] [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx] [-bnum num]"
+          " [-psiz num] [-msiz num] [-dfunit num] [-pccap num]"
+          " [-rcd|-rcld|-rcdd|-rci|-rcu|-rcf] [-lv] path rnum\n", g_progname);
   eprintf("  %s queue [-th num] [-it num] [-rnd] [-oat|-oas|-onl|-otl|-onr]"
-          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-bnum num] [-psiz num] [-msiz num]"
-          " [-dfunit num] [-pccap num] [-rcd|-rcld|-rcdd] [-lv] path rnum\n", g_progname);
+          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx] [-bnum num] [-psiz num] [-msiz num]"
+          " [-dfunit num] [-pccap num] [-rcd|-rcld|-rcdd|-rci|-rcu|-rcf] [-lv] path rnum\n",
+          g_progname);
   eprintf("  %s wicked [-th num] [-it num] [-oat|-oas|-onl|-otl|-onr]"
-          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-bnum num] [-psiz num] [-msiz num]"
-          " [-dfunit num] [-pccap num] [-rcd|-rcld|-rcdd] [-lv] path rnum\n", g_progname);
+          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx] [-bnum num] [-psiz num] [-msiz num]"
+          " [-dfunit num] [-pccap num] [-rcd|-rcld|-rcdd|-rci|-rcu|-rcf] [-lv] path rnum\n",
+          g_progname);
   eprintf("  %s tran [-th num] [-it num] [-hard] [-oat|-oas|-onl|-otl|-onr]"
-          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-bnum num] [-psiz num] [-msiz num]"
-          " [-dfunit num] [-pccap num] [-rcd|-rcld|-rcdd] [-lv] path rnum\n", g_progname);
+          " [-apow num] [-fpow num] [-ts] [-tl] [-tc] [-tx] [-bnum num] [-psiz num] [-msiz num]"
+          " [-dfunit num] [-pccap num] [-rcd|-rcld|-rcdd|-rci|-rcu|-rcf] [-lv] path rnum\n",
+          g_progname);
+  eprintf("  %s comp [-psiz num] [-pccap num] [-rci|-rcu|-rcf] [-lv] path rnum\n", g_progname);
+  eprintf("  %s scan [-psiz num] [-pccap num] [-lv] path rnum\n", g_progname);
   eprintf("\n");
   std::exit(1);
 }
@@ -155,6 +196,7 @@ static void dbmetaprint(kc::BasicDB* db, bool verbose) {
       if (opts & kc::TreeDB::TSMALL) oprintf(" small");
       if (opts & kc::TreeDB::TLINEAR) oprintf(" linear");
       if (opts & kc::TreeDB::TCOMPRESS) oprintf(" compress");
+      if (opts & kc::TreeDB::TXXHASH) oprintf(" xxhash");
       oprintf(" (opts=%d)\n", opts);
       oprintf("comparator: %s\n", status["rcomp"].c_str());
       if (status["opaque"].size() >= 16) {
@@ -277,6 +319,8 @@ static int32_t runorder(int argc, char** argv) {
         opts |= kc::TreeDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::TreeDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::TreeDB::TXXHASH;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -298,6 +342,12 @@ static int32_t runorder(int argc, char** argv) {
         rcomp = kc::LEXICALDESCCOMP;
       } else if (!std::strcmp(argv[i], "-rcdd")) {
         rcomp = kc::DECIMALDESCCOMP;
+      } else if (!std::strcmp(argv[i], "-rci")) {
+        rcomp = kc::INTEGERCOMP;
+      } else if (!std::strcmp(argv[i], "-rcu")) {
+        rcomp = kc::UNSIGNEDCOMP;
+      } else if (!std::strcmp(argv[i], "-rcf")) {
+        rcomp = kc::FLOATCOMP;
       } else if (!std::strcmp(argv[i], "-lv")) {
         lv = true;
       } else {
@@ -375,6 +425,8 @@ static int32_t runqueue(int argc, char** argv) {
         opts |= kc::TreeDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::TreeDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::TreeDB::TXXHASH;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -396,6 +448,12 @@ static int32_t runqueue(int argc, char** argv) {
         rcomp = kc::LEXICALDESCCOMP;
       } else if (!std::strcmp(argv[i], "-rcdd")) {
         rcomp = kc::DECIMALDESCCOMP;
+      } else if (!std::strcmp(argv[i], "-rci")) {
+        rcomp = kc::INTEGERCOMP;
+      } else if (!std::strcmp(argv[i], "-rcu")) {
+        rcomp = kc::UNSIGNEDCOMP;
+      } else if (!std::strcmp(argv[i], "-rcf")) {
+        rcomp = kc::FLOATCOMP;
       } else if (!std::strcmp(argv[i], "-lv")) {
         lv = true;
       } else {
@@ -470,6 +528,8 @@ static int32_t runwicked(int argc, char** argv) {
         opts |= kc::TreeDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::TreeDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::TreeDB::TXXHASH;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -491,6 +551,12 @@ static int32_t runwicked(int argc, char** argv) {
         rcomp = kc::LEXICALDESCCOMP;
       } else if (!std::strcmp(argv[i], "-rcdd")) {
         rcomp = kc::DECIMALDESCCOMP;
+      } else if (!std::strcmp(argv[i], "-rci")) {
+        rcomp = kc::INTEGERCOMP;
+      } else if (!std::strcmp(argv[i], "-rcu")) {
+        rcomp = kc::UNSIGNEDCOMP;
+      } else if (!std::strcmp(argv[i], "-rcf")) {
+        rcomp = kc::FLOATCOMP;
       } else if (!std::strcmp(argv[i], "-lv")) {
         lv = true;
       } else {
@@ -568,6 +634,8 @@ static int32_t runtran(int argc, char** argv) {
         opts |= kc::TreeDB::TLINEAR;
       } else if (!std::strcmp(argv[i], "-tc")) {
         opts |= kc::TreeDB::TCOMPRESS;
+      } else if (!std::strcmp(argv[i], "-tx")) {
+        opts |= kc::TreeDB::TXXHASH;
       } else if (!std::strcmp(argv[i], "-bnum")) {
         if (++i >= argc) usage();
         bnum = kc::atoix(argv[i]);
@@ -589,6 +657,12 @@ static int32_t runtran(int argc, char** argv) {
         rcomp = kc::LEXICALDESCCOMP;
       } else if (!std::strcmp(argv[i], "-rcdd")) {
         rcomp = kc::DECIMALDESCCOMP;
+      } else if (!std::strcmp(argv[i], "-rci")) {
+        rcomp = kc::INTEGERCOMP;
+      } else if (!std::strcmp(argv[i], "-rcu")) {
+        rcomp = kc::UNSIGNEDCOMP;
+      } else if (!std::strcmp(argv[i], "-rcf")) {
+        rcomp = kc::FLOATCOMP;
       } else if (!std::strcmp(argv[i], "-lv")) {
         lv = true;
       } else {
@@ -613,6 +687,93 @@ static int32_t runtran(int argc, char** argv) {
 }
 
 
+// parse arguments of comp command
+static int32_t runcomp(int argc, char** argv) {
+  bool argbrk = false;
+  const char* path = NULL;
+  const char* rstr = NULL;
+  int64_t psiz = -1;
+  int64_t pccap = 0;
+  kc::Comparator* rcomp = kc::INTEGERCOMP;
+  bool lv = false;
+  for (int32_t i = 2; i < argc; i++) {
+    if (!argbrk && argv[i][0] == '-') {
+      if (!std::strcmp(argv[i], "--")) {
+        argbrk = true;
+      } else if (!std::strcmp(argv[i], "-psiz")) {
+        if (++i >= argc) usage();
+        psiz = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-pccap")) {
+        if (++i >= argc) usage();
+        pccap = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-rci")) {
+        rcomp = kc::INTEGERCOMP;
+      } else if (!std::strcmp(argv[i], "-rcu")) {
+        rcomp = kc::UNSIGNEDCOMP;
+      } else if (!std::strcmp(argv[i], "-rcf")) {
+        rcomp = kc::FLOATCOMP;
+      } else if (!std::strcmp(argv[i], "-lv")) {
+        lv = true;
+      } else {
+        usage();
+      }
+    } else if (!path) {
+      argbrk = true;
+      path = argv[i];
+    } else if (!rstr) {
+      rstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!path || !rstr) usage();
+  int64_t rnum = kc::atoix(rstr);
+  if (rnum < 1) usage();
+  int32_t rv = proccomp(path, rnum, psiz, pccap, rcomp, lv);
+  return rv;
+}
+
+
+// parse arguments of scan command
+static int32_t runscan(int argc, char** argv) {
+  bool argbrk = false;
+  const char* path = NULL;
+  const char* rstr = NULL;
+  int64_t psiz = -1;
+  int64_t pccap = 0;
+  bool lv = false;
+  for (int32_t i = 2; i < argc; i++) {
+    if (!argbrk && argv[i][0] == '-') {
+      if (!std::strcmp(argv[i], "--")) {
+        argbrk = true;
+      } else if (!std::strcmp(argv[i], "-psiz")) {
+        if (++i >= argc) usage();
+        psiz = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-pccap")) {
+        if (++i >= argc) usage();
+        pccap = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-lv")) {
+        lv = true;
+      } else {
+        usage();
+      }
+    } else if (!path) {
+      argbrk = true;
+      path = argv[i];
+    } else if (!rstr) {
+      rstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!path || !rstr) usage();
+  int64_t rnum = kc::atoix(rstr);
+  if (rnum < 1) usage();
+  int32_t rv = procscan(path, rnum, psiz, pccap, lv);
+  return rv;
+}
+
+
 // perform order command
 static int32_t procorder(const char* path, int64_t rnum, int32_t thnum, bool rnd, int32_t mode,
                          bool tran, int32_t oflags, int32_t apow, int32_t fpow,
@@ -1463,6 +1624,46 @@ static int32_t procorder(const char* path, int64_t rnum, int32_t thnum, bool rnd
     dbmetaprint(&db, false);
     oprintf("time: %.3f\n", etime - stime);
   }
+  if (mode == 'e') {
+    oprintf("removing records in a range:\n");
+    stime = kc::time();
+    kc::Comparator* comp = rcomp ? rcomp : kc::LEXICALCOMP;
+    char bbuf[RECBUFSIZ];
+    size_t bsiz = std::sprintf(bbuf, "%08lld", (long long)(rnum / 4 + 1));
+    char ebuf[RECBUFSIZ];
+    size_t esiz = std::sprintf(ebuf, "%08lld", (long long)(rnum / 2 + 1));
+    if (comp->compare(bbuf, bsiz, ebuf, esiz) > 0) {
+      char swap[RECBUFSIZ];
+      std::memcpy(swap, bbuf, bsiz);
+      std::memcpy(bbuf, ebuf, esiz);
+      std::memcpy(ebuf, swap, bsiz);
+      std::swap(bsiz, esiz);
+    }
+    int64_t cnt = 0;
+    kc::DB::Cursor* cur = db.cursor();
+    if (cur->jump(bbuf, bsiz)) {
+      std::string key;
+      while (cur->get_key(&key, true) &&
+             comp->compare(key.data(), key.size(), ebuf, esiz) < 0) {
+        cnt++;
+      }
+    }
+    delete cur;
+    if (db.count_range(bbuf, bsiz, ebuf, esiz) != cnt ||
+        db.count_range(NULL, 0, NULL, 0) != db.count()) {
+      dberrprint(&db, __LINE__, "DB::count_range");
+      err = true;
+    }
+    int64_t onum = db.count();
+    if (db.remove_range(bbuf, bsiz, ebuf, esiz) != cnt || db.count() != onum - cnt ||
+        db.count_range(bbuf, bsiz, ebuf, esiz) != 0) {
+      dberrprint(&db, __LINE__, "DB::remove_range");
+      err = true;
+    }
+    etime = kc::time();
+    dbmetaprint(&db, false);
+    oprintf("time: %.3f\n", etime - stime);
+  }
   if (mode == 0 || mode == 'r' || mode == 'e') {
     oprintf("removing records:\n");
     stime = kc::time();
@@ -1894,12 +2095,13 @@ static int32_t procwicked(const char* path, int64_t rnum, int32_t thnum, int32_t
     class ThreadWicked : public kc::Thread {
      public:
       void setparams(int32_t id, kc::TreeDB* db, int64_t rnum, int32_t thnum,
-                     const char* lbuf) {
+                     const char* lbuf, int64_t pccap) {
         id_ = id;
         db_ = db;
         rnum_ = rnum;
         thnum_ = thnum;
         lbuf_ = lbuf;
+        pccap_ = pccap;
         err_ = false;
       }
       bool error() {
@@ -2149,6 +2351,13 @@ static int32_t procwicked(const char* path, int64_t rnum, int32_t thnum, int32_t
               }
             }
           }
+          if (pccap_ > 0 && myrand(200) == 0) {
+            int64_t cap = pccap_ / (myrand(4) + 1);
+            if (!db_->resize_page_cache(cap)) {
+              dberrprint(db_, __LINE__, "DB::resize_page_cache");
+              err_ = true;
+            }
+          }
           if (i == rnum_ / 2) {
             if (myrand(thnum_ * 4) == 0) {
               if (myrand(2) == 0) {
@@ -2196,18 +2405,19 @@ static int32_t procwicked(const char* path, int64_t rnum, int32_t thnum, int32_t
       int64_t rnum_;
       int32_t thnum_;
       const char* lbuf_;
+      int64_t pccap_;
       bool err_;
     };
     char lbuf[RECBUFSIZL];
     std::memset(lbuf, '*', sizeof(lbuf));
     ThreadWicked threads[THREADMAX];
     if (thnum < 2) {
-      threads[0].setparams(0, &db, rnum, thnum, lbuf);
+      threads[0].setparams(0, &db, rnum, thnum, lbuf, pccap);
       threads[0].run();
       if (threads[0].error()) err = true;
     } else {
       for (int32_t i = 0; i < thnum; i++) {
-        threads[i].setparams(i, &db, rnum, thnum, lbuf);
+        threads[i].setparams(i, &db, rnum, thnum, lbuf, pccap);
         threads[i].start();
       }
       for (int32_t i = 0; i < thnum; i++) {
@@ -2215,6 +2425,10 @@ static int32_t procwicked(const char* path, int64_t rnum, int32_t thnum, int32_t
         if (threads[i].error()) err = true;
       }
     }
+    if (pccap > 0 && !db.resize_page_cache(pccap)) {
+      dberrprint(&db, __LINE__, "DB::resize_page_cache");
+      err = true;
+    }
     dbmetaprint(&db, itcnt == itnum);
     if (!db.close()) {
       dberrprint(&db, __LINE__, "DB::close");
@@ -2530,5 +2744,348 @@ static int32_t proctran(const char* path, int64_t rnum, int32_t thnum, int32_t i
 }
 
 
+// perform comp command
+static int32_t proccomp(const char* path, int64_t rnum, int32_t psiz, int64_t pccap,
+                        kc::Comparator* rcomp, bool lv) {
+  oprintf("<Comparator Test>\n  seed=%u  path=%s  rnum=%lld  psiz=%d  pccap=%lld"
+          "  rcomp=%p  lv=%d\n\n",
+          g_randseed, path, (long long)rnum, psiz, (long long)pccap, rcomp, lv);
+  bool err = false;
+  bool flt = rcomp == kc::FLOATCOMP;
+  kc::TreeDB db;
+  oprintf("opening the database:\n");
+  double stime = kc::time();
+  db.tune_logger(stdlogger(g_progname, &std::cout),
+                 lv ? kc::UINT32MAX : kc::BasicDB::Logger::WARN | kc::BasicDB::Logger::ERROR);
+  if (psiz > 0) db.tune_page(psiz);
+  if (pccap > 0) db.tune_page_cache(pccap);
+  db.tune_comparator(rcomp);
+  if (!db.open(path, kc::TreeDB::OWRITER | kc::TreeDB::OCREATE | kc::TreeDB::OTRUNCATE)) {
+    dberrprint(&db, __LINE__, "DB::open");
+    err = true;
+  }
+  double etime = kc::time();
+  dbmetaprint(&db, false);
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("setting records of binary keys:\n");
+  stime = kc::time();
+  std::vector<CompRecord> recs;
+  recs.reserve(rnum);
+  for (int64_t i = 1; !err && i <= rnum; i++) {
+    CompRecord rec;
+    char kbuf[sizeof(uint64_t)];
+    size_t ksiz;
+    uint64_t bits = ((uint64_t)myrand(1LL << 32) << 32) | (uint64_t)myrand(1LL << 32);
+    if (flt) {
+      double dnum;
+      switch (myrand(4)) {
+        case 0: {
+          dnum = (myrand(2001) - 1000) / 8.0;
+          if (dnum == 0 && myrand(2) == 0) dnum = -dnum;
+          break;
+        }
+        case 1: {
+          dnum = std::ldexp((myrand(2000001) - 1000000) / 1000000.0, myrand(201) - 100);
+          break;
+        }
+        case 2: {
+          std::memcpy(&dnum, &bits, sizeof(dnum));
+          if (dnum != dnum || !(dnum > -FLT_MAX && dnum < FLT_MAX)) dnum = 0;
+          break;
+        }
+        default: {
+          dnum = myrand(2) == 0 ? HUGE_VAL : 0.0;
+          if (myrand(2) == 0) dnum = -dnum;
+          break;
+        }
+      }
+      if (myrand(2) == 0) {
+        float fnum = dnum;
+        uint32_t fbits;
+        std::memcpy(&fbits, &fnum, sizeof(fbits));
+        ksiz = sizeof(fbits);
+        kc::writefixnum(kbuf, fbits, ksiz);
+        rec.fnum = fnum;
+        rec.neg = fbits >> 31;
+      } else {
+        uint64_t dbits;
+        std::memcpy(&dbits, &dnum, sizeof(dbits));
+        ksiz = sizeof(dbits);
+        kc::writefixnum(kbuf, dbits, ksiz);
+        rec.fnum = dnum;
+        rec.neg = dbits >> 63;
+      }
+      rec.num = 0;
+    } else {
+      if (rcomp == kc::INTEGERCOMP) {
+        ksiz = 1 << myrand(4);
+      } else {
+        ksiz = myrand(sizeof(kbuf)) + 1;
+      }
+      if (myrand(2) == 0) bits = (uint64_t)(myrand(1024) - 512);
+      if (ksiz < sizeof(bits)) bits &= (1ULL << (ksiz * 8)) - 1;
+      kc::writefixnum(kbuf, bits, ksiz);
+      rec.num = bits;
+      if (rcomp == kc::INTEGERCOMP) {
+        int64_t snum = bits;
+        if (ksiz < sizeof(bits) && (bits >> (ksiz * 8 - 1))) snum -= 1LL << (ksiz * 8);
+        rec.num = (uint64_t)snum ^ (1ULL << 63);
+      }
+      rec.fnum = 0;
+      rec.neg = false;
+    }
+    rec.key.append(kbuf, ksiz);
+    char vbuf[RECBUFSIZ];
+    size_t vsiz = std::sprintf(vbuf, "%lld", (long long)i);
+    if (!db.set(kbuf, ksiz, vbuf, vsiz)) {
+      dberrprint(&db, __LINE__, "DB::set");
+      err = true;
+    }
+    recs.push_back(rec);
+    if (rnum > 250 && i % (rnum / 250) == 0) {
+      oputchar('.');
+      if (i == rnum || i % (rnum / 10) == 0) oprintf(" (%08lld)\n", (long long)i);
+    }
+  }
+  std::sort(recs.begin(), recs.end(), CompRecordLess(flt));
+  std::vector<CompRecord>::iterator rit = recs.begin();
+  std::vector<CompRecord>::iterator ritend = recs.end();
+  std::vector<CompRecord>::iterator wit = recs.begin();
+  while (rit != ritend) {
+    if (wit == recs.begin() || rit->key != (wit - 1)->key) *(wit++) = *rit;
+    ++rit;
+  }
+  recs.erase(wit, recs.end());
+  int64_t onum = recs.size();
+  for (int64_t i = 1; !err && i < onum; i++) {
+    const std::string& pkey = recs[i-1].key;
+    const std::string& key = recs[i].key;
+    if (rcomp->compare(pkey.data(), pkey.size(), key.data(), key.size()) >= 0 ||
+        rcomp->compare(key.data(), key.size(), pkey.data(), pkey.size()) <= 0) {
+      dberrprint(&db, __LINE__, "Comparator::compare");
+      err = true;
+    }
+  }
+  etime = kc::time();
+  dbmetaprint(&db, false);
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("reopening the database:\n");
+  stime = kc::time();
+  if (!db.close()) {
+    dberrprint(&db, __LINE__, "DB::close");
+    err = true;
+  }
+  kc::TreeDB rdb;
+  rdb.tune_logger(stdlogger(g_progname, &std::cout),
+                  lv ? kc::UINT32MAX : kc::BasicDB::Logger::WARN | kc::BasicDB::Logger::ERROR);
+  if (pccap > 0) rdb.tune_page_cache(pccap);
+  if (!rdb.open(path, kc::TreeDB::OREADER)) {
+    dberrprint(&rdb, __LINE__, "DB::open");
+    err = true;
+  }
+  if (rdb.count() != onum) {
+    dberrprint(&rdb, __LINE__, "DB::count");
+    err = true;
+  }
+  etime = kc::time();
+  dbmetaprint(&rdb, false);
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("traversing the database by the cursor:\n");
+  stime = kc::time();
+  kc::DB::Cursor* cur = rdb.cursor();
+  if (!cur->jump() && rdb.error() != kc::BasicDB::Error::NOREC) {
+    dberrprint(&rdb, __LINE__, "Cursor::jump");
+    err = true;
+  }
+  int64_t cnt = 0;
+  std::string key;
+  while (!err && cur->get_key(&key, true)) {
+    if (cnt >= onum || key != recs[cnt].key) {
+      dberrprint(&rdb, __LINE__, "Cursor::get_key");
+      err = true;
+    }
+    cnt++;
+    if (onum > 250 && cnt % (onum / 250) == 0) {
+      oputchar('.');
+      if (cnt == onum || cnt % (onum / 10) == 0) oprintf(" (%08lld)\n", (long long)cnt);
+    }
+  }
+  if (!err && (rdb.error() != kc::BasicDB::Error::NOREC || cnt != onum)) {
+    dberrprint(&rdb, __LINE__, "Cursor::get_key");
+    err = true;
+  }
+  if (!cur->jump_back() && rdb.error() != kc::BasicDB::Error::NOREC) {
+    dberrprint(&rdb, __LINE__, "Cursor::jump_back");
+    err = true;
+  }
+  while (!err && cur->get_key(&key, false)) {
+    if (cnt < 1 || key != recs[cnt-1].key) {
+      dberrprint(&rdb, __LINE__, "Cursor::get_key");
+      err = true;
+    }
+    cnt--;
+    if (!cur->step_back() && rdb.error() != kc::BasicDB::Error::NOREC) {
+      dberrprint(&rdb, __LINE__, "Cursor::step_back");
+      err = true;
+    }
+  }
+  if (!err && cnt != 0) {
+    dberrprint(&rdb, __LINE__, "Cursor::step_back");
+    err = true;
+  }
+  for (int64_t i = 0; !err && i < onum && i < 100; i++) {
+    const std::string& jkey = recs[myrand(onum)].key;
+    if (!cur->jump(jkey.data(), jkey.size()) || !cur->get_key(&key, false) || key != jkey) {
+      dberrprint(&rdb, __LINE__, "Cursor::jump");
+      err = true;
+    }
+  }
+  delete cur;
+  etime = kc::time();
+  dbmetaprint(&rdb, false);
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("closing the database:\n");
+  stime = kc::time();
+  if (!rdb.close()) {
+    dberrprint(&rdb, __LINE__, "DB::close");
+    err = true;
+  }
+  etime = kc::time();
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
+// perform scan command
+static int32_t procscan(const char* path, int64_t rnum, int32_t psiz, int64_t pccap, bool lv) {
+  oprintf("<Scan Resistance Test>\n  seed=%u  path=%s  rnum=%lld  psiz=%d  pccap=%lld"
+          "  lv=%d\n\n", g_randseed, path, (long long)rnum, psiz, (long long)pccap, lv);
+  bool err = false;
+  kc::TreeDB db;
+  oprintf("opening the database:\n");
+  double stime = kc::time();
+  db.tune_logger(stdlogger(g_progname, &std::cout),
+                 lv ? kc::UINT32MAX : kc::BasicDB::Logger::WARN | kc::BasicDB::Logger::ERROR);
+  if (psiz > 0) db.tune_page(psiz);
+  if (pccap > 0) db.tune_page_cache(pccap);
+  if (!db.open(path, kc::TreeDB::OWRITER | kc::TreeDB::OCREATE | kc::TreeDB::OTRUNCATE)) {
+    dberrprint(&db, __LINE__, "DB::open");
+    err = true;
+  }
+  double etime = kc::time();
+  dbmetaprint(&db, false);
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("setting records:\n");
+  stime = kc::time();
+  char vbuf[RECBUFSIZ];
+  std::memset(vbuf, '*', sizeof(vbuf));
+  for (int64_t i = 1; !err && i <= rnum; i++) {
+    char kbuf[RECBUFSIZ];
+    size_t ksiz = std::sprintf(kbuf, "%08lld", (long long)i);
+    if (!db.set(kbuf, ksiz, vbuf, sizeof(vbuf) / 2)) {
+      dberrprint(&db, __LINE__, "DB::set");
+      err = true;
+    }
+    if (rnum > 250 && i % (rnum / 250) == 0) {
+      oputchar('.');
+      if (i == rnum || i % (rnum / 10) == 0) oprintf(" (%08lld)\n", (long long)i);
+    }
+  }
+  if (!db.close()) {
+    dberrprint(&db, __LINE__, "DB::close");
+    err = true;
+  }
+  if (!db.open(path, kc::TreeDB::OREADER)) {
+    dberrprint(&db, __LINE__, "DB::open");
+    err = true;
+  }
+  etime = kc::time();
+  dbmetaprint(&db, false);
+  oprintf("time: %.3f\n", etime - stime);
+  std::map<std::string, std::string> status;
+  if (!db.status(&status)) {
+    dberrprint(&db, __LINE__, "DB::status");
+    err = true;
+  }
+  int64_t hnum = kc::atoi(status["pccap"].c_str()) / kc::atoi(status["psiz"].c_str()) / 8 + 1;
+  std::vector<std::string> hkeys;
+  for (int64_t i = 0; i < hnum; i++) {
+    char kbuf[RECBUFSIZ];
+    size_t ksiz = std::sprintf(kbuf, "%08lld", (long long)(myrand(rnum) + 1));
+    hkeys.push_back(std::string(kbuf, ksiz));
+  }
+  for (int32_t hint = 1; !err && hint >= 0; hint--) {
+    oprintf("warming the hot set of %lld records:\n", (long long)hnum);
+    stime = kc::time();
+    for (int32_t i = 0; !err && i < 4; i++) {
+      for (int64_t j = 0; !err && j < hnum; j++) {
+        const std::string& hkey = hkeys[j];
+        if (db.get(hkey.data(), hkey.size(), vbuf, sizeof(vbuf)) < 0) {
+          dberrprint(&db, __LINE__, "DB::get");
+          err = true;
+        }
+      }
+    }
+    etime = kc::time();
+    oprintf("time: %.3f\n", etime - stime);
+    oprintf("scanning the database with the scan hint %s:\n", hint ? "on" : "off");
+    stime = kc::time();
+    kc::TreeDB::Cursor* cur = db.cursor();
+    cur->set_scan_hint(hint);
+    if (!cur->jump()) {
+      dberrprint(&db, __LINE__, "Cursor::jump");
+      err = true;
+    }
+    int64_t cnt = 0;
+    while (!err && cur->step()) {
+      cnt++;
+    }
+    if (!err && (db.error() != kc::BasicDB::Error::NOREC || cnt + 1 != rnum)) {
+      dberrprint(&db, __LINE__, "Cursor::step");
+      err = true;
+    }
+    delete cur;
+    status.clear();
+    if (!db.status(&status)) {
+      dberrprint(&db, __LINE__, "DB::status");
+      err = true;
+    }
+    int64_t omiss = kc::atoi(status["lmiss"].c_str());
+    for (int64_t i = 0; !err && i < hnum; i++) {
+      const std::string& hkey = hkeys[i];
+      if (db.get(hkey.data(), hkey.size(), vbuf, sizeof(vbuf)) < 0) {
+        dberrprint(&db, __LINE__, "DB::get");
+        err = true;
+      }
+    }
+    status.clear();
+    if (!db.status(&status)) {
+      dberrprint(&db, __LINE__, "DB::status");
+      err = true;
+    }
+    int64_t miss = kc::atoi(status["lmiss"].c_str()) - omiss;
+    oprintf("misses of the hot set: %lld\n", (long long)miss);
+    if (hint && miss != 0) {
+      dberrprint(&db, __LINE__, "Cursor::set_scan_hint");
+      err = true;
+    }
+    etime = kc::time();
+    dbmetaprint(&db, false);
+    oprintf("time: %.3f\n", etime - stime);
+  }
+  oprintf("closing the database:\n");
+  stime = kc::time();
+  if (!db.close()) {
+    dberrprint(&db, __LINE__, "DB::close");
+    err = true;
+  }
+  etime = kc::time();
+  oprintf("time: %.3f\n", etime - stime);
+  oprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
 
 // END OF FILE
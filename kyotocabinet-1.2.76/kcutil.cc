@@ -77,6 +77,15 @@ const char* const FEATURES = ""
 #endif
 #if _KC_LZMA
     "(lzma)"
+#endif
+#if _KC_LZ4
+    "(lz4)"
+#endif
+#if _KC_ZSTD
+    "(zstd)"
+#endif
+#if _KC_URING
+    "(uring)"
 #endif
     ;
 
@@ -154,6 +163,112 @@ size_t strucsdist(const uint32_t* aary, size_t anum, const uint32_t* bary, size_
 }
 
 
+// tables of CRC32C by the slicing-by-8 method
+static uint32_t crc32ctbl[8][256];
+
+
+// initialize the tables of CRC32C
+static bool crc32cinit() {
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int32_t j = 0; j < 8; j++) {
+      crc = (crc >> 1) ^ (0x82f63b78U & (0 - (crc & 1)));
+    }
+    crc32ctbl[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = crc32ctbl[0][i];
+    for (int32_t j = 1; j < 8; j++) {
+      crc = crc32ctbl[0][crc&0xff] ^ (crc >> 8);
+      crc32ctbl[j][i] = crc;
+    }
+  }
+  return true;
+}
+static const bool crc32cready = crc32cinit();
+
+
+// calculate CRC32C with the tables
+static uint32_t crc32csoft(const unsigned char* rp, size_t size, uint32_t crc) {
+  while (size >= 8) {
+    uint32_t lo = crc ^ (((uint32_t)rp[0] << 0) | ((uint32_t)rp[1] << 8) |
+                         ((uint32_t)rp[2] << 16) | ((uint32_t)rp[3] << 24));
+    uint32_t hi = ((uint32_t)rp[4] << 0) | ((uint32_t)rp[5] << 8) |
+        ((uint32_t)rp[6] << 16) | ((uint32_t)rp[7] << 24);
+    crc = crc32ctbl[7][lo&0xff] ^ crc32ctbl[6][(lo>>8)&0xff] ^
+        crc32ctbl[5][(lo>>16)&0xff] ^ crc32ctbl[4][lo>>24] ^
+        crc32ctbl[3][hi&0xff] ^ crc32ctbl[2][(hi>>8)&0xff] ^
+        crc32ctbl[1][(hi>>16)&0xff] ^ crc32ctbl[0][hi>>24];
+    rp += 8;
+    size -= 8;
+  }
+  while (size > 0) {
+    crc = crc32ctbl[0][(crc^*rp)&0xff] ^ (crc >> 8);
+    rp++;
+    size--;
+  }
+  return crc;
+}
+
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+
+// calculate CRC32C with the crc32 instruction
+__attribute__((target("sse4.2")))
+static uint32_t crc32chard(const unsigned char* rp, size_t size, uint32_t crc) {
+#if defined(__x86_64__)
+  uint64_t lcrc = crc;
+  while (size >= sizeof(uint64_t)) {
+    uint64_t num;
+    std::memcpy(&num, rp, sizeof(num));
+    lcrc = __builtin_ia32_crc32di(lcrc, num);
+    rp += sizeof(num);
+    size -= sizeof(num);
+  }
+  crc = lcrc;
+#endif
+  while (size >= sizeof(uint32_t)) {
+    uint32_t num;
+    std::memcpy(&num, rp, sizeof(num));
+    crc = __builtin_ia32_crc32si(crc, num);
+    rp += sizeof(num);
+    size -= sizeof(num);
+  }
+  while (size > 0) {
+    crc = __builtin_ia32_crc32qi(crc, *rp);
+    rp++;
+    size--;
+  }
+  return crc;
+}
+
+
+// check whether the crc32 instruction is supported
+static bool crc32chasinst() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2");
+}
+static const bool crc32chw = crc32chasinst();
+
+
+#endif
+
+
+/**
+ * Get the checksum by CRC32C.
+ */
+uint32_t hashcrc32c(const void* buf, size_t size, uint32_t crc) {
+  _assert_(buf && size <= MEMMAXSIZ);
+  const unsigned char* rp = (const unsigned char*)buf;
+  crc = ~crc;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  if (crc32chw) return ~crc32chard(rp, size, crc);
+#endif
+  return ~crc32csoft(rp, size, crc);
+}
+
+
 /**
  * Allocate a nullified region on memory.
  */
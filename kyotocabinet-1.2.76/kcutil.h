@@ -296,6 +296,28 @@ uint64_t hashmurmur(const void* buf, size_t size);
 uint64_t hashfnv(const void* buf, size_t size);
 
 
+/**
+ * Get the hash value by XXH64 hashing.
+ * @param buf the source buffer.
+ * @param size the size of the source buffer.
+ * @return the hash value.
+ * @note The input is consumed in four independent lanes of 64-bit words, which is faster than
+ * MurMur hashing for keys longer than a few words.
+ */
+uint64_t hashxx(const void* buf, size_t size);
+
+
+/**
+ * Get the checksum by CRC32C.
+ * @param buf the source buffer.
+ * @param size the size of the source buffer.
+ * @param crc the checksum of the preceding data.  By default, it is 0 for no preceding data.
+ * @return the checksum of the preceding data and the source buffer.
+ * @note The crc32 instruction of SSE4.2 is used if the processor supports it.
+ */
+uint32_t hashcrc32c(const void* buf, size_t size, uint32_t crc = 0);
+
+
 /**
  * Get the hash value suitable for a file name.
  * @param buf the source buffer.
@@ -1405,6 +1427,83 @@ inline uint64_t hashfnv(const void* buf, size_t size) {
 }
 
 
+/**
+ * Get the hash value by XXH64 hashing.
+ */
+inline uint64_t hashxx(const void* buf, size_t size) {
+  _assert_(buf && size <= MEMMAXSIZ);
+  const uint64_t prime1 = 0x9e3779b185ebca87ULL;
+  const uint64_t prime2 = 0xc2b2ae3d27d4eb4fULL;
+  const uint64_t prime3 = 0x165667b19e3779f9ULL;
+  const uint64_t prime4 = 0x85ebca77c2b2ae63ULL;
+  const uint64_t prime5 = 0x27d4eb2f165667c5ULL;
+  const unsigned char* rp = (const unsigned char*)buf;
+  const unsigned char* ep = rp + size;
+  uint64_t hash;
+  if (size >= 32) {
+    uint64_t lanes[4];
+    lanes[0] = prime1 + prime2;
+    lanes[1] = prime2;
+    lanes[2] = 0;
+    lanes[3] = 0 - prime1;
+    do {
+      for (int32_t i = 0; i < 4; i++) {
+        uint64_t num = ((uint64_t)rp[0] << 0) | ((uint64_t)rp[1] << 8) |
+            ((uint64_t)rp[2] << 16) | ((uint64_t)rp[3] << 24) |
+            ((uint64_t)rp[4] << 32) | ((uint64_t)rp[5] << 40) |
+            ((uint64_t)rp[6] << 48) | ((uint64_t)rp[7] << 56);
+        lanes[i] += num * prime2;
+        lanes[i] = (lanes[i] << 31) | (lanes[i] >> 33);
+        lanes[i] *= prime1;
+        rp += sizeof(uint64_t);
+      }
+    } while (ep - rp >= 32);
+    hash = ((lanes[0] << 1) | (lanes[0] >> 63)) + ((lanes[1] << 7) | (lanes[1] >> 57)) +
+        ((lanes[2] << 12) | (lanes[2] >> 52)) + ((lanes[3] << 18) | (lanes[3] >> 46));
+    for (int32_t i = 0; i < 4; i++) {
+      uint64_t num = lanes[i] * prime2;
+      num = (num << 31) | (num >> 33);
+      num *= prime1;
+      hash ^= num;
+      hash = hash * prime1 + prime4;
+    }
+  } else {
+    hash = prime5;
+  }
+  hash += size;
+  while (ep - rp >= 8) {
+    uint64_t num = ((uint64_t)rp[0] << 0) | ((uint64_t)rp[1] << 8) |
+        ((uint64_t)rp[2] << 16) | ((uint64_t)rp[3] << 24) |
+        ((uint64_t)rp[4] << 32) | ((uint64_t)rp[5] << 40) |
+        ((uint64_t)rp[6] << 48) | ((uint64_t)rp[7] << 56);
+    num *= prime2;
+    num = (num << 31) | (num >> 33);
+    num *= prime1;
+    hash ^= num;
+    hash = ((hash << 27) | (hash >> 37)) * prime1 + prime4;
+    rp += sizeof(uint64_t);
+  }
+  if (ep - rp >= 4) {
+    uint64_t num = ((uint64_t)rp[0] << 0) | ((uint64_t)rp[1] << 8) |
+        ((uint64_t)rp[2] << 16) | ((uint64_t)rp[3] << 24);
+    hash ^= num * prime1;
+    hash = ((hash << 23) | (hash >> 41)) * prime2 + prime3;
+    rp += sizeof(uint32_t);
+  }
+  while (rp < ep) {
+    hash ^= (uint64_t)*rp * prime5;
+    hash = ((hash << 11) | (hash >> 53)) * prime1;
+    rp++;
+  }
+  hash ^= hash >> 33;
+  hash *= prime2;
+  hash ^= hash >> 29;
+  hash *= prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+
 /**
  * Get the hash value suitable for a file name.
  */
@@ -78,7 +78,7 @@ static void usage() {
   eprintf("  %s hex [-d] [file]\n", g_progname);
   eprintf("  %s enc [-hex|-url|-quote] [-d] [file]\n", g_progname);
   eprintf("  %s ciph [-key str] [file]\n", g_progname);
-  eprintf("  %s comp [-def|-gz|-lzo|-lzma] [-d] [file]\n", g_progname);
+  eprintf("  %s comp [-def|-gz|-lzo|-lzma|-lz4|-zstd] [-d] [file]\n", g_progname);
   eprintf("  %s hash [-fnv|-path|-crc] [file]\n", g_progname);
   eprintf("  %s regex [-alt str] [-ic] pattern [file]\n", g_progname);
   eprintf("  %s conf [-v|-i|-l|-p]\n", g_progname);
@@ -192,6 +192,10 @@ static int32_t runcomp(int argc, char** argv) {
         mode = 3;
       } else if (!std::strcmp(argv[i], "-lzma")) {
         mode = 4;
+      } else if (!std::strcmp(argv[i], "-lz4")) {
+        mode = 5;
+      } else if (!std::strcmp(argv[i], "-zstd")) {
+        mode = 6;
       } else if (!std::strcmp(argv[i], "-d")) {
         dec = true;
       } else {
@@ -613,6 +617,56 @@ static int32_t proccomp(const char* file, int32_t mode, bool dec) {
       }
       break;
     }
+    case 5: {
+      kc::LZ4::Mode zmode = kc::LZ4::RAW;
+      if (dec) {
+        size_t zsiz;
+        char* zbuf = kc::LZ4::decompress(ostr.data(), ostr.size(), &zsiz, zmode);
+        if (zbuf) {
+          std::cout.write(zbuf, zsiz);
+          delete[] zbuf;
+        } else {
+          eprintf("%s: decompression failed\n", g_progname);
+          err = true;
+        }
+      } else {
+        size_t zsiz;
+        char* zbuf = kc::LZ4::compress(ostr.data(), ostr.size(), &zsiz, zmode);
+        if (zbuf) {
+          std::cout.write(zbuf, zsiz);
+          delete[] zbuf;
+        } else {
+          eprintf("%s: compression failed\n", g_progname);
+          err = true;
+        }
+      }
+      break;
+    }
+    case 6: {
+      kc::ZSTD::Mode zmode = kc::ZSTD::RAW;
+      if (dec) {
+        size_t zsiz;
+        char* zbuf = kc::ZSTD::decompress(ostr.data(), ostr.size(), &zsiz, zmode);
+        if (zbuf) {
+          std::cout.write(zbuf, zsiz);
+          delete[] zbuf;
+        } else {
+          eprintf("%s: decompression failed\n", g_progname);
+          err = true;
+        }
+      } else {
+        size_t zsiz;
+        char* zbuf = kc::ZSTD::compress(ostr.data(), ostr.size(), &zsiz, zmode);
+        if (zbuf) {
+          std::cout.write(zbuf, zsiz);
+          delete[] zbuf;
+        } else {
+          eprintf("%s: compression failed\n", g_progname);
+          err = true;
+        }
+      }
+      break;
+    }
   }
   return err ? 1 : 0;
 }
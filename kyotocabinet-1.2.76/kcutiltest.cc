@@ -41,14 +41,17 @@ static int32_t runlhmap(int argc, char** argv);
 static int32_t runthmap(int argc, char** argv);
 static int32_t runtalist(int argc, char** argv);
 static int32_t runmisc(int argc, char** argv);
+static int32_t runhash(int argc, char** argv);
 static int32_t procmutex(int64_t rnum, int32_t thnum, double iv);
 static int32_t proccond(int64_t rnum, int32_t thnum, double iv);
 static int32_t procpara(int64_t rnum, int32_t thnum, double iv);
-static int32_t procfile(const char* path, int64_t rnum, int32_t thnum, bool rnd, int64_t msiz);
+static int32_t procfile(const char* path, int64_t rnum, int32_t thnum, bool rnd, int64_t msiz,
+                        bool mgrow);
 static int32_t proclhmap(int64_t rnum, bool rnd, int64_t bnum);
 static int32_t procthmap(int64_t rnum, bool rnd, int64_t bnum);
 static int32_t proctalist(int64_t rnum, bool rnd);
 static int32_t procmisc(int64_t rnum);
+static int32_t prochash(int64_t rnum, int32_t ksiz);
 
 
 // main routine
@@ -77,6 +80,8 @@ int main(int argc, char** argv) {
     rv = runtalist(argc, argv);
   } else if (!std::strcmp(argv[1], "misc")) {
     rv = runmisc(argc, argv);
+  } else if (!std::strcmp(argv[1], "hash")) {
+    rv = runhash(argc, argv);
   } else {
     usage();
   }
@@ -99,11 +104,12 @@ static void usage() {
   eprintf("  %s mutex [-th num] [-iv num] rnum\n", g_progname);
   eprintf("  %s para [-th num] [-iv num] rnum\n", g_progname);
   eprintf("  %s cond [-th num] [-iv num] rnum\n", g_progname);
-  eprintf("  %s file [-th num] [-rnd] [-msiz num] path rnum\n", g_progname);
+  eprintf("  %s file [-th num] [-rnd] [-msiz num] [-mg] path rnum\n", g_progname);
   eprintf("  %s lhmap [-rnd] [-bnum num] rnum\n", g_progname);
   eprintf("  %s thmap [-rnd] [-bnum num] rnum\n", g_progname);
   eprintf("  %s talist [-rnd] rnum\n", g_progname);
   eprintf("  %s misc rnum\n", g_progname);
+  eprintf("  %s hash [-ksiz num] rnum\n", g_progname);
   eprintf("\n");
   std::exit(1);
 }
@@ -248,6 +254,7 @@ static int32_t runfile(int argc, char** argv) {
   int32_t thnum = 1;
   bool rnd = false;
   int64_t msiz = 0;
+  bool mgrow = false;
   for (int32_t i = 2; i < argc; i++) {
     if (!argbrk && argv[i][0] == '-') {
       if (!std::strcmp(argv[i], "--")) {
@@ -260,6 +267,8 @@ static int32_t runfile(int argc, char** argv) {
       } else if (!std::strcmp(argv[i], "-msiz")) {
         if (++i >= argc) usage();
         msiz = kc::atoix(argv[i]);
+      } else if (!std::strcmp(argv[i], "-mg")) {
+        mgrow = true;
       } else {
         usage();
       }
@@ -276,7 +285,7 @@ static int32_t runfile(int argc, char** argv) {
   int64_t rnum = kc::atoix(rstr);
   if (rnum < 1 || thnum < 1 || msiz < 0) usage();
   if (thnum > THREADMAX) thnum = THREADMAX;
-  int32_t rv = procfile(path, rnum, thnum, rnd, msiz);
+  int32_t rv = procfile(path, rnum, thnum, rnd, msiz, mgrow);
   return rv;
 }
 
@@ -400,6 +409,36 @@ static int32_t runmisc(int argc, char** argv) {
 }
 
 
+// parse arguments of hash command
+static int32_t runhash(int argc, char** argv) {
+  bool argbrk = false;
+  const char* rstr = NULL;
+  int32_t ksiz = 24;
+  for (int32_t i = 2; i < argc; i++) {
+    if (!argbrk && argv[i][0] == '-') {
+      if (!std::strcmp(argv[i], "--")) {
+        argbrk = true;
+      } else if (!std::strcmp(argv[i], "-ksiz")) {
+        if (++i >= argc) usage();
+        ksiz = kc::atoix(argv[i]);
+      } else {
+        usage();
+      }
+    } else if (!rstr) {
+      argbrk = true;
+      rstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!rstr) usage();
+  int64_t rnum = kc::atoix(rstr);
+  if (rnum < 1 || ksiz < 1) usage();
+  int32_t rv = prochash(rnum, ksiz);
+  return rv;
+}
+
+
 // perform mutex command
 static int32_t procmutex(int64_t rnum, int32_t thnum, double iv) {
   oprintf("<Mutex Test>\n  seed=%u  rnum=%lld  thnum=%d  iv=%.3f\n\n",
@@ -1383,14 +1422,17 @@ static int32_t procpara(int64_t rnum, int32_t thnum, double iv) {
 
 
 // perform file command
-static int32_t procfile(const char* path, int64_t rnum, int32_t thnum, bool rnd, int64_t msiz) {
-  oprintf("<File Test>\n  seed=%u  path=%s  rnum=%lld  thnum=%d  rnd=%d  msiz=%lld\n\n",
-          g_randseed, path, (long long)rnum, thnum, rnd, (long long)msiz);
+static int32_t procfile(const char* path, int64_t rnum, int32_t thnum, bool rnd, int64_t msiz,
+                        bool mgrow) {
+  oprintf("<File Test>\n  seed=%u  path=%s  rnum=%lld  thnum=%d  rnd=%d  msiz=%lld"
+          "  mgrow=%d\n\n", g_randseed, path, (long long)rnum, thnum, rnd, (long long)msiz, mgrow);
   bool err = false;
   kc::File file;
   oprintf("opening the file:\n");
   double stime = kc::time();
-  if (!file.open(path, kc::File::OWRITER | kc::File::OCREATE | kc::File::OTRUNCATE, msiz)) {
+  uint32_t omode = kc::File::OWRITER | kc::File::OCREATE | kc::File::OTRUNCATE;
+  if (mgrow) omode |= kc::File::OMAPGROW;
+  if (!file.open(path, omode, msiz)) {
     fileerrprint(&file, __LINE__, "File::open");
     err = true;
   }
@@ -1650,6 +1692,37 @@ static int32_t procfile(const char* path, int64_t rnum, int32_t thnum, bool rnd,
   etime = kc::time();
   filemetaprint(&file);
   oprintf("time: %.3f\n", etime - stime);
+  oprintf("batch reading:\n");
+  stime = kc::time();
+  int64_t bmax = file.size() / FILEIOUNIT;
+  const size_t BATCHNUM = 16;
+  for (int64_t i = 1; !err && bmax > 0 && i <= rnum; i += BATCHNUM) {
+    kc::File::ReadRequest reqs[BATCHNUM];
+    char bbufs[BATCHNUM][FILEIOUNIT];
+    size_t bnum = 0;
+    while (bnum < BATCHNUM && i + (int64_t)bnum <= rnum) {
+      int64_t num = rnd ? myrand(bmax) : (i + bnum - 1) % bmax;
+      reqs[bnum].off = num * FILEIOUNIT;
+      reqs[bnum].buf = bbufs[bnum];
+      reqs[bnum].size = FILEIOUNIT;
+      bnum++;
+    }
+    if (!file.read_batch(reqs, bnum)) {
+      fileerrprint(&file, __LINE__, "File::read_batch");
+      err = true;
+    }
+    for (size_t j = 0; !err && j < bnum; j++) {
+      char rbuf[FILEIOUNIT];
+      if (!reqs[j].ok || !file.read_fast(reqs[j].off, rbuf, FILEIOUNIT) ||
+          std::memcmp(rbuf, bbufs[j], FILEIOUNIT)) {
+        fileerrprint(&file, __LINE__, "File::read_batch");
+        err = true;
+      }
+    }
+  }
+  etime = kc::time();
+  filemetaprint(&file);
+  oprintf("time: %.3f\n", etime - stime);
   oprintf("committing transaction:\n");
   stime = kc::time();
   int64_t qsiz = file.size() / 4;
@@ -2752,6 +2825,42 @@ static int32_t procmisc(int64_t rnum) {
       errprint(__LINE__, "LZO::compress");
       err = true;
     }
+    zbuf = kc::LZ4::compress(ubuf, usiz, &zsiz, kc::LZ4::CRC);
+    if (zbuf) {
+      obuf = kc::LZ4::decompress(zbuf, zsiz, &osiz, kc::LZ4::CRC);
+      if (obuf) {
+        if (osiz != usiz || std::memcmp(obuf, ubuf, osiz)) {
+          errprint(__LINE__, "LZ4::decompress");
+          err = true;
+        }
+        delete[] obuf;
+      } else {
+        errprint(__LINE__, "LZ4::decompress");
+        err = true;
+      }
+      delete[] zbuf;
+    } else {
+      errprint(__LINE__, "LZ4::compress");
+      err = true;
+    }
+    zbuf = kc::ZSTD::compress(ubuf, usiz, &zsiz, kc::ZSTD::CRC);
+    if (zbuf) {
+      obuf = kc::ZSTD::decompress(zbuf, zsiz, &osiz, kc::ZSTD::CRC);
+      if (obuf) {
+        if (osiz != usiz || std::memcmp(obuf, ubuf, osiz)) {
+          errprint(__LINE__, "ZSTD::decompress");
+          err = true;
+        }
+        delete[] obuf;
+      } else {
+        errprint(__LINE__, "ZSTD::decompress");
+        err = true;
+      }
+      delete[] zbuf;
+    } else {
+      errprint(__LINE__, "ZSTD::compress");
+      err = true;
+    }
     std::string ustr((char*)ubuf, usiz);
     kc::Regex::match(ustr, ".(\x80).");
     kc::Regex::replace(ustr, ".(\x80).", "[$0$1$2$&]");
@@ -2765,6 +2874,60 @@ static int32_t procmisc(int64_t rnum) {
   return err ? 1 : 0;
 }
 
+// perform hash command
+static int32_t prochash(int64_t rnum, int32_t ksiz) {
+  oprintf("<Hash Function Test>\n  seed=%u  rnum=%lld  ksiz=%d\n\n",
+          g_randseed, (long long)rnum, ksiz);
+  bool err = false;
+  oprintf("checking test vectors:\n");
+  char vbuf[RECBUFSIZ];
+  for (int32_t i = 0; i < (int32_t)sizeof(vbuf); i++) {
+    vbuf[i] = i;
+  }
+  if (kc::hashxx("", 0) != 0xef46db3751d8e999ULL) {
+    errprint(__LINE__, "hashxx: empty");
+    err = true;
+  }
+  if (kc::hashxx("abc", 3) != 0x44bc2cf5ad770999ULL) {
+    errprint(__LINE__, "hashxx: abc");
+    err = true;
+  }
+  if (kc::hashxx(vbuf, 100) == kc::hashxx(vbuf + 1, 100)) {
+    errprint(__LINE__, "hashxx: collision");
+    err = true;
+  }
+  size_t bsiz = ksiz + sizeof(uint64_t);
+  char* kbuf = new char[bsiz];
+  for (size_t i = 0; i < bsiz; i++) {
+    kbuf[i] = 'a' + myrand(26);
+  }
+  const char* const names[] = { "MurMur", "FNV", "XXH64" };
+  for (int32_t func = 0; func < 3; func++) {
+    oprintf("hashing with %s:\n", names[func]);
+    double stime = kc::time();
+    uint64_t sum = 0;
+    for (int64_t i = 1; i <= rnum; i++) {
+      const char* rp = kbuf + i % sizeof(uint64_t);
+      switch (func) {
+        case 0: sum += kc::hashmurmur(rp, ksiz); break;
+        case 1: sum += kc::hashfnv(rp, ksiz); break;
+        default: sum += kc::hashxx(rp, ksiz); break;
+      }
+      if (rnum > 250 && i % (rnum / 250) == 0) {
+        oputchar('.');
+        if (i == rnum || i % (rnum / 10) == 0) oprintf(" (%08lld)\n", (long long)i);
+      }
+    }
+    double etime = kc::time() - stime;
+    oprintf("sum: %016llx\n", (unsigned long long)sum);
+    oprintf("time: %.3f (%.1f MB/s)\n", etime,
+            etime > 0 ? (double)rnum * ksiz / etime / (1024 * 1024) : 0.0);
+  }
+  delete[] kbuf;
+  oprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
 
 
 // END OF FILE
@@ -125,6 +125,24 @@
 #define _KC_LZMA       0
 #endif
 
+#if defined(_MYLZ4)
+#define _KC_LZ4        1
+#else
+#define _KC_LZ4        0
+#endif
+
+#if defined(_MYZSTD)
+#define _KC_ZSTD       1
+#else
+#define _KC_ZSTD       0
+#endif
+
+#if defined(_MYURING)
+#define _KC_URING      1
+#else
+#define _KC_URING      0
+#endif
+
 #if defined(_SYS_MSVC_)
 #define _KC_PXREGEX    0
 #else
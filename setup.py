@@ -1,16 +1,52 @@
 from distutils.core import setup, Extension
+from distutils.ccompiler import new_compiler
+from distutils.sysconfig import customize_compiler
 import os.path
+import shutil
+import tempfile
 
 kyotocabinet_cc = "kcutil.cc", "kcthread.cc", "kcfile.cc", "kccompress.cc", "kccompare.cc", "kcmap.cc", "kcregex.cc", "kcdb.cc", "kcplantdb.cc", "kcprotodb.cc", "kcstashdb.cc", "kccachedb.cc", "kchashdb.cc", "kcdirdb.cc", "kctextdb.cc", "kcpolydb.cc", "kcdbext.cc", "kclangc.cc"
 
 #kyotocabinet_cc = []
 
+# optional compression libraries: (macro, header, library)
+# Values stored as tagged copies by a build without a library are still read after it is found.
+compression_libs = [("_MYZLIB", "zlib.h", "z"),
+                    ("_MYLZMA", "lzma.h", "lzma"),
+                    ("_MYLZ4", "lz4.h", "lz4"),
+                    ("_MYZSTD", "zstd.h", "zstd")]
+
+def has_library(header, library):
+    """Check whether a header and a library are usable by compiling a tiny program."""
+    compiler = new_compiler()
+    customize_compiler(compiler)
+    tmpdir = tempfile.mkdtemp()
+    try:
+        src = os.path.join(tmpdir, 'check.c')
+        with open(src, 'w') as f:
+            f.write('#include <%s>\nint main(void) { return 0; }\n' % header)
+        objs = compiler.compile([src], output_dir=tmpdir)
+        compiler.link_executable(objs, os.path.join(tmpdir, 'check'), libraries=[library])
+        return True
+    except Exception:
+        return False
+    finally:
+        shutil.rmtree(tmpdir)
+
+define_macros = []
+libraries = []
+for macro, header, library in compression_libs:
+    if has_library(header, library):
+        define_macros.append((macro, None))
+        libraries.append(library)
+
 README = open(os.path.join(os.path.dirname(__file__), 'README.rst')).read()
 
 module1 = Extension('yakc',
                     include_dirs = ['kyotocabinet-1.2.76'],
                     sources = ['yakc.cpp'] + [os.path.join('kyotocabinet-1.2.76', x) for x in kyotocabinet_cc],
-                    libraries=[])
+                    define_macros = define_macros,
+                    libraries = libraries)
 
 setup (name = 'yakc',
        version = '0.1.5',
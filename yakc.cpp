@@ -11,17 +11,28 @@ typedef struct {
     PyObject_HEAD
     kyotocabinet::BasicDB *m_db;
     bool use_pickle;
+    bool m_closed;
 } KyotoDB;
 
+typedef struct {
+    PyObject_HEAD
+    KyotoDB *m_db;
+    kyotocabinet::BasicDB::Snapshot *m_snapshot;
+} KyotoSnapshot;
+
 typedef struct {
     PyObject_HEAD
     KyotoDB *m_db;
     kyotocabinet::BasicDB::Cursor *m_cursor;
     enum KyotoCursorType m_type;
+    KyotoSnapshot *m_owner;
+    kyotocabinet::BasicDB::Snapshot::Cursor *m_scursor;
 } KyotoCursor;
 
 extern PyTypeObject yakc_CursorType;
+extern PyTypeObject yakc_SnapshotType;
 int Cursor_init(KyotoCursor *self, PyObject *args, PyObject *kwds);
+static bool Snapshot_check(KyotoSnapshot *self);
 
 
 class AutoPythonRef
@@ -131,6 +142,7 @@ KyotoDB_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     self = (KyotoDB *)type->tp_alloc(type, 0);
     if (self != NULL) {
         self->m_db = NULL;
+        self->m_closed = false;
     }
     return (PyObject *)self;
 }
@@ -375,6 +387,7 @@ static PyObject *
 KyotoDB_close(KyotoDB *self)
 {
     self->m_db->close();
+    self->m_closed = true;
     Py_RETURN_NONE;
 }
 
@@ -437,17 +450,81 @@ KyotoDB_has_key(KyotoDB *self, PyObject *obj)
 static PyObject *
 KyotoDB_clear(KyotoDB *self)
 {
-    kyotocabinet::BasicDB::Cursor *cursor = self->m_db->cursor();
-    if (cursor == NULL) {
-        PyErr_SetString(PyExc_RuntimeError, "Cannot create cursor");
+    if (!self->m_db->clear()) {
+        PyErr_SetString(PyExc_RuntimeError, "KyotoCabinet Error");
         return 0;
     }
-    cursor->jump();
-    while (cursor->remove());
-    delete cursor;
     Py_RETURN_NONE;
 }
 
+static bool
+KyotoDB_range(KyotoDB *self, PyObject *args, PyObject *kwds,
+              std::string *cbegin, std::string *cend,
+              const char **bkbuf, const char **ekbuf)
+{
+    static char* kwlist[5] = {
+        strdup("begin"), strdup("end"), NULL
+    };
+
+    PyObject *begin = Py_None;
+    PyObject *end = Py_None;
+
+    if (! PyArg_ParseTupleAndKeywords(args, kwds, "|OO", kwlist,
+                                      &begin, &end))
+        return false;
+
+    bool ok;
+    *bkbuf = NULL;
+    if (begin != Py_None) {
+        *cbegin = KyotoDB_dump(begin, self->use_pickle, &ok);
+        if (!ok)
+            return false;
+        *bkbuf = cbegin->data();
+    }
+    *ekbuf = NULL;
+    if (end != Py_None) {
+        *cend = KyotoDB_dump(end, self->use_pickle, &ok);
+        if (!ok)
+            return false;
+        *ekbuf = cend->data();
+    }
+    return true;
+}
+
+static PyObject *
+KyotoDB_remove_range(KyotoDB *self, PyObject *args, PyObject *kwds)
+{
+    std::string cbegin, cend;
+    const char *bkbuf, *ekbuf;
+    if (!KyotoDB_range(self, args, kwds, &cbegin, &cend, &bkbuf, &ekbuf))
+        return 0;
+
+    int64_t num = self->m_db->remove_range(bkbuf, cbegin.size(),
+                                           ekbuf, cend.size());
+    if (num < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "KyotoCabinet Error");
+        return 0;
+    }
+    return PyInt_FromLong(num);
+}
+
+static PyObject *
+KyotoDB_count_range(KyotoDB *self, PyObject *args, PyObject *kwds)
+{
+    std::string cbegin, cend;
+    const char *bkbuf, *ekbuf;
+    if (!KyotoDB_range(self, args, kwds, &cbegin, &cend, &bkbuf, &ekbuf))
+        return 0;
+
+    int64_t num = self->m_db->count_range(bkbuf, cbegin.size(),
+                                          ekbuf, cend.size());
+    if (num < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "KyotoCabinet Error");
+        return 0;
+    }
+    return PyInt_FromLong(num);
+}
+
 static PyObject *
 KyotoDB_pop(KyotoDB *self, PyObject *args, PyObject *kwds)
 {
@@ -576,6 +653,110 @@ KyotoDB_update(KyotoDB *self, PyObject *args, PyObject *kwds)
     Py_RETURN_NONE;
 }
 
+static PyObject *
+KyotoDB_apply_batch(KyotoDB *self, PyObject *args, PyObject *kwds)
+{
+    static char* kwlist[5] = {
+        strdup("set"), strdup("remove"), NULL
+    };
+
+    PyObject *sets = Py_None;
+    PyObject *removes = Py_None;
+
+    if (! PyArg_ParseTupleAndKeywords(args, kwds, "|OO", kwlist,
+                                      &sets, &removes))
+        return NULL;
+
+    kyotocabinet::BasicDB::WriteBatch batch;
+    bool ok;
+
+    if (removes != Py_None) {
+        APR iterator(PyObject_GetIter(removes));
+        APR item;
+
+        if (iterator == NULL) {
+            PyErr_SetString(PyExc_RuntimeError, "object is not iterable");
+            return NULL;
+        }
+
+        while ((item = PyIter_Next(iterator.get())) != NULL) {
+            std::string ckey = KyotoDB_dump(item, self->use_pickle, &ok);
+            if (!ok)
+                return NULL;
+            batch.remove(ckey);
+        }
+    }
+
+    if (sets != Py_None) {
+        bool mapping = PyMapping_Check(sets);
+        APR iterator(PyObject_GetIter(sets));
+        APR item;
+
+        if (iterator == NULL) {
+            PyErr_SetString(PyExc_RuntimeError, "object is not iterable");
+            return NULL;
+        }
+
+        Py_ssize_t i = 0;
+        while ((item = PyIter_Next(iterator.get())) != NULL) {
+            APR key;
+            APR value;
+            if (mapping) {
+                key = item.get();
+                ++key;
+                value = PyObject_GetItem(sets, item.get());
+            } else if (PySequence_Check(item.get()) && PySequence_Size(item.get()) == 2) {
+                key = PySequence_GetItem(item.get(), 0);
+                value = PySequence_GetItem(item.get(), 1);
+            } else {
+                APR str(PyString_FromFormat("batch set sequence element #%zd is not a pair", i));
+                PyErr_SetObject(PyExc_TypeError, str.get());
+                return NULL;
+            }
+            if (value == NULL)
+                return NULL;
+
+            std::string ckey = KyotoDB_dump(key, self->use_pickle, &ok);
+            if (!ok)
+                return NULL;
+
+            std::string cvalue = KyotoDB_dump(value, self->use_pickle, &ok);
+            if (!ok)
+                return NULL;
+
+            batch.set(ckey, cvalue);
+            i++;
+        }
+    }
+
+    if (!self->m_db->apply_batch(batch)) {
+        PyErr_SetString(PyExc_RuntimeError, "KyotoCabinet Error");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *
+KyotoDB_snapshot(KyotoDB *self)
+{
+    kyotocabinet::BasicDB::Snapshot *snapshot = self->m_db->snapshot();
+    if (!snapshot) {
+        PyErr_SetString(PyExc_RuntimeError, "KyotoCabinet Error");
+        return NULL;
+    }
+
+    KyotoSnapshot *result = PyObject_New(KyotoSnapshot, &yakc_SnapshotType);
+    if (result == NULL) {
+        delete snapshot;
+        return NULL;
+    }
+    result->m_db = self;
+    Py_INCREF((PyObject *)self);
+    result->m_snapshot = snapshot;
+    return (PyObject *)result;
+}
+
 
 static PyMethodDef KyotoDB_methods[] = {
     {"size", (PyCFunction)KyotoDB_size, METH_NOARGS,
@@ -600,6 +781,10 @@ static PyMethodDef KyotoDB_methods[] = {
      "close database"},
     {"clear", (PyCFunction)KyotoDB_clear, METH_NOARGS,
      "remove all items"},
+    {"remove_range", (PyCFunction)KyotoDB_remove_range, METH_KEYWORDS,
+     "remove items whose keys are in [begin, end)"},
+    {"count_range", (PyCFunction)KyotoDB_count_range, METH_KEYWORDS,
+     "count items whose keys are in [begin, end)"},
     {"has_key", (PyCFunction)KyotoDB_has_key, METH_O,
      "check key availability"},
     {"get", (PyCFunction)KyotoDB_get, METH_KEYWORDS,
@@ -608,6 +793,10 @@ static PyMethodDef KyotoDB_methods[] = {
      "pop item"},
     {"update", (PyCFunction)KyotoDB_update, METH_KEYWORDS,
      "update item"},
+    {"apply_batch", (PyCFunction)KyotoDB_apply_batch, METH_KEYWORDS,
+     "remove and set items atomically"},
+    {"snapshot", (PyCFunction)KyotoDB_snapshot, METH_NOARGS,
+     "read-only view of the database as of now"},
     {NULL, NULL, 0, NULL}        /* Sentinel */
 };
 
@@ -684,6 +873,10 @@ Cursor_dealloc(KyotoCursor* self)
     Py_DECREF(self->m_db);
     if (self->m_cursor)
         delete self->m_cursor;
+    if (self->m_scursor)
+        delete self->m_scursor;
+    if (self->m_owner)
+        Py_DECREF(self->m_owner);
 }
 
 static PyObject *
@@ -694,6 +887,8 @@ Cursor_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     if (self != NULL) {
         self->m_cursor = NULL;
         self->m_type = KYOTO_KEY;
+        self->m_owner = NULL;
+        self->m_scursor = NULL;
     }
 
     return (PyObject *) self;
@@ -726,6 +921,8 @@ int Cursor_init(KyotoCursor *self, PyObject *args, PyObject *kwds)
     self->m_cursor = kyotodb->m_db->cursor();
     self->m_cursor->jump();
     self->m_type = (enum KyotoCursorType)type;
+    self->m_owner = NULL;
+    self->m_scursor = NULL;
 
     return 0;
 }
@@ -742,7 +939,11 @@ Cursor_next(KyotoCursor *self)
 {
     std::string key;
     std::string value;
-    bool succeed = self->m_cursor->get(&key, &value, true);
+    if (self->m_owner && !Snapshot_check(self->m_owner))
+        return NULL;
+    bool succeed = self->m_scursor ?
+        self->m_scursor->get(&key, &value, true) :
+        self->m_cursor->get(&key, &value, true);
     if (succeed) {
         switch (self->m_type) {
         case KYOTO_VALUE: {
@@ -806,6 +1007,238 @@ PyTypeObject yakc_CursorType = {
     Cursor_new,                 /* tp_new */
 };
 
+/* ---------------- Snapshot -------------------*/
+
+static bool
+Snapshot_check(KyotoSnapshot *self)
+{
+    if (!self->m_db->m_closed)
+        return true;
+    PyErr_SetString(PyExc_RuntimeError, "Database is closed");
+    return false;
+}
+
+static void
+Snapshot_error(KyotoSnapshot *self, PyObject *key)
+{
+    kyotocabinet::BasicDB::Error err = self->m_db->m_db->error();
+    if (err == kyotocabinet::BasicDB::Error::NOREC) {
+        PyErr_SetObject(PyExc_KeyError, key);
+        return;
+    }
+    APR str(PyString_FromFormat("KyotoCabinet Error: %s", err.message()));
+    PyErr_SetObject(PyExc_RuntimeError, str);
+}
+
+static void
+Snapshot_dealloc(KyotoSnapshot *self)
+{
+    delete self->m_snapshot;
+    Py_DECREF(self->m_db);
+    self->ob_type->tp_free((PyObject *)self);
+}
+
+static PyObject *
+Snapshot_cursor(KyotoSnapshot *self, enum KyotoCursorType type)
+{
+    if (!Snapshot_check(self))
+        return NULL;
+    KyotoCursor *cursor = PyObject_New(KyotoCursor, &yakc_CursorType);
+    if (cursor == NULL)
+        return NULL;
+    cursor->m_db = self->m_db;
+    Py_INCREF((PyObject *)self->m_db);
+    cursor->m_cursor = NULL;
+    cursor->m_type = type;
+    cursor->m_owner = self;
+    Py_INCREF((PyObject *)self);
+    cursor->m_scursor = self->m_snapshot->cursor();
+    cursor->m_scursor->jump();
+    return (PyObject *)cursor;
+}
+
+static PyObject *
+Snapshot_iter(KyotoSnapshot *self)
+{
+    return Snapshot_cursor(self, KYOTO_KEY);
+}
+
+static PyObject *
+Snapshot_itervalues(KyotoSnapshot *self)
+{
+    return Snapshot_cursor(self, KYOTO_VALUE);
+}
+
+static PyObject *
+Snapshot_iteritems(KyotoSnapshot *self)
+{
+    return Snapshot_cursor(self, KYOTO_ITEMS);
+}
+
+static PyObject *
+Snapshot_array(KyotoSnapshot *self, enum KyotoCursorType type)
+{
+    APR cursor(Snapshot_cursor(self, type));
+    if (cursor == NULL)
+        return NULL;
+    return PySequence_List(cursor.get());
+}
+
+static PyObject *
+Snapshot_keys(KyotoSnapshot *self)
+{
+    return Snapshot_array(self, KYOTO_KEY);
+}
+
+static PyObject *
+Snapshot_values(KyotoSnapshot *self)
+{
+    return Snapshot_array(self, KYOTO_VALUE);
+}
+
+static PyObject *
+Snapshot_items(KyotoSnapshot *self)
+{
+    return Snapshot_array(self, KYOTO_ITEMS);
+}
+
+static PyObject *
+Snapshot__get__(KyotoSnapshot *self, PyObject *key)
+{
+    if (!Snapshot_check(self))
+        return NULL;
+    bool ok;
+    std::string ckey = KyotoDB_dump(key, self->m_db->use_pickle, &ok);
+    if (!ok) return 0;
+
+    std::string value;
+    if (self->m_snapshot->get(ckey, &value))
+        return KyotoDB_load(value, self->m_db->use_pickle);
+    Snapshot_error(self, key);
+    return NULL;
+}
+
+static PyObject *
+Snapshot_get(KyotoSnapshot *self, PyObject *args, PyObject *kwds)
+{
+    static char* kwlist[5] = {
+        strdup("key"), strdup("default"), NULL
+    };
+
+    PyObject *key = NULL;
+    PyObject *defaultvalue = Py_None;
+
+    if (! PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist,
+                                      &key, &defaultvalue))
+        return 0;
+    if (!Snapshot_check(self))
+        return NULL;
+
+    bool ok;
+    std::string ckey = KyotoDB_dump(key, self->m_db->use_pickle, &ok);
+    if (!ok)
+        return 0;
+
+    std::string value;
+    if (self->m_snapshot->get(ckey, &value))
+        return KyotoDB_load(value, self->m_db->use_pickle);
+    if (self->m_db->m_db->error() != kyotocabinet::BasicDB::Error::NOREC) {
+        Snapshot_error(self, key);
+        return NULL;
+    }
+
+    Py_INCREF(defaultvalue);
+    return defaultvalue;
+}
+
+static int
+Snapshot_contains(KyotoSnapshot *self, PyObject *obj)
+{
+    if (!Snapshot_check(self))
+        return -1;
+    bool ok;
+    std::string ckey = KyotoDB_dump(obj, self->m_db->use_pickle, &ok);
+    std::string value;
+    if (!ok)
+        return 0;
+    if (self->m_snapshot->get(ckey, &value))
+        return 1;
+    if (self->m_db->m_db->error() != kyotocabinet::BasicDB::Error::NOREC) {
+        Snapshot_error(self, obj);
+        return -1;
+    }
+    return 0;
+}
+
+static PyMethodDef Snapshot_methods[] = {
+    {"keys", (PyCFunction)Snapshot_keys, METH_NOARGS,
+     "List of keys"},
+    {"values", (PyCFunction)Snapshot_values, METH_NOARGS,
+     "List of values"},
+    {"items", (PyCFunction)Snapshot_items, METH_NOARGS,
+     "List of items"},
+    {"iterkeys", (PyCFunction)Snapshot_iter, METH_NOARGS,
+     "Iterator of keys"},
+    {"itervalues", (PyCFunction)Snapshot_itervalues, METH_NOARGS,
+     "Iterator of values"},
+    {"iteritems", (PyCFunction)Snapshot_iteritems, METH_NOARGS,
+     "Iterator of items"},
+    {"get", (PyCFunction)Snapshot_get, METH_KEYWORDS,
+     "get item for key"},
+    {NULL, NULL, 0, NULL}        /* Sentinel */
+};
+
+static PyMappingMethods Snapshot_mapping = {
+    NULL,                       // length
+    (binaryfunc)Snapshot__get__,
+    NULL,                       // set item
+};
+
+static PySequenceMethods Snapshot_sequence = {
+    NULL,                       // length
+    NULL,                       // concatenate
+    NULL,                       // repeat
+    NULL,                       // get item
+    NULL,                       // slice
+    NULL,                       // set item
+    NULL,                       // slice
+    (objobjproc)Snapshot_contains,
+    NULL,                       // in-place concatenate
+    NULL                        // in-place repeat
+};
+
+PyTypeObject yakc_SnapshotType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                          /*ob_size*/
+    "yakc.Snapshot",            /*tp_name*/
+    sizeof(KyotoSnapshot),      /*tp_basicsize*/
+    0,                          /*tp_itemsize*/
+    (destructor)Snapshot_dealloc, /*tp_dealloc*/
+    0,                          /*tp_print*/
+    0,                          /*tp_getattr*/
+    0,                          /*tp_setattr*/
+    0,                          /*tp_compare*/
+    0,                          /*tp_repr*/
+    0,                          /*tp_as_number*/
+    &Snapshot_sequence,         /*tp_as_sequence*/
+    &Snapshot_mapping,          /*tp_as_mapping*/
+    0,                          /*tp_hash */
+    0,                          /*tp_call*/
+    0,                          /*tp_str*/
+    0,                          /*tp_getattro*/
+    0,                          /*tp_setattro*/
+    0,                          /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,         /*tp_flags*/
+    "Kyoto DB Snapshot",        /* tp_doc */
+    0,                          /* tp_traverse */
+    0,                          /* tp_clear */
+    0,                          /* tp_richcompare */
+    0,                          /* tp_weaklistoffset */
+    (getiterfunc)Snapshot_iter, /* tp_iter */
+    0,                          /* tp_iternext */
+    Snapshot_methods,           /* tp_methods */
+};
+
 static PyMethodDef module_methods[] = {
     {NULL}  /* Sentinel */
 };
@@ -835,6 +1268,12 @@ inityakc(void)
     Py_INCREF(&yakc_CursorType);
     PyModule_AddObject(m, "Cursor", (PyObject *)&yakc_CursorType);
 
+    if (PyType_Ready(&yakc_SnapshotType) < 0)
+        return;
+
+    Py_INCREF(&yakc_SnapshotType);
+    PyModule_AddObject(m, "Snapshot", (PyObject *)&yakc_SnapshotType);
+
     APR cpickle_name(PyString_FromString("cPickle"));
     APR cpickle(PyImport_Import(cpickle_name));
 
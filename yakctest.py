@@ -79,6 +79,14 @@ class KyotoCabinetTest(unittest.TestCase):
         self.d.clear()
         self.assertEqual([], self.d.keys())
 
+    def test_range(self):
+        self.assertEqual(2, self.d.count_range('b', 'which'))
+        self.assertEqual(4, self.d.count_range())
+        self.assertEqual(2, self.d.remove_range(begin='b', end='which'))
+        self.assertEqual(['a', 'which'], self.d.keys())
+        self.assertEqual(1, self.d.remove_range(end='which'))
+        self.assertEqual(['which'], self.d.keys())
+
     def test_contains(self):
         self.assertEqual(True, 'a' in self.d)
         self.assertEqual(True, 'this' in self.d)
@@ -119,6 +127,43 @@ class KyotoCabinetTest(unittest.TestCase):
         self.assertEqual('view', self.d['sight'])
         self.assertEqual('snow', self.d['ski'])
 
+    def test_apply_batch(self):
+        self.d.apply_batch(set=[('a', '789'), ('c', 'new')], remove=['b', 'c', 'pen'])
+        self.assertEqual(['a', 'c', 'this', 'which'], self.d.keys())
+        self.assertEqual('789', self.d['a'])
+        self.assertEqual('new', self.d['c'])
+
+        self.d.apply_batch(set={'x': 'y'})
+        self.assertEqual('y', self.d['x'])
+        self.d.apply_batch(remove=['x', 'this'])
+        self.assertEqual(['a', 'c', 'which'], self.d.keys())
+        self.assertRaises(TypeError, self.d.apply_batch, set=['abc'])
+
+    def test_snapshot(self):
+        s = self.d.snapshot()
+        self.d['a'] = '789'
+        self.d['c'] = 'new'
+        self.d.pop('this')
+        self.assertEqual('123', s['a'])
+        self.assertEqual('is', s.get('this'))
+        self.assertEqual(None, s.get('c'))
+        self.assertEqual(False, 'c' in s)
+        self.assertEqual(True, 'this' in s)
+        self.assertEqual([('a', '123'), ('b', '456'),
+                          ('this', 'is'), ('which', 'pair')], sorted(s.items()))
+        self.assertEqual(['a', 'b', 'c', 'which'], sorted(self.d.keys()))
+        self.assertRaises(KeyError, s.__getitem__, 'c')
+        del s
+        self.d['b'] = '000'
+        self.assertEqual('000', self.d['b'])
+
+    def test_snapshot_after_close(self):
+        s = self.d.snapshot()
+        self.d.close()
+        self.assertRaises(RuntimeError, s.get, 'a')
+        self.assertRaises(RuntimeError, s.__getitem__, 'a')
+        self.assertRaises(RuntimeError, s.keys)
+
 
     def tearDown(self):
         self.d.close()
@@ -133,6 +178,10 @@ class KyotoCabinetHashDb(KyotoCabinetTest):
         KyotoCabinetTest.__init__(self, *vargs, **kwds)
         self.mgr = 'kchashmgr'
         self.suffix = '.kch'
+
+    def test_range(self):
+        self.assertRaises(RuntimeError, self.d.count_range, 'b', 'which')
+        self.assertRaises(RuntimeError, self.d.remove_range, 'b', 'which')
         
 
 if __name__ == '__main__':